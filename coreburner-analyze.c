@@ -0,0 +1,916 @@
+/* coreburner-analyze.c
+ *
+ * CoreBurner offline log analyzer
+ *
+ * Features:
+ *  - Streaming reader for CoreBurner CSV logs and the compact binary
+ *    (.cbl) format, with a fixed-size row block (memory-bounded)
+ *  - Parallel per-column reduction (column slices split across threads)
+ *  - Per-phase statistics (phases from "# phase=NAME" markers)
+ *  - Per-core utilization / frequency statistics
+ *  - Run comparison: Mann-Whitney U test + bootstrap CI of mean delta
+ *    for throughput, frequency and power
+ *  - Regression flagging beyond a threshold (exit status 2)
+ *
+ * Build:
+ *   make coreburner-analyze
+ *   gcc -O2 -pthread -std=c11 -Wall -Wextra -o coreburner-analyze coreburner-analyze.c -lm
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/sysinfo.h>
+
+#define DEFAULT_BLOCK_ROWS 4096
+#define DEFAULT_BOOTSTRAP 2000
+#define DEFAULT_THRESHOLD_PCT 2.0
+#define DEFAULT_ALPHA 0.05
+#define MAX_PHASES 64
+#define MAX_PHASE_NAME 64
+#define RESERVOIR_CAP 65536
+
+#define CBL_MAGIC "CBLOG1\n"
+#define CBL_TAG_ROW 'R'
+#define CBL_TAG_PHASE 'P'
+
+/* Derived per-row metrics */
+enum {
+    M_THROUGHPUT = 0,   /* Million ops/s (sum of thread deltas / dt) */
+    M_FREQ,             /* Mean MHz across logged cores */
+    M_POWER,            /* Package watts (pkg_watts column) */
+    M_TEMP,             /* cpu_temp */
+    M_COUNT
+};
+
+static const char *metric_names[M_COUNT] = {
+    "Throughput (Mops/s)", "Frequency (MHz)", "Power (W)", "Temperature (C)"
+};
+
+/***********************************************************
+ *                 Running Statistics
+ ***********************************************************/
+typedef struct {
+    uint64_t n;
+    double mean;
+    double m2;
+    double min;
+    double max;
+} running_stat_t;
+
+static void rs_init(running_stat_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->min = INFINITY;
+    s->max = -INFINITY;
+}
+
+static void rs_add(running_stat_t *s, double v) {
+    if (isnan(v)) return;
+    s->n++;
+    double d = v - s->mean;
+    s->mean += d / s->n;
+    s->m2 += d * (v - s->mean);
+    if (v < s->min) s->min = v;
+    if (v > s->max) s->max = v;
+}
+
+static double rs_stdev(const running_stat_t *s) {
+    return s->n > 1 ? sqrt(s->m2 / (s->n - 1)) : 0.0;
+}
+
+/* Reservoir of samples kept for significance tests (bounded memory) */
+typedef struct {
+    double *v;
+    size_t n;
+    uint64_t seen;
+    uint64_t rng;
+} reservoir_t;
+
+static uint64_t xorshift64(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *s = x;
+    return x;
+}
+
+static int reservoir_init(reservoir_t *r, uint64_t seed) {
+    r->v = malloc(RESERVOIR_CAP * sizeof(double));
+    r->n = 0;
+    r->seen = 0;
+    r->rng = seed ? seed : 0x9e3779b97f4a7c15ULL;
+    return r->v ? 0 : -1;
+}
+
+static void reservoir_add(reservoir_t *r, double v) {
+    if (isnan(v)) return;
+    r->seen++;
+    if (r->n < RESERVOIR_CAP) {
+        r->v[r->n++] = v;
+        return;
+    }
+    uint64_t j = xorshift64(&r->rng) % r->seen;
+    if (j < RESERVOIR_CAP) r->v[j] = v;
+}
+
+static void reservoir_free(reservoir_t *r) {
+    free(r->v);
+    r->v = NULL;
+    r->n = 0;
+}
+
+/***********************************************************
+ *                    Log Reader
+ ***********************************************************/
+typedef struct {
+    FILE *f;
+    const char *path;
+    int binary;
+    int ncols;
+    char **names;
+    int phase;                  /* current phase index */
+    int nphases;
+    char phases[MAX_PHASES][MAX_PHASE_NAME];
+    char fingerprint[17];       /* from "# fp.hash=" header line */
+    char *line;
+    size_t cap;
+} log_reader_t;
+
+static int reader_phase_index(log_reader_t *r, const char *name) {
+    for (int i = 0; i < r->nphases; ++i)
+        if (strcmp(r->phases[i], name) == 0) return i;
+    if (r->nphases >= MAX_PHASES) return MAX_PHASES - 1;
+    snprintf(r->phases[r->nphases], MAX_PHASE_NAME, "%s", name);
+    return r->nphases++;
+}
+
+static void free_names(char **names, int n) {
+    if (!names) return;
+    for (int i = 0; i < n; ++i) free(names[i]);
+    free(names);
+}
+
+static int parse_csv_header(log_reader_t *r, const char *line) {
+    int n = 1;
+    for (const char *p = line; *p; ++p) if (*p == ',') n++;
+
+    char **names = calloc(n, sizeof(char *));
+    if (!names) return -1;
+
+    const char *p = line;
+    for (int i = 0; i < n; ++i) {
+        const char *e = p;
+        while (*e && *e != ',' && *e != '\n' && *e != '\r') e++;
+        names[i] = strndup(p, e - p);
+        p = (*e == ',') ? e + 1 : e;
+    }
+
+    if (r->names) {
+        int same = (n == r->ncols);
+        for (int i = 0; same && i < n; ++i)
+            same = strcmp(names[i], r->names[i]) == 0;
+        free_names(names, n);
+        if (!same) {
+            fprintf(stderr, "%s: column layout changes mid-file, stopping\n", r->path);
+            return -1;
+        }
+        return 0;
+    }
+
+    r->names = names;
+    r->ncols = n;
+    return 0;
+}
+
+static int log_open(log_reader_t *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    r->path = path;
+    r->f = fopen(path, "rb");
+    if (!r->f) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    char magic[sizeof(CBL_MAGIC)] = {0};
+    size_t got = fread(magic, 1, sizeof(CBL_MAGIC) - 1, r->f);
+    if (got == sizeof(CBL_MAGIC) - 1 && memcmp(magic, CBL_MAGIC, got) == 0) {
+        uint32_t ncols = 0;
+        if (fread(&ncols, sizeof(ncols), 1, r->f) != 1 || ncols == 0 || ncols > 1u << 20)
+            goto bad;
+        r->binary = 1;
+        r->ncols = (int)ncols;
+        r->names = calloc(ncols, sizeof(char *));
+        if (!r->names) goto bad;
+        for (uint32_t i = 0; i < ncols; ++i) {
+            uint16_t len = 0;
+            if (fread(&len, sizeof(len), 1, r->f) != 1) goto bad;
+            r->names[i] = calloc(len + 1, 1);
+            if (!r->names[i] || fread(r->names[i], 1, len, r->f) != len) goto bad;
+        }
+        r->phase = reader_phase_index(r, "all");
+        return 0;
+    }
+
+    rewind(r->f);
+    r->phase = reader_phase_index(r, "all");
+
+    /* CSV: skip comments up to the column header */
+    while (getline(&r->line, &r->cap, r->f) > 0) {
+        if (r->line[0] == '#') {
+            if (strncmp(r->line, "# phase=", 8) == 0) {
+                r->line[strcspn(r->line, "\r\n")] = '\0';
+                r->phase = reader_phase_index(r, r->line + 8);
+            } else if (strncmp(r->line, "# fp.hash=", 10) == 0) {
+                snprintf(r->fingerprint, sizeof(r->fingerprint), "%.16s", r->line + 10);
+            }
+            continue;
+        }
+        if (strncmp(r->line, "timestamp,", 10) == 0) {
+            if (parse_csv_header(r, r->line) != 0) goto bad;
+            return 0;
+        }
+    }
+
+bad:
+    fprintf(stderr, "%s: not a CoreBurner log\n", path);
+    free_names(r->names, r->ncols);
+    r->names = NULL;
+    fclose(r->f);
+    free(r->line);
+    r->f = NULL;
+    r->line = NULL;
+    return -1;
+}
+
+/* Reads the next data row into row[ncols]. Returns 1 on row, 0 on EOF, -1 on error. */
+static int log_next_row(log_reader_t *r, double *row) {
+    if (r->binary) {
+        for (;;) {
+            int tag = fgetc(r->f);
+            if (tag == EOF) return 0;
+            if (tag == CBL_TAG_PHASE) {
+                uint16_t len = 0;
+                char name[MAX_PHASE_NAME];
+                if (fread(&len, sizeof(len), 1, r->f) != 1) return -1;
+                if (len >= sizeof(name)) return -1;
+                if (fread(name, 1, len, r->f) != len) return -1;
+                name[len] = '\0';
+                r->phase = reader_phase_index(r, name);
+                continue;
+            }
+            if (tag != CBL_TAG_ROW) return -1;
+            if (fread(row, sizeof(double), r->ncols, r->f) != (size_t)r->ncols) return -1;
+            return 1;
+        }
+    }
+
+    while (getline(&r->line, &r->cap, r->f) > 0) {
+        char *p = r->line;
+        if (*p == '#') {
+            if (strncmp(p, "# phase=", 8) == 0) {
+                p[strcspn(p, "\r\n")] = '\0';
+                r->phase = reader_phase_index(r, p + 8);
+            }
+            continue;
+        }
+        if (strncmp(p, "timestamp,", 10) == 0) {
+            /* Appended run: header repeats */
+            if (parse_csv_header(r, p) != 0) return -1;
+            continue;
+        }
+        if (*p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        for (int c = 0; c < r->ncols; ++c) {
+            char *end = p;
+            double v = strtod(p, &end);
+            row[c] = (end == p) ? NAN : v;
+            p = end;
+            while (*p && *p != ',' && *p != '\n') p++;
+            if (*p == ',') p++;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+static void log_close(log_reader_t *r) {
+    if (r->f) fclose(r->f);
+    free(r->line);
+    free_names(r->names, r->ncols);
+    memset(r, 0, sizeof(*r));
+}
+
+/***********************************************************
+ *              Column Layout Discovery
+ ***********************************************************/
+typedef struct {
+    int col_elapsed;
+    int col_temp;
+    int col_power;
+    int ncores;
+    int *col_util;      /* per core */
+    int *col_freq;      /* per core */
+    int nops;
+    int *col_ops;       /* threadN_ops_delta */
+} layout_t;
+
+static int layout_build(layout_t *l, const log_reader_t *r) {
+    memset(l, 0, sizeof(*l));
+    l->col_elapsed = l->col_temp = l->col_power = -1;
+    l->col_util = calloc(r->ncols, sizeof(int));
+    l->col_freq = calloc(r->ncols, sizeof(int));
+    l->col_ops  = calloc(r->ncols, sizeof(int));
+    if (!l->col_util || !l->col_freq || !l->col_ops) return -1;
+
+    for (int c = 0; c < r->ncols; ++c) {
+        const char *n = r->names[c];
+        int idx = 0;
+        char kind[16];
+
+        if (strcmp(n, "elapsed_sec") == 0) l->col_elapsed = c;
+        else if (strcmp(n, "cpu_temp") == 0) l->col_temp = c;
+        else if (strcmp(n, "pkg_watts") == 0) l->col_power = c;
+        else if (sscanf(n, "cpu%d_%15s", &idx, kind) == 2) {
+            if (strcmp(kind, "util") == 0) l->col_util[l->ncores] = c;
+            else if (strcmp(kind, "freq") == 0) l->col_freq[l->ncores++] = c;
+        } else if (strncmp(n, "thread", 6) == 0 && strstr(n, "_ops_delta")) {
+            l->col_ops[l->nops++] = c;
+        }
+    }
+    return 0;
+}
+
+static void layout_free(layout_t *l) {
+    free(l->col_util);
+    free(l->col_freq);
+    free(l->col_ops);
+}
+
+/***********************************************************
+ *              Parallel Block Reduction
+ ***********************************************************/
+typedef struct {
+    int ncols;
+    int nrows;
+    const double *rows;         /* nrows * ncols, row-major */
+    const int *row_phase;
+    running_stat_t *col_stats;  /* MAX_PHASES * ncols */
+    int c0, c1;
+} reduce_job_t;
+
+static void *reduce_columns(void *arg) {
+    reduce_job_t *j = (reduce_job_t *)arg;
+    for (int i = 0; i < j->nrows; ++i) {
+        const double *row = j->rows + (size_t)i * j->ncols;
+        running_stat_t *ps = j->col_stats + (size_t)j->row_phase[i] * j->ncols;
+        for (int c = j->c0; c < j->c1; ++c)
+            rs_add(&ps[c], row[c]);
+    }
+    return NULL;
+}
+
+static void reduce_block(int nthreads, int ncols, int nrows, const double *rows,
+                         const int *row_phase, running_stat_t *col_stats)
+{
+    if (nthreads > ncols) nthreads = ncols;
+    if (nthreads < 1) nthreads = 1;
+
+    pthread_t tids[nthreads];
+    reduce_job_t jobs[nthreads];
+    int per = (ncols + nthreads - 1) / nthreads;
+
+    for (int t = 0; t < nthreads; ++t) {
+        jobs[t] = (reduce_job_t){ ncols, nrows, rows, row_phase, col_stats,
+                                  t * per, (t + 1) * per > ncols ? ncols : (t + 1) * per };
+        if (t == nthreads - 1 || pthread_create(&tids[t], NULL, reduce_columns, &jobs[t]) != 0) {
+            reduce_columns(&jobs[t]);
+            tids[t] = 0;
+        }
+    }
+    for (int t = 0; t < nthreads; ++t)
+        if (tids[t]) pthread_join(tids[t], NULL);
+}
+
+/***********************************************************
+ *                  Log Analysis
+ ***********************************************************/
+typedef struct {
+    int ncols;
+    int nphases;
+    char phases[MAX_PHASES][MAX_PHASE_NAME];
+    char **names;
+    char fingerprint[17];
+    layout_t layout;
+    uint64_t rows;
+    running_stat_t *col_stats;                  /* MAX_PHASES * ncols */
+    running_stat_t metric[MAX_PHASES][M_COUNT];
+    reservoir_t samples[M_COUNT];               /* all phases */
+} analysis_t;
+
+static void derive_metrics(const layout_t *l, const double *row, double *prev_elapsed, double *out) {
+    for (int m = 0; m < M_COUNT; ++m) out[m] = NAN;
+
+    double dt = 0;
+    if (l->col_elapsed >= 0 && !isnan(row[l->col_elapsed])) {
+        double e = row[l->col_elapsed];
+        dt = (e > *prev_elapsed) ? e - *prev_elapsed : e;  /* new run restarts elapsed */
+        *prev_elapsed = e;
+    }
+
+    if (l->nops > 0 && dt > 0) {
+        double sum = 0;
+        for (int i = 0; i < l->nops; ++i)
+            if (!isnan(row[l->col_ops[i]])) sum += row[l->col_ops[i]];
+        out[M_THROUGHPUT] = sum / 1e6 / dt;
+    }
+
+    double fsum = 0;
+    int fcnt = 0;
+    for (int i = 0; i < l->ncores; ++i) {
+        double f = row[l->col_freq[i]];
+        if (!isnan(f) && f > 0) { fsum += f; fcnt++; }
+    }
+    if (fcnt > 0) out[M_FREQ] = fsum / fcnt / 1000.0;  /* kHz -> MHz */
+
+    if (l->col_power >= 0) out[M_POWER] = row[l->col_power];
+    if (l->col_temp >= 0 && row[l->col_temp] > 0) out[M_TEMP] = row[l->col_temp];
+}
+
+static int analyze_logs(analysis_t *a, char **paths, int npaths, int nthreads, int block_rows) {
+    memset(a, 0, sizeof(*a));
+    for (int m = 0; m < M_COUNT; ++m)
+        if (reservoir_init(&a->samples[m], 0x1234567ULL + m) != 0) return -1;
+    for (int p = 0; p < MAX_PHASES; ++p)
+        for (int m = 0; m < M_COUNT; ++m) rs_init(&a->metric[p][m]);
+
+    double *block = NULL;
+    int *row_phase = NULL;
+
+    for (int fi = 0; fi < npaths; ++fi) {
+        log_reader_t r;
+        if (log_open(&r, paths[fi]) != 0) {
+            free(block); free(row_phase);
+            return -1;
+        }
+
+        if (!a->names) {
+            /* First file defines the layout */
+            a->ncols = r.ncols;
+            a->names = calloc(r.ncols, sizeof(char *));
+            a->col_stats = malloc((size_t)MAX_PHASES * r.ncols * sizeof(running_stat_t));
+            block = malloc((size_t)block_rows * r.ncols * sizeof(double));
+            row_phase = malloc((size_t)block_rows * sizeof(int));
+            if (!a->names || !a->col_stats || !block || !row_phase) {
+                log_close(&r);
+                free(block); free(row_phase);
+                return -1;
+            }
+            for (int c = 0; c < r.ncols; ++c) a->names[c] = strdup(r.names[c]);
+            snprintf(a->fingerprint, sizeof(a->fingerprint), "%s", r.fingerprint);
+            for (size_t i = 0; i < (size_t)MAX_PHASES * r.ncols; ++i) rs_init(&a->col_stats[i]);
+            layout_build(&a->layout, &r);
+        } else if (r.fingerprint[0] && strcmp(r.fingerprint, a->fingerprint) != 0) {
+            fprintf(stderr, "Warning: %s has fingerprint %s, first log has %s\n",
+                    paths[fi], r.fingerprint, a->fingerprint[0] ? a->fingerprint : "(none)");
+        }
+        if (r.ncols != a->ncols) {
+            fprintf(stderr, "%s: %d columns, expected %d (logs must share a layout)\n",
+                    paths[fi], r.ncols, a->ncols);
+            log_close(&r);
+            free(block); free(row_phase);
+            return -1;
+        }
+
+        double prev_elapsed = 0;
+        int nrows = 0;
+        int rc;
+        do {
+            double *row = block + (size_t)nrows * a->ncols;
+            rc = log_next_row(&r, row);
+            if (rc == 1) {
+                /* Phase names are global across files */
+                int gp = -1;
+                for (int p = 0; p < a->nphases; ++p)
+                    if (strcmp(a->phases[p], r.phases[r.phase]) == 0) { gp = p; break; }
+                if (gp < 0) {
+                    gp = a->nphases < MAX_PHASES ? a->nphases++ : MAX_PHASES - 1;
+                    snprintf(a->phases[gp], MAX_PHASE_NAME, "%s", r.phases[r.phase]);
+                }
+                row_phase[nrows] = gp;
+
+                double d[M_COUNT];
+                derive_metrics(&a->layout, row, &prev_elapsed, d);
+                for (int m = 0; m < M_COUNT; ++m) {
+                    rs_add(&a->metric[gp][m], d[m]);
+                    reservoir_add(&a->samples[m], d[m]);
+                }
+                nrows++;
+                a->rows++;
+            }
+            if (nrows == block_rows || (rc != 1 && nrows > 0)) {
+                reduce_block(nthreads, a->ncols, nrows, block, row_phase, a->col_stats);
+                nrows = 0;
+            }
+        } while (rc == 1);
+
+        if (rc < 0) fprintf(stderr, "%s: truncated or malformed row, stopping early\n", paths[fi]);
+        log_close(&r);
+    }
+
+    free(block);
+    free(row_phase);
+    return a->rows > 0 ? 0 : -1;
+}
+
+static void analysis_free(analysis_t *a) {
+    free_names(a->names, a->ncols);
+    free(a->col_stats);
+    layout_free(&a->layout);
+    for (int m = 0; m < M_COUNT; ++m) reservoir_free(&a->samples[m]);
+}
+
+static void print_analysis(const analysis_t *a) {
+    printf(" Rows    : %" PRIu64 "\n", a->rows);
+    if (a->fingerprint[0]) printf(" Machine : %s\n", a->fingerprint);
+    printf(" Columns : %d (%d cores, %d threads)\n", a->ncols, a->layout.ncores, a->layout.nops);
+    printf(" Phases  : %d\n", a->nphases);
+
+    for (int p = 0; p < a->nphases; ++p) {
+        printf("\n--- Phase '%s' ---\n", a->phases[p]);
+        printf(" %-22s %10s %10s %10s %10s %8s\n", "Metric", "Mean", "Stdev", "Min", "Max", "N");
+        for (int m = 0; m < M_COUNT; ++m) {
+            const running_stat_t *s = &a->metric[p][m];
+            if (s->n == 0) continue;
+            printf(" %-22s %10.2f %10.2f %10.2f %10.2f %8" PRIu64 "\n",
+                   metric_names[m], s->mean, rs_stdev(s), s->min, s->max, s->n);
+        }
+    }
+
+    if (a->layout.ncores == 0) return;
+
+    printf("\n--- Per-Core (all phases) ---\n");
+    printf(" %-6s %9s %9s %10s %10s %10s %10s\n",
+           "Core", "Util%", "UtilSd", "FreqMHz", "FreqSd", "FreqMin", "FreqMax");
+    for (int i = 0; i < a->layout.ncores; ++i) {
+        running_stat_t u, f;
+        rs_init(&u);
+        rs_init(&f);
+        /* Merge phase accumulators (parallel-variance combination) */
+        for (int p = 0; p < a->nphases; ++p) {
+            const running_stat_t *cs[2] = {
+                &a->col_stats[(size_t)p * a->ncols + a->layout.col_util[i]],
+                &a->col_stats[(size_t)p * a->ncols + a->layout.col_freq[i]]
+            };
+            running_stat_t *dst[2] = { &u, &f };
+            for (int k = 0; k < 2; ++k) {
+                const running_stat_t *s = cs[k];
+                running_stat_t *d = dst[k];
+                if (s->n == 0) continue;
+                uint64_t n = d->n + s->n;
+                double delta = s->mean - d->mean;
+                d->m2 += s->m2 + delta * delta * (double)d->n * s->n / n;
+                d->mean += delta * s->n / n;
+                d->n = n;
+                if (s->min < d->min) d->min = s->min;
+                if (s->max > d->max) d->max = s->max;
+            }
+        }
+        printf(" cpu%-3d %9.2f %9.2f %10.1f %10.1f %10.1f %10.1f\n",
+               i, u.mean, rs_stdev(&u), f.mean / 1000.0, rs_stdev(&f) / 1000.0,
+               f.n ? f.min / 1000.0 : 0.0, f.n ? f.max / 1000.0 : 0.0);
+    }
+}
+
+/***********************************************************
+ *              Significance Tests
+ ***********************************************************/
+typedef struct {
+    double v;
+    int group;
+} ranked_t;
+
+static int cmp_ranked(const void *a, const void *b) {
+    double x = ((const ranked_t *)a)->v, y = ((const ranked_t *)b)->v;
+    return (x > y) - (x < y);
+}
+
+/* Two-sided Mann-Whitney U test (normal approximation, tie-corrected). Returns p-value. */
+static double mann_whitney_p(const double *a, size_t na, const double *b, size_t nb) {
+    if (na < 2 || nb < 2) return NAN;
+
+    size_t n = na + nb;
+    ranked_t *all = malloc(n * sizeof(ranked_t));
+    if (!all) return NAN;
+    for (size_t i = 0; i < na; ++i) all[i] = (ranked_t){ a[i], 0 };
+    for (size_t i = 0; i < nb; ++i) all[na + i] = (ranked_t){ b[i], 1 };
+    qsort(all, n, sizeof(ranked_t), cmp_ranked);
+
+    double rank_sum_a = 0, tie_term = 0;
+    for (size_t i = 0; i < n; ) {
+        size_t j = i;
+        while (j + 1 < n && all[j + 1].v == all[i].v) j++;
+        double rank = (i + j) / 2.0 + 1.0;
+        double t = (double)(j - i + 1);
+        tie_term += t * t * t - t;
+        for (size_t k = i; k <= j; ++k)
+            if (all[k].group == 0) rank_sum_a += rank;
+        i = j + 1;
+    }
+    free(all);
+
+    double u = rank_sum_a - na * (na + 1) / 2.0;
+    double mu = na * (double)nb / 2.0;
+    double sigma = sqrt(na * (double)nb / 12.0 * ((n + 1) - tie_term / ((double)n * (n - 1))));
+    if (sigma <= 0) return 1.0;
+
+    double z = (fabs(u - mu) - 0.5) / sigma;
+    if (z < 0) z = 0;
+    return erfc(z / sqrt(2.0));
+}
+
+typedef struct {
+    const double *a, *b;
+    size_t na, nb;
+    int iters;
+    uint64_t seed;
+    double *out;    /* relative delta of means per iteration */
+} boot_job_t;
+
+static void *bootstrap_worker(void *arg) {
+    boot_job_t *j = (boot_job_t *)arg;
+    uint64_t s = j->seed;
+    for (int it = 0; it < j->iters; ++it) {
+        double sa = 0, sb = 0;
+        for (size_t i = 0; i < j->na; ++i) sa += j->a[xorshift64(&s) % j->na];
+        for (size_t i = 0; i < j->nb; ++i) sb += j->b[xorshift64(&s) % j->nb];
+        double ma = sa / j->na, mb = sb / j->nb;
+        j->out[it] = ma != 0 ? (mb - ma) / fabs(ma) * 100.0 : NAN;
+    }
+    return NULL;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Percentile bootstrap CI of the relative change in means (percent) */
+static int bootstrap_ci(const double *a, size_t na, const double *b, size_t nb,
+                        int iters, int nthreads, double alpha, double *lo, double *hi)
+{
+    if (na == 0 || nb == 0 || iters <= 0) return -1;
+    double *res = malloc(iters * sizeof(double));
+    if (!res) return -1;
+
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > iters) nthreads = iters;
+    pthread_t tids[nthreads];
+    boot_job_t jobs[nthreads];
+    int per = iters / nthreads;
+
+    for (int t = 0; t < nthreads; ++t) {
+        int start = t * per;
+        int cnt = (t == nthreads - 1) ? iters - start : per;
+        jobs[t] = (boot_job_t){ a, b, na, nb, cnt, 0x9e3779b97f4a7c15ULL * (t + 1), res + start };
+        if (t == nthreads - 1 || pthread_create(&tids[t], NULL, bootstrap_worker, &jobs[t]) != 0) {
+            bootstrap_worker(&jobs[t]);
+            tids[t] = 0;
+        }
+    }
+    for (int t = 0; t < nthreads; ++t)
+        if (tids[t]) pthread_join(tids[t], NULL);
+
+    qsort(res, iters, sizeof(double), cmp_double);
+    *lo = res[(int)floor(alpha / 2 * (iters - 1))];
+    *hi = res[(int)ceil((1 - alpha / 2) * (iters - 1))];
+    free(res);
+    return 0;
+}
+
+/***********************************************************
+ *                    Commands
+ ***********************************************************/
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+        "Usage:\n"
+        "  %s stats   [options] LOG...\n"
+        "  %s compare [options] BASE_LOG NEW_LOG\n"
+        "  %s convert IN.csv OUT.cbl\n"
+        "\n"
+        "LOG is a CoreBurner CSV log or a binary .cbl log (see 'convert').\n"
+        "Phases are delimited by '# phase=NAME' lines in CSV logs.\n"
+        "\n"
+        "Options:\n"
+        "  --threads N          Reduction / bootstrap threads (default: online CPUs)\n"
+        "  --block ROWS         Rows buffered per reduction block (default %d)\n"
+        "  --threshold PCT      Regression threshold for compare (default %.1f)\n"
+        "  --alpha A            Significance level for compare (default %.2f)\n"
+        "  --bootstrap N        Bootstrap resamples for compare (default %d)\n"
+        "\n"
+        "compare exits with status 2 when a regression is flagged.\n",
+        prog, prog, prog, DEFAULT_BLOCK_ROWS, DEFAULT_THRESHOLD_PCT,
+        DEFAULT_ALPHA, DEFAULT_BOOTSTRAP);
+}
+
+static int cmd_stats(char **paths, int npaths, int nthreads, int block_rows) {
+    analysis_t a;
+    int rc = analyze_logs(&a, paths, npaths, nthreads, block_rows);
+    if (rc == 0) {
+        printf("=== CoreBurner Log Statistics ===\n");
+        for (int i = 0; i < npaths; ++i) printf(" Log     : %s\n", paths[i]);
+        print_analysis(&a);
+    } else {
+        fprintf(stderr, "No data rows found\n");
+    }
+    analysis_free(&a);
+    return rc == 0 ? 0 : 1;
+}
+
+static int cmd_compare(const char *base, const char *cand, int nthreads, int block_rows,
+                       double threshold_pct, double alpha, int boot_iters)
+{
+    analysis_t a, b;
+    char *pa[1] = { (char *)base };
+    char *pb[1] = { (char *)cand };
+
+    if (analyze_logs(&a, pa, 1, nthreads, block_rows) != 0) {
+        fprintf(stderr, "%s: no data rows\n", base);
+        analysis_free(&a);
+        return 1;
+    }
+    if (analyze_logs(&b, pb, 1, nthreads, block_rows) != 0) {
+        fprintf(stderr, "%s: no data rows\n", cand);
+        analysis_free(&a);
+        analysis_free(&b);
+        return 1;
+    }
+
+    printf("=== CoreBurner Run Comparison ===\n");
+    printf(" Base      : %s (%" PRIu64 " rows)\n", base, a.rows);
+    printf(" Candidate : %s (%" PRIu64 " rows)\n", cand, b.rows);
+    if (a.fingerprint[0] || b.fingerprint[0])
+        printf(" Machines  : %s -> %s%s\n",
+               a.fingerprint[0] ? a.fingerprint : "?", b.fingerprint[0] ? b.fingerprint : "?",
+               strcmp(a.fingerprint, b.fingerprint) ? " (fingerprint changed)" : "");
+    printf(" Threshold : %.2f%%  alpha=%.3f  bootstrap=%d\n\n", threshold_pct, alpha, boot_iters);
+    printf(" %-22s %10s %10s %9s %19s %9s  %s\n",
+           "Metric", "Base", "New", "Delta%", "CI95 Delta%", "p(MWU)", "Verdict");
+
+    int regressions = 0;
+    int compared[] = { M_THROUGHPUT, M_FREQ, M_POWER, M_TEMP };
+
+    for (size_t k = 0; k < sizeof(compared) / sizeof(compared[0]); ++k) {
+        int m = compared[k];
+        const reservoir_t *ra = &a.samples[m], *rb = &b.samples[m];
+        if (ra->n == 0 || rb->n == 0) continue;
+
+        double ma = 0, mb = 0;
+        for (size_t i = 0; i < ra->n; ++i) ma += ra->v[i];
+        for (size_t i = 0; i < rb->n; ++i) mb += rb->v[i];
+        ma /= ra->n;
+        mb /= rb->n;
+
+        double delta = ma != 0 ? (mb - ma) / fabs(ma) * 100.0 : NAN;
+        double p = mann_whitney_p(ra->v, ra->n, rb->v, rb->n);
+        double lo = NAN, hi = NAN;
+        bootstrap_ci(ra->v, ra->n, rb->v, rb->n, boot_iters, nthreads, alpha, &lo, &hi);
+
+        /* Throughput and frequency regress downwards, power and temperature upwards */
+        int worse_is_up = (m == M_POWER || m == M_TEMP);
+        int beyond = worse_is_up ? (delta > threshold_pct) : (delta < -threshold_pct);
+        int significant = !isnan(p) && p < alpha;
+        const char *verdict = "ok";
+        if (beyond && significant) {
+            verdict = "REGRESSION";
+            if (m != M_TEMP) regressions++;
+        } else if (beyond) {
+            verdict = "not significant";
+        }
+
+        char ci[32];
+        snprintf(ci, sizeof(ci), "[%+.2f, %+.2f]", lo, hi);
+        printf(" %-22s %10.2f %10.2f %+8.2f%% %19s %9.4f  %s\n",
+               metric_names[m], ma, mb, delta, ci, p, verdict);
+    }
+
+    printf("\n Result    : %s\n", regressions ? "REGRESSION" : "PASS");
+
+    analysis_free(&a);
+    analysis_free(&b);
+    return regressions ? 2 : 0;
+}
+
+static int cmd_convert(const char *in, const char *out) {
+    log_reader_t r;
+    if (log_open(&r, in) != 0) return 1;
+
+    FILE *o = fopen(out, "wb");
+    if (!o) {
+        fprintf(stderr, "%s: %s\n", out, strerror(errno));
+        log_close(&r);
+        return 1;
+    }
+
+    uint32_t ncols = (uint32_t)r.ncols;
+    fwrite(CBL_MAGIC, 1, sizeof(CBL_MAGIC) - 1, o);
+    fwrite(&ncols, sizeof(ncols), 1, o);
+    for (int c = 0; c < r.ncols; ++c) {
+        uint16_t len = (uint16_t)strlen(r.names[c]);
+        fwrite(&len, sizeof(len), 1, o);
+        fwrite(r.names[c], 1, len, o);
+    }
+
+    double *row = malloc(r.ncols * sizeof(double));
+    int last_phase = r.phase;
+    uint64_t rows = 0;
+    int rc = 0;
+
+    while (row && (rc = log_next_row(&r, row)) == 1) {
+        if (r.phase != last_phase) {
+            uint16_t len = (uint16_t)strlen(r.phases[r.phase]);
+            fputc(CBL_TAG_PHASE, o);
+            fwrite(&len, sizeof(len), 1, o);
+            fwrite(r.phases[r.phase], 1, len, o);
+            last_phase = r.phase;
+        }
+        fputc(CBL_TAG_ROW, o);
+        fwrite(row, sizeof(double), r.ncols, o);
+        rows++;
+    }
+
+    int failed = (fclose(o) != 0) || !row || rc < 0;
+    free(row);
+    log_close(&r);
+
+    if (failed) {
+        fprintf(stderr, "Conversion of %s failed\n", in);
+        return 1;
+    }
+    printf("Converted %" PRIu64 " rows to %s\n", rows, out);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const char *cmd = argv[1];
+    int nthreads = get_nprocs();
+    int block_rows = DEFAULT_BLOCK_ROWS;
+    double threshold_pct = DEFAULT_THRESHOLD_PCT;
+    double alpha = DEFAULT_ALPHA;
+    int boot_iters = DEFAULT_BOOTSTRAP;
+
+    char **paths = calloc(argc, sizeof(char *));
+    int npaths = 0;
+    if (!paths) return 1;
+
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            nthreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--block") == 0 && i + 1 < argc) {
+            block_rows = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold_pct = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+            alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--bootstrap") == 0 && i + 1 < argc) {
+            boot_iters = atoi(argv[++i]);
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "Unknown or malformed argument: %s\n", argv[i]);
+            print_usage(argv[0]);
+            free(paths);
+            return 1;
+        } else {
+            paths[npaths++] = argv[i];
+        }
+    }
+
+    if (nthreads < 1) nthreads = 1;
+    if (block_rows < 1) block_rows = DEFAULT_BLOCK_ROWS;
+    if (alpha <= 0 || alpha >= 1) alpha = DEFAULT_ALPHA;
+
+    int rc = 1;
+    if (strcmp(cmd, "stats") == 0 && npaths >= 1) {
+        rc = cmd_stats(paths, npaths, nthreads, block_rows);
+    } else if (strcmp(cmd, "compare") == 0 && npaths == 2) {
+        rc = cmd_compare(paths[0], paths[1], nthreads, block_rows, threshold_pct, alpha, boot_iters);
+    } else if (strcmp(cmd, "convert") == 0 && npaths == 2) {
+        rc = cmd_convert(paths[0], paths[1]);
+    } else {
+        print_usage(argv[0]);
+    }
+
+    free(paths);
+    return rc;
+}
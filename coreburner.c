@@ -57,6 +57,17 @@
 #include <fcntl.h>
 #include <cpuid.h>
 #include <stdarg.h>
+#include <sys/utsname.h>
+#include <sys/file.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#include <linux/futex.h>
+#include <dirent.h>
+#include <fnmatch.h>
 
 #define CONTROL_PERIOD_MS 100
 #define DEFAULT_LOG_INTERVAL 1
@@ -66,12 +77,24 @@
 #define DYN_FREQ_STEP_PCT 10
 #define MAX_CORES_TO_LOG 64
 
+#ifndef COREBURNER_VERSION
+#define COREBURNER_VERSION "2.0+dcl"
+#endif
+#ifndef COREBURNER_BUILD_ID
+#define COREBURNER_BUILD_ID "unknown"
+#endif
+
 #define TEMP_SANITY_MIN -20.0
 #define TEMP_SANITY_MAX 150.0
 
 /* Array-based SIMD workload configuration */
 #define SIMD_ARRAY_SIZE (1024 * 1024)  /* 1M floats = 4MB per buffer */
 #define SIMD_INNER_ITERATIONS 100       /* Operations per array chunk */
+#define MEMBW_BUFFER_WORDS (4 * 1024 * 1024)  /* 32MB per thread, allocated on first use */
+#define KPATH_SYSCALLS_PER_SLICE 64           /* SYSCALL: getppid calls per slice */
+#define KPATH_TRIPS_PER_SLICE 8               /* PIPE: pipe+eventfd round trips per slice */
+#define KPATH_PAGES 16                        /* PGFAULT/MADVISE: pages faulted per slice */
+#define KPATH_PAGE_SIZE 4096
 
 /* MSR Registers for frequency and power */
 #define MSR_IA32_APERF 0x000000E8
@@ -80,11 +103,28 @@
 #define MSR_PKG_ENERGY_STATUS 0x611
 #define MSR_PP0_ENERGY_STATUS 0x639
 #define MSR_DRAM_ENERGY_STATUS 0x619
+#define MSR_PLATFORM_ENERGY_STATUS 0x64D
+#define MSR_IA32_PERF_STATUS 0x198
+#define MSR_AMD_RAPL_POWER_UNIT 0xC0010299
+#define MSR_AMD_CORE_ENERGY_STATUS 0xC001029A
+#define MSR_AMD_PKG_ENERGY_STATUS 0xC001029B
+#define AMD_MAX_CCDS 16
 
 /* Frequency residency buckets (in MHz) */
 #define FREQ_BUCKETS 20
 #define FREQ_BUCKET_SIZE 200  /* 200 MHz per bucket */
 
+/* Repeat-and-aggregate limits */
+#define MAX_REPEAT 1000
+#define CI_MIN_REPS 3             /* Minimum repetitions before adaptive stop */
+#define COOLDOWN_TEMP_MAX_SEC 300 /* Upper bound on waiting for --cooldown-temp */
+
+/* Indexed results store (see results_store_append) */
+#define RESULTS_STORE_DEFAULT_DIR "results.d"
+#define BASELINE_DEFAULT_Z 3.0
+#define BASELINE_DEFAULT_MIN_SAMPLES 5
+#define BASELINE_DEFAULT_TOL_PCT 2.0
+
 /* Cdyn class definitions */
 typedef enum {
     CDYN_CLASS_0 = 0,  /* Low dynamic capacitance (INT, SSE) */
@@ -103,8 +143,169 @@ typedef struct {
     double p1_mhz;
     double all_core_turbo_mhz;
     double tolerance_pct;  /* Acceptable deviation percentage */
+    int tolerance_set;     /* --dcl-tolerance given; overrides spec files */
+    const char *spec_path; /* --dcl-spec FILE|DIR */
+    const char *report_path;
+    int suite;             /* --dcl-suite */
 } dcl_spec_t;
 
+/* Repeat-and-aggregate configuration */
+typedef struct {
+    int count;              /* Number of repetitions (max when adaptive) */
+    int cooldown_sec;       /* Minimum idle time between repetitions */
+    double cooldown_temp;   /* Wait until temp <= this before next rep (0 = off) */
+    double ci_target_pct;   /* Adaptive stop: CI half-width as % of mean (0 = off) */
+} repeat_spec_t;
+
+/* Screening configuration (--baseline / --update-baseline) */
+typedef struct {
+    const char *source;         /* baseline file, or "store" for the results store */
+    const char *update_path;    /* fold accepted runs into this file */
+    double z_max;               /* |z| above this is out-of-family */
+    int min_samples;            /* minimum baseline n for a metric to be judged */
+    double tol_pct;             /* zero-variance baseline: allowed |delta| as % of mean */
+} baseline_spec_t;
+
+/* Trace-driven replay (--replay) */
+typedef struct {
+    const char *path;
+    double speed;               /* time-scale, 2.0 = replay twice as fast */
+    const char *cpu_map;        /* "LANE:CPU,..." remap, NULL = lane % cpus */
+    const char *kernels;        /* "UTIL:TYPE,..." kernel by recorded util */
+} replay_spec_t;
+
+/* SMT interference matrix (--mode smt-matrix) */
+typedef struct {
+    const char *kernels;        /* "INT,AVX2,..." (default: all supported) */
+    int core_cpu;               /* CPU whose core to use, -1 = first with siblings */
+    const char *pair;           /* "A,B" explicit CPUs, bypasses topology */
+} smt_spec_t;
+
+/* Context-switch / XSAVE cost (--mode ctx-switch) */
+typedef struct {
+    const char *method;         /* "futex" (ring ping-pong) or "yield" */
+    const char *thread_types;   /* "NONE,AVX512,..." per-thread state, NULL = sweep */
+    int work_slices;            /* kernel slices between switches */
+} ctx_spec_t;
+
+/* TLB / huge-page stress (--type TLB, --mode tlb-sweep) */
+typedef struct {
+    const char *footprints;     /* "64M,1G,16G"; --type TLB uses the first */
+    const char *pages;          /* "4k,thp,2m,1g"; --type TLB uses the first */
+} tlb_spec_t;
+
+/* Lock contention (--type LOCK) and worker placement (--spread) */
+typedef struct {
+    const char *kind;           /* mutex|spin|ticket|mcs|rwlock */
+    long cs_iters;              /* critical-section RMW steps on shared lines */
+    long ncs_iters;             /* local INT iterations between acquisitions */
+    int read_pct;               /* rwlock read share */
+    const char *spread;         /* linear|cores|smt|sockets|ccx|cppc */
+    const char *core_type;      /* any|p|e|p-first|e-first (hybrid parts) */
+} lock_spec_t;
+
+/* Copy / fill bandwidth (--type COPY, --mode copy-sweep) */
+typedef struct {
+    const char *methods;        /* "movsb,avx2,nt,..."; --type COPY uses the first */
+    const char *sizes;          /* "4K,1M,256M"; --type COPY uses the first */
+    int threads;                /* copy-sweep worker count */
+} copy_spec_t;
+
+/* Denormal / FP-assist options (--mxcsr, --mode fp-assist) */
+typedef struct {
+    const char *mxcsr;          /* off|ftz|daz|ftz+daz for every worker */
+    const char *assist_event;   /* raw PMU config overriding the model table */
+} fpa_spec_t;
+
+/* Front-end stress options (--type FRONTEND, --mode frontend-sweep) */
+typedef struct {
+    const char *footprints;     /* generated code sizes; first one for --type FRONTEND */
+    const char *random;         /* percent of random targets/conditions per point */
+} fe_spec_t;
+
+/* Memory-capacity pressure next to any --type (--mem-pressure) */
+typedef struct {
+    const char *size;           /* SIZE or N% of MemAvailable; NULL = off */
+    double touch_mbps;          /* re-touch rate keeping the region resident */
+    int cycle_sec;              /* drop + refault a quarter every N s; 0 = off */
+} memp_spec_t;
+
+/* Measured Cdyn options (--mode cdyn-fit) */
+typedef struct {
+    const char *kernels;        /* kernels to fit (default INT..AVX512) */
+    const char *freqs;          /* pinned MHz steps (default 5 over cpuinfo min..max) */
+} cdyn_spec_t;
+
+/* V/F curve options (--mode vf-curve) */
+typedef struct {
+    const char *freqs;          /* pinned MHz steps; overrides steps */
+    int steps;                  /* evenly over cpuinfo min..max (default 8) */
+    int each;                   /* load one CPU at a time */
+} vf_spec_t;
+
+/* CPPC / EPP controls (amd-pstate, intel_pstate active mode) */
+typedef struct {
+    const char *epp;            /* energy_performance_preference for every CPU */
+    const char *pstate_mode;    /* amd_pstate/status: active|passive|guided */
+} cppc_spec_t;
+
+/* Uncore frequency options (any mode; --mode uncore-sweep) */
+typedef struct {
+    long min_mhz;               /* pin min_freq_khz for the run; 0 = untouched */
+    long max_mhz;               /* pin max_freq_khz for the run; 0 = untouched */
+    const char *freqs;          /* uncore-sweep MHz steps (default 5 over initial min..max) */
+} uncore_spec_t;
+
+/* hwmon channel logging (any mode) */
+typedef struct {
+    const char *select;         /* comma-separated globs over chip/label or chip/channel */
+    double fan_ramp_pct;        /* fan ramp onset: rise above the first reading (default 10) */
+} hwmon_spec_t;
+
+/* Predictive thermal guard (--thermal-guard) */
+#define GUARD_MAX_WINDOW 64
+
+typedef struct {
+    int enabled;
+    double margin_sec;          /* back off when the predicted time to threshold is below this */
+    int window;                 /* samples per sensor in the slope fit */
+    const char *action;         /* duty|isa */
+} guard_spec_t;
+
+/* Machine fingerprint (see collect_machine_fingerprint) */
+#define FP_STR 128
+
+typedef struct {
+    char cpu_vendor[16];
+    char cpu_model_name[FP_STR];
+    unsigned int family;
+    unsigned int model;
+    unsigned int stepping;
+    char cpu_flags[FP_STR];
+    char microcode[32];
+    char kernel_release[FP_STR];
+    char kernel_cmdline[512];
+    char cmdline_perf[256];         /* sorted performance-relevant subset, hashed */
+    char cpufreq_driver[32];
+    char governor[32];
+    char epp[48];
+    char boost[16];
+    char smt[16];
+    long mem_total_mb;
+    int numa_nodes;
+    char thp[32];
+    char power_limits[FP_STR];
+    char bios_vendor[64];
+    char bios_version[64];
+    char bios_date[32];
+    char product_name[FP_STR];
+    char build[FP_STR];
+    char isa_dispatch[64];
+    char hash[17];
+} machine_fingerprint_t;
+
+static machine_fingerprint_t g_fingerprint;
+
 /* Frequency residency tracker */
 typedef struct {
     uint64_t buckets[FREQ_BUCKETS];
@@ -114,10 +315,25 @@ typedef struct {
     double avg_freq_mhz;
 } freq_residency_t;
 
+/* Per-run results collected by main_runtime (one per repetition) */
+typedef struct {
+    long elapsed_sec;
+    double avg_util;
+    double avg_temp;            /* NAN if no sensor */
+    double avg_freq_mhz;        /* 0 if unavailable */
+    double avg_pkg_watts;       /* NAN if RAPL disabled/unavailable */
+    double total_ops_millions;
+    double ops_per_sec;         /* Million ops/s */
+    int ncores;                 /* entries in the per-core arrays */
+    double *core_avg_util;      /* per-core average utilization (%) */
+    double *core_avg_freq_mhz;  /* per-core average frequency (0 = unavailable) */
+} run_stats_t;
+
 static volatile sig_atomic_t stop_flag = 0;
+static volatile sig_atomic_t user_stop_flag = 0;  /* SIGINT/SIGTERM only, survives repetitions */
 static pthread_mutex_t global_lock = PTHREAD_MUTEX_INITIALIZER;
 
-void sigint_handler(int s) { (void)s; stop_flag = 1; }
+void sigint_handler(int s) { (void)s; stop_flag = 1; user_stop_flag = 1; }
 
 /***********************************************************
  *                   CPU Affinity Helpers
@@ -167,7 +383,10 @@ long parse_duration_seconds(const char *s) {
 /***********************************************************
  *                      /proc/stat Parsing
  ***********************************************************/
-int read_proc_stat(uint64_t *total_out, uint64_t *idle_out, int max_cpus) {
+/* Per-CPU jiffies; user_out (user+nice) and sys_out (system+irq+softirq)
+ * may be NULL when only utilization is needed. */
+int read_proc_stat_split(uint64_t *total_out, uint64_t *idle_out,
+                         uint64_t *user_out, uint64_t *sys_out, int max_cpus) {
     FILE *f = fopen("/proc/stat", "r");
     if (!f) return -1;
 
@@ -206,6 +425,8 @@ int read_proc_stat(uint64_t *total_out, uint64_t *idle_out, int max_cpus) {
         if (idx < max_cpus) {
             total_out[idx] = total;
             idle_out[idx] = idle_all;
+            if (user_out) user_out[idx] = user + nice;
+            if (sys_out) sys_out[idx] = system + (matched >= 6 ? irq : 0) + (matched >= 7 ? softirq : 0);
         }
         idx++;
     }
@@ -214,10 +435,89 @@ int read_proc_stat(uint64_t *total_out, uint64_t *idle_out, int max_cpus) {
     return idx;
 }
 
+int read_proc_stat(uint64_t *total_out, uint64_t *idle_out, int max_cpus) {
+    return read_proc_stat_split(total_out, idle_out, NULL, NULL, max_cpus);
+}
+
+/***********************************************************
+ *                  CPU Vendor Backend
+ * Picked once from CPUID leaf 0 and used to choose the energy
+ * counters (rapl_init), the temperature sensor and the
+ * vendor-specific parts of DCL validation. Hygon parts use
+ * the AMD interfaces.
+ ***********************************************************/
+typedef enum {
+    CPU_VENDOR_OTHER = 0,
+    CPU_VENDOR_INTEL,
+    CPU_VENDOR_AMD
+} cpu_vendor_t;
+
+static const char *cpu_vendor_names[] = { "other", "intel", "amd" };
+
+cpu_vendor_t cpu_vendor(void) {
+    static int probed = 0;
+    static cpu_vendor_t v = CPU_VENDOR_OTHER;
+    if (probed) return v;
+    probed = 1;
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    char id[13] = "";
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+        memcpy(id + 0, &ebx, 4);
+        memcpy(id + 4, &edx, 4);
+        memcpy(id + 8, &ecx, 4);
+        id[12] = '\0';
+    }
+    if (strcmp(id, "GenuineIntel") == 0) v = CPU_VENDOR_INTEL;
+    else if (strcmp(id, "AuthenticAMD") == 0 || strcmp(id, "HygonGenuine") == 0) v = CPU_VENDOR_AMD;
+#endif
+    return v;
+}
+
 /***********************************************************
  *                Temperature Sensor Helpers
+ * AMD prefers k10temp Tctl (the control temperature the SMU
+ * throttles on); per-CCD Tccd sensors are logged separately.
  ***********************************************************/
+int read_sysfs_str(const char *path, char *buf, size_t len);
+
+/* tempN_input of the first hwmon named `driver` whose tempN_label
+ * equals `label`; returns N (>0) and fills out, or 0 */
+int hwmon_find_temp(const char *driver, const char *label, char *out, size_t len) {
+    char path[96], buf[64];
+    for (int h = 0; h < 64; ++h) {
+        snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/name", h);
+        if (read_sysfs_str(path, buf, sizeof(buf)) != 0 || strcmp(buf, driver) != 0) continue;
+        for (int t = 1; t <= 32; ++t) {
+            snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/temp%d_label", h, t);
+            if (read_sysfs_str(path, buf, sizeof(buf)) != 0 || strcmp(buf, label) != 0) continue;
+            snprintf(out, len, "/sys/class/hwmon/hwmon%d/temp%d_input", h, t);
+            return t;
+        }
+    }
+    return 0;
+}
+
+/* AMD: k10temp Tccd<id> input paths, one per populated CCD; returns the count */
+int amd_tccd_find(char paths[][64], int *ids, int max) {
+    int n = 0;
+    for (int c = 1; c <= AMD_MAX_CCDS && n < max; ++c) {
+        char label[16];
+        snprintf(label, sizeof(label), "Tccd%d", c);
+        if (hwmon_find_temp("k10temp", label, paths[n], sizeof(paths[n])) > 0) ids[n++] = c;
+    }
+    return n;
+}
+
 char *find_temperature_input_path() {
+    if (cpu_vendor() == CPU_VENDOR_AMD) {
+        char amd[64];
+        if (hwmon_find_temp("k10temp", "Tctl", amd, sizeof(amd)) > 0 ||
+            hwmon_find_temp("k10temp", "Tdie", amd, sizeof(amd)) > 0 ||
+            hwmon_find_temp("zenpower", "Tdie", amd, sizeof(amd)) > 0)
+            return strdup(amd);
+    }
+
     const char *fixed[] = {
         "/sys/class/thermal/thermal_zone0/temp",
         "/sys/class/thermal/thermal_zone1/temp",
@@ -259,6 +559,278 @@ double read_temperature(const char *path) {
     return t;
 }
 
+/***********************************************************
+ *                hwmon Sensor Harvesting
+ * Every hwmon channel (temp, fan, power, curr, in) is named
+ * <chip>/<label>, or <chip>/<channel> when it has no label.
+ * --hwmon selects channels by glob; the selected *_input
+ * files stay open and are re-read with pread() per interval.
+ * The summary relates the first fan ramp to CPU temperature.
+ ***********************************************************/
+#define HWMON_SYSFS "/sys/class/hwmon"
+#define HWMON_INIT_CHANS 64         /* first allocation; grown as channels are found */
+
+enum { HWMON_TEMP, HWMON_FAN, HWMON_POWER, HWMON_CURR, HWMON_IN, HWMON_KINDS };
+
+static const char *hwmon_prefix[HWMON_KINDS] = { "temp", "fan", "power", "curr", "in" };
+static const char *hwmon_unit[HWMON_KINDS] = { "C", "rpm", "W", "A", "V" };
+/* raw sysfs units: millidegree, RPM, microwatt, milliamp, millivolt */
+static const double hwmon_scale[HWMON_KINDS] = { 1e-3, 1.0, 1e-6, 1e-3, 1e-3 };
+
+typedef struct {
+    int hwmon;                  /* N of hwmonN */
+    int kind;
+    char chip[32];
+    char chan[24];              /* e.g. fan2 */
+    char label[48];             /* *_label, else chan */
+    char column[96];            /* CSV column: hw_<chip>_<label>_<unit> */
+    int fd;                     /* *_input, open for the run */
+} hwmon_chan_t;
+
+static hwmon_chan_t *g_hwmon = NULL;
+static int g_hwmon_n = 0;
+static double g_hwmon_ramp_pct = 10.0;  /* --fan-ramp-pct */
+
+/* Enumerate every channel into a malloc'd *out (caller frees); returns the count */
+static int hwmon_enumerate(hwmon_chan_t **out) {
+    *out = NULL;
+    DIR *top = opendir(HWMON_SYSFS);
+    if (!top) return 0;
+    hwmon_chan_t *all = NULL;
+    int n = 0, cap = 0, oom = 0;
+    struct dirent *de;
+    while (!oom && (de = readdir(top))) {
+        int h;
+        if (sscanf(de->d_name, "hwmon%d", &h) != 1) continue;
+        char dir[96], path[160], chip[32];
+        snprintf(dir, sizeof(dir), HWMON_SYSFS "/hwmon%d", h);
+        snprintf(path, sizeof(path), "%s/name", dir);
+        if (read_sysfs_str(path, chip, sizeof(chip)) != 0) snprintf(chip, sizeof(chip), "hwmon%d", h);
+        DIR *d = opendir(dir);
+        if (!d) continue;
+        struct dirent *fe;
+        while ((fe = readdir(d))) {
+            char pre[16];
+            int idx;
+            size_t len = strlen(fe->d_name);
+            if (len < 7 || strcmp(fe->d_name + len - 6, "_input") != 0) continue;
+            if (sscanf(fe->d_name, "%15[a-z]%d", pre, &idx) != 2) continue;
+            int kind = -1;
+            for (int k = 0; k < HWMON_KINDS; ++k)
+                if (strcmp(pre, hwmon_prefix[k]) == 0) kind = k;
+            if (kind < 0) continue;
+            if (n == cap) {
+                int ncap = cap ? cap * 2 : HWMON_INIT_CHANS;
+                hwmon_chan_t *grown = realloc(all, ncap * sizeof(*all));
+                if (!grown) {
+                    fprintf(stderr, "Warning: out of memory listing hwmon channels; keeping the first %d\n", n);
+                    oom = 1;
+                    break;
+                }
+                all = grown;
+                cap = ncap;
+            }
+            hwmon_chan_t *c = &all[n++];
+            memset(c, 0, sizeof(*c));
+            c->hwmon = h;
+            c->kind = kind;
+            c->fd = -1;
+            snprintf(c->chip, sizeof(c->chip), "%s", chip);
+            snprintf(c->chan, sizeof(c->chan), "%s%d", hwmon_prefix[kind], idx);
+            snprintf(path, sizeof(path), "%s/%s_label", dir, c->chan);
+            if (read_sysfs_str(path, c->label, sizeof(c->label)) != 0 || !c->label[0])
+                snprintf(c->label, sizeof(c->label), "%s", c->chan);
+        }
+        closedir(d);
+    }
+    closedir(top);
+
+    /* stable order: hwmon index, kind, channel */
+    for (int i = 1; i < n; ++i)
+        for (int j = i; j > 0; --j) {
+            hwmon_chan_t *a = &all[j - 1], *b = &all[j];
+            int cmp = a->hwmon != b->hwmon ? a->hwmon - b->hwmon :
+                      a->kind != b->kind ? a->kind - b->kind : strcmp(a->chan, b->chan);
+            if (cmp <= 0) break;
+            hwmon_chan_t t = *a; *a = *b; *b = t;
+        }
+    *out = all;
+    return n;
+}
+
+static double hwmon_read(hwmon_chan_t *c) {
+    char buf[32];
+    ssize_t r;
+    if (c->fd >= 0) r = pread(c->fd, buf, sizeof(buf) - 1, 0);
+    else {
+        char path[160];
+        snprintf(path, sizeof(path), HWMON_SYSFS "/hwmon%d/%s_input", c->hwmon, c->chan);
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return NAN;
+        r = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+    }
+    if (r <= 0) return NAN;
+    buf[r] = '\0';
+    char *end;
+    long raw = strtol(buf, &end, 10);
+    if (end == buf) return NAN;
+    return raw * hwmon_scale[c->kind];
+}
+
+/* --hwmon-list: every channel with its current reading */
+void hwmon_list(FILE *f) {
+    hwmon_chan_t *all;
+    int n = hwmon_enumerate(&all);
+    if (n == 0) fprintf(f, "No hwmon channels under " HWMON_SYSFS "\n");
+    for (int i = 0; i < n; ++i) {
+        char name[96];
+        snprintf(name, sizeof(name), "%s/%s", all[i].chip, all[i].label);
+        double v = hwmon_read(&all[i]);
+        fprintf(f, "  hwmon%-3d %-28s %-8s ", all[i].hwmon, name, all[i].chan);
+        if (isnan(v)) fprintf(f, "(unreadable)\n");
+        else fprintf(f, "%.3f %s\n", v, hwmon_unit[all[i].kind]);
+    }
+    free(all);
+}
+
+void hwmon_close(void) {
+    for (int i = 0; i < g_hwmon_n; ++i)
+        if (g_hwmon[i].fd >= 0) { close(g_hwmon[i].fd); g_hwmon[i].fd = -1; }
+}
+
+/* Select channels whose "chip/label" or "chip/channel" matches one
+ * of the comma-separated globs and open their inputs. The matches
+ * are packed to the front of the enumerated array, which becomes g_hwmon. */
+int hwmon_select(const char *globs) {
+    g_hwmon_n = 0;
+    if (!globs || !*globs) return 0;
+    hwmon_chan_t *all;
+    int n = hwmon_enumerate(&all);
+    for (int i = 0; i < n; ++i) {
+        char by_label[96], by_chan[64];
+        snprintf(by_label, sizeof(by_label), "%s/%s", all[i].chip, all[i].label);
+        snprintf(by_chan, sizeof(by_chan), "%s/%s", all[i].chip, all[i].chan);
+        int hit = 0;
+        char *copy = strdup(globs), *save = NULL;
+        for (char *g = copy ? strtok_r(copy, ",", &save) : NULL; g && !hit; g = strtok_r(NULL, ",", &save))
+            hit = fnmatch(g, by_label, 0) == 0 || fnmatch(g, by_chan, 0) == 0;
+        free(copy);
+        if (!hit) continue;
+
+        hwmon_chan_t *c = &all[g_hwmon_n];
+        if (g_hwmon_n != i) *c = all[i];
+        snprintf(c->column, sizeof(c->column), "hw_%s_%.40s_%s", all[i].chip, all[i].label, hwmon_unit[c->kind]);
+        for (char *q = c->column; *q; ++q)
+            if (!isalnum((unsigned char)*q)) *q = '_';
+        for (int k = 0; k < g_hwmon_n; ++k)    /* e.g. coretemp on each package */
+            if (strcmp(all[k].column, c->column) == 0) {
+                size_t l = strlen(c->column);
+                snprintf(c->column + l, sizeof(c->column) - l, "_%d", c->hwmon);
+                break;
+            }
+        char path[160];
+        snprintf(path, sizeof(path), HWMON_SYSFS "/hwmon%d/%s_input", c->hwmon, c->chan);
+        c->fd = open(path, O_RDONLY);
+        if (c->fd < 0) {
+            fprintf(stderr, "Warning: hwmon %s unreadable: %s\n", by_label, strerror(errno));
+            continue;
+        }
+        g_hwmon_n++;
+    }
+    if (g_hwmon_n > 0) {
+        g_hwmon = all;
+        atexit(hwmon_close);
+    } else {
+        free(all);
+        fprintf(stderr, "Warning: --hwmon '%s' matched no readable channel (see --hwmon-list)\n", globs);
+    }
+    return 0;
+}
+
+/* Per-channel run statistics; fans also track ramp onset and
+ * their correlation with the CPU temperature */
+typedef struct {
+    double min, max, sum;
+    int n;
+    double first;               /* first reading: fan baseline */
+    int onset_sec;              /* first sample above baseline x (1 + ramp); -1 = none */
+    double onset_temp;          /* CPU temperature at onset */
+    double sx, sy, sxx, syy, sxy;   /* fan RPM vs CPU temperature */
+    int np;
+} hwmon_stats_t;
+
+void hwmon_stats_init(hwmon_stats_t *st, int n) {
+    memset(st, 0, n * sizeof(*st));
+    for (int i = 0; i < n; ++i) st[i].onset_sec = -1;
+}
+
+void hwmon_stats_add(hwmon_stats_t *st, const hwmon_chan_t *c, double v, double tempC, int elapsed) {
+    if (isnan(v)) return;
+    if (st->n == 0 || v < st->min) st->min = v;
+    if (st->n == 0 || v > st->max) st->max = v;
+    if (st->n == 0) st->first = v;
+    st->sum += v;
+    st->n++;
+    if (c->kind != HWMON_FAN) return;
+    /* a stopped fan (0 RPM, zero-RPM mode) ramps at any spin-up */
+    if (st->onset_sec < 0 && st->n > 1 && v > st->first * (1.0 + g_hwmon_ramp_pct / 100.0) && v - st->first >= 50.0) {
+        st->onset_sec = elapsed;
+        st->onset_temp = tempC;
+    }
+    if (!isnan(tempC)) {
+        st->sx += v; st->sy += tempC;
+        st->sxx += v * v; st->syy += tempC * tempC; st->sxy += v * tempC;
+        st->np++;
+    }
+}
+
+void hwmon_report(FILE *f, const hwmon_stats_t *st, double temp_start, int summary) {
+    if (g_hwmon_n == 0) return;
+    if (summary) fprintf(f, "\n[hwmon]\n");
+    for (int i = 0; i < g_hwmon_n; ++i) {
+        const hwmon_chan_t *c = &g_hwmon[i];
+        const hwmon_stats_t *s = &st[i];
+        if (s->n == 0) continue;
+        double avg = s->sum / s->n;
+        double r = NAN;
+        if (c->kind == HWMON_FAN && s->np > 2) {
+            double vx = s->np * s->sxx - s->sx * s->sx, vy = s->np * s->syy - s->sy * s->sy;
+            if (vx > 0 && vy > 0) r = (s->np * s->sxy - s->sx * s->sy) / sqrt(vx * vy);
+        }
+        if (summary) {
+            fprintf(f, "%s_min=%.3f\n%s_avg=%.3f\n%s_max=%.3f\n", c->column, s->min, c->column, avg,
+                    c->column, s->max);
+            if (c->kind != HWMON_FAN) continue;
+            if (s->onset_sec >= 0) {
+                fprintf(f, "%s_ramp_onset_sec=%d\n", c->column, s->onset_sec);
+                if (!isnan(s->onset_temp)) fprintf(f, "%s_ramp_onset_temp_c=%.1f\n", c->column, s->onset_temp);
+                if (!isnan(s->onset_temp) && !isnan(temp_start))
+                    fprintf(f, "%s_ramp_onset_temp_rise_c=%.1f\n", c->column, s->onset_temp - temp_start);
+            }
+            if (!isnan(r)) fprintf(f, "%s_temp_correlation=%.3f\n", c->column, r);
+        } else {
+            char name[96];
+            snprintf(name, sizeof(name), "%s/%s", c->chip, c->label);
+            fprintf(f, " hwmon %-24.24s: min %.2f avg %.2f max %.2f %s", name, s->min, avg, s->max,
+                    hwmon_unit[c->kind]);
+            if (c->kind == HWMON_FAN) {
+                if (s->onset_sec >= 0) {
+                    fprintf(f, ", ramp at %ds", s->onset_sec);
+                    if (!isnan(s->onset_temp)) {
+                        fprintf(f, " / %.1f °C", s->onset_temp);
+                        if (!isnan(temp_start)) fprintf(f, " (+%.1f)", s->onset_temp - temp_start);
+                    }
+                } else {
+                    fprintf(f, ", no ramp");
+                }
+                if (!isnan(r)) fprintf(f, ", r(temp)=%.2f", r);
+            }
+            fprintf(f, "\n");
+        }
+    }
+}
+
 /***********************************************************
  *                  CPU Frequency Helpers
  ***********************************************************/
@@ -291,6 +863,35 @@ int write_sysfs_int(const char *path, long value) {
     return rc;
 }
 
+/* Read a single-line sysfs/procfs value, newline stripped. Returns 0 on success. */
+int read_sysfs_str(const char *path, char *buf, size_t len) {
+    if (!buf || len == 0) return -1;
+    buf[0] = '\0';
+
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    if (!fgets(buf, (int)len, f)) {
+        fclose(f);
+        buf[0] = '\0';
+        return -1;
+    }
+    fclose(f);
+
+    buf[strcspn(buf, "\r\n")] = '\0';
+    return 0;
+}
+
+int write_sysfs_str(const char *path, const char *value) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+
+    int rc = fprintf(f, "%s\n", value) < 0 ? -1 : 0;
+
+    if (fclose(f) != 0) rc = -1;
+    return rc;
+}
+
 int write_scaling_governor(int cpu, const char *gov) {
     char path[256];
     snprintf(path, sizeof(path),
@@ -345,6 +946,17 @@ void close_msr(int fd) {
     if (fd >= 0) close(fd);
 }
 
+/* Core voltage from IA32_PERF_STATUS[47:32] in 1/8192 V (Intel);
+ * NAN when the MSR is unreadable or reports 0 */
+double read_core_voltage(int cpu) {
+    int fd = open_msr(cpu);
+    uint64_t v = 0;
+    int ok = read_msr(fd, MSR_IA32_PERF_STATUS, &v) == 0;
+    close_msr(fd);
+    double volts = ok ? ((v >> 32) & 0xFFFF) / 8192.0 : NAN;
+    return volts > 0 ? volts : NAN;
+}
+
 /* Calculate actual frequency from APERF/MPERF ratio 
  * Returns frequency in MHz, or -1 on error */
 double calculate_frequency_mhz(int cpu, double base_freq_mhz) {
@@ -386,90 +998,425 @@ double calculate_frequency_mhz(int cpu, double base_freq_mhz) {
 
 /***********************************************************
  *                  RAPL Power Reading
+ * One backend per package, picked at rapl_init by vendor and
+ * by what is accessible, in this order:
+ *  msr       - Intel 0x606/0x611/0x639/0x619/0x64D, or AMD
+ *              0xC0010299/0xC001029B with the per-core
+ *              0xC001029A summed over the package's cores;
+ *              32-bit counters
+ *  powercap  - /sys/class/powercap/intel-rapl:<pkg> energy_uj
+ *              (also the AMD RAPL driver); each zone wraps at
+ *              its own max_energy_range_uj
+ *  perf      - the `power` PMU via perf_event_open, without
+ *              root under perf_event_paranoid <= 0 or with
+ *              CAP_PERFMON; 64-bit counts, no wrap
+ *  amd_energy- hwmon Esocket<pkg> counters, AMD only
+ * Domains a backend lacks (AMD DRAM, psys off clients) read
+ * as NAN watts.
  ***********************************************************/
+typedef enum {
+    RAPL_SRC_MSR = 0,
+    RAPL_SRC_POWERCAP,
+    RAPL_SRC_PERF,
+    RAPL_SRC_AMD_ENERGY
+} rapl_src_t;
+
+static const char *rapl_src_names[] = { "msr", "powercap", "perf", "amd_energy" };
+
+enum { RAPL_PKG = 0, RAPL_PP0, RAPL_DRAM, RAPL_PSYS, RAPL_DOMAINS };
+static const char *rapl_powercap_names[RAPL_DOMAINS] = { "package", "core", "dram", "psys" };
+static const char *rapl_perf_events[RAPL_DOMAINS] = { "energy-pkg", "energy-cores", "energy-ram", "energy-psys" };
+
+#define RAPL_PERF_PMU "/sys/bus/event_source/devices/power"
+
 typedef struct {
     int fd;
-    double energy_unit;
-    uint64_t prev_pkg_energy;
-    uint64_t prev_pp0_energy;
-    uint64_t prev_dram_energy;
+    rapl_src_t src;
+    double energy_unit;         /* joules per counter tick (perf: per domain) */
+    uint64_t wrap[RAPL_DOMAINS]; /* counter range per domain */
+    int has[RAPL_DOMAINS];
+    uint32_t msr[RAPL_DOMAINS];
+    char path[RAPL_DOMAINS][128];
+    int perf_fd[RAPL_DOMAINS];
+    double perf_scale[RAPL_DOMAINS];
+    int *core_fds;              /* AMD msr: one per physical core, summed as pp0 */
+    uint64_t *prev_core;
+    int ncore;
+    uint64_t prev[RAPL_DOMAINS];
+    double psys_watts;          /* last rapl_read_power(); NAN without psys */
     struct timespec prev_time;
 } rapl_state_t;
 
-int rapl_init(rapl_state_t *state, int cpu) {
-    if (!state) return -1;
-    
-    memset(state, 0, sizeof(*state));
+static int read_topology_int(int cpu, const char *name);
+static int parse_cpu_list(const char *s, int *out, int max);
+
+/* Raw counter of one domain; 0 when unreadable */
+static uint64_t rapl_read_domain(const rapl_state_t *s, int d) {
+    uint64_t v = 0;
+    char buf[32];
+    if (s->src == RAPL_SRC_MSR) {
+        read_msr(s->fd, s->msr[d], &v);
+    } else if (s->src == RAPL_SRC_PERF) {
+        if (read(s->perf_fd[d], &v, sizeof(v)) != sizeof(v)) v = 0;
+    } else if (read_sysfs_str(s->path[d], buf, sizeof(buf)) == 0) {
+        v = strtoull(buf, NULL, 10);
+    }
+    return v;
+}
+
+static uint64_t rapl_delta(uint64_t now, uint64_t prev, uint64_t wrap) {
+    return now >= prev ? now - prev : wrap - prev + now;
+}
+
+static void rapl_set_wrap(rapl_state_t *state, uint64_t wrap) {
+    for (int d = 0; d < RAPL_DOMAINS; ++d) state->wrap[d] = wrap;
+}
+
+/* A powercap zone's range: max_energy_range_uj next to its energy_uj, + 1 */
+static uint64_t rapl_powercap_wrap(const char *energy_path) {
+    char path[160], buf[32];
+    int dir = (int)(strlen(energy_path) - strlen("energy_uj"));
+    snprintf(path, sizeof(path), "%.*smax_energy_range_uj", dir, energy_path);
+    return read_sysfs_str(path, buf, sizeof(buf)) == 0 ? strtoull(buf, NULL, 10) + 1 : 1ULL << 32;
+}
+
+static int rapl_init_msr(rapl_state_t *state, int cpu) {
+    int amd = cpu_vendor() == CPU_VENDOR_AMD;
     state->fd = open_msr(cpu);
     if (state->fd < 0) return -1;
-    
-    /* Read energy unit */
+
+    /* Read energy unit (bits 12:8 on both vendors) */
     uint64_t unit_reg = 0;
-    if (read_msr(state->fd, MSR_RAPL_POWER_UNIT, &unit_reg) != 0) {
+    if (read_msr(state->fd, amd ? MSR_AMD_RAPL_POWER_UNIT : MSR_RAPL_POWER_UNIT, &unit_reg) != 0) {
         close_msr(state->fd);
         state->fd = -1;
         return -1;
     }
-    
-    /* Energy unit is in bits 12:8 */
     state->energy_unit = 1.0 / (1 << ((unit_reg >> 8) & 0x1F));
-    
+    rapl_set_wrap(state, 1ULL << 32);
+    if (!amd) {
+        uint64_t v;
+        state->msr[RAPL_PKG] = MSR_PKG_ENERGY_STATUS;
+        state->msr[RAPL_PP0] = MSR_PP0_ENERGY_STATUS;
+        state->msr[RAPL_DRAM] = MSR_DRAM_ENERGY_STATUS;
+        state->msr[RAPL_PSYS] = MSR_PLATFORM_ENERGY_STATUS;
+        state->has[RAPL_PKG] = state->has[RAPL_PP0] = state->has[RAPL_DRAM] = 1;
+        state->has[RAPL_PSYS] = read_msr(state->fd, MSR_PLATFORM_ENERGY_STATUS, &v) == 0 && v != 0;
+        return 0;
+    }
+
+    /* AMD: package counter plus one core counter per physical core */
+    state->msr[RAPL_PKG] = MSR_AMD_PKG_ENERGY_STATUS;
+    state->has[RAPL_PKG] = 1;
+    int pkg = read_topology_int(cpu, "physical_package_id");
+    int ncpu = (int)sysconf(_SC_NPROCESSORS_CONF);
+    int *seen = calloc(ncpu, sizeof(int));
+    state->core_fds = calloc(ncpu, sizeof(int));
+    state->prev_core = calloc(ncpu, sizeof(uint64_t));
+    if (!seen || !state->core_fds || !state->prev_core) {
+        free(seen);
+        return 0;   /* package power still works */
+    }
+    for (int c = 0; c < ncpu; ++c) {
+        int core = read_topology_int(c, "core_id");
+        if (core < 0 || read_topology_int(c, "physical_package_id") != pkg) continue;
+        int dup = 0;
+        for (int k = 0; k < c && !dup; ++k) dup = seen[k] == core + 1;
+        seen[c] = core + 1;
+        if (dup) continue;
+        int fd = open_msr(c);
+        uint64_t v;
+        if (fd < 0 || read_msr(fd, MSR_AMD_CORE_ENERGY_STATUS, &v) != 0) {
+            close_msr(fd);
+            continue;
+        }
+        state->core_fds[state->ncore++] = fd;
+    }
+    state->has[RAPL_PP0] = state->ncore > 0;
+    free(seen);
+    return 0;
+}
+
+static int rapl_init_powercap(rapl_state_t *state, int cpu) {
+    int pkg = read_topology_int(cpu, "physical_package_id");
+    char path[128], buf[32];
+    if (pkg < 0) pkg = 0;
+    snprintf(state->path[RAPL_PKG], sizeof(state->path[RAPL_PKG]), "/sys/class/powercap/intel-rapl:%d/energy_uj", pkg);
+    if (read_sysfs_str(state->path[RAPL_PKG], buf, sizeof(buf)) != 0) {
+        state->path[RAPL_PKG][0] = '\0';
+        return -1;
+    }
+    state->has[RAPL_PKG] = 1;
+    state->energy_unit = 1e-6;
+    state->src = RAPL_SRC_POWERCAP;
+    /* core/dram are subzones of the package; psys is a top-level zone */
+    for (int z = 0; z < 16; ++z) {
+        int sub = z < 8;
+        if (sub) snprintf(path, sizeof(path), "/sys/class/powercap/intel-rapl:%d:%d/name", pkg, z);
+        else snprintf(path, sizeof(path), "/sys/class/powercap/intel-rapl:%d/name", z - 8);
+        if (read_sysfs_str(path, buf, sizeof(buf)) != 0) continue;
+        for (int d = RAPL_PP0; d < RAPL_DOMAINS; ++d) {
+            if (strcmp(buf, rapl_powercap_names[d]) != 0 || (d == RAPL_PSYS) == sub) continue;
+            path[strlen(path) - 4] = '\0';
+            snprintf(state->path[d], sizeof(state->path[d]), "%senergy_uj", path);
+            state->has[d] = 1;
+        }
+    }
+    /* zones have their own ranges (dram and psys differ from the package) */
+    for (int d = 0; d < RAPL_DOMAINS; ++d)
+        if (state->has[d]) state->wrap[d] = rapl_powercap_wrap(state->path[d]);
+    return 0;
+}
+
+/* One power PMU event per domain on the package's designated CPU */
+static int rapl_init_perf(rapl_state_t *state, int cpu) {
+    char path[160], buf[256];
+    if (read_sysfs_str(RAPL_PERF_PMU "/type", buf, sizeof(buf)) != 0) return -1;
+    uint32_t type = (uint32_t)atoi(buf);
+
+    /* cpumask lists one CPU per package; use the one in cpu's package */
+    int pkg = read_topology_int(cpu, "physical_package_id"), pmu_cpu = cpu;
+    if (read_sysfs_str(RAPL_PERF_PMU "/cpumask", buf, sizeof(buf)) == 0) {
+        int list[64];
+        int n = parse_cpu_list(buf, list, 64);
+        for (int i = 0; i < n; ++i)
+            if (read_topology_int(list[i], "physical_package_id") == pkg) pmu_cpu = list[i];
+    }
+
+    int opened = 0;
+    for (int d = 0; d < RAPL_DOMAINS; ++d) {
+        state->perf_fd[d] = -1;
+        snprintf(path, sizeof(path), RAPL_PERF_PMU "/events/%s", rapl_perf_events[d]);
+        if (read_sysfs_str(path, buf, sizeof(buf)) != 0) continue;
+        char *ev = strstr(buf, "event=");
+        if (!ev) continue;
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = strtoull(ev + 6, NULL, 0);
+        int fd = (int)syscall(SYS_perf_event_open, &attr, -1, pmu_cpu, -1, 0);
+        if (fd < 0) continue;
+        snprintf(path, sizeof(path), RAPL_PERF_PMU "/events/%s.scale", rapl_perf_events[d]);
+        state->perf_scale[d] = read_sysfs_str(path, buf, sizeof(buf)) == 0 ? atof(buf) : 0.0;
+        if (state->perf_scale[d] <= 0) state->perf_scale[d] = 1.0 / 4294967296.0;   /* 2^-32 J */
+        state->perf_fd[d] = fd;
+        state->has[d] = 1;
+        opened++;
+    }
+    /* psys alone is not enough: callers need package power */
+    if (!opened || state->perf_fd[RAPL_PKG] < 0) {
+        for (int d = 0; d < RAPL_DOMAINS; ++d) {
+            if (state->perf_fd[d] >= 0) close(state->perf_fd[d]);
+            state->perf_fd[d] = -1;
+            state->has[d] = 0;
+        }
+        return -1;
+    }
+    rapl_set_wrap(state, UINT64_MAX);
+    state->src = RAPL_SRC_PERF;
+    return 0;
+}
+
+static int rapl_init_amd_energy(rapl_state_t *state, int cpu) {
+    char path[96], buf[32], want[16];
+    snprintf(want, sizeof(want), "Esocket%d", read_topology_int(cpu, "physical_package_id"));
+    for (int h = 0; h < 64; ++h) {
+        snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/name", h);
+        if (read_sysfs_str(path, buf, sizeof(buf)) != 0 || strcmp(buf, "amd_energy") != 0) continue;
+        for (int e = 1; e <= 1024; ++e) {
+            snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/energy%d_label", h, e);
+            if (read_sysfs_str(path, buf, sizeof(buf)) != 0) break;
+            if (strcmp(buf, want) != 0) continue;
+            snprintf(state->path[RAPL_PKG], sizeof(state->path[RAPL_PKG]),
+                     "/sys/class/hwmon/hwmon%d/energy%d_input", h, e);
+            state->has[RAPL_PKG] = 1;
+            state->energy_unit = 1e-6;
+            rapl_set_wrap(state, UINT64_MAX);
+            state->src = RAPL_SRC_AMD_ENERGY;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int rapl_init(rapl_state_t *state, int cpu) {
+    if (!state) return -1;
+
+    memset(state, 0, sizeof(*state));
+    state->fd = -1;
+    for (int d = 0; d < RAPL_DOMAINS; ++d) state->perf_fd[d] = -1;
+    state->psys_watts = NAN;
+    if (rapl_init_msr(state, cpu) != 0 && rapl_init_powercap(state, cpu) != 0 &&
+        rapl_init_perf(state, cpu) != 0 &&
+        (cpu_vendor() != CPU_VENDOR_AMD || rapl_init_amd_energy(state, cpu) != 0))
+        return -1;
+
     /* Initialize counters */
-    read_msr(state->fd, MSR_PKG_ENERGY_STATUS, &state->prev_pkg_energy);
-    read_msr(state->fd, MSR_PP0_ENERGY_STATUS, &state->prev_pp0_energy);
-    read_msr(state->fd, MSR_DRAM_ENERGY_STATUS, &state->prev_dram_energy);
+    for (int d = 0; d < RAPL_DOMAINS; ++d)
+        if (state->has[d]) state->prev[d] = rapl_read_domain(state, d);
+    for (int k = 0; k < state->ncore; ++k)
+        read_msr(state->core_fds[k], MSR_AMD_CORE_ENERGY_STATUS, &state->prev_core[k]);
     clock_gettime(CLOCK_MONOTONIC, &state->prev_time);
-    
+
     return 0;
 }
 
-/* Returns average power in watts since last call */
+/* Returns average power in watts since last call; psys lands in state->psys_watts */
 int rapl_read_power(rapl_state_t *state, double *pkg_watts, double *pp0_watts, double *dram_watts) {
-    if (!state || state->fd < 0) return -1;
-    
-    uint64_t pkg_energy = 0, pp0_energy = 0, dram_energy = 0;
+    if (!state || !state->has[RAPL_PKG]) return -1;
+
     struct timespec now;
-    
-    read_msr(state->fd, MSR_PKG_ENERGY_STATUS, &pkg_energy);
-    read_msr(state->fd, MSR_PP0_ENERGY_STATUS, &pp0_energy);
-    read_msr(state->fd, MSR_DRAM_ENERGY_STATUS, &dram_energy);
+    uint64_t energy[RAPL_DOMAINS] = { 0 };
+    for (int d = 0; d < RAPL_DOMAINS; ++d)
+        if (state->has[d] && !(d == RAPL_PP0 && state->ncore)) energy[d] = rapl_read_domain(state, d);
     clock_gettime(CLOCK_MONOTONIC, &now);
-    
+
     double time_delta = (now.tv_sec - state->prev_time.tv_sec) +
                        (now.tv_nsec - state->prev_time.tv_nsec) / 1e9;
-    
+
     if (time_delta < 0.001) return -1;  /* Too short interval */
-    
-    /* Handle counter wraparound (32-bit counters) */
-    uint64_t pkg_delta = (pkg_energy >= state->prev_pkg_energy) ? 
-        (pkg_energy - state->prev_pkg_energy) : 
-        ((1ULL << 32) - state->prev_pkg_energy + pkg_energy);
-    
-    uint64_t pp0_delta = (pp0_energy >= state->prev_pp0_energy) ?
-        (pp0_energy - state->prev_pp0_energy) :
-        ((1ULL << 32) - state->prev_pp0_energy + pp0_energy);
-    
-    uint64_t dram_delta = (dram_energy >= state->prev_dram_energy) ?
-        (dram_energy - state->prev_dram_energy) :
-        ((1ULL << 32) - state->prev_dram_energy + dram_energy);
-    
-    if (pkg_watts) *pkg_watts = (pkg_delta * state->energy_unit) / time_delta;
-    if (pp0_watts) *pp0_watts = (pp0_delta * state->energy_unit) / time_delta;
-    if (dram_watts) *dram_watts = (dram_delta * state->energy_unit) / time_delta;
-    
-    state->prev_pkg_energy = pkg_energy;
-    state->prev_pp0_energy = pp0_energy;
-    state->prev_dram_energy = dram_energy;
+
+    /* Handle counter wraparound at the backend's range */
+    double watts[RAPL_DOMAINS];
+    for (int d = 0; d < RAPL_DOMAINS; ++d) {
+        uint64_t delta = rapl_delta(energy[d], state->prev[d], state->wrap[d]);
+        if (d == RAPL_PP0 && state->ncore) {
+            delta = 0;
+            for (int k = 0; k < state->ncore; ++k) {
+                uint64_t v = 0;
+                read_msr(state->core_fds[k], MSR_AMD_CORE_ENERGY_STATUS, &v);
+                delta += rapl_delta(v, state->prev_core[k], state->wrap[d]);
+                state->prev_core[k] = v;
+            }
+        }
+        double unit = state->src == RAPL_SRC_PERF ? state->perf_scale[d] : state->energy_unit;
+        watts[d] = state->has[d] ? (delta * unit) / time_delta : NAN;
+        state->prev[d] = energy[d];
+    }
+
+    if (pkg_watts) *pkg_watts = watts[RAPL_PKG];
+    if (pp0_watts) *pp0_watts = watts[RAPL_PP0];
+    if (dram_watts) *dram_watts = watts[RAPL_DRAM];
+    state->psys_watts = watts[RAPL_PSYS];
     state->prev_time = now;
-    
+
     return 0;
 }
 
 void rapl_close(rapl_state_t *state) {
-    if (state && state->fd >= 0) {
+    if (!state) return;
+    if (state->fd >= 0) {
         close_msr(state->fd);
         state->fd = -1;
     }
+    for (int d = 0; d < RAPL_DOMAINS; ++d) {
+        if (state->perf_fd[d] >= 0) close(state->perf_fd[d]);
+        state->perf_fd[d] = -1;
+        state->has[d] = 0;
+    }
+    for (int k = 0; k < state->ncore; ++k) close_msr(state->core_fds[k]);
+    free(state->core_fds);
+    free(state->prev_core);
+    state->core_fds = NULL;
+    state->prev_core = NULL;
+    state->ncore = 0;
+}
+
+/* Why rapl_init found no backend: the requirements of each one it tries, in order */
+void rapl_warn_unavailable(const char *consequence) {
+    fprintf(stderr, "Warning: RAPL unavailable (needs root + msr module, readable powercap energy_uj, or the "
+            "power PMU with perf_event_paranoid <= 0%s). %s\n",
+            cpu_vendor() == CPU_VENDOR_AMD ? ", or the amd_energy hwmon driver" : "", consequence);
+}
+
+/***********************************************************
+ *                 perf_event Counter Groups
+ * Thin wrapper over perf_event_open(2) for hardware and
+ * cache events on one thread or CPU. Events that fail to
+ * open are skipped, so callers check perf_group_has().
+ ***********************************************************/
+#define PERF_GROUP_MAX 8
+#define PERF_HW_CACHE(cache, op, result) \
+    ((uint64_t)(cache) | ((uint64_t)(op) << 8) | ((uint64_t)(result) << 16))
+
+typedef struct {
+    int fd[PERF_GROUP_MAX];
+    const char *name[PERF_GROUP_MAX];
+    int n;
+    pid_t pid;
+    int cpu;
+    int exclude_kernel;         /* set after EACCES when perf_event_paranoid > 1 */
+} perf_group_t;
+
+void perf_group_init(perf_group_t *g, pid_t pid, int cpu) {
+    memset(g, 0, sizeof(*g));
+    for (int i = 0; i < PERF_GROUP_MAX; ++i) g->fd[i] = -1;
+    g->pid = pid;
+    g->cpu = cpu;
+}
+
+/* Add an event; returns its slot, or -1 if the kernel/PMU refused it */
+int perf_group_add(perf_group_t *g, const char *name, uint32_t type, uint64_t config) {
+    if (g->n >= PERF_GROUP_MAX) return -1;
+
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (g->n == 0);
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int leader = g->n ? g->fd[0] : -1;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        attr.exclude_kernel = g->exclude_kernel;
+        int fd = (int)syscall(SYS_perf_event_open, &attr, g->pid, g->cpu, leader, 0);
+        if (fd >= 0) {
+            g->fd[g->n] = fd;
+            g->name[g->n] = name;
+            return g->n++;
+        }
+        if ((errno != EACCES && errno != EPERM) || g->exclude_kernel) break;
+        g->exclude_kernel = 1;  /* unprivileged: user-mode counts only */
+    }
+    return -1;
+}
+
+int perf_group_has(const perf_group_t *g, const char *name) {
+    for (int i = 0; i < g->n; ++i)
+        if (strcmp(g->name[i], name) == 0) return i;
+    return -1;
+}
+
+int perf_group_start(perf_group_t *g) {
+    if (g->n == 0) return -1;
+    ioctl(g->fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    return ioctl(g->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+/* Read all counters into vals[0..n), scaled for multiplexing */
+int perf_group_read(perf_group_t *g, double *vals) {
+    if (g->n == 0) return -1;
+
+    uint64_t buf[3 + PERF_GROUP_MAX];
+    ssize_t got = read(g->fd[0], buf, sizeof(buf));
+    if (got < (ssize_t)(3 * sizeof(uint64_t)) || buf[0] != (uint64_t)g->n) return -1;
+
+    double scale = (buf[2] > 0) ? (double)buf[1] / (double)buf[2] : 0.0;
+    for (int i = 0; i < g->n; ++i) vals[i] = (double)buf[3 + i] * scale;
+    return 0;
+}
+
+void perf_group_stop(perf_group_t *g) {
+    if (g->n > 0) ioctl(g->fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_group_close(perf_group_t *g) {
+    for (int i = 0; i < g->n; ++i)
+        if (g->fd[i] >= 0) close(g->fd[i]);
+    g->n = 0;
 }
 
 /***********************************************************
@@ -482,12 +1429,28 @@ typedef enum {
     W_AVX, 
     W_AVX2, 
     W_AVX512, 
+    W_MEMBW,
+    W_CRYPTO,
+    W_GATHER,
+    W_SYSCALL,
+    W_PIPE,
+    W_PGFAULT,
+    W_MADVISE,
+    W_TLB,
+    W_LOCK,
+    W_COPY,
+    W_DFLOAT,
+    W_DSSE,
+    W_DAVX,
+    W_FRONTEND,
     W_MIXED,
     W_AUTO 
 } workload_t;
 
 /* Forward declarations */
 void print_cpu_simd_capabilities();
+void collect_machine_fingerprint(machine_fingerprint_t *fp);
+void write_machine_fingerprint(FILE *f, const char *prefix, const machine_fingerprint_t *fp);
 
 /***********************************************************
  *          Cdyn Class Detection and Mapping
@@ -497,8 +1460,22 @@ cdyn_class_t get_cdyn_class(workload_t type) {
         case W_INT:
         case W_FLOAT:
         case W_SSE:
+        case W_MEMBW:
+        case W_CRYPTO:
+        case W_SYSCALL:
+        case W_PIPE:
+        case W_PGFAULT:
+        case W_MADVISE:
+        case W_TLB:
+        case W_LOCK:
+        case W_COPY:
+        case W_DFLOAT:
+        case W_DSSE:
+        case W_FRONTEND:
             return CDYN_CLASS_0;  /* Low Cdyn */
         case W_AVX:
+        case W_DAVX:
+        case W_GATHER:
             return CDYN_CLASS_1;  /* Medium Cdyn */
         case W_AVX2:
         case W_AVX512:
@@ -616,11 +1593,16 @@ int validate_frequency(const dcl_spec_t *dcl, workload_t type, double measured_m
     return passed;
 }
 
+/* One work unit = WORK_UNIT_ITERS scalar iterations or one pass over the
+ * SIMD buffer; the _iters and _span variants run a fraction of a unit so
+ * trace replay can hit millisecond duty-cycle boundaries. */
+#define WORK_UNIT_ITERS 10000000
+
 /* INT workload */
-void int_work_unit(volatile uint64_t *state) {
+void int_work_iters(volatile uint64_t *state, long iters) {
     uint64_t x = *state;
 
-    for (int i = 0; i < 10000000; ++i) {
+    for (long i = 0; i < iters; ++i) {
         x += (x << 1) ^ 0x9e3779b97f4a7c15ULL;
         x ^= (x >> 7);
         x = x * 6364136223846793005ULL + 1442695040888963407ULL;
@@ -630,11 +1612,15 @@ void int_work_unit(volatile uint64_t *state) {
     *state = x;
 }
 
+void int_work_unit(volatile uint64_t *state) {
+    int_work_iters(state, WORK_UNIT_ITERS);
+}
+
 /* FLOAT workload */
-void float_work_unit(volatile double *state) {
+void float_work_iters(volatile double *state, long iters) {
     double x = *state;
 
-    for (int i = 0; i < 10000000; ++i) {
+    for (long i = 0; i < iters; ++i) {
         x = x * 1.0000001 + 0.10000001;
         x = fmod(x, 100000.0);
         x = sqrt(x * x + 1.0);
@@ -644,14 +1630,18 @@ void float_work_unit(volatile double *state) {
     *state = x;
 }
 
+void float_work_unit(volatile double *state) {
+    float_work_iters(state, WORK_UNIT_ITERS);
+}
+
 /* SSE workload - 128-bit SIMD (array-based for true vectorization) */
-void sse_work_unit(float *buf) {
+void sse_work_span(float *buf, size_t n) {
     __m128 b = _mm_set1_ps(1.000001f);
     __m128 c = _mm_set1_ps(0.999999f);
     __m128 d = _mm_set1_ps(0.5f);
 
     /* Process array in 4-float chunks (SSE processes 4 floats/iteration) */
-    for (size_t i = 0; i < SIMD_ARRAY_SIZE; i += 4) {
+    for (size_t i = 0; i < n; i += 4) {
         __m128 a = _mm_loadu_ps(buf + i);
         
         /* Standard operations for ISA comparison (5 ops per iteration) */
@@ -667,14 +1657,18 @@ void sse_work_unit(float *buf) {
     }
 }
 
+void sse_work_unit(float *buf) {
+    sse_work_span(buf, SIMD_ARRAY_SIZE);
+}
+
 /* AVX workload - 256-bit FP only (array-based for true vectorization) */
-void avx_work_unit(float *buf) {
+void avx_work_span(float *buf, size_t n) {
     __m256 b = _mm256_set1_ps(1.000001f);
     __m256 c = _mm256_set1_ps(0.999999f);
     __m256 d = _mm256_set1_ps(0.5f);
 
     /* Process array in 8-float chunks (AVX processes 8 floats/iteration = 2x SSE) */
-    for (size_t i = 0; i < SIMD_ARRAY_SIZE; i += 8) {
+    for (size_t i = 0; i < n; i += 8) {
         __m256 a = _mm256_loadu_ps(buf + i);
         
         /* IDENTICAL operations as SSE but on 2x wider vectors */
@@ -690,14 +1684,18 @@ void avx_work_unit(float *buf) {
     }
 }
 
+void avx_work_unit(float *buf) {
+    avx_work_span(buf, SIMD_ARRAY_SIZE);
+}
+
 /* AVX2 workload - 256-bit with FMA (array-based for true vectorization) */
-void avx2_work_unit(float *buf) {
+void avx2_work_span(float *buf, size_t n) {
     __m256 b = _mm256_set1_ps(1.000001f);
     __m256 c = _mm256_set1_ps(0.999999f);
     __m256 d = _mm256_set1_ps(0.5f);
 
     /* Process array in 8-float chunks with FMA operations */
-    for (size_t i = 0; i < SIMD_ARRAY_SIZE; i += 8) {
+    for (size_t i = 0; i < n; i += 8) {
         __m256 a = _mm256_loadu_ps(buf + i);
         
         /* Use FMA instructions heavily (AVX2's main advantage over AVX) */
@@ -713,15 +1711,19 @@ void avx2_work_unit(float *buf) {
     }
 }
 
+void avx2_work_unit(float *buf) {
+    avx2_work_span(buf, SIMD_ARRAY_SIZE);
+}
+
 /* AVX-512 workload - 512-bit vectors */
-void avx512_work_unit(float *buf) {
+void avx512_work_span(float *buf, size_t n) {
 #ifdef __AVX512F__
     __m512 b = _mm512_set1_ps(1.000001f);
     __m512 c = _mm512_set1_ps(0.999999f);
     __m512 d = _mm512_set1_ps(0.5f);
 
     /* Process array in 16-float chunks (AVX-512 processes 16 floats/iteration = 4x SSE) */
-    for (size_t i = 0; i < SIMD_ARRAY_SIZE; i += 16) {
+    for (size_t i = 0; i < n; i += 16) {
         __m512 a = _mm512_loadu_ps(buf + i);
         
         /* IDENTICAL operations as SSE/AVX/AVX2 but on 4x wider vectors */
@@ -737,7 +1739,132 @@ void avx512_work_unit(float *buf) {
     }
 #else
     /* Fallback to AVX2 if AVX-512 not available at compile time */
-    avx2_work_unit(buf);
+    avx2_work_span(buf, n);
+#endif
+}
+
+void avx512_work_unit(float *buf) {
+    avx512_work_span(buf, SIMD_ARRAY_SIZE);
+}
+
+/* MEMBW workload - streaming read+write over a buffer well beyond LLC.
+ * buf holds MEMBW_BUFFER_WORDS words: first half is read, second written. */
+void membw_work_span(uint64_t *buf, size_t off, size_t n) {
+    const size_t half = MEMBW_BUFFER_WORDS / 2;
+    uint64_t *src = buf + (off % half);
+    uint64_t *dst = buf + half + (off % half);
+    if (off % half + n > half) n = half - off % half;
+
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = src[i] * 3 + 1;
+}
+
+void membw_work_unit(uint64_t *buf) {
+    membw_work_span(buf, 0, MEMBW_BUFFER_WORDS / 2);
+}
+
+/* CRYPTO workload - AES rounds on 8 independent blocks (AES-NI pipe) */
+void crypto_work_iters(volatile uint64_t *state, long iters) {
+#ifdef __AES__
+    __m128i key = _mm_set_epi64x(0x0f0e0d0c0b0a0908LL, (long long)*state);
+    __m128i b[8];
+    for (int k = 0; k < 8; ++k) b[k] = _mm_set_epi64x(k, (long long)*state + k);
+
+    for (long i = 0; i < iters; ++i)
+        for (int k = 0; k < 8; ++k)
+            b[k] = _mm_aesenc_si128(b[k], key);
+
+    __m128i x = b[0];
+    for (int k = 1; k < 8; ++k) x = _mm_xor_si128(x, b[k]);
+    *state = (uint64_t)_mm_cvtsi128_si64(x);
+#else
+    /* Fallback to INT if AES-NI not available at compile time */
+    int_work_iters(state, iters);
+#endif
+}
+
+void crypto_work_unit(volatile uint64_t *state) {
+    crypto_work_iters(state, WORK_UNIT_ITERS / 4);
+}
+
+/* GATHER workload - AVX2 gathers at pseudo-random indices into buf.
+ * lanes[8] is the per-thread LCG state; it carries over between calls so
+ * slices keep walking the whole buffer instead of replaying the same lines. */
+void gather_work_span(float *buf, size_t n, uint32_t *lanes) {
+#ifdef __AVX2__
+    const __m256i mul = _mm256_set1_epi32(1103515245);
+    const __m256i inc = _mm256_set1_epi32(12345);
+    const __m256i mask = _mm256_set1_epi32(SIMD_ARRAY_SIZE - 1);
+    __m256i idx = _mm256_loadu_si256((const __m256i *)lanes);
+    __m256 acc = _mm256_setzero_ps();
+
+    for (size_t i = 0; i < n; i += 8) {
+        idx = _mm256_and_si256(_mm256_add_epi32(_mm256_mullo_epi32(idx, mul), inc), mask);
+        acc = _mm256_add_ps(acc, _mm256_i32gather_ps(buf, idx, 4));
+    }
+    _mm256_storeu_si256((__m256i *)lanes, idx);
+
+    float out[8];
+    _mm256_storeu_ps(out, acc);
+    buf[0] += out[0] * 1e-30f;
+#else
+    /* Fallback to AVX2 arithmetic (itself falls back) if no gather at compile time */
+    (void)lanes;
+    avx2_work_span(buf, n);
+#endif
+}
+
+void gather_work_unit(float *buf, uint32_t *lanes) {
+    gather_work_span(buf, SIMD_ARRAY_SIZE, lanes);
+}
+
+/* Denormal variants of FLOAT / SSE / AVX: x = x*0.5 + d has a
+ * subnormal fixed point (2d), so every multiply and add takes a
+ * microcode assist unless MXCSR FTZ/DAZ are set (--mxcsr). */
+#define DENORM_F32 1e-39f
+#define DENORM_F64 1e-310
+
+void dfloat_work_iters(volatile double *state, long iters) {
+    double x = *state;
+    if (x > 2 * DENORM_F64 || x < 0) x = DENORM_F64;
+
+    for (long i = 0; i < iters; ++i) {
+        x = x * 0.5 + DENORM_F64;
+        x = x * 0.75 + DENORM_F64 * 0.5;
+    }
+
+    *state = x;
+}
+
+void dsse_work_span(float *buf, size_t n) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 d = _mm_set1_ps(DENORM_F32);
+
+    for (size_t i = 0; i < n; i += 4) {
+        __m128 a = _mm_min_ps(_mm_loadu_ps(buf + i), _mm_add_ps(d, d));  /* clamp into the subnormal range */
+        for (int j = 0; j < SIMD_INNER_ITERATIONS; ++j) {
+            a = _mm_add_ps(_mm_mul_ps(a, half), d);
+            a = _mm_add_ps(_mm_mul_ps(a, half), d);
+        }
+        _mm_storeu_ps(buf + i, _mm_add_ps(a, _mm_set1_ps(1.0f)));        /* keep buf normal for other kernels */
+    }
+}
+
+void davx_work_span(float *buf, size_t n) {
+#ifdef __AVX__
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 d = _mm256_set1_ps(DENORM_F32);
+
+    for (size_t i = 0; i < n; i += 8) {
+        __m256 a = _mm256_min_ps(_mm256_loadu_ps(buf + i), _mm256_add_ps(d, d));
+        for (int j = 0; j < SIMD_INNER_ITERATIONS; ++j) {
+            a = _mm256_add_ps(_mm256_mul_ps(a, half), d);
+            a = _mm256_add_ps(_mm256_mul_ps(a, half), d);
+        }
+        _mm256_storeu_ps(buf + i, _mm256_add_ps(a, _mm256_set1_ps(1.0f)));
+    }
+#else
+    dsse_work_span(buf, n);
 #endif
 }
 
@@ -855,6 +1982,17 @@ int cpu_supports_avx512() {
 #endif
 }
 
+int cpu_supports_aes() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return (ecx >> 25) & 1;  /* AES-NI */
+#else
+    return 0;
+#endif
+}
+
 /*******************************************************
  *                    Worker Thread
  *******************************************************/
@@ -862,6 +2000,7 @@ typedef struct {
     int cpu_id;
     double target_util;
     workload_t type;
+    int trace_lane;             /* --replay lane driven by this worker */
     _Atomic uint64_t ops_done;
 } worker_arg_t;
 
@@ -973,13 +2112,79 @@ int safe_fprintf_flush(FILE *f, const char *fmt, ...) {
  ***********************************************************/
 void print_usage(const char *prog) {
     fprintf(stderr,
-        "Usage: %s --mode single|multi|single-core-multi --util N(10-100) "
-        "--duration X[s|m|h] --type AUTO|INT|FLOAT|SSE|AVX|AVX2|AVX512|MIXED [options]\n"
+        "Usage: %s --mode single|multi|single-core-multi|smt-matrix|ctx-switch|tlb-sweep|copy-sweep|fp-assist|frontend-sweep|dcl-validate|cdyn-fit|vf-curve|uncore-sweep --util N(10-100) "
+        "--duration X[s|m|h] --type AUTO|INT|FLOAT|SSE|AVX|AVX2|AVX512|MEMBW|CRYPTO|GATHER|SYSCALL|PIPE|PGFAULT|MADVISE|TLB|LOCK|COPY|DFLOAT|DSSE|DAVX|FRONTEND|MIXED [options]\n"
         "\n"
         "Modes:\n"
         "  single              Single thread on one core\n"
         "  multi               One thread per available core\n"
         "  single-core-multi   Multiple threads on a single core\n"
+        "  replay              Follow a recorded utilization trace (--replay FILE)\n"
+        "  smt-matrix          Kernel-pair interference on SMT siblings (--duration per pair)\n"
+        "  ctx-switch          Context-switch cost per vector state on --single-core-id\n"
+        "  tlb-sweep           TLB-defeating chase per footprint and page size on --single-core-id\n"
+        "  copy-sweep          GB/s, power and frequency per copy method and transfer size\n"
+        "  fp-assist           FLOAT/SSE/AVX vs denormal variants, with and without FTZ/DAZ\n"
+        "  frontend-sweep      IPC, branch misses and power per code footprint and randomness\n"
+        "  dcl-validate        Every P0n, turbo-bin, P1 and PL point of a --dcl-spec file\n"
+        "  cdyn-fit            Fit P = Cdyn*V^2*f + leakage per kernel over pinned frequencies\n"
+        "  vf-curve            Per-CPU voltage vs pinned frequency under --type, outliers flagged\n"
+        "  uncore-sweep        Copy GB/s, LLC load latency and power per pinned uncore frequency\n"
+        "\n"
+        "SMT Matrix Options:\n"
+        "  --smt-kernels LIST       Kernels to pair (default all supported:\n"
+        "                           INT,FLOAT,SSE,AVX,AVX2,AVX512,MEMBW,CRYPTO,GATHER)\n"
+        "  --smt-cpu N              Use the physical core of CPU N (default: first with siblings)\n"
+        "  --smt-pair A,B           Use CPUs A and B directly, bypassing topology\n"
+        "\n"
+        "Context-Switch Options (with --single-core-id/--single-core-threads):\n"
+        "  --switch-method M        futex (ring ping-pong, default) or yield\n"
+        "  --thread-types LIST      Per-thread vector state NONE|SSE|AVX|AVX512|AMX,\n"
+        "                           repeated over threads (default: sweep each state)\n"
+        "  --switch-work N          Kernel slices (1/1024 unit) between switches (default 1)\n"
+        "\n"
+        "Lock Options (--type LOCK):\n"
+        "  --lock-kind K            mutex|spin|ticket|mcs|rwlock (default mutex)\n"
+        "  --lock-cs N              Critical section: N RMW steps on shared lines (default 100)\n"
+        "  --lock-ncs N             Local INT iterations between acquisitions (default 100)\n"
+        "  --lock-read-pct N        rwlock: percent of acquisitions that read (default 80)\n"
+        "  --spread S               Worker CPU order: linear|cores|smt|sockets|ccx|cppc (default linear)\n"
+        "  --core-type T            Hybrid parts: any|p|e (only that type) or p-first|e-first (default any)\n"
+        "\n"
+        "Cdyn Fit Options (--mode cdyn-fit, root, --enable-rapl):\n"
+        "  --cdyn-kernels LIST      Kernels to fit, MIXED allowed (default INT,FLOAT,SSE,AVX,AVX2,AVX512)\n"
+        "  --cdyn-freqs LIST        Pinned MHz steps (default 5 from cpuinfo min to max)\n"
+        "\n"
+        "V/F Curve Options (--mode vf-curve, root):\n"
+        "  --vf-freqs LIST          Pinned MHz steps\n"
+        "  --vf-steps N             Steps from cpuinfo min to max when no list (default 8)\n"
+        "  --vf-cores all|each      Load all CPUs per step, or one CPU at a time (default all)\n"
+        "\n"
+        "Memory Pressure Options (alongside any --type):\n"
+        "  --mem-pressure S         Hold S bytes (e.g. 8G) or N%% of MemAvailable resident\n"
+        "  --mem-touch-rate MB/s    Re-touch rate over the held region (default 256, 0 = none)\n"
+        "  --mem-cycle SEC          Drop and refault a quarter of it every SEC s (default off)\n"
+        "\n"
+        "Front-End Options (--type FRONTEND uses the first entry of each list):\n"
+        "  --fe-footprint LIST      Generated code sizes (default 16K,256K,4M,32M; --type FRONTEND: 8M)\n"
+        "  --fe-random LIST         Percent random call targets/branch outcomes, 0-100\n"
+        "                           (default 0,10,50; --type FRONTEND: 50)\n"
+        "\n"
+        "Denormal Options (DFLOAT/DSSE/DAVX, --mode fp-assist):\n"
+        "  --mxcsr M                Worker MXCSR: off|ftz|daz|ftz+daz (default: untouched)\n"
+        "  --assist-event CFG       Raw PMU config for FP assists (default: by CPU model)\n"
+        "\n"
+        "Copy Options (--type COPY uses the first entry of each list):\n"
+        "  --copy-method LIST       libc|movsb|avx2|avx512|nt|stosb|ntfill (default: all;\n"
+        "                           --type COPY: movsb)\n"
+        "  --copy-size LIST         Transfer sizes (default 4K,64K,1M,16M,256M; --type COPY: 64M)\n"
+        "  --copy-threads N         copy-sweep workers from --single-core-id on (default 1)\n"
+        "\n"
+        "TLB Options (--type TLB uses the first entry of each list):\n"
+        "  --tlb-footprint LIST     Chase footprints, e.g. 64M,1G,16G (default 64M,1G,8G;\n"
+        "                           --type TLB: 1G per thread)\n"
+        "  --tlb-pages LIST         Backing pages 4k|thp|2m|1g (default 4k,thp,2m,1g;\n"
+        "                           2m/1g need reserved hugetlb pages)\n"
         "\n"
         "Options:\n"
         "  --max-threads N          Max worker threads (default %d)\n"
@@ -988,6 +2193,30 @@ void print_usage(const char *prog) {
         "  --log FILE               Write CSV log to FILE\n"
         "  --log-interval N         Log/report interval (default %d sec)\n"
         "  --log-append             Append instead of overwrite\n"
+        "  --hwmon GLOBS            Log hwmon channels matching chip/label globs, e.g.\n"
+        "                           'nct*/fan*,*/CPU*,ipmi*/power*' (comma-separated)\n"
+        "  --fan-ramp-pct P         Fan ramp onset: rise over the first reading (default 10)\n"
+        "  --hwmon-list             List every hwmon channel with its reading and exit\n"
+        "\n"
+        "Repeat & Aggregate:\n"
+        "  --repeat N               Run N repetitions, report mean/stdev/95%% CI\n"
+        "  --cooldown S             Idle seconds between repetitions (default 10)\n"
+        "  --cooldown-temp N        Also wait until CPU temp <= N °C (max 300 s)\n"
+        "  --ci-target PCT          Stop early once ops/s 95%% CI half-width <= PCT%% of mean\n"
+        "\n"
+        "Trace Record & Replay:\n"
+        "  --record-trace FILE      Record per-CPU util trace (see --record-trace --help)\n"
+        "  --replay FILE            Replay a trace (implies --mode replay, duration from trace)\n"
+        "  --replay-speed X         Time-scale factor (default 1.0, 2.0 = twice as fast)\n"
+        "  --replay-map LIST        Lane to CPU remap \"LANE:CPU,...\" (default lane %% cpus)\n"
+        "  --replay-kernels LIST    Kernel by recorded util \"UTIL:TYPE,...\" (default --type)\n"
+        "\n"
+        "Fleet Baseline Screening:\n"
+        "  --baseline SRC           Screen against baseline FILE, or 'store' (results store)\n"
+        "  --update-baseline FILE   Fold the run into FILE if it passes screening\n"
+        "  --baseline-z Z           Out-of-family threshold |z| (default 3.0)\n"
+        "  --baseline-min N         Minimum baseline samples per metric (default 5)\n"
+        "  --baseline-tol PCT       Zero-variance baseline: allowed deviation from the mean (default 2)\n"
         "\n"
         "Single-Core Multi-Thread Options:\n"
         "  --single-core-id N       CPU core ID to pin threads (default 0)\n"
@@ -995,16 +2224,28 @@ void print_usage(const char *prog) {
         "\n"
         "CPU Frequency / Governor (requires root):\n"
         "  --set-governor GOV       Set CPU governor\n"
+        "  --set-epp PREF           Set energy_performance_preference (amd-pstate/intel_pstate active)\n"
+        "  --amd-pstate MODE        Switch amd-pstate to active|passive|guided before other writes\n"
         "  --set-min-freq HZ        Set scaling_min_freq\n"
         "  --set-max-freq HZ        Set scaling_max_freq\n"
         "  --freq-table LIST        Format: \"0:3200000,1:2800000,...\"\n"
+        "  --uncore-min MHZ         Pin intel_uncore_frequency min on every die (restored at exit)\n"
+        "  --uncore-max MHZ         Pin intel_uncore_frequency max on every die (restored at exit)\n"
+        "  --uncore-freqs LIST      uncore-sweep MHz steps (default 5 from initial min to max)\n"
         "\n"
         "Dynamic Frequency Management:\n"
         "  --dynamic-freq           Auto reduce freq when temp rises\n"
+        "  --thermal-guard          Predict time to --temp-threshold per sensor and back off\n"
+        "                           load in advance instead of hard-stopping\n"
+        "  --guard-margin S         Back off when a sensor is predicted within S s (default 15)\n"
+        "  --guard-window N         Samples in the per-sensor slope fit (default 8)\n"
+        "  --guard-action A         duty (lower duty cycle) or isa (drop ISA, then duty)\n"
         "\n"
         "Mixed Workload Options:\n"
         "  --mixed-ratio A:B:C      INT:FLOAT:AVX ratios\n"
         "                           Example: --mixed-ratio 5:2:3\n"
+        "  --kernel-fraction F      SYSCALL/PIPE/PGFAULT/MADVISE: share of busy time\n"
+        "                           in the kernel path, rest is INT (0.05-1, default 1)\n"
         "\n"
         "DCL Frequency Validation (requires MSR access):\n"
         "  --validate-dcl           Enable DCL frequency validation\n"
@@ -1012,13 +2253,24 @@ void print_usage(const char *prog) {
         "  --dcl-avx-freq MHZ       Expected AVX P0n frequency\n"
         "  --dcl-avx2-freq MHZ      Expected AVX2 P0n frequency\n"
         "  --dcl-avx512-freq MHZ    Expected AVX512 P0n frequency\n"
-        "  --dcl-tolerance PCT      Allowed deviation percentage (default 3.0)\n"
+        "  --dcl-tolerance PCT      Allowed deviation percentage (default 3.0, or the\n"
+        "                           spec file's; given here it overrides the file)\n"
+        "  --dcl-spec FILE|DIR      Versioned SKU spec file, or a directory of *.dcl\n"
+        "                           files matched by CPU family/model/stepping\n"
+        "  --dcl-report FILE        dcl-validate JSON report (default <log>.dcl.json)\n"
+        "  --dcl-suite              dcl-validate over SSE, AVX, AVX2 and AVX512 in one\n"
+        "                           warm worker pool; expectations from --dcl-spec or\n"
+        "                           the --dcl-*-freq options\n"
         "  --enable-msr-freq        Use MSR APERF/MPERF for frequency measurement\n"
         "  --enable-rapl            Enable RAPL power monitoring\n"
         "  --base-freq MHZ          Base frequency for APERF/MPERF calc (default 2000)\n"
         "\n"
         "Misc:\n"
         "  --check                  Validate config but do not run workload\n"
+        "  --check-simd             Show CPU SIMD capabilities and exit\n"
+        "  --results-dir DIR        Results store directory (default " RESULTS_STORE_DEFAULT_DIR ")\n"
+        "  --query [filters]        Query the results store (see --query --help)\n"
+        "  --fingerprint            Print the machine fingerprint and exit\n"
         "  --help                   Show this help\n",
         prog, DEFAULT_MAX_THREADS, DEFAULT_TEMP_THRESHOLD, DEFAULT_LOG_INTERVAL
     );
@@ -1037,11 +2289,52 @@ workload_t parse_type(const char *s) {
     if (str_case_equal(s, "AVX"))    return W_AVX;
     if (str_case_equal(s, "AVX2"))   return W_AVX2;
     if (str_case_equal(s, "AVX512")) return W_AVX512;
+    if (str_case_equal(s, "MEMBW"))  return W_MEMBW;
+    if (str_case_equal(s, "CRYPTO")) return W_CRYPTO;
+    if (str_case_equal(s, "GATHER")) return W_GATHER;
+    if (str_case_equal(s, "SYSCALL")) return W_SYSCALL;
+    if (str_case_equal(s, "PIPE"))   return W_PIPE;
+    if (str_case_equal(s, "PGFAULT")) return W_PGFAULT;
+    if (str_case_equal(s, "MADVISE")) return W_MADVISE;
+    if (str_case_equal(s, "TLB"))    return W_TLB;
+    if (str_case_equal(s, "LOCK"))   return W_LOCK;
+    if (str_case_equal(s, "COPY"))   return W_COPY;
+    if (str_case_equal(s, "DFLOAT")) return W_DFLOAT;
+    if (str_case_equal(s, "DSSE"))   return W_DSSE;
+    if (str_case_equal(s, "DAVX"))   return W_DAVX;
+    if (str_case_equal(s, "FRONTEND")) return W_FRONTEND;
     if (str_case_equal(s, "MIXED"))  return W_MIXED;
     if (str_case_equal(s, "AUTO"))   return W_AUTO;
     return W_AUTO;
 }
 
+const char *workload_str(workload_t type) {
+    switch (type) {
+    case W_INT:    return "INT";
+    case W_FLOAT:  return "FLOAT";
+    case W_SSE:    return "SSE";
+    case W_AVX:    return "AVX";
+    case W_AVX2:   return "AVX2";
+    case W_AVX512: return "AVX512";
+    case W_MEMBW:  return "MEMBW";
+    case W_CRYPTO: return "CRYPTO";
+    case W_GATHER: return "GATHER";
+    case W_SYSCALL: return "SYSCALL";
+    case W_PIPE:   return "PIPE";
+    case W_PGFAULT: return "PGFAULT";
+    case W_MADVISE: return "MADVISE";
+    case W_TLB:    return "TLB";
+    case W_LOCK:   return "LOCK";
+    case W_COPY:   return "COPY";
+    case W_DFLOAT: return "DFLOAT";
+    case W_DSSE:   return "DSSE";
+    case W_DAVX:   return "DAVX";
+    case W_FRONTEND: return "FRONTEND";
+    case W_AUTO:   return "AUTO";
+    default:       return "MIXED";
+    }
+}
+
 /***********************************************************
  *                 CLI Argument Parser
  ***********************************************************/
@@ -1056,9 +2349,28 @@ int parse_args(
     char **out_freq_table,
     int *out_dynamic_freq,
     char **out_mixed_ratio,
+    double *out_kernel_fraction,
     int *out_single_core_id, int *out_single_core_threads,
     dcl_spec_t *out_dcl, int *out_enable_msr_freq, int *out_enable_rapl, 
-    double *out_base_freq_mhz)
+    double *out_base_freq_mhz,
+    repeat_spec_t *out_repeat,
+    char **out_results_dir,
+    baseline_spec_t *out_baseline,
+    replay_spec_t *out_replay,
+    smt_spec_t *out_smt,
+    ctx_spec_t *out_ctx,
+    tlb_spec_t *out_tlb,
+    lock_spec_t *out_lock,
+    copy_spec_t *out_copy,
+    fpa_spec_t *out_fpa,
+    fe_spec_t *out_fe,
+    memp_spec_t *out_memp,
+    cdyn_spec_t *out_cdyn,
+    vf_spec_t *out_vf,
+    uncore_spec_t *out_uncore,
+    cppc_spec_t *out_cppc,
+    hwmon_spec_t *out_hwmon,
+    guard_spec_t *out_guard)
 {
     *out_mode = NULL;
     *out_util = -1;
@@ -1084,6 +2396,7 @@ int parse_args(
     
     *out_single_core_id = 0;
     *out_single_core_threads = 2;
+    *out_kernel_fraction = 1.0;
     
     /* DCL validation defaults */
     memset(out_dcl, 0, sizeof(*out_dcl));
@@ -1092,6 +2405,50 @@ int parse_args(
     *out_enable_rapl = 0;
     *out_base_freq_mhz = 2000.0;
 
+    /* Repeat defaults */
+    out_repeat->count = 1;
+    out_repeat->cooldown_sec = 10;
+    out_repeat->cooldown_temp = 0.0;
+    out_repeat->ci_target_pct = 0.0;
+    *out_results_dir = RESULTS_STORE_DEFAULT_DIR;
+
+    /* Baseline screening defaults */
+    memset(out_baseline, 0, sizeof(*out_baseline));
+    out_baseline->z_max = BASELINE_DEFAULT_Z;
+    out_baseline->min_samples = BASELINE_DEFAULT_MIN_SAMPLES;
+    out_baseline->tol_pct = BASELINE_DEFAULT_TOL_PCT;
+
+    /* Trace replay defaults */
+    memset(out_replay, 0, sizeof(*out_replay));
+    out_replay->speed = 1.0;
+
+    /* SMT matrix defaults */
+    memset(out_smt, 0, sizeof(*out_smt));
+    out_smt->core_cpu = -1;
+    memset(out_ctx, 0, sizeof(*out_ctx));
+    out_ctx->work_slices = 1;
+    memset(out_tlb, 0, sizeof(*out_tlb));
+    memset(out_lock, 0, sizeof(*out_lock));
+    out_lock->cs_iters = 100;
+    out_lock->ncs_iters = 100;
+    out_lock->read_pct = 80;
+    memset(out_copy, 0, sizeof(*out_copy));
+    out_copy->threads = 1;
+    memset(out_fpa, 0, sizeof(*out_fpa));
+    memset(out_fe, 0, sizeof(*out_fe));
+    memset(out_memp, 0, sizeof(*out_memp));
+    out_memp->touch_mbps = 256.0;
+    memset(out_cdyn, 0, sizeof(*out_cdyn));
+    memset(out_vf, 0, sizeof(*out_vf));
+    memset(out_uncore, 0, sizeof(*out_uncore));
+    memset(out_cppc, 0, sizeof(*out_cppc));
+    memset(out_hwmon, 0, sizeof(*out_hwmon));
+    out_hwmon->fan_ramp_pct = 10.0;
+    memset(out_guard, 0, sizeof(*out_guard));
+    out_guard->margin_sec = 15.0;
+    out_guard->window = 8;
+    out_guard->action = "duty";
+
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
             *out_mode = argv[++i];
@@ -1133,11 +2490,36 @@ int parse_args(
             continue;
         }
 
+        if (strcmp(argv[i], "--hwmon") == 0 && i + 1 < argc) {
+            out_hwmon->select = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--fan-ramp-pct") == 0 && i + 1 < argc) {
+            out_hwmon->fan_ramp_pct = atof(argv[++i]);
+            if (out_hwmon->fan_ramp_pct <= 0) {
+                fprintf(stderr, "Error: --fan-ramp-pct must be > 0\n");
+                return -1;
+            }
+            continue;
+        }
+
+        if (strcmp(argv[i], "--hwmon-list") == 0) {
+            hwmon_list(stdout);
+            exit(0);
+        }
+
         if (strcmp(argv[i], "--check-simd") == 0) {
             print_cpu_simd_capabilities();
             exit(0);
         }
 
+        if (strcmp(argv[i], "--fingerprint") == 0) {
+            collect_machine_fingerprint(&g_fingerprint);
+            write_machine_fingerprint(stdout, "", &g_fingerprint);
+            exit(0);
+        }
+
         if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
             *out_log_path = argv[++i];
             continue;
@@ -1170,6 +2552,37 @@ int parse_args(
             continue;
         }
 
+        if (strcmp(argv[i], "--set-epp") == 0 && i + 1 < argc) {
+            out_cppc->epp = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--amd-pstate") == 0 && i + 1 < argc) {
+            out_cppc->pstate_mode = argv[++i];
+            if (!str_case_equal(out_cppc->pstate_mode, "active") &&
+                !str_case_equal(out_cppc->pstate_mode, "passive") &&
+                !str_case_equal(out_cppc->pstate_mode, "guided")) {
+                fprintf(stderr, "Error: --amd-pstate must be active, passive or guided\n");
+                return -1;
+            }
+            continue;
+        }
+
+        if (strcmp(argv[i], "--uncore-min") == 0 && i + 1 < argc) {
+            out_uncore->min_mhz = atol(argv[++i]);
+            continue;
+        }
+
+        if (strcmp(argv[i], "--uncore-max") == 0 && i + 1 < argc) {
+            out_uncore->max_mhz = atol(argv[++i]);
+            continue;
+        }
+
+        if (strcmp(argv[i], "--uncore-freqs") == 0 && i + 1 < argc) {
+            out_uncore->freqs = argv[++i];
+            continue;
+        }
+
         if (strcmp(argv[i], "--freq-table") == 0 && i + 1 < argc) {
             *out_freq_table = argv[++i];
             continue;
@@ -1180,10 +2593,54 @@ int parse_args(
             continue;
         }
 
+        if (strcmp(argv[i], "--thermal-guard") == 0) {
+            out_guard->enabled = 1;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--guard-margin") == 0 && i + 1 < argc) {
+            out_guard->margin_sec = atof(argv[++i]);
+            out_guard->enabled = 1;
+            if (out_guard->margin_sec <= 0) {
+                fprintf(stderr, "Error: --guard-margin must be > 0\n");
+                return -1;
+            }
+            continue;
+        }
+
+        if (strcmp(argv[i], "--guard-window") == 0 && i + 1 < argc) {
+            out_guard->window = atoi(argv[++i]);
+            out_guard->enabled = 1;
+            if (out_guard->window < 3 || out_guard->window > GUARD_MAX_WINDOW) {
+                fprintf(stderr, "Error: --guard-window must be 3..%d\n", GUARD_MAX_WINDOW);
+                return -1;
+            }
+            continue;
+        }
+
+        if (strcmp(argv[i], "--guard-action") == 0 && i + 1 < argc) {
+            out_guard->action = argv[++i];
+            out_guard->enabled = 1;
+            if (!str_case_equal(out_guard->action, "duty") && !str_case_equal(out_guard->action, "isa")) {
+                fprintf(stderr, "Error: --guard-action must be duty or isa\n");
+                return -1;
+            }
+            continue;
+        }
+
         if (strcmp(argv[i], "--mixed-ratio") == 0 && i + 1 < argc) {
             *out_mixed_ratio = argv[++i];
             continue;
         }
+
+        if (strcmp(argv[i], "--kernel-fraction") == 0 && i + 1 < argc) {
+            *out_kernel_fraction = atof(argv[++i]);
+            if (*out_kernel_fraction < 0.05 || *out_kernel_fraction > 1.0) {
+                fprintf(stderr, "Error: --kernel-fraction must be 0.05-1.0\n");
+                return -1;
+            }
+            continue;
+        }
         
         if (strcmp(argv[i], "--single-core-id") == 0 && i + 1 < argc) {
             *out_single_core_id = atoi(argv[++i]);
@@ -1227,6 +2684,22 @@ int parse_args(
         
         if (strcmp(argv[i], "--dcl-tolerance") == 0 && i + 1 < argc) {
             out_dcl->tolerance_pct = atof(argv[++i]);
+            out_dcl->tolerance_set = 1;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--dcl-spec") == 0 && i + 1 < argc) {
+            out_dcl->spec_path = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--dcl-suite") == 0) {
+            out_dcl->suite = 1;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--dcl-report") == 0 && i + 1 < argc) {
+            out_dcl->report_path = argv[++i];
             continue;
         }
         
@@ -1245,1091 +2718,8906 @@ int parse_args(
             continue;
         }
 
-        if (strcmp(argv[i], "--help") == 0) {
-            print_usage(argv[0]);
-            return -1;
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            out_repeat->count = atoi(argv[++i]);
+            continue;
         }
 
-        fprintf(stderr, "Unknown or malformed argument: %s\n", argv[i]);
-        print_usage(argv[0]);
-        return -1;
-    }
+        if (strcmp(argv[i], "--cooldown") == 0 && i + 1 < argc) {
+            out_repeat->cooldown_sec = atoi(argv[++i]);
+            continue;
+        }
 
-    /* Validate mandatory parameters */
-    if (!*out_mode) {
-        fprintf(stderr, "Missing --mode\n");
-        return -1;
-    }
+        if (strcmp(argv[i], "--cooldown-temp") == 0 && i + 1 < argc) {
+            out_repeat->cooldown_temp = atof(argv[++i]);
+            continue;
+        }
 
-    if (*out_util < 0) {
-        fprintf(stderr, "Missing or invalid --util\n");
-        return -1;
-    }
+        if (strcmp(argv[i], "--ci-target") == 0 && i + 1 < argc) {
+            out_repeat->ci_target_pct = atof(argv[++i]);
+            continue;
+        }
 
-    if (*out_duration <= 0) {
-        fprintf(stderr, "Missing or invalid --duration\n");
-        return -1;
-    }
+        if (strcmp(argv[i], "--results-dir") == 0 && i + 1 < argc) {
+            *out_results_dir = argv[++i];
+            continue;
+        }
 
-    if (*out_util < 10 || *out_util > 100) {
-        fprintf(stderr, "--util must be between 10 and 100\n");
-        return -1;
-    }
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            out_baseline->source = argv[++i];
+            continue;
+        }
 
-    if (*out_max_threads <= 0 || *out_max_threads > DEFAULT_MAX_THREADS) {
-        fprintf(stderr, "--max-threads must be between 1 and %d\n",
-                DEFAULT_MAX_THREADS);
-        return -1;
-    }
+        if (strcmp(argv[i], "--update-baseline") == 0 && i + 1 < argc) {
+            out_baseline->update_path = argv[++i];
+            continue;
+        }
 
-    return 0;
-}
+        if (strcmp(argv[i], "--baseline-z") == 0 && i + 1 < argc) {
+            out_baseline->z_max = atof(argv[++i]);
+            continue;
+        }
 
-/***********************************************************
- *                Frequency Table Parser
- ***********************************************************/
-int parse_freq_table(
-    const char *s,
-    int *out_count,
-    int **out_cpu,
-    long **out_freq)
-{
-    if (!s) {
-        *out_count = 0;
-        *out_cpu = NULL;
-        *out_freq = NULL;
-        return 0;
-    }
+        if (strcmp(argv[i], "--baseline-min") == 0 && i + 1 < argc) {
+            out_baseline->min_samples = atoi(argv[++i]);
+            continue;
+        }
 
-    char *copy = strdup(s);
-    if (!copy) return -1;
+        if (strcmp(argv[i], "--baseline-tol") == 0 && i + 1 < argc) {
+            out_baseline->tol_pct = atof(argv[++i]);
+            continue;
+        }
 
-    int maxpairs = 256;
-    int *cpus  = malloc(sizeof(int) * maxpairs);
-    long *freq = malloc(sizeof(long) * maxpairs);
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            out_replay->path = argv[++i];
+            continue;
+        }
 
-    if (!cpus || !freq) {
-        free(cpus);
-        free(freq);
-        free(copy);
-        return -1;
-    }
+        if (strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc) {
+            out_replay->speed = atof(argv[++i]);
+            continue;
+        }
 
-    int cnt = 0;
+        if (strcmp(argv[i], "--replay-map") == 0 && i + 1 < argc) {
+            out_replay->cpu_map = argv[++i];
+            continue;
+        }
 
-    char *tok = strtok(copy, ",");
-    while (tok) {
-        char *sep = strchr(tok, ':');
-        if (!sep) {
-            tok = strtok(NULL, ",");
+        if (strcmp(argv[i], "--replay-kernels") == 0 && i + 1 < argc) {
+            out_replay->kernels = argv[++i];
             continue;
         }
 
-        *sep = '\0';
+        if (strcmp(argv[i], "--smt-kernels") == 0 && i + 1 < argc) {
+            out_smt->kernels = argv[++i];
+            continue;
+        }
 
-        cpus[cnt]  = atoi(tok);
-        freq[cnt]  = atol(sep + 1);
+        if (strcmp(argv[i], "--smt-cpu") == 0 && i + 1 < argc) {
+            out_smt->core_cpu = atoi(argv[++i]);
+            continue;
+        }
 
-        cnt++;
-        tok = strtok(NULL, ",");
-    }
+        if (strcmp(argv[i], "--smt-pair") == 0 && i + 1 < argc) {
+            out_smt->pair = argv[++i];
+            continue;
+        }
 
-    free(copy);
+        if (strcmp(argv[i], "--switch-method") == 0 && i + 1 < argc) {
+            out_ctx->method = argv[++i];
+            continue;
+        }
 
-    *out_cpu  = cpus;
-    *out_freq = freq;
-    *out_count = cnt;
+        if (strcmp(argv[i], "--thread-types") == 0 && i + 1 < argc) {
+            out_ctx->thread_types = argv[++i];
+            continue;
+        }
 
-    return 0;
-}
+        if (strcmp(argv[i], "--lock-kind") == 0 && i + 1 < argc) {
+            out_lock->kind = argv[++i];
+            continue;
+        }
 
-/***********************************************************
- *             Mixed Ratio Parser (A:B:C)
- ***********************************************************/
-typedef struct {
-    int r_int;
-    int r_float;
-    int r_avx;
-    int total;
-} mixed_ratio_t;
+        if (strcmp(argv[i], "--lock-cs") == 0 && i + 1 < argc) {
+            out_lock->cs_iters = atol(argv[++i]);
+            if (out_lock->cs_iters < 0) {
+                fprintf(stderr, "Error: --lock-cs must be >= 0\n");
+                return -1;
+            }
+            continue;
+        }
 
-static mixed_ratio_t g_mixed_ratio = {0,0,0,0};
+        if (strcmp(argv[i], "--lock-ncs") == 0 && i + 1 < argc) {
+            out_lock->ncs_iters = atol(argv[++i]);
+            if (out_lock->ncs_iters < 0) {
+                fprintf(stderr, "Error: --lock-ncs must be >= 0\n");
+                return -1;
+            }
+            continue;
+        }
 
-int parse_mixed_ratio(const char *s, mixed_ratio_t *mr) {
-    if (!s) return -1;
+        if (strcmp(argv[i], "--lock-read-pct") == 0 && i + 1 < argc) {
+            out_lock->read_pct = atoi(argv[++i]);
+            if (out_lock->read_pct < 0 || out_lock->read_pct > 100) {
+                fprintf(stderr, "Error: --lock-read-pct must be 0-100\n");
+                return -1;
+            }
+            continue;
+        }
 
-    int a=0, b=0, c=0;
+        if (strcmp(argv[i], "--spread") == 0 && i + 1 < argc) {
+            out_lock->spread = argv[++i];
+            continue;
+        }
 
-    if (sscanf(s, "%d:%d:%d", &a, &b, &c) != 3)
-        return -1;
+        if (strcmp(argv[i], "--core-type") == 0 && i + 1 < argc) {
+            out_lock->core_type = argv[++i];
+            continue;
+        }
 
-    if (a < 0 || b < 0 || c < 0)
-        return -1;
+        if (strcmp(argv[i], "--mem-pressure") == 0 && i + 1 < argc) {
+            out_memp->size = argv[++i];
+            continue;
+        }
 
-    int total = a + b + c;
+        if (strcmp(argv[i], "--mem-touch-rate") == 0 && i + 1 < argc) {
+            out_memp->touch_mbps = atof(argv[++i]);
+            if (out_memp->touch_mbps < 0) {
+                fprintf(stderr, "Error: --mem-touch-rate must be >= 0 MB/s\n");
+                return -1;
+            }
+            continue;
+        }
 
-    if (total <= 0)
-        return -1;
+        if (strcmp(argv[i], "--mem-cycle") == 0 && i + 1 < argc) {
+            out_memp->cycle_sec = atoi(argv[++i]);
+            if (out_memp->cycle_sec < 0) {
+                fprintf(stderr, "Error: --mem-cycle must be >= 0 seconds\n");
+                return -1;
+            }
+            continue;
+        }
 
-    mr->r_int   = a;
-    mr->r_float = b;
-    mr->r_avx   = c;
-    mr->total   = total;
+        if (strcmp(argv[i], "--cdyn-kernels") == 0 && i + 1 < argc) {
+            out_cdyn->kernels = argv[++i];
+            continue;
+        }
 
-    return 0;
-}
+        if (strcmp(argv[i], "--cdyn-freqs") == 0 && i + 1 < argc) {
+            out_cdyn->freqs = argv[++i];
+            continue;
+        }
 
-/***********************************************************
- *        CPU SIMD Capabilities Display & Verification
- ***********************************************************/
-void print_cpu_simd_capabilities() {
-    printf("\n=== CPU SIMD Capabilities ===");
-    printf("\n CPU Architecture Support:");
-    
-#if defined(__x86_64__)
-    printf("\n  Architecture    : x86_64 (64-bit)");
-#elif defined(__i386__)
-    printf("\n  Architecture    : i386 (32-bit)");
-#else
-    printf("\n  Architecture    : Non-x86 (SIMD detection unavailable)");
-#endif
+        if (strcmp(argv[i], "--vf-freqs") == 0 && i + 1 < argc) {
+            out_vf->freqs = argv[++i];
+            continue;
+        }
 
-#if defined(__x86_64__) || defined(__i386__)
-    int has_sse = cpu_supports_sse();
-    int has_avx = cpu_supports_avx();
-    int has_avx2 = cpu_supports_avx2();
-    int has_avx512 = cpu_supports_avx512();
-    
-    printf("\n  SSE4.2          : %s", has_sse ? "✓ YES" : "✗ NO");
-    printf("\n  AVX (256-bit)   : %s", has_avx ? "✓ YES" : "✗ NO");
-    printf("\n  AVX2 + FMA      : %s", has_avx2 ? "✓ YES" : "✗ NO");
-    printf("\n  AVX-512         : %s", has_avx512 ? "✓ YES" : "✗ NO");
-    
-    printf("\n\n Recommended Workload Types:");
-    if (has_avx512)
-        printf("\n  Best            : --type AVX512 (512-bit vectors)");
-    else if (has_avx2)
-        printf("\n  Best            : --type AVX2 (256-bit with FMA)");
-    else if (has_avx)
-        printf("\n  Best            : --type AVX (256-bit floating point)");
-    else if (has_sse)
-        printf("\n  Best            : --type SSE (128-bit vectors)");
-    else
-        printf("\n  Best            : --type FLOAT or INT (scalar only)");
-    
-    printf("\n  Auto-detect     : --type AUTO (will select best available)");
-#endif
-    
-    printf("\n\n Compile-time Flags:");
-#ifdef __SSE4_2__
-    printf("\n  __SSE4_2__      : Defined (SSE4.2 instructions enabled)");
-#endif
-#ifdef __AVX__
-    printf("\n  __AVX__         : Defined (AVX instructions enabled)");
-#endif
-#ifdef __AVX2__
-    printf("\n  __AVX2__        : Defined (AVX2 instructions enabled)");
-#endif
-#ifdef __FMA__
-    printf("\n  __FMA__         : Defined (FMA instructions enabled)");
-#endif
-#ifdef __AVX512F__
-    printf("\n  __AVX512F__     : Defined (AVX-512 instructions enabled)");
-#endif
-    
-    printf("\n\n Note: Compiled with -march=native enables all CPU-supported instructions");
-    
-    printf("\n\n=== Verification Methods ===");
-    printf("\n\n 1. Check CPU flags:");
-    printf("\n    $ lscpu | grep -i flags");
-    printf("\n    $ cat /proc/cpuinfo | grep flags | head -1");
-    printf("\n");
-    printf("\n 2. Profile with perf (requires root):");
-    printf("\n    $ sudo perf stat ./coreburner --mode multi --util 50 --duration 10 --type AVX2");
-    printf("\n");
-    printf("\n 3. Inspect binary for SIMD instructions:");
-    printf("\n    $ objdump -d coreburner | grep 'ymm'  # AVX/AVX2 (256-bit)");
-    printf("\n    $ objdump -d coreburner | grep 'zmm'  # AVX-512 (512-bit)");
-    printf("\n    $ objdump -d coreburner | grep 'xmm'  # SSE (128-bit)");
-    printf("\n");
-    printf("\n 4. Look for specific instructions:");
-    printf("\n    $ objdump -d coreburner | grep -E '(vfmadd|vmul|vadd)'");
-    printf("\n    - 'v' prefix = AVX family (vmulps, vaddpd, etc.)");
-    printf("\n    - 'vfmadd' = FMA instructions (AVX2)");
-    printf("\n    - 'ymm' registers = 256-bit vectors (AVX/AVX2)");
-    printf("\n    - 'zmm' registers = 512-bit vectors (AVX-512)");
-    printf("\n");
-    printf("\n 5. Use Intel VTune or AMD uProf for detailed profiling");
-    printf("\n\n");
-}
+        if (strcmp(argv[i], "--vf-steps") == 0 && i + 1 < argc) {
+            out_vf->steps = atoi(argv[++i]);
+            if (out_vf->steps < 2) {
+                fprintf(stderr, "Error: --vf-steps must be >= 2\n");
+                return -1;
+            }
+            continue;
+        }
 
-/***********************************************************
- *             Auto-detect Best SIMD Level
- ***********************************************************/
-workload_t auto_detect_best_simd() {
-    if (cpu_supports_avx512()) {
-        fprintf(stderr, "Auto-detected: AVX-512 (512-bit SIMD)\n");
-        return W_AVX512;
-    }
-    if (cpu_supports_avx2()) {
-        fprintf(stderr, "Auto-detected: AVX2 (256-bit with FMA)\n");
-        return W_AVX2;
-    }
-    if (cpu_supports_avx()) {
-        fprintf(stderr, "Auto-detected: AVX (256-bit FP)\n");
-        return W_AVX;
-    }
-    if (cpu_supports_sse()) {
-        fprintf(stderr, "Auto-detected: SSE (128-bit)\n");
-        return W_SSE;
-    }
-    fprintf(stderr, "Auto-detected: INT (no SIMD)\n");
-    return W_INT;
-}
+        if (strcmp(argv[i], "--vf-cores") == 0 && i + 1 < argc) {
+            const char *v = argv[++i];
+            if (str_case_equal(v, "each")) out_vf->each = 1;
+            else if (str_case_equal(v, "all")) out_vf->each = 0;
+            else {
+                fprintf(stderr, "Error: --vf-cores must be all or each\n");
+                return -1;
+            }
+            continue;
+        }
 
-/***********************************************************
- *             Environment Validation
- ***********************************************************/
-int validate_environment(
-    const char *mode,
-    workload_t type,
-    int max_threads,
-    int *out_nthreads,
-    char **temp_path,
-    double temp_threshold,
-    int wants_cpufreq_write,
-    const char *mixed_ratio_str,
-    int single_core_id,
-    int single_core_threads)
-{
-    if (access("/proc/stat", R_OK) != 0) {
-        fprintf(stderr, "Error: /proc/stat not readable\n");
+        if (strcmp(argv[i], "--fe-footprint") == 0 && i + 1 < argc) {
+            out_fe->footprints = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--fe-random") == 0 && i + 1 < argc) {
+            out_fe->random = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--mxcsr") == 0 && i + 1 < argc) {
+            out_fpa->mxcsr = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--assist-event") == 0 && i + 1 < argc) {
+            out_fpa->assist_event = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--copy-method") == 0 && i + 1 < argc) {
+            out_copy->methods = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--copy-size") == 0 && i + 1 < argc) {
+            out_copy->sizes = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--copy-threads") == 0 && i + 1 < argc) {
+            out_copy->threads = atoi(argv[++i]);
+            if (out_copy->threads <= 0) {
+                fprintf(stderr, "Error: --copy-threads must be > 0\n");
+                return -1;
+            }
+            continue;
+        }
+
+        if (strcmp(argv[i], "--tlb-footprint") == 0 && i + 1 < argc) {
+            out_tlb->footprints = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--tlb-pages") == 0 && i + 1 < argc) {
+            out_tlb->pages = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--switch-work") == 0 && i + 1 < argc) {
+            out_ctx->work_slices = atoi(argv[++i]);
+            if (out_ctx->work_slices < 0) {
+                fprintf(stderr, "Error: --switch-work must be >= 0\n");
+                return -1;
+            }
+            continue;
+        }
+
+        if (strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return -1;
+        }
+
+        fprintf(stderr, "Unknown or malformed argument: %s\n", argv[i]);
+        print_usage(argv[0]);
         return -1;
     }
 
-    /* Determine worker thread count */
-    int affinity = get_affinity_cpu_count();
-    g_available_cpus = affinity;
-
-    int nthreads;
-    if (str_case_equal(mode, "single")) {
-        nthreads = 1;
-    } else if (str_case_equal(mode, "single-core-multi")) {
-        /* Validate single-core-multi parameters */
-        if (single_core_id < 0 || single_core_id >= affinity) {
-            fprintf(stderr,
-                    "Error: --single-core-id=%d is out of range (0-%d)\n",
-                    single_core_id, affinity - 1);
+    /* --replay takes load shape and length from the trace */
+    if (out_replay->path) {
+        if (*out_mode && !str_case_equal(*out_mode, "replay")) {
+            fprintf(stderr, "--replay cannot be combined with --mode %s\n", *out_mode);
             return -1;
         }
-        if (single_core_threads <= 0 || single_core_threads > max_threads) {
-            fprintf(stderr,
-                    "Error: --single-core-threads=%d must be 1-%d\n",
-                    single_core_threads, max_threads);
+        *out_mode = "replay";
+        if (*out_util < 0) *out_util = 100;
+        if (*out_duration < 0) *out_duration = 0;
+        if (out_replay->speed <= 0) {
+            fprintf(stderr, "--replay-speed must be > 0\n");
             return -1;
         }
-        nthreads = single_core_threads;
-    } else {
-        nthreads = affinity;
+    } else if (*out_mode && str_case_equal(*out_mode, "replay")) {
+        fprintf(stderr, "--mode replay requires --replay FILE\n");
+        return -1;
     }
 
-    /* NEW BEHAVIOR: Clamp instead of error */
-    if (nthreads > max_threads) {
-        fprintf(stderr,
-                "Info: system shows %d CPUs but --max-threads=%d. "
-                "Clamping thread count to %d.\n",
-                nthreads, max_threads, max_threads);
-        nthreads = max_threads;
+    /* --dcl-suite: dcl-validate at full load, spec from --dcl-spec or --dcl-*-freq */
+    if (out_dcl->suite) {
+        if (*out_mode && !str_case_equal(*out_mode, "dcl-validate")) {
+            fprintf(stderr, "--dcl-suite cannot be combined with --mode %s\n", *out_mode);
+            return -1;
+        }
+        *out_mode = "dcl-validate";
+        if (*out_util < 0) *out_util = 100;
     }
 
-    if (nthreads > DEFAULT_MAX_THREADS)
-        nthreads = DEFAULT_MAX_THREADS;
+    /* Validate mandatory parameters */
+    if (!*out_mode) {
+        fprintf(stderr, "Missing --mode\n");
+        return -1;
+    }
 
-    /* SIMD capability checks (skip for AUTO as it's already validated) */
-    if (type == W_AUTO) {
-        /* AUTO type will be resolved to actual type before here */
-        return 0;
+    /* --spread orders the CPU list; modes pinned to one core or a recorded map never read it */
+    if (out_lock->spread) {
+        static const char *const spread_modes[] = { "single", "multi", "copy-sweep", "uncore-sweep",
+                                                    "dcl-validate", "cdyn-fit", "vf-curve" };
+        int ok = 0;
+        for (size_t m = 0; m < sizeof(spread_modes) / sizeof(spread_modes[0]); ++m)
+            if (str_case_equal(*out_mode, spread_modes[m])) ok = 1;
+        if (!ok) {
+            fprintf(stderr, "--spread cannot be combined with --mode %s\n", *out_mode);
+            return -1;
+        }
     }
-    
-    if (type == W_SSE && !cpu_supports_sse()) {
-        fprintf(stderr,
-                "Error: CPU does not support SSE4.2.\n");
-        return -1;
+
+    /* --mem-pressure runs beside the main runtime loop; the sweep modes measure on their own */
+    if (out_memp->size) {
+        static const char *const sweep_modes[] = { "smt-matrix", "ctx-switch", "tlb-sweep", "copy-sweep",
+                                                   "fp-assist", "frontend-sweep", "dcl-validate", "cdyn-fit",
+                                                   "vf-curve", "uncore-sweep" };
+        for (size_t m = 0; m < sizeof(sweep_modes) / sizeof(sweep_modes[0]); ++m)
+            if (str_case_equal(*out_mode, sweep_modes[m])) {
+                fprintf(stderr, "--mem-pressure cannot be combined with --mode %s\n", *out_mode);
+                return -1;
+            }
     }
 
-    if (type == W_AVX && !cpu_supports_avx()) {
-        fprintf(stderr,
-                "Error: CPU or OS does not support AVX (XGETBV/xsave).\n");
+    if (*out_util < 0) {
+        fprintf(stderr, "Missing or invalid --util\n");
         return -1;
     }
 
-    if (type == W_AVX2 && !cpu_supports_avx2()) {
-        fprintf(stderr,
-                "Error: CPU does not support AVX2 or FMA.\n");
+    if (*out_duration <= 0 && !out_replay->path) {
+        fprintf(stderr, "Missing or invalid --duration\n");
         return -1;
     }
 
-    if (type == W_AVX512 && !cpu_supports_avx512()) {
-        fprintf(stderr,
-                "Error: CPU or OS does not support AVX-512F.\n");
+    if (*out_util < 10 || *out_util > 100) {
+        fprintf(stderr, "--util must be between 10 and 100\n");
         return -1;
     }
 
-    if (type == W_MIXED && !cpu_supports_avx()) {
-        fprintf(stderr,
-                "Error: MIXED mode requires AVX support.\n");
+    if (*out_max_threads <= 0 || *out_max_threads > DEFAULT_MAX_THREADS) {
+        fprintf(stderr, "--max-threads must be between 1 and %d\n",
+                DEFAULT_MAX_THREADS);
         return -1;
     }
 
-    /* Temperature sensor detection */
-    *temp_path = find_temperature_input_path();
-    if (!*temp_path) {
-        fprintf(stderr,
-                "Warning: Could not find CPU temp sensor. "
-                "Thermal auto-stop disabled.\n");
-    } else {
-        double t = read_temperature(*temp_path);
-        if (isnan(t))
-            fprintf(stderr, "Warning: CPU temp sensor unreadable.\n");
+    if (out_repeat->count < 1 || out_repeat->count > MAX_REPEAT) {
+        fprintf(stderr, "--repeat must be between 1 and %d\n", MAX_REPEAT);
+        return -1;
     }
 
-    /* cpufreq write checks */
-    if (wants_cpufreq_write && geteuid() != 0) {
-        fprintf(stderr,
-                "Error: root required for CPU frequency settings.\n");
+    if (out_repeat->cooldown_sec < 0) {
+        fprintf(stderr, "--cooldown must be >= 0\n");
         return -1;
     }
 
-    /* MIXED ratio must be provided */
-    if (type == W_MIXED) {
-        if (!mixed_ratio_str) {
-            fprintf(stderr,
-                    "Error: MIXED mode requires --mixed-ratio A:B:C\n");
-            return -1;
-        }
-
-        mixed_ratio_t mr;
-        if (parse_mixed_ratio(mixed_ratio_str, &mr) != 0) {
-            fprintf(stderr,
-                    "Error: invalid --mixed-ratio format\n");
-            return -1;
-        }
-
-        g_mixed_ratio = mr;
+    if (out_baseline->z_max <= 0 || out_baseline->min_samples < 2 || out_baseline->tol_pct < 0) {
+        fprintf(stderr, "--baseline-z must be > 0, --baseline-min >= 2 and --baseline-tol >= 0\n");
+        return -1;
     }
 
-    *out_nthreads = nthreads;
     return 0;
 }
 
+/***********************************************************
+ *                Frequency Table Parser
+ ***********************************************************/
+int parse_freq_table(
+    const char *s,
+    int *out_count,
+    int **out_cpu,
+    long **out_freq)
+{
+    if (!s) {
+        *out_count = 0;
+        *out_cpu = NULL;
+        *out_freq = NULL;
+        return 0;
+    }
 
-/*******************************************************
- * CoreBurner — CHUNK 4 / 5
- *  - Corrected worker_thread (uses g_mixed_ratio weights)
- *  - Main runtime loop: spawn workers, monitor, logging
- *  - Dynamic frequency tuner
- *  - Graceful shutdown & summary
- *******************************************************/
-
+    char *copy = strdup(s);
+    if (!copy) return -1;
 
+    int maxpairs = 256;
+    int *cpus  = malloc(sizeof(int) * maxpairs);
+    long *freq = malloc(sizeof(long) * maxpairs);
 
-void *worker_thread(void *arg) {
-    worker_arg_t *w = (worker_arg_t *)arg;
+    if (!cpus || !freq) {
+        free(cpus);
+        free(freq);
+        free(copy);
+        return -1;
+    }
 
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
-    CPU_SET(w->cpu_id, &cpuset);
+    int cnt = 0;
 
-    /* Try to pin thread */
-    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0) {
-        cpu_set_t cur;
-        CPU_ZERO(&cur);
-        if (sched_getaffinity(0, sizeof(cur), &cur) == 0) {
-            int fallback = -1;
-            for (int i = 0; i < CPU_SETSIZE; ++i)
-                if (CPU_ISSET(i, &cur)) { fallback = i; break; }
-            if (fallback >= 0) {
-                CPU_ZERO(&cpuset);
-                CPU_SET(fallback, &cpuset);
-                pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
-                w->cpu_id = fallback;
-            }
+    char *tok = strtok(copy, ",");
+    while (tok) {
+        char *sep = strchr(tok, ':');
+        if (!sep) {
+            tok = strtok(NULL, ",");
+            continue;
         }
-    }
 
-    /* Local workload state */
-    volatile uint64_t int_state = (uint64_t)(uintptr_t)w ^ 0xabcdef;
-    volatile double float_state = (double)(w->cpu_id + 1) * 1.234567;
-    
-    /* Aligned buffers for array-based SIMD operations (1M floats = 4MB) */
-    float *sse_buf = (float*)aligned_alloc(16, SIMD_ARRAY_SIZE * sizeof(float));
-    float *avx_buf = (float*)aligned_alloc(32, SIMD_ARRAY_SIZE * sizeof(float));
-    float *avx512_buf = (float*)aligned_alloc(64, SIMD_ARRAY_SIZE * sizeof(float));
-    
-    if (!sse_buf || !avx_buf || !avx512_buf) {
-        fprintf(stderr, "Failed to allocate SIMD buffers\n");
-        return NULL;
-    }
-    
-    /* Initialize arrays with unique values */
-    for (size_t i = 0; i < SIMD_ARRAY_SIZE; ++i) {
-        sse_buf[i] = (float)(i + w->cpu_id);
-        avx_buf[i] = (float)(i + w->cpu_id);
-        avx512_buf[i] = (float)(i + w->cpu_id);
+        *sep = '\0';
+
+        cpus[cnt]  = atoi(tok);
+        freq[cnt]  = atol(sep + 1);
+
+        cnt++;
+        tok = strtok(NULL, ",");
     }
 
-    /* RNG seed per-thread */
-    unsigned int rnd_seed = (unsigned int)(time(NULL) ^ (uintptr_t)w ^ (w->cpu_id * 7919));
+    free(copy);
 
-    const long period_ns = CONTROL_PERIOD_MS * 1000000L;
-    double util = w->target_util;
-    if (util < 0) util = 0;
-    if (util > 100) util = 100;
+    *out_cpu  = cpus;
+    *out_freq = freq;
+    *out_count = cnt;
 
-    long busy_ns = (long)round((util / 100.0) * period_ns);
-    long sleep_ns = period_ns - busy_ns;
+    return 0;
+}
 
-    struct timespec t0, t1;
+/***********************************************************
+ *              TLB / Page-Walk Stress Buffers
+ * One pointer-chase node per 4K of the footprint, visited in
+ * a single random cycle (Sattolo), so every load touches a
+ * new 4K page in an order the prefetchers cannot follow. The
+ * node layout is identical for every backing page size, so
+ * only the TLB reach changes between 4K, THP, 2M and 1G.
+ ***********************************************************/
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#define TLB_NODE_STRIDE 4096
+#define TLB_LOADS_PER_SLICE 2048
 
-    while (!stop_flag) {
-        clock_gettime(CLOCK_MONOTONIC, &t0);
+typedef enum { TLB_PAGE_4K, TLB_PAGE_THP, TLB_PAGE_2M, TLB_PAGE_1G, TLB_PAGE_KINDS } tlb_page_t;
 
-        if (busy_ns > 0) {
-            for (;;) {
-                /* execute workload */
-                if (w->type == W_INT) {
-                    int_work_unit(&int_state);
-                } else if (w->type == W_FLOAT) {
-                    float_work_unit(&float_state);
-                } else if (w->type == W_SSE) {
-                    sse_work_unit(sse_buf);
-                } else if (w->type == W_AVX) {
-                    avx_work_unit(avx_buf);
-                } else if (w->type == W_AVX2) {
-                    avx2_work_unit(avx_buf);
-                } else if (w->type == W_AVX512) {
-                    avx512_work_unit(avx512_buf);
-                } else { /* W_MIXED with weights */
-                    /* Use g_mixed_ratio to choose which unit to run */
-                    int pick = 0;
-                    if (g_mixed_ratio.total > 0) {
-                        pick = rand_r(&rnd_seed) % g_mixed_ratio.total;
-                        if (pick < g_mixed_ratio.r_int) {
-                            int_work_unit(&int_state);
-                        } else if (pick < (g_mixed_ratio.r_int + g_mixed_ratio.r_float)) {
-                            float_work_unit(&float_state);
-                        } else {
-                            /* Use best available SIMD */
-                            avx2_work_unit(avx_buf);
-                        }
-                    } else {
-                        /* fallback: 1:1:1 */
-                        int_work_unit(&int_state);
-                        float_work_unit(&float_state);
-                        avx2_work_unit(avx_buf);
-                    }
-                }
+static const char *tlb_page_names[TLB_PAGE_KINDS] = { "4k", "thp", "2m", "1g" };
 
-                /* Scale operations counter to reflect actual work done
-                 * Array-based SIMD: 1 work_unit = SIMD_ARRAY_SIZE * SIMD_INNER_ITERATIONS float ops
-                 * Report in thousands to keep numbers manageable (1M * 100 / 1000 = 100K per work unit) */
-                uint64_t ops_scale = (w->type >= W_SSE && w->type <= W_AVX512) 
-                    ? (SIMD_ARRAY_SIZE * SIMD_INNER_ITERATIONS / 1000)  /* ~100K for SIMD workloads */
-                    : 1;  /* Keep old scale for INT/FLOAT */
-                
-                __atomic_fetch_add(&w->ops_done, ops_scale, __ATOMIC_RELAXED);
+typedef struct {
+    void **start;
+    void *map;
+    size_t map_len;
+    size_t bytes;
+    tlb_page_t kind;
+} tlb_buf_t;
+
+/* Settings for --type TLB (first entries of --tlb-footprint/--tlb-pages) */
+static uint64_t g_tlb_footprint = 1ULL << 30;
+static tlb_page_t g_tlb_page = TLB_PAGE_4K;
+
+/* "512K", "64M", "16G", "1T" (binary units) */
+int parse_size_bytes(const char *s, uint64_t *out) {
+    char *end = NULL;
+    double v = strtod(s, &end);
+    if (end == s || v <= 0) return -1;
+    uint64_t mul = 1;
+    switch (toupper((unsigned char)*end)) {
+    case 'K': mul = 1ULL << 10; end++; break;
+    case 'M': mul = 1ULL << 20; end++; break;
+    case 'G': mul = 1ULL << 30; end++; break;
+    case 'T': mul = 1ULL << 40; end++; break;
+    default: break;
+    }
+    if (*end == 'B' || *end == 'b') end++;
+    if (*end != '\0') return -1;
+    *out = (uint64_t)(v * (double)mul);
+    return 0;
+}
 
-                clock_gettime(CLOCK_MONOTONIC, &t1);
-                long elapsed = (t1.tv_sec - t0.tv_sec) * 1000000000L + (t1.tv_nsec - t0.tv_nsec);
+int parse_tlb_page(const char *s, tlb_page_t *out) {
+    for (int k = 0; k < TLB_PAGE_KINDS; ++k)
+        if (str_case_equal(s, tlb_page_names[k])) { *out = (tlb_page_t)k; return 0; }
+    return -1;
+}
 
-                if (elapsed >= busy_ns || stop_flag)
-                    break;
-            }
+/* --type TLB: first --tlb-footprint / --tlb-pages entries */
+int tlb_apply_workload_spec(const tlb_spec_t *spec) {
+    char first[64];
+    if (spec->footprints) {
+        snprintf(first, sizeof(first), "%s", spec->footprints);
+        first[strcspn(first, ",")] = '\0';
+        if (parse_size_bytes(first, &g_tlb_footprint) != 0 || g_tlb_footprint < 2 * TLB_NODE_STRIDE) {
+            fprintf(stderr, "Error: bad --tlb-footprint '%s'\n", first);
+            return -1;
         }
+    }
+    if (spec->pages) {
+        snprintf(first, sizeof(first), "%s", spec->pages);
+        first[strcspn(first, ",")] = '\0';
+        if (parse_tlb_page(first, &g_tlb_page) != 0) {
+            fprintf(stderr, "Error: bad --tlb-pages '%s' (4k|thp|2m|1g)\n", first);
+            return -1;
+        }
+    }
+    return 0;
+}
 
-        if (sleep_ns > 0 && !stop_flag)
-            safe_nanosleep(0, sleep_ns);
+/* /proc/meminfo field in kB, -1 if missing */
+long read_meminfo_kb(const char *field) {
+    FILE *f = fopen("/proc/meminfo", "r");
+    if (!f) return -1;
+    char line[256];
+    size_t len = strlen(field);
+    long kb = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, field, len) == 0 && line[len] == ':') {
+            kb = strtol(line + len + 1, NULL, 10);
+            break;
+        }
     }
+    fclose(f);
+    return kb;
+}
 
-    /* Cleanup allocated SIMD buffers */
-    free(sse_buf);
-    free(avx_buf);
-    free(avx512_buf);
+/* Free hugetlb pool of one page size in kB, -1 if unknown. The per-size
+ * sysfs pool covers 1G pages too; meminfo only has the default size */
+long read_hugepages_free_kb(size_t page_bytes) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/kernel/mm/hugepages/hugepages-%zukB/free_hugepages", page_bytes >> 10);
+    FILE *f = fopen(path, "r");
+    if (f) {
+        long n = -1;
+        if (fscanf(f, "%ld", &n) != 1) n = -1;
+        fclose(f);
+        return n < 0 ? -1 : n * (long)(page_bytes >> 10);
+    }
+    long size_kb = read_meminfo_kb("Hugepagesize");
+    long free_n = read_meminfo_kb("HugePages_Free");
+    if (size_kb != (long)(page_bytes >> 10) || free_n < 0) return -1;
+    return free_n * size_kb;
+}
 
-    return NULL;
+/* --type TLB faults in the whole footprint on every worker: keep
+ * footprint x nthreads within 90% of MemAvailable, like tlb-sweep */
+void tlb_cap_workload_footprint(int nthreads) {
+    long avail_kb = read_meminfo_kb("MemAvailable");
+    if (avail_kb <= 0 || nthreads <= 0) return;
+    uint64_t cap = (uint64_t)avail_kb * 1024 / 10 * 9 / (uint64_t)nthreads;
+    cap -= cap % TLB_NODE_STRIDE;
+    if (g_tlb_footprint <= cap) return;
+    fprintf(stderr, "Warning: --type TLB footprint %.0f MB x %d threads exceeds 90%% of MemAvailable "
+            "(%ld MB); using %.0f MB per thread\n", g_tlb_footprint / 1048576.0, nthreads, avail_kb / 1024,
+            cap / 1048576.0);
+    g_tlb_footprint = cap < 2 * TLB_NODE_STRIDE ? 2 * TLB_NODE_STRIDE : cap;
 }
 
-/* ---------------- main runtime logic (spawn threads, monitoring, logging) ---------------- */
-int main_runtime(
-    const char *mode,
-    double util,
-    long duration,
-    workload_t type,
-    int nthreads,
-    double temp_threshold,
-    const char *log_path,
-    int log_interval,
-    int log_append,
-    int dynamic_freq,
-    long *current_max_freq,
-    char **temp_path_ptr,
-    worker_arg_t **out_wargs,
-    pthread_t **out_tids,
-    int single_core_id,
-    double *out_avg_util)
-{
-    /* allocate worker structures */
-    pthread_t *tids = calloc(nthreads, sizeof(pthread_t));
-    worker_arg_t *wargs = calloc(nthreads, sizeof(worker_arg_t));
-    if (!tids || !wargs) {
-        fprintf(stderr, "Allocation failed for threads\n");
-        return -1;
+/* Map `bytes` backed by `kind` pages; rounds up to the page size */
+static int tlb_map(tlb_buf_t *b, size_t bytes, tlb_page_t kind) {
+    const size_t huge = (kind == TLB_PAGE_1G) ? (1UL << 30) : (1UL << 21);
+    memset(b, 0, sizeof(*b));
+    b->kind = kind;
+
+    if (kind == TLB_PAGE_2M || kind == TLB_PAGE_1G) {
+        b->map_len = (bytes + huge - 1) & ~(huge - 1);
+        b->map = mmap(NULL, b->map_len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                      (kind == TLB_PAGE_1G ? MAP_HUGE_1GB : MAP_HUGE_2MB), -1, 0);
+        if (b->map == MAP_FAILED) { b->map = NULL; return -1; }
+        b->bytes = (bytes + TLB_NODE_STRIDE - 1) & ~(size_t)(TLB_NODE_STRIDE - 1);
+        return 0;
     }
 
-    for (int i = 0; i < nthreads; ++i) {
-        /* For single-core-multi mode, all threads go to the same core */
-        if (str_case_equal(mode, "single-core-multi")) {
-            wargs[i].cpu_id = single_core_id;
-        } else {
-            wargs[i].cpu_id = i % g_available_cpus;
-        }
-        wargs[i].target_util = util;
-        wargs[i].type = type;
-        __atomic_store_n(&wargs[i].ops_done, 0, __ATOMIC_RELAXED);
-    }
+    /* 4K and THP: over-map to align the usable range to 2M */
+    size_t len = (bytes + huge - 1) & ~(huge - 1);
+    char *raw = mmap(NULL, len + huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return -1;
+    char *aligned = (char *)(((uintptr_t)raw + huge - 1) & ~(uintptr_t)(huge - 1));
+    if (aligned > raw) munmap(raw, aligned - raw);
+    if (raw + len + huge > aligned + len) munmap(aligned + len, (raw + len + huge) - (aligned + len));
+    b->map = aligned;
+    b->map_len = len;
+    b->bytes = (bytes + TLB_NODE_STRIDE - 1) & ~(size_t)(TLB_NODE_STRIDE - 1);
+    madvise(b->map, b->map_len, kind == TLB_PAGE_THP ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+    return 0;
+}
 
-    /* signal handlers already set up by caller if needed */
+void tlb_buf_free(tlb_buf_t *b) {
+    if (b->map) munmap(b->map, b->map_len);
+    memset(b, 0, sizeof(*b));
+}
 
-    /* spawn worker threads */
-    for (int i = 0; i < nthreads; ++i) {
-        if (pthread_create(&tids[i], NULL, worker_thread, &wargs[i]) != 0) {
-            fprintf(stderr, "Failed to create thread %d: %s\n", i, strerror(errno));
-            stop_flag = 1;
-            break;
-        }
+/* Map and link the chase; returns 0 or -1 (errno from mmap) */
+int tlb_buf_build(tlb_buf_t *b, size_t bytes, tlb_page_t kind, unsigned int seed) {
+    if (tlb_map(b, bytes, kind) != 0) return -1;
+
+    size_t nodes = b->bytes / TLB_NODE_STRIDE;
+    uint32_t *order = malloc(nodes * sizeof(uint32_t));
+    if (!order || nodes < 2) {
+        free(order);
+        tlb_buf_free(b);
+        errno = ENOMEM;
+        return -1;
     }
 
-    /* start monitor thread */
-    pthread_t mon_tid = 0;
-    if (pthread_create(&mon_tid, NULL, monitor_thread, NULL) != 0) {
-        fprintf(stderr, "Warning: failed to start monitor thread\n");
-        mon_tid = 0;
+    /* Sattolo: a single cycle through all nodes */
+    uint64_t x = 0x9e3779b97f4a7c15ULL ^ seed;
+    for (size_t i = 0; i < nodes; ++i) order[i] = (uint32_t)i;
+    for (size_t i = nodes - 1; i > 0; --i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        size_t j = x % i;
+        uint32_t t = order[i]; order[i] = order[j]; order[j] = t;
     }
 
-    /* logging set up */
-    FILE *logf = NULL;
-    FILE *summaryf = NULL;
-    char *summary_path = NULL;
-    uint64_t *prev_ops = NULL;
-    int logging_enabled = 0;
+    /* Node i sits at a hashed cache-line offset in its 4K so that
+     * physically contiguous (huge) pages still spread over all sets */
+    char *base = b->map;
+#define TLB_NODE(i) ((void **)(base + (size_t)(i) * TLB_NODE_STRIDE + \
+                     ((((uint32_t)(i) * 0x9E3779B1u) >> 20) & (TLB_NODE_STRIDE - 64))))
+    for (size_t i = 0; i < nodes; ++i)
+        *TLB_NODE(i) = (void *)TLB_NODE(order[i]);
+    b->start = TLB_NODE(0);
+#undef TLB_NODE
+
+    free(order);
+    return 0;
+}
 
-    if (log_path) {
-        logf = fopen(log_path, log_append ? "a" : "w");
-        if (!logf) {
-            fprintf(stderr, "Failed to open log file '%s' for writing: %s\n", log_path, strerror(errno));
-            logging_enabled = 0;
-        } else {
-            logging_enabled = 1;
-            if (!log_append) {
-                time_t ts = time(NULL);
-                safe_fprintf_flush(logf, "# coreburner log\n");
-                safe_fprintf_flush(logf, "# mode=%s\n", mode);
-                safe_fprintf_flush(logf, "# workload=%s\n", 
-                    (type == W_INT) ? "INT" : 
-                    (type == W_FLOAT) ? "FLOAT" : 
-                    (type == W_SSE) ? "SSE" :
-                    (type == W_AVX) ? "AVX" : 
-                    (type == W_AVX2) ? "AVX2" :
-                    (type == W_AVX512) ? "AVX512" :
-                    (type == W_AUTO) ? "AUTO" : "MIXED");
-                safe_fprintf_flush(logf, "# util=%.1f\n", util);
-                safe_fprintf_flush(logf, "# threads=%d\n", nthreads);
-                safe_fprintf_flush(logf, "# interval=%ds\n", log_interval);
-                safe_fprintf_flush(logf, "# temp_threshold=%.1f\n", temp_threshold);
-                safe_fprintf_flush(logf, "# start_time=%ld\n", (long)ts);
-            }
+/* Follow n links from p; returns where it stopped */
+void **tlb_chase(void **p, long n) {
+    for (long i = 0; i < n; ++i) p = (void **)*p;
+    return p;
+}
 
-            /* CSV header */
-            safe_fprintf_flush(logf, "timestamp,elapsed_sec,cpu_temp");
-            int cores_to_log = (g_available_cpus > MAX_CORES_TO_LOG) ? MAX_CORES_TO_LOG : g_available_cpus;
-            for (int c = 0; c < cores_to_log; ++c) safe_fprintf_flush(logf, ",cpu%d_util,cpu%d_freq", c, c);
-            if (g_available_cpus > cores_to_log) safe_fprintf_flush(logf, ",cpu_others_util,cpu_others_freq");
-            for (int t = 0; t < nthreads; ++t) safe_fprintf_flush(logf, ",thread%d_ops_delta", t);
-            safe_fprintf_flush(logf, "\n");
+/* kB of anonymous memory in this process backed by THP */
+long tlb_thp_kb(void) {
+    FILE *f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f) return -1;
+    char line[256];
+    long kb = -1;
+    while (fgets(line, sizeof(line), f))
+        if (sscanf(line, "AnonHugePages: %ld", &kb) == 1) break;
+    fclose(f);
+    return kb;
+}
 
-            fflush(logf);
-            prev_ops = calloc(nthreads, sizeof(uint64_t));
-            if (prev_ops) for (int t = 0; t < nthreads; ++t) prev_ops[t] = 0;
+/***********************************************************
+ *               Lock Contention Kernels
+ * --type LOCK: every slice is one acquisition of a shared lock
+ * (--lock-kind), a critical section of --lock-cs RMW steps on
+ * shared cache lines, then --lock-ncs local INT iterations.
+ * Locks are always released inside a slice, so the duty-cycle
+ * sleep never holds one. Ops count acquisitions per thread.
+ ***********************************************************/
+typedef enum { LK_MUTEX, LK_SPIN, LK_TICKET, LK_MCS, LK_RWLOCK, LK_KINDS } lock_kind_t;
+
+static const char *lock_kind_names[LK_KINDS] = { "mutex", "spin", "ticket", "mcs", "rwlock" };
+
+typedef struct mcs_node {
+    struct mcs_node *next;
+    int locked;
+} __attribute__((aligned(64))) mcs_node_t;
+
+static struct {
+    lock_kind_t kind;
+    long cs_iters;
+    long ncs_iters;
+    int read_pct;               /* rwlock: share of acquisitions that are reads */
+    pthread_mutex_t mutex;
+    pthread_rwlock_t rw;
+    int spin __attribute__((aligned(64)));
+    uint32_t ticket_next __attribute__((aligned(64)));
+    uint32_t ticket_owner __attribute__((aligned(64)));
+    mcs_node_t *mcs_tail __attribute__((aligned(64)));
+    volatile uint64_t shared[16] __attribute__((aligned(64)));   /* two cache lines */
+} g_lock = {
+    .kind = LK_MUTEX,
+    .cs_iters = 100,
+    .ncs_iters = 100,
+    .read_pct = 80,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .rw = PTHREAD_RWLOCK_INITIALIZER,
+};
+
+int parse_lock_kind(const char *s, lock_kind_t *out) {
+    for (int k = 0; k < LK_KINDS; ++k)
+        if (str_case_equal(s, lock_kind_names[k])) { *out = (lock_kind_t)k; return 0; }
+    return -1;
+}
 
-            summary_path = malloc(strlen(log_path) + 20);
-            if (summary_path) { strcpy(summary_path, log_path); strcat(summary_path, ".summary.txt"); summaryf = fopen(summary_path, "w"); if (!summaryf) { free(summary_path); summary_path = NULL; } }
-        }
+/* Test-and-test-and-set */
+static void spin_acquire(int *l) {
+    for (;;) {
+        if (!__atomic_exchange_n(l, 1, __ATOMIC_ACQUIRE)) return;
+        while (__atomic_load_n(l, __ATOMIC_RELAXED)) _mm_pause();
     }
+}
 
-    time_t start = time(NULL);
-    time_t end_time = start + duration;
-    time_t now = start;
+static void spin_release(int *l) {
+    __atomic_store_n(l, 0, __ATOMIC_RELEASE);
+}
 
-    /* prepare /proc.stat buffers for monitoring */
-    uint64_t *total_prev = calloc(g_available_cpus, sizeof(uint64_t));
-    uint64_t *idle_prev  = calloc(g_available_cpus, sizeof(uint64_t));
-    uint64_t *total_curr = calloc(g_available_cpus, sizeof(uint64_t));
-    uint64_t *idle_curr  = calloc(g_available_cpus, sizeof(uint64_t));
-    if (!total_prev || !idle_prev || !total_curr || !idle_curr) {
-        fprintf(stderr, "Memory allocation failed\n");
-        stop_flag = 1;
-    } else {
-        if (read_proc_stat(total_prev, idle_prev, g_available_cpus) <= 0) {
-            fprintf(stderr, "Failed to read /proc/stat initial snapshot\n");
-            stop_flag = 1;
-        }
+static void ticket_acquire(void) {
+    uint32_t me = __atomic_fetch_add(&g_lock.ticket_next, 1, __ATOMIC_RELAXED);
+    while (__atomic_load_n(&g_lock.ticket_owner, __ATOMIC_ACQUIRE) != me) _mm_pause();
+}
+
+static void ticket_release(void) {
+    __atomic_store_n(&g_lock.ticket_owner, g_lock.ticket_owner + 1, __ATOMIC_RELEASE);
+}
+
+/* MCS: each waiter spins on its own node */
+static void mcs_acquire(mcs_node_t *n) {
+    n->next = NULL;
+    __atomic_store_n(&n->locked, 1, __ATOMIC_RELAXED);
+    mcs_node_t *prev = __atomic_exchange_n(&g_lock.mcs_tail, n, __ATOMIC_ACQ_REL);
+    if (!prev) return;
+    __atomic_store_n(&prev->next, n, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&n->locked, __ATOMIC_ACQUIRE)) _mm_pause();
+}
+
+static void mcs_release(mcs_node_t *n) {
+    mcs_node_t *next = __atomic_load_n(&n->next, __ATOMIC_ACQUIRE);
+    if (!next) {
+        mcs_node_t *expected = n;
+        if (__atomic_compare_exchange_n(&g_lock.mcs_tail, &expected, NULL, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            return;
+        while (!(next = __atomic_load_n(&n->next, __ATOMIC_ACQUIRE))) _mm_pause();
     }
+    __atomic_store_n(&next->locked, 0, __ATOMIC_RELEASE);
+}
 
-    int cores_to_log = (g_available_cpus > MAX_CORES_TO_LOG) ? MAX_CORES_TO_LOG : g_available_cpus;
+static void lock_cs_write(long iters) {
+    for (long i = 0; i < iters; ++i) g_lock.shared[i & 15] += (uint64_t)i | 1;
+}
 
-    /* Statistics tracking */
-    double temp_sum = 0.0;
-    long freq_sum = 0;
-    int temp_count = 0;
-    int freq_count = 0;
-    double util_sum = 0.0;
-    int util_count = 0;
+static void lock_cs_read(long iters) {
+    uint64_t acc = 0;
+    for (long i = 0; i < iters; ++i) acc += g_lock.shared[i & 15];
+    if (acc == 1) g_lock.shared[0] = 0;     /* keep the loads */
+}
 
-    /* dynamic freq tracking */
-    if (dynamic_freq && current_max_freq) {
-        for (int c = 0; c < g_available_cpus; ++c) {
-            long hz = 0;
-            if (read_scaling_cur_freq(c, &hz) == 0) current_max_freq[c] = hz;
-            else current_max_freq[c] = 0;
+/* One acquisition: lock, critical section, unlock, local work */
+void lock_work_slice(mcs_node_t *node, volatile uint64_t *local, unsigned int *seed) {
+    switch (g_lock.kind) {
+    case LK_SPIN:
+        spin_acquire(&g_lock.spin);
+        lock_cs_write(g_lock.cs_iters);
+        spin_release(&g_lock.spin);
+        break;
+    case LK_TICKET:
+        ticket_acquire();
+        lock_cs_write(g_lock.cs_iters);
+        ticket_release();
+        break;
+    case LK_MCS:
+        mcs_acquire(node);
+        lock_cs_write(g_lock.cs_iters);
+        mcs_release(node);
+        break;
+    case LK_RWLOCK:
+        if ((int)(rand_r(seed) % 100) < g_lock.read_pct) {
+            pthread_rwlock_rdlock(&g_lock.rw);
+            lock_cs_read(g_lock.cs_iters);
+        } else {
+            pthread_rwlock_wrlock(&g_lock.rw);
+            lock_cs_write(g_lock.cs_iters);
         }
+        pthread_rwlock_unlock(&g_lock.rw);
+        break;
+    default:
+        pthread_mutex_lock(&g_lock.mutex);
+        lock_cs_write(g_lock.cs_iters);
+        pthread_mutex_unlock(&g_lock.mutex);
+        break;
     }
+    if (g_lock.ncs_iters > 0) int_work_iters(local, g_lock.ncs_iters);
+}
 
-    /* Main monitoring & logging loop */
-    while (!stop_flag && now < end_time) {
-        for (int s = 0; s < log_interval && !stop_flag; ++s) sleep(1);
-        if (stop_flag) break;
+/* Jain's index over per-thread counts: 1 = perfectly fair, 1/n = one thread wins */
+double jain_fairness(const uint64_t *v, int n) {
+    double sum = 0.0, sq = 0.0;
+    for (int i = 0; i < n; ++i) { sum += (double)v[i]; sq += (double)v[i] * (double)v[i]; }
+    return sq > 0 ? sum * sum / (n * sq) : 0.0;
+}
 
-        int cpus_read = read_proc_stat(total_curr, idle_curr, g_available_cpus);
-        if (cpus_read <= 0) cpus_read = g_available_cpus;
+/***********************************************************
+ *                  Topology Spread
+ * --spread orders the CPUs workers are pinned to (multi mode):
+ *  linear  - affinity order (default)
+ *  cores   - one per physical core first, then SMT siblings
+ *  smt     - fill both siblings of a core before the next
+ *  sockets - alternate packages, cores before siblings
+ *  ccx     - alternate L3 domains (AMD CCX/CCD), cores first
+ *  cppc    - highest ACPI CPPC highest_perf first (preferred
+ *            cores), cores before siblings
+ ***********************************************************/
+static int *g_cpu_order = NULL;
+static int g_cpu_order_len = 0;
 
-        double *util_pct = calloc(cpus_read, sizeof(double));
-        long *freqs = calloc(cpus_read, sizeof(long));
-        if (!util_pct || !freqs) { free(util_pct); free(freqs); break; }
+typedef struct {
+    int cpu;
+    int pkg;
+    int core;
+    int sib_rank;               /* 0 for the first sibling of its core */
+    int pkg_rank;               /* index of the core within its package */
+    int l3;                     /* cache/index3/id: CCX on AMD, package on Intel */
+    int l3_rank;                /* index of the core within its L3 domain */
+    int perf;                   /* acpi_cppc/highest_perf, -1 if absent */
+} cpu_topo_t;
+
+static int read_topology_int(int cpu, const char *name) {
+    char path[160], buf[32];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+    if (read_sysfs_str(path, buf, sizeof(buf)) != 0) return -1;
+    return atoi(buf);
+}
 
-        for (int c = 0; c < cpus_read; ++c) {
-            uint64_t totald = total_curr[c] - total_prev[c];
-            uint64_t idled  = idle_curr[c] - idle_prev[c];
-            double usage = 0.0;
-            if (totald > 0) usage = 100.0 * (double)(totald - idled) / (double)totald;
-            util_pct[c] = usage;
-            total_prev[c] = total_curr[c];
-            idle_prev[c] = idle_curr[c];
+static int read_cpu_sysfs_int(int cpu, const char *rel) {
+    char path[160], buf[32];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/%s", cpu, rel);
+    if (read_sysfs_str(path, buf, sizeof(buf)) != 0) return -1;
+    return atoi(buf);
+}
 
-            if (read_scaling_cur_freq(c, &freqs[c]) != 0) freqs[c] = 0;
-        }
+static const char *g_spread_mode = NULL;
+
+static int cpu_topo_cmp(const void *a, const void *b) {
+    const cpu_topo_t *x = a, *y = b;
+    if (str_case_equal(g_spread_mode, "cores")) {
+        if (x->sib_rank != y->sib_rank) return x->sib_rank - y->sib_rank;
+        if (x->pkg != y->pkg) return x->pkg - y->pkg;
+        if (x->core != y->core) return x->core - y->core;
+    } else if (str_case_equal(g_spread_mode, "ccx")) {
+        if (x->sib_rank != y->sib_rank) return x->sib_rank - y->sib_rank;
+        if (x->l3_rank != y->l3_rank) return x->l3_rank - y->l3_rank;
+        if (x->pkg != y->pkg) return x->pkg - y->pkg;
+        if (x->l3 != y->l3) return x->l3 - y->l3;
+    } else if (str_case_equal(g_spread_mode, "cppc")) {
+        if (x->sib_rank != y->sib_rank) return x->sib_rank - y->sib_rank;
+        if (x->perf != y->perf) return y->perf - x->perf;
+    } else if (str_case_equal(g_spread_mode, "smt")) {
+        if (x->pkg != y->pkg) return x->pkg - y->pkg;
+        if (x->core != y->core) return x->core - y->core;
+        if (x->sib_rank != y->sib_rank) return x->sib_rank - y->sib_rank;
+    } else {    /* sockets */
+        if (x->sib_rank != y->sib_rank) return x->sib_rank - y->sib_rank;
+        if (x->pkg_rank != y->pkg_rank) return x->pkg_rank - y->pkg_rank;
+        if (x->pkg != y->pkg) return x->pkg - y->pkg;
+    }
+    return x->cpu - y->cpu;
+}
 
-        double tempC = NAN;
-        if (temp_path_ptr && *temp_path_ptr) tempC = read_temperature(*temp_path_ptr);
+/* Build g_cpu_order from the affinity mask; 0 on success */
+int topology_spread_init(const char *spread) {
+    if (!spread || str_case_equal(spread, "linear")) return 0;
+    if (!str_case_equal(spread, "cores") && !str_case_equal(spread, "smt") &&
+        !str_case_equal(spread, "sockets") && !str_case_equal(spread, "ccx") &&
+        !str_case_equal(spread, "cppc")) {
+        fprintf(stderr, "Error: --spread must be linear, cores, smt, sockets, ccx or cppc\n");
+        return -1;
+    }
 
-        /* Accumulate statistics */
-        if (!isnan(tempC)) {
-            temp_sum += tempC;
-            temp_count++;
-        }
-        for (int c = 0; c < cpus_read; ++c) {
-            if (freqs[c] > 0) {
-                freq_sum += freqs[c];
-                freq_count++;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return -1;
+
+    int n = CPU_COUNT(&set);
+    cpu_topo_t *t = calloc(n, sizeof(*t));
+    g_cpu_order = calloc(n, sizeof(int));
+    if (!t || !g_cpu_order) { free(t); return -1; }
+
+    int k = 0;
+    for (int c = 0; c < CPU_SETSIZE && k < n; ++c) {
+        if (!CPU_ISSET(c, &set)) continue;
+        t[k].cpu = c;
+        t[k].pkg = read_topology_int(c, "physical_package_id");
+        t[k].core = read_topology_int(c, "core_id");
+        t[k].l3 = read_cpu_sysfs_int(c, "cache/index3/id");
+        t[k].perf = read_cpu_sysfs_int(c, "acpi_cppc/highest_perf");
+        for (int j = 0; j < k; ++j)
+            if (t[j].pkg == t[k].pkg && t[j].core == t[k].core) t[k].sib_rank++;
+        if (t[k].sib_rank == 0)
+            for (int j = 0; j < k; ++j)
+                if (t[j].pkg == t[k].pkg && t[j].sib_rank == 0) t[k].pkg_rank++;
+        if (t[k].sib_rank == 0)
+            for (int j = 0; j < k; ++j)
+                if (t[j].pkg == t[k].pkg && t[j].l3 == t[k].l3 && t[j].sib_rank == 0) t[k].l3_rank++;
+        k++;
+    }
+    /* siblings inherit their core's rank within the package */
+    for (int i = 0; i < k; ++i)
+        for (int j = 0; j < k; ++j)
+            if (t[j].sib_rank == 0 && t[j].pkg == t[i].pkg && t[j].core == t[i].core) {
+                t[i].pkg_rank = t[j].pkg_rank;
+                t[i].l3_rank = t[j].l3_rank;
             }
-            util_sum += util_pct[c];
-            util_count++;
-        }
 
-        now = time(NULL);
-        int elapsed_sec = (int)(now - start);
+    if (str_case_equal(spread, "cppc") && k > 0 && t[0].perf < 0)
+        fprintf(stderr, "Warning: no acpi_cppc/highest_perf; --spread cppc falls back to cores order\n");
+    g_spread_mode = spread;
+    qsort(t, k, sizeof(*t), cpu_topo_cmp);
+    for (int i = 0; i < k; ++i) g_cpu_order[i] = t[i].cpu;
+    g_cpu_order_len = k;
+    free(t);
+    return 0;
+}
 
-        /* Console output */
-        printf("\n=== time: %lds elapsed (%lds remaining) ===\n", (long)(now - start), (long)(end_time - now));
-        for (int c = 0; c < cpus_read; ++c) {
-            if (c < cores_to_log) printf(" core %2d : %6.2f%%  freq=%ld kHz\n", c, util_pct[c], freqs[c]);
+/***********************************************************
+ *                 Copy / Fill Kernels
+ * memcpy strategies compared by --type COPY and --mode
+ * copy-sweep. Buffers are 64-byte aligned and transfers are
+ * whole 256-byte blocks, so the vector loops need no tails.
+ ***********************************************************/
+#define COPY_BLOCK 256
+#define COPY_CHUNK_MAX (256 * 1024)    /* --type COPY: bytes per slice at most */
+#define COPY_MIN_SIZE 1024
+
+typedef void (*copy_fn_t)(void *dst, const void *src, size_t n);
+
+typedef struct {
+    const char *name;
+    int fill;                   /* writes only, src unused */
+    int need;                   /* 0 = baseline, 1 = AVX2, 2 = AVX-512F */
+    copy_fn_t fn;
+} copy_method_t;
+
+static void copy_libc(void *dst, const void *src, size_t n) {
+    memcpy(dst, src, n);
+}
+
+static void copy_movsb(void *dst, const void *src, size_t n) {
+    __asm__ volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(n) : : "memory");
+}
+
+static void fill_stosb(void *dst, const void *src, size_t n) {
+    (void)src;
+    __asm__ volatile("rep stosb" : "+D"(dst), "+c"(n) : "a"(0x5a) : "memory");
+}
+
+static void copy_avx2(void *dst, const void *src, size_t n) {
+#ifdef __AVX2__
+    const char *s = src;
+    char *d = dst;
+    for (size_t i = 0; i < n; i += 128) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i *)(s + i + 64));
+        __m256i e = _mm256_loadu_si256((const __m256i *)(s + i + 96));
+        _mm256_storeu_si256((__m256i *)(d + i), a);
+        _mm256_storeu_si256((__m256i *)(d + i + 32), b);
+        _mm256_storeu_si256((__m256i *)(d + i + 64), c);
+        _mm256_storeu_si256((__m256i *)(d + i + 96), e);
+    }
+#else
+    memcpy(dst, src, n);
+#endif
+}
+
+static void copy_avx512(void *dst, const void *src, size_t n) {
+#ifdef __AVX512F__
+    const char *s = src;
+    char *d = dst;
+    for (size_t i = 0; i < n; i += 256) {
+        __m512i a = _mm512_loadu_si512(s + i);
+        __m512i b = _mm512_loadu_si512(s + i + 64);
+        __m512i c = _mm512_loadu_si512(s + i + 128);
+        __m512i e = _mm512_loadu_si512(s + i + 192);
+        _mm512_storeu_si512(d + i, a);
+        _mm512_storeu_si512(d + i + 64, b);
+        _mm512_storeu_si512(d + i + 128, c);
+        _mm512_storeu_si512(d + i + 192, e);
+    }
+#else
+    copy_avx2(dst, src, n);
+#endif
+}
+
+/* Streaming stores bypass the cache hierarchy (write-combining) */
+static void copy_nt(void *dst, const void *src, size_t n) {
+    const char *s = src;
+    char *d = dst;
+#if defined(__AVX512F__)
+    for (size_t i = 0; i < n; i += 128) {
+        __m512i a = _mm512_load_si512(s + i);
+        __m512i b = _mm512_load_si512(s + i + 64);
+        _mm512_stream_si512((void *)(d + i), a);
+        _mm512_stream_si512((void *)(d + i + 64), b);
+    }
+#elif defined(__AVX2__)
+    for (size_t i = 0; i < n; i += 64) {
+        __m256i a = _mm256_load_si256((const __m256i *)(s + i));
+        __m256i b = _mm256_load_si256((const __m256i *)(s + i + 32));
+        _mm256_stream_si256((__m256i *)(d + i), a);
+        _mm256_stream_si256((__m256i *)(d + i + 32), b);
+    }
+#else
+    for (size_t i = 0; i < n; i += 16)
+        _mm_stream_si128((__m128i *)(d + i), _mm_load_si128((const __m128i *)(s + i)));
+#endif
+    _mm_sfence();
+}
+
+static void fill_nt(void *dst, const void *src, size_t n) {
+    (void)src;
+    char *d = dst;
+    __m128i v = _mm_set1_epi8(0x5a);
+    for (size_t i = 0; i < n; i += 64) {
+        _mm_stream_si128((__m128i *)(d + i), v);
+        _mm_stream_si128((__m128i *)(d + i + 16), v);
+        _mm_stream_si128((__m128i *)(d + i + 32), v);
+        _mm_stream_si128((__m128i *)(d + i + 48), v);
+    }
+    _mm_sfence();
+}
+
+static const copy_method_t copy_methods[] = {
+    { "libc",   0, 0, copy_libc },
+    { "movsb",  0, 0, copy_movsb },
+    { "avx2",   0, 1, copy_avx2 },
+    { "avx512", 0, 2, copy_avx512 },
+    { "nt",     0, 0, copy_nt },
+    { "stosb",  1, 0, fill_stosb },
+    { "ntfill", 1, 0, fill_nt },
+};
+#define COPY_METHODS ((int)(sizeof(copy_methods) / sizeof(copy_methods[0])))
+
+/* Settings for --type COPY (first --copy-method / --copy-size entries) */
+static int g_copy_method = 1;          /* movsb */
+static size_t g_copy_size = 64UL << 20;
+
+int parse_copy_method(const char *s) {
+    for (int m = 0; m < COPY_METHODS; ++m)
+        if (str_case_equal(s, copy_methods[m].name)) return m;
+    return -1;
+}
+
+static int copy_method_supported(int m) {
+    if (copy_methods[m].need == 1) return cpu_supports_avx2();
+    if (copy_methods[m].need == 2) return cpu_supports_avx512();
+    return 1;
+}
+
+/* Round a transfer size to whole copy blocks */
+static size_t copy_round(uint64_t bytes) {
+    if (bytes < COPY_MIN_SIZE) bytes = COPY_MIN_SIZE;
+    return (size_t)(bytes & ~(uint64_t)(COPY_BLOCK - 1));
+}
+
+/* --type COPY: first --copy-method / --copy-size entries */
+int copy_apply_workload_spec(const copy_spec_t *spec) {
+    char first[64];
+    if (spec->methods) {
+        snprintf(first, sizeof(first), "%s", spec->methods);
+        first[strcspn(first, ",")] = '\0';
+        g_copy_method = parse_copy_method(first);
+        if (g_copy_method < 0) {
+            fprintf(stderr, "Error: unknown --copy-method '%s'\n", first);
+            return -1;
         }
-        if (cpus_read > cores_to_log) {
-            double agg_util = 0; long agg_freq = 0; int agg_cnt = 0;
-            for (int c = cores_to_log; c < cpus_read; ++c) { agg_util += util_pct[c]; if (freqs[c] > 0) { agg_freq += freqs[c]; agg_cnt++; } }
-            if (agg_cnt > 0) agg_freq /= agg_cnt;
-            printf(" cores %d..%d : avg_util=%.2f%% avg_freq=%ld kHz\n", cores_to_log, cpus_read - 1, agg_util / (cpus_read - cores_to_log), agg_freq);
+    }
+    if (spec->sizes) {
+        uint64_t b;
+        snprintf(first, sizeof(first), "%s", spec->sizes);
+        first[strcspn(first, ",")] = '\0';
+        if (parse_size_bytes(first, &b) != 0) {
+            fprintf(stderr, "Error: bad --copy-size '%s'\n", first);
+            return -1;
         }
-        if (!isnan(tempC)) printf(" CPU temp : %.2f °C\n", tempC); else printf(" CPU temp : (unavailable)\n");
-        for (int t = 0; t < nthreads; ++t) { uint64_t ops = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED); printf(" thread %2d pinned->cpu%2d : ops_total=%" PRIu64 " target=%.1f%%\n", t, wargs[t].cpu_id, ops, wargs[t].target_util); }
+        g_copy_size = copy_round(b);
+    }
+    return 0;
+}
 
-        /* Logging to CSV */
-        if (logf && logging_enabled) {
-            if (safe_fprintf_flush(logf, "%ld,%d,", (long)now, elapsed_sec) != 0) {
-                fprintf(stderr, "Warning: log write failed. Disabling logging.\n");
-                fclose(logf); logf = NULL; logging_enabled = 0;
-            } else {
-                if (!isnan(tempC)) fprintf(logf, "%.2f", tempC);
-                for (int c = 0; c < cores_to_log; ++c) fprintf(logf, ",%.2f,%ld", util_pct[c], freqs[c]);
-                if (cpus_read > cores_to_log) {
-                    double agg_util = 0; long agg_freq = 0; int agg_cnt = 0;
-                    for (int c = cores_to_log; c < cpus_read; ++c) { agg_util += util_pct[c]; if (freqs[c] > 0) { agg_freq += freqs[c]; agg_cnt++; } }
-                    double avg_util = (cpus_read - cores_to_log) ? agg_util / (cpus_read - cores_to_log) : 0.0;
-                    long avg_freq = agg_cnt ? agg_freq / agg_cnt : 0;
-                    fprintf(logf, ",%.2f,%ld", avg_util, avg_freq);
-                }
-                for (int t = 0; t < nthreads; ++t) {
-                    uint64_t ops = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED);
-                    uint64_t prev = prev_ops ? prev_ops[t] : 0ULL;
-                    uint64_t delta = (ops >= prev) ? (ops - prev) : (UINT64_MAX - prev + ops + 1);
-                    if (prev_ops) prev_ops[t] = ops;
-                    fprintf(logf, ",%" PRIu64, delta);
-                }
-                fprintf(logf, "\n"); fflush(logf);
-            }
-        }
+/***********************************************************
+ *               Front-End Code Generator
+ * FRONTEND: a generated image of FE_BLOCK_BYTES x86-64 blocks
+ * covering --fe-footprint bytes, entered by one indirect call
+ * per block. Each block is an ALU filler mix with
+ * FE_BRANCHES_PER_BLOCK data-dependent jz sites. --fe-random
+ * is the share of call targets and branch conditions drawn at
+ * random; the rest follow a fixed Sattolo order and per-block
+ * conditions, which the predictors can learn.
+ ***********************************************************/
+#define FE_BLOCK_BYTES 1024
+#define FE_BRANCHES_PER_BLOCK 4
+#define FE_CALLS_PER_SLICE 64
+#define FE_DEFAULT_FOOTPRINT (8UL << 20)
 
-        /* Dynamic freq tuner */
-        if (dynamic_freq && !isnan(tempC) && current_max_freq) {
-            if (tempC >= temp_threshold) {
-                for (int c = 0; c < g_available_cpus; ++c) {
-                    long cur = current_max_freq[c];
-                    if (cur <= 0) { long r=0; if (read_scaling_cur_freq(c, &r) == 0) cur = r; }
-                    long new_max = (long)(cur * (100 - DYN_FREQ_STEP_PCT) / 100.0);
-                    if (new_max < 100000) new_max = 100000;
-                    if (write_scaling_min_max(c, -1, new_max) == 0) {
-                        current_max_freq[c] = new_max;
-                        fprintf(stderr, "dynamic-freq: reduced cpu %d max_freq to %ld kHz due to temp %.2f\n", c, new_max, tempC);
-                    }
-                }
-            }
-        }
+typedef uint64_t (*fe_block_fn_t)(uint64_t x, uint64_t cond);
 
-        /* temp safety auto-stop */
-        if (!isnan(tempC) && tempC >= temp_threshold) {
-            fprintf(stderr, "ALERT: CPU temperature %.2f°C >= threshold %.2f°C. Stopping.\n", tempC, temp_threshold);
-            stop_flag = 1;
-            free(util_pct); free(freqs);
-            break;
-        }
+typedef struct {
+    unsigned char *code;        /* nblocks * FE_BLOCK_BYTES, PROT_READ|PROT_EXEC */
+    size_t map_bytes;
+    uint32_t nblocks;
+    uint32_t *next;             /* predictable successor of each block */
+    uint32_t rand_thresh;       /* --fe-random scaled to 0..65536 */
+} fe_image_t;
+
+static size_t g_fe_footprint = FE_DEFAULT_FOOTPRINT;
+static int g_fe_random_pct = 50;
+static fe_image_t g_fe_image;                   /* --type FRONTEND, built on first use */
+static int g_fe_ready;                          /* 0 = not yet, 1 = ok, -1 = failed */
+static pthread_mutex_t g_fe_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Scratch registers the blocks may clobber: rax rcx rdx r8-r11 */
+static const int fe_regs[] = { 0, 1, 2, 8, 9, 10, 11 };
+#define FE_NREGS ((int)(sizeof(fe_regs) / sizeof(fe_regs[0])))
+
+static inline uint64_t fe_rand(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
 
-        free(util_pct); free(freqs);
+/* op r/m64(dst), r64(src): 0x89 mov, 0x31 xor */
+static unsigned char *fe_emit_rr(unsigned char *p, unsigned char op, int dst, int src) {
+    *p++ = 0x48 | (src >= 8 ? 4 : 0) | (dst >= 8 ? 1 : 0);
+    *p++ = op;
+    *p++ = 0xC0 | ((src & 7) << 3) | (dst & 7);
+    return p;
+}
+
+/* One filler instruction: add imm32, xor, rol imm8 or imul */
+static unsigned char *fe_emit_filler(unsigned char *p, uint64_t *rng) {
+    uint64_t r = fe_rand(rng);
+    int dst = fe_regs[r % FE_NREGS];
+    int src = fe_regs[(r >> 8) % FE_NREGS];
+    unsigned int kind = (unsigned int)((r >> 16) % 10);
+    uint32_t imm = (uint32_t)(r >> 32);
+
+    if (kind < 4) {                         /* add dst, imm32 (7 bytes) */
+        *p++ = 0x48 | (dst >= 8 ? 1 : 0);
+        *p++ = 0x81;
+        *p++ = 0xC0 | (dst & 7);
+        memcpy(p, &imm, 4);
+        p += 4;
+    } else if (kind < 7) {                  /* xor dst, src (3 bytes) */
+        if (src == dst) src = fe_regs[((r >> 8) + 1) % FE_NREGS];
+        p = fe_emit_rr(p, 0x31, dst, src);
+    } else if (kind < 9) {                  /* rol dst, imm8 (4 bytes) */
+        *p++ = 0x48 | (dst >= 8 ? 1 : 0);
+        *p++ = 0xC1;
+        *p++ = 0xC0 | (dst & 7);
+        *p++ = (unsigned char)(1 + imm % 63);
+    } else {                                /* imul dst, src (4 bytes) */
+        *p++ = 0x48 | (dst >= 8 ? 4 : 0) | (src >= 8 ? 1 : 0);
+        *p++ = 0x0F;
+        *p++ = 0xAF;
+        *p++ = 0xC0 | ((dst & 7) << 3) | (src & 7);
     }
+    return p;
+}
 
-    /* Stop workers and monitor */
-    stop_flag = 1;
-    for (int i = 0; i < nthreads; ++i) pthread_join(tids[i], NULL);
-    if (mon_tid) pthread_join(mon_tid, NULL);
+/* uint64_t block(uint64_t x, uint64_t cond): filler seeded from x,
+ * each jz site skips ~24 bytes when its cond bit is clear */
+static void fe_emit_block(unsigned char *p, uint64_t *rng) {
+    unsigned char *end = p + FE_BLOCK_BYTES - 32;   /* room for the epilogue */
+    const ptrdiff_t gap = (FE_BLOCK_BYTES - 64) / FE_BRANCHES_PER_BLOCK;
+    unsigned char *start = p;
+    int br = 0;
+
+    for (int i = 0; i < FE_NREGS; ++i) p = fe_emit_rr(p, 0x89, fe_regs[i], 7);   /* mov reg, rdi */
+
+    while (p < end - 8) {
+        if (br < FE_BRANCHES_PER_BLOCK && p - start >= (br + 1) * gap - gap / 2 && p + 48 < end) {
+            uint32_t bit = 1u << br;
+            *p++ = 0xF7;                        /* test esi, imm32 */
+            *p++ = 0xC6;
+            memcpy(p, &bit, 4);
+            p += 4;
+            *p++ = 0x74;                        /* jz rel8 */
+            unsigned char *rel = p++;
+            unsigned char *skip = p;
+            while (p - skip < 24) p = fe_emit_filler(p, rng);
+            *rel = (unsigned char)(p - skip);
+            br++;
+            continue;
+        }
+        p = fe_emit_filler(p, rng);
+    }
 
-    /* Final summary with statistics */
-    if (total_curr && idle_curr) read_proc_stat(total_curr, idle_curr, g_available_cpus);
-    
-    /* Calculate final statistics */
-    uint64_t total_ops = 0;
-    for (int t = 0; t < nthreads; ++t) {
-        total_ops += __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED);
+    for (int i = 1; i < FE_NREGS; ++i) p = fe_emit_rr(p, 0x31, 0, fe_regs[i]);  /* xor rax, reg */
+    *p++ = 0xC3;                                                                /* ret */
+    memset(p, 0xCC, (size_t)(start + FE_BLOCK_BYTES - p));                      /* int3 padding */
+}
+
+void fe_image_free(fe_image_t *im) {
+    if (im->code) munmap(im->code, im->map_bytes);
+    free(im->next);
+    memset(im, 0, sizeof(*im));
+}
+
+int fe_image_build(fe_image_t *im, size_t footprint, int random_pct) {
+    memset(im, 0, sizeof(*im));
+    im->nblocks = (uint32_t)(footprint / FE_BLOCK_BYTES);
+    if (im->nblocks < 2) im->nblocks = 2;
+    im->rand_thresh = (uint32_t)(random_pct * 65536 / 100);
+    im->map_bytes = ((size_t)im->nblocks * FE_BLOCK_BYTES + 4095) & ~(size_t)4095;
+
+    im->code = mmap(NULL, im->map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    im->next = malloc((size_t)im->nblocks * sizeof(uint32_t));
+    if (im->code == MAP_FAILED || !im->next) {
+        if (im->code == MAP_FAILED) im->code = NULL;
+        fe_image_free(im);
+        return -1;
     }
-    long elapsed = (long)(time(NULL) - start);
-    double avg_temp = temp_count > 0 ? temp_sum / temp_count : 0.0;
-    long avg_freq = freq_count > 0 ? freq_sum / freq_count : 0;
-    double avg_util = util_count > 0 ? util_sum / util_count : 0.0;
-    double avg_ops_per_core = nthreads > 0 ? (double)total_ops / nthreads : 0.0;
-    double total_ops_millions = total_ops / 1000000.0;
+
+    uint64_t rng = 0x9E3779B97F4A7C15ULL ^ footprint;
+    for (uint32_t b = 0; b < im->nblocks; ++b)
+        fe_emit_block(im->code + (size_t)b * FE_BLOCK_BYTES, &rng);
+
+    /* Sattolo: one cycle through every block, no spatial locality */
+    for (uint32_t b = 0; b < im->nblocks; ++b) im->next[b] = b;
+    for (uint32_t b = im->nblocks - 1; b > 0; --b) {
+        uint32_t j = (uint32_t)(fe_rand(&rng) % b);
+        uint32_t t = im->next[b];
+        im->next[b] = im->next[j];
+        im->next[j] = t;
+    }
+
+    if (mprotect(im->code, im->map_bytes, PROT_READ | PROT_EXEC) != 0) {
+        fprintf(stderr, "Warning: cannot make generated code executable: %s\n", strerror(errno));
+        fe_image_free(im);
+        return -1;
+    }
+    __builtin___clear_cache((char *)im->code, (char *)im->code + im->map_bytes);
+    return 0;
+}
+
+/* calls indirect calls into im; random picks use the low and
+ * middle 16 bits of each draw, the target the high bits */
+uint64_t fe_run(const fe_image_t *im, uint64_t *rng, uint32_t *cursor, uint64_t acc, long calls) {
+    uint32_t cur = *cursor;
+    for (long c = 0; c < calls; ++c) {
+        uint64_t r = fe_rand(rng);
+        uint32_t idx = (r & 0xFFFF) < im->rand_thresh ? (uint32_t)((r >> 32) % im->nblocks) : im->next[cur];
+        uint64_t cond = ((r >> 16) & 0xFFFF) < im->rand_thresh ? (r >> 40) : (uint64_t)idx * 0x9E3779B1u;
+        fe_block_fn_t fn;
+        void *addr = im->code + (size_t)idx * FE_BLOCK_BYTES;
+        memcpy(&fn, &addr, sizeof(fn));
+        acc ^= fn(acc, cond);
+        cur = idx;
+    }
+    *cursor = cur;
+    return acc;
+}
+
+/* Shared image for --type FRONTEND; every thread gets the same code */
+static const fe_image_t *fe_workload_image(void) {
+    int ready = __atomic_load_n(&g_fe_ready, __ATOMIC_ACQUIRE);
+    if (ready == 0) {
+        pthread_mutex_lock(&g_fe_lock);
+        ready = g_fe_ready;
+        if (ready == 0) {
+            ready = fe_image_build(&g_fe_image, g_fe_footprint, g_fe_random_pct) == 0 ? 1 : -1;
+            if (ready < 0) fprintf(stderr, "Warning: FRONTEND code image unavailable, using INT\n");
+            __atomic_store_n(&g_fe_ready, ready, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&g_fe_lock);
+    }
+    return ready == 1 ? &g_fe_image : NULL;
+}
+
+int fe_apply_workload_spec(const fe_spec_t *spec) {
+    char first[64];
+    if (spec->footprints) {
+        uint64_t b;
+        snprintf(first, sizeof(first), "%s", spec->footprints);
+        first[strcspn(first, ",")] = '\0';
+        if (parse_size_bytes(first, &b) != 0 || b < 2 * FE_BLOCK_BYTES) {
+            fprintf(stderr, "Error: bad --fe-footprint '%s'\n", first);
+            return -1;
+        }
+        g_fe_footprint = (size_t)b;
+    }
+    if (spec->random) {
+        g_fe_random_pct = atoi(spec->random);
+        if (g_fe_random_pct < 0 || g_fe_random_pct > 100) {
+            fprintf(stderr, "Error: --fe-random entries must be 0-100\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/***********************************************************
+ *               Memory-Capacity Pressure
+ * --mem-pressure SIZE|N%: a background thread holds an
+ * anonymous region of SIZE (or N% of MemAvailable at start)
+ * next to any --type. Pages are re-written at --mem-touch-rate
+ * so they stay resident, and --mem-cycle S drops and refaults
+ * a quarter of the region every S seconds to keep reclaim busy.
+ * The sampler logs RSS, kswapd CPU and scan / major-fault rates.
+ ***********************************************************/
+#define MEMP_TICK_NS 10000000L          /* touch pacing granularity */
+#define MEMP_PAGE 4096UL
+#define MEMP_MAX_KSWAPD 64
+
+typedef struct {
+    size_t bytes;                   /* resolved target */
+    double touch_mbps;
+    int cycle_sec;
+    char *region;
+    pthread_t tid;
+    int running;
+    volatile int stop;
+    _Atomic uint64_t touched;       /* bytes re-touched after population */
+    _Atomic uint64_t cycles;
+    int kswapd_pid[MEMP_MAX_KSWAPD];
+    int kswapd_n;
+} mem_pressure_t;
+
+static mem_pressure_t g_memp;
+
+/* Point-in-time counters behind the sampler's memory columns */
+typedef struct {
+    uint64_t kswapd_ticks;          /* utime+stime of all kswapd threads */
+    uint64_t pgscan_kswapd;
+    uint64_t pgscan_direct;
+    uint64_t pgmajfault;
+    long rss_kb;                    /* this process */
+} memp_stats_t;
+
+static void memp_find_kswapd(mem_pressure_t *m) {
+    DIR *d = opendir("/proc");
+    struct dirent *e;
+    m->kswapd_n = 0;
+    if (!d) return;
+    while ((e = readdir(d)) && m->kswapd_n < MEMP_MAX_KSWAPD) {
+        int pid = atoi(e->d_name);
+        if (pid <= 0) continue;
+        char path[64], comm[32] = "";
+        snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+        if (read_sysfs_str(path, comm, sizeof(comm)) == 0 && strncmp(comm, "kswapd", 6) == 0)
+            m->kswapd_pid[m->kswapd_n++] = pid;
+    }
+    closedir(d);
+}
+
+/* Sum of /proc/<pid>/stat utime+stime (fields 14, 15) */
+static uint64_t memp_proc_ticks(int pid) {
+    char path[64], buf[512];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+    char *p = strrchr(buf, ')');    /* comm may contain spaces */
+    unsigned long long ut = 0, st = 0;
+    if (!p || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &ut, &st) != 2)
+        return 0;
+    return ut + st;
+}
+
+void memp_read_stats(memp_stats_t *s) {
+    memset(s, 0, sizeof(*s));
+    for (int i = 0; i < g_memp.kswapd_n; ++i) s->kswapd_ticks += memp_proc_ticks(g_memp.kswapd_pid[i]);
+
+    FILE *f = fopen("/proc/vmstat", "r");
+    if (f) {
+        char key[64];
+        unsigned long long v;
+        while (fscanf(f, "%63s %llu", key, &v) == 2) {
+            if (strcmp(key, "pgscan_kswapd") == 0) s->pgscan_kswapd = v;
+            else if (strcmp(key, "pgscan_direct") == 0) s->pgscan_direct = v;
+            else if (strcmp(key, "pgmajfault") == 0) s->pgmajfault = v;
+        }
+        fclose(f);
+    }
+
+    long pages = 0, resident = 0;
+    f = fopen("/proc/self/statm", "r");
+    if (f) {
+        if (fscanf(f, "%ld %ld", &pages, &resident) == 2) s->rss_kb = resident * (sysconf(_SC_PAGESIZE) / 1024);
+        fclose(f);
+    }
+}
+
+/* Write one word per page over [off, off+len); returns bytes covered */
+static size_t memp_touch(mem_pressure_t *m, size_t off, size_t len) {
+    if (off + len > m->bytes) len = m->bytes - off;
+    for (size_t p = off; p < off + len; p += MEMP_PAGE)
+        *(volatile uint64_t *)(m->region + p) = p;
+    return len;
+}
+
+static void *memp_thread(void *arg) {
+    mem_pressure_t *m = (mem_pressure_t *)arg;
+    const size_t per_tick = (size_t)(m->touch_mbps * 1048576.0 * MEMP_TICK_NS / 1e9);
+    const size_t quarter = (m->bytes / 4) & ~(MEMP_PAGE - 1);
+    size_t cursor = 0, cycle_off = 0;
+    struct timespec last_cycle;
+    clock_gettime(CLOCK_MONOTONIC, &last_cycle);
+
+    while (!m->stop) {
+        safe_nanosleep(0, MEMP_TICK_NS);
+        if (per_tick) {
+            size_t done = memp_touch(m, cursor, per_tick);
+            cursor = (cursor + done) % m->bytes;
+            __atomic_fetch_add(&m->touched, done, __ATOMIC_RELAXED);
+        }
+        if (m->cycle_sec > 0 && quarter) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (now.tv_sec - last_cycle.tv_sec >= m->cycle_sec) {
+                /* give a quarter back and fault it straight in again */
+                madvise(m->region + cycle_off, quarter, MADV_DONTNEED);
+                memp_touch(m, cycle_off, quarter);
+                cycle_off = (cycle_off + quarter) % (quarter * 4);
+                __atomic_fetch_add(&m->cycles, 1, __ATOMIC_RELAXED);
+                last_cycle = now;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Resolve SIZE or N% of MemAvailable; 0 bytes = invalid */
+static size_t memp_resolve(const char *spec) {
+    size_t len = strlen(spec);
+    if (len > 1 && spec[len - 1] == '%') {
+        double pct = atof(spec);
+        long avail_kb = read_meminfo_kb("MemAvailable");
+        if (pct <= 0 || pct > 100 || avail_kb <= 0) return 0;
+        return (size_t)(avail_kb * 1024.0 * pct / 100.0);
+    }
+    uint64_t b;
+    return parse_size_bytes(spec, &b) == 0 ? (size_t)b : 0;
+}
+
+/* Map and populate the region, then start the toucher thread */
+int memp_start(const memp_spec_t *spec) {
+    mem_pressure_t *m = &g_memp;
+    memset(m, 0, sizeof(*m));
+    m->bytes = memp_resolve(spec->size) & ~(MEMP_PAGE - 1);
+    m->touch_mbps = spec->touch_mbps;
+    m->cycle_sec = spec->cycle_sec;
+    if (m->bytes == 0) {
+        fprintf(stderr, "Error: bad --mem-pressure '%s' (SIZE or 1-100%%)\n", spec->size);
+        return -1;
+    }
+
+    long avail_kb = read_meminfo_kb("MemAvailable");
+    if (avail_kb > 0 && m->bytes > (size_t)avail_kb * 1024)
+        fprintf(stderr, "Warning: --mem-pressure %zu MB exceeds MemAvailable %ld MB; expect swap or OOM\n",
+                m->bytes >> 20, avail_kb / 1024);
+
+    m->region = mmap(NULL, m->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (m->region == MAP_FAILED) {
+        fprintf(stderr, "Error: cannot map %zu MB for --mem-pressure: %s\n", m->bytes >> 20, strerror(errno));
+        m->region = NULL;
+        return -1;
+    }
+
+    printf("Memory pressure: populating %zu MB ...\n", m->bytes >> 20);
+    for (size_t off = 0; off < m->bytes && !user_stop_flag; off += 64UL << 20)
+        memp_touch(m, off, 64UL << 20);
+    if (user_stop_flag) {
+        munmap(m->region, m->bytes);
+        m->region = NULL;
+        return -1;
+    }
+
+    memp_find_kswapd(m);
+    if (m->kswapd_n == 0) fprintf(stderr, "Warning: no kswapd threads found; kswapd_pct not logged\n");
+    if (pthread_create(&m->tid, NULL, memp_thread, m) != 0) {
+        munmap(m->region, m->bytes);
+        m->region = NULL;
+        return -1;
+    }
+    m->running = 1;
+    printf("Memory pressure: holding %zu MB, touch %.0f MB/s, cycle %s\n", m->bytes >> 20, m->touch_mbps,
+           m->cycle_sec > 0 ? "on" : "off");
+    return 0;
+}
+
+void memp_stop(void) {
+    mem_pressure_t *m = &g_memp;
+    if (!m->running) return;
+    m->stop = 1;
+    pthread_join(m->tid, NULL);
+    munmap(m->region, m->bytes);
+    m->region = NULL;
+    m->running = 0;
+}
+
+/***********************************************************
+ *             Mixed Ratio Parser (A:B:C)
+ ***********************************************************/
+typedef struct {
+    int r_int;
+    int r_float;
+    int r_avx;
+    int total;
+} mixed_ratio_t;
+
+static mixed_ratio_t g_mixed_ratio = {0,0,0,0};
+
+int parse_mixed_ratio(const char *s, mixed_ratio_t *mr) {
+    if (!s) return -1;
+
+    int a=0, b=0, c=0;
+
+    if (sscanf(s, "%d:%d:%d", &a, &b, &c) != 3)
+        return -1;
+
+    if (a < 0 || b < 0 || c < 0)
+        return -1;
+
+    int total = a + b + c;
+
+    if (total <= 0)
+        return -1;
+
+    mr->r_int   = a;
+    mr->r_float = b;
+    mr->r_avx   = c;
+    mr->total   = total;
+
+    return 0;
+}
+
+/***********************************************************
+ *                   Kernel Dispatch
+ * Per-thread kernel state plus whole-unit and slice runners
+ * shared by workers, trace replay and the SMT matrix.
+ ***********************************************************/
+#define WORK_SLICES_PER_UNIT 1024   /* slice = unit fraction run between clock checks */
+#define MXCSR_FTZ 0x8000            /* flush denormal results to zero */
+#define MXCSR_DAZ 0x0040            /* treat denormal inputs as zero */
+
+enum { MXCSR_MODE_OFF, MXCSR_MODE_FTZ, MXCSR_MODE_DAZ, MXCSR_MODE_FTZ_DAZ, MXCSR_MODES };
+
+static const struct { const char *name; unsigned int bits; } mxcsr_modes[MXCSR_MODES] = {
+    { "off", 0 }, { "ftz", MXCSR_FTZ }, { "daz", MXCSR_DAZ }, { "ftz+daz", MXCSR_FTZ | MXCSR_DAZ },
+};
+
+/* --mxcsr for every kernel thread; -1 leaves MXCSR as inherited */
+static int g_mxcsr_mode = -1;
+
+int parse_mxcsr_mode(const char *s) {
+    for (int m = 0; m < MXCSR_MODES; ++m)
+        if (str_case_equal(s, mxcsr_modes[m].name)) return m;
+    return -1;
+}
+
+typedef struct {
+    volatile uint64_t int_state;
+    volatile double float_state;
+    float *sse_buf;
+    float *avx_buf;
+    float *avx512_buf;
+    uint64_t *membw_buf;    /* allocated on first MEMBW use */
+    int kpath_ready;        /* kernel-path resources: 0 = not yet, 1 = ok, -1 = failed */
+    int kpath_pipe[2];
+    int kpath_efd;
+    char *kpath_region;     /* MADVISE region, KPATH_PAGES pages */
+    uint64_t kpath_ns;      /* --kernel-fraction balance: time in kernel-path ops */
+    uint64_t kpath_user_ns; /* ... and in the INT filler */
+    tlb_buf_t tlb;          /* TLB chase, built on first use */
+    void **tlb_cursor;
+    int tlb_ready;          /* 0 = not yet, 1 = ok, -1 = failed */
+    mcs_node_t mcs_node;    /* this thread's MCS queue node */
+    char *copy_src;         /* COPY buffers, g_copy_size each, allocated on first use */
+    char *copy_dst;
+    size_t copy_off;
+    uint64_t fe_rng;        /* FRONTEND target/condition draws */
+    uint32_t fe_cursor;     /* FRONTEND current block */
+    uint32_t gather_idx[8]; /* GATHER LCG lanes, continued across slices */
+    unsigned int seed;
+    size_t off;             /* slice cursor */
+    int slices;             /* slices since the last whole unit */
+} work_state_t;
+
+int work_state_init(work_state_t *ws, int cpu_id) {
+    memset(ws, 0, sizeof(*ws));
+    ws->int_state = (uint64_t)(uintptr_t)ws ^ 0xabcdef;
+    ws->float_state = (double)(cpu_id + 1) * 1.234567;
+
+    /* Aligned buffers for array-based SIMD operations (1M floats = 4MB) */
+    ws->sse_buf = (float*)aligned_alloc(16, SIMD_ARRAY_SIZE * sizeof(float));
+    ws->avx_buf = (float*)aligned_alloc(32, SIMD_ARRAY_SIZE * sizeof(float));
+    ws->avx512_buf = (float*)aligned_alloc(64, SIMD_ARRAY_SIZE * sizeof(float));
+    if (!ws->sse_buf || !ws->avx_buf || !ws->avx512_buf) {
+        fprintf(stderr, "Failed to allocate SIMD buffers\n");
+        return -1;
+    }
+
+    /* Initialize arrays with unique values */
+    for (size_t i = 0; i < SIMD_ARRAY_SIZE; ++i) {
+        ws->sse_buf[i] = (float)(i + cpu_id);
+        ws->avx_buf[i] = (float)(i + cpu_id);
+        ws->avx512_buf[i] = (float)(i + cpu_id);
+    }
+
+    /* RNG seed per-thread */
+    ws->seed = (unsigned int)(time(NULL) ^ (uintptr_t)ws ^ (cpu_id * 7919));
+    ws->fe_rng = ((uint64_t)ws->seed << 32) | 0x9E3779B9u;
+    for (int l = 0; l < 8; ++l) ws->gather_idx[l] = l;
+
+    /* MXCSR is per thread; every kernel thread passes through here */
+    if (g_mxcsr_mode >= 0)
+        _mm_setcsr((_mm_getcsr() & ~(MXCSR_FTZ | MXCSR_DAZ)) | mxcsr_modes[g_mxcsr_mode].bits);
+    return 0;
+}
+
+void work_state_free(work_state_t *ws) {
+    free(ws->sse_buf);
+    free(ws->avx_buf);
+    free(ws->avx512_buf);
+    free(ws->membw_buf);
+    if (ws->kpath_ready == 1) {
+        close(ws->kpath_pipe[0]);
+        close(ws->kpath_pipe[1]);
+        close(ws->kpath_efd);
+        munmap(ws->kpath_region, KPATH_PAGES * KPATH_PAGE_SIZE);
+    }
+    if (ws->tlb_ready == 1) tlb_buf_free(&ws->tlb);
+    free(ws->copy_src);
+    free(ws->copy_dst);
+}
+
+static int work_state_copy(work_state_t *ws) {
+    if (!ws->copy_src && !ws->copy_dst) {
+        ws->copy_src = aligned_alloc(64, g_copy_size);
+        ws->copy_dst = aligned_alloc(64, g_copy_size);
+        if (ws->copy_src && ws->copy_dst) {
+            memset(ws->copy_src, 0x33, g_copy_size);
+            memset(ws->copy_dst, 0, g_copy_size);
+        } else {
+            fprintf(stderr, "Warning: cannot allocate COPY buffers, using INT\n");
+        }
+    }
+    return ws->copy_src && ws->copy_dst;
+}
+
+/* One COPY slice: up to COPY_CHUNK_MAX bytes at the rolling offset */
+static void copy_work_slice(work_state_t *ws) {
+    size_t chunk = g_copy_size < COPY_CHUNK_MAX ? g_copy_size : COPY_CHUNK_MAX;
+    if (ws->copy_off + chunk > g_copy_size) ws->copy_off = 0;
+    copy_methods[g_copy_method].fn(ws->copy_dst + ws->copy_off, ws->copy_src + ws->copy_off, chunk);
+    ws->copy_off += chunk;
+}
+
+static void **work_state_tlb(work_state_t *ws) {
+    if (!ws->tlb_ready) {
+        ws->tlb_ready = -1;
+        if (tlb_buf_build(&ws->tlb, g_tlb_footprint, g_tlb_page, ws->seed) == 0) {
+            ws->tlb_cursor = ws->tlb.start;
+            ws->tlb_ready = 1;
+        } else {
+            fprintf(stderr, "Warning: cannot map %.0f MB of %s pages for TLB (%s), using INT\n",
+                    g_tlb_footprint / 1048576.0, tlb_page_names[g_tlb_page], strerror(errno));
+        }
+    }
+    return ws->tlb_ready == 1 ? ws->tlb_cursor : NULL;
+}
+
+static uint64_t *work_state_membw(work_state_t *ws) {
+    if (!ws->membw_buf) {
+        ws->membw_buf = aligned_alloc(64, MEMBW_BUFFER_WORDS * sizeof(uint64_t));
+        if (ws->membw_buf)
+            for (size_t i = 0; i < MEMBW_BUFFER_WORDS; ++i) ws->membw_buf[i] = i;
+    }
+    return ws->membw_buf;
+}
+
+/***********************************************************
+ * Kernel-path workloads. Each slice is a batch of kernel entries:
+ *  SYSCALL - getppid() via raw syscall (minimal entry/exit)
+ *  PIPE    - 1-byte pipe and eventfd write/read round trips
+ *  PGFAULT - mmap, first-touch fault every page, munmap
+ *  MADVISE - touch a resident region, MADV_DONTNEED, refault
+ * With --kernel-fraction < 1 slices alternate with INT filler so
+ * that the measured time split tracks the requested fraction.
+ ***********************************************************/
+static double g_kernel_fraction = 1.0;
+
+static int workload_is_kernel_path(workload_t t) {
+    return t == W_SYSCALL || t == W_PIPE || t == W_PGFAULT || t == W_MADVISE;
+}
+
+static int work_state_kpath(work_state_t *ws) {
+    if (ws->kpath_ready) return ws->kpath_ready;
+
+    ws->kpath_ready = -1;
+    if (pipe(ws->kpath_pipe) != 0) {
+        fprintf(stderr, "Warning: pipe() failed (%s), kernel-path work falls back to INT\n", strerror(errno));
+        return -1;
+    }
+    ws->kpath_efd = eventfd(0, 0);
+    ws->kpath_region = mmap(NULL, KPATH_PAGES * KPATH_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ws->kpath_efd < 0 || ws->kpath_region == MAP_FAILED) {
+        fprintf(stderr, "Warning: eventfd/mmap failed (%s), kernel-path work falls back to INT\n", strerror(errno));
+        close(ws->kpath_pipe[0]);
+        close(ws->kpath_pipe[1]);
+        if (ws->kpath_efd >= 0) close(ws->kpath_efd);
+        return -1;
+    }
+    ws->kpath_ready = 1;
+    return 1;
+}
+
+static void kpath_touch(char *region, int pages) {
+    for (int p = 0; p < pages; ++p) ((volatile char *)region)[(size_t)p * KPATH_PAGE_SIZE] = (char)p;
+}
+
+static void kpath_run(workload_t t, work_state_t *ws) {
+    switch (t) {
+    case W_SYSCALL:
+        for (int i = 0; i < KPATH_SYSCALLS_PER_SLICE; ++i) syscall(SYS_getppid);
+        break;
+    case W_PIPE:
+        for (int i = 0; i < KPATH_TRIPS_PER_SLICE; ++i) {
+            char b = (char)i;
+            uint64_t v = 1;
+            if (write(ws->kpath_pipe[1], &b, 1) == 1) { if (read(ws->kpath_pipe[0], &b, 1) < 0) break; }
+            if (write(ws->kpath_efd, &v, sizeof(v)) == sizeof(v)) { if (read(ws->kpath_efd, &v, sizeof(v)) < 0) break; }
+        }
+        break;
+    case W_PGFAULT: {
+        char *m = mmap(NULL, KPATH_PAGES * KPATH_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m == MAP_FAILED) break;
+        kpath_touch(m, KPATH_PAGES);
+        munmap(m, KPATH_PAGES * KPATH_PAGE_SIZE);
+        break;
+    }
+    default:    /* W_MADVISE */
+        kpath_touch(ws->kpath_region, KPATH_PAGES);
+        madvise(ws->kpath_region, KPATH_PAGES * KPATH_PAGE_SIZE, MADV_DONTNEED);
+        break;
+    }
+}
+
+/* One kernel-path slice, or INT filler when ahead of --kernel-fraction */
+static void kpath_work_slice(workload_t t, work_state_t *ws, long iters) {
+    if (work_state_kpath(ws) != 1) {
+        int_work_iters(&ws->int_state, iters);
+        return;
+    }
+    if (g_kernel_fraction >= 1.0) {
+        kpath_run(t, ws);
+        return;
+    }
+
+    struct timespec a, b;
+    int kernel = ws->kpath_ns <= g_kernel_fraction * (double)(ws->kpath_ns + ws->kpath_user_ns);
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    if (kernel) kpath_run(t, ws);
+    else int_work_iters(&ws->int_state, iters);
+    clock_gettime(CLOCK_MONOTONIC, &b);
+
+    uint64_t dt = (uint64_t)((b.tv_sec - a.tv_sec) * 1000000000LL + (b.tv_nsec - a.tv_nsec));
+    if (kernel) ws->kpath_ns += dt;
+    else ws->kpath_user_ns += dt;
+}
+
+/* Ops credited per completed unit. Array-based SIMD: 1 work_unit =
+ * SIMD_ARRAY_SIZE * SIMD_INNER_ITERATIONS float ops, reported in thousands
+ * (~100K per unit); TLB counts thousands of chase loads, LOCK counts
+ * acquisitions, COPY counts MB written, FRONTEND thousands of block
+ * calls; everything else counts units. */
+uint64_t work_unit_ops(workload_t t) {
+    if (t == W_TLB) return (uint64_t)TLB_LOADS_PER_SLICE * WORK_SLICES_PER_UNIT / 1000;
+    if (t == W_LOCK) return WORK_SLICES_PER_UNIT;   /* acquisitions */
+    if (t == W_FRONTEND) return (uint64_t)FE_CALLS_PER_SLICE * WORK_SLICES_PER_UNIT / 1000;
+    if (t == W_COPY) {                              /* MB written */
+        size_t chunk = g_copy_size < COPY_CHUNK_MAX ? g_copy_size : COPY_CHUNK_MAX;
+        uint64_t mb = ((uint64_t)chunk * WORK_SLICES_PER_UNIT) >> 20;
+        return mb ? mb : 1;
+    }
+    return ((t >= W_SSE && t <= W_AVX512) || t == W_DSSE || t == W_DAVX)
+        ? (SIMD_ARRAY_SIZE * SIMD_INNER_ITERATIONS / 1000)
+        : 1;
+}
+
+/* MIXED: choose INT/FLOAT/AVX2 by g_mixed_ratio weights */
+static workload_t mixed_pick(work_state_t *ws) {
+    int pick = rand_r(&ws->seed) % g_mixed_ratio.total;
+    if (pick < g_mixed_ratio.r_int) return W_INT;
+    if (pick < g_mixed_ratio.r_int + g_mixed_ratio.r_float) return W_FLOAT;
+    return W_AVX2;  /* best available SIMD */
+}
+
+void run_work_unit(workload_t t, work_state_t *ws) {
+    if (t == W_MIXED) {
+        if (g_mixed_ratio.total <= 0) {
+            /* fallback: 1:1:1 */
+            int_work_unit(&ws->int_state);
+            float_work_unit(&ws->float_state);
+            avx2_work_unit(ws->avx_buf);
+            return;
+        }
+        t = mixed_pick(ws);
+    }
+
+    switch (t) {
+    case W_FLOAT:  float_work_unit(&ws->float_state); break;
+    case W_SSE:    sse_work_unit(ws->sse_buf); break;
+    case W_AVX:    avx_work_unit(ws->avx_buf); break;
+    case W_AVX2:   avx2_work_unit(ws->avx_buf); break;
+    case W_AVX512: avx512_work_unit(ws->avx512_buf); break;
+    case W_MEMBW:
+        if (work_state_membw(ws)) membw_work_unit(ws->membw_buf);
+        else int_work_unit(&ws->int_state);
+        break;
+    case W_CRYPTO: crypto_work_unit(&ws->int_state); break;
+    case W_GATHER: gather_work_unit(ws->avx_buf, ws->gather_idx); break;
+    case W_SYSCALL:
+    case W_PIPE:
+    case W_PGFAULT:
+    case W_MADVISE:
+        for (int s = 0; s < WORK_SLICES_PER_UNIT; ++s)
+            kpath_work_slice(t, ws, WORK_UNIT_ITERS / WORK_SLICES_PER_UNIT);
+        break;
+    case W_TLB:
+        if (work_state_tlb(ws))
+            ws->tlb_cursor = tlb_chase(ws->tlb_cursor, (long)TLB_LOADS_PER_SLICE * WORK_SLICES_PER_UNIT);
+        else
+            int_work_unit(&ws->int_state);
+        break;
+    case W_LOCK:
+        for (int s = 0; s < WORK_SLICES_PER_UNIT; ++s)
+            lock_work_slice(&ws->mcs_node, &ws->int_state, &ws->seed);
+        break;
+    case W_DFLOAT: dfloat_work_iters(&ws->float_state, WORK_UNIT_ITERS); break;
+    case W_DSSE:   dsse_work_span(ws->sse_buf, SIMD_ARRAY_SIZE); break;
+    case W_DAVX:   davx_work_span(ws->avx_buf, SIMD_ARRAY_SIZE); break;
+    case W_FRONTEND: {
+        const fe_image_t *im = fe_workload_image();
+        if (im) ws->int_state = fe_run(im, &ws->fe_rng, &ws->fe_cursor, ws->int_state,
+                                       (long)FE_CALLS_PER_SLICE * WORK_SLICES_PER_UNIT);
+        else int_work_unit(&ws->int_state);
+        break;
+    }
+    case W_COPY:
+        if (!work_state_copy(ws)) { int_work_unit(&ws->int_state); break; }
+        for (int s = 0; s < WORK_SLICES_PER_UNIT; ++s) copy_work_slice(ws);
+        break;
+    default:       int_work_unit(&ws->int_state); break;
+    }
+}
+
+/* Run 1/WORK_SLICES_PER_UNIT of a unit; returns the ops to credit
+ * (work_unit_ops once every WORK_SLICES_PER_UNIT slices, else 0). */
+uint64_t run_work_slice(workload_t t, work_state_t *ws) {
+    const long iters = WORK_UNIT_ITERS / WORK_SLICES_PER_UNIT;
+    const size_t span = SIMD_ARRAY_SIZE / WORK_SLICES_PER_UNIT;
+    workload_t k = (t == W_MIXED && g_mixed_ratio.total > 0) ? mixed_pick(ws) : t;
+
+    switch (k) {
+    case W_FLOAT:  float_work_iters(&ws->float_state, iters); break;
+    case W_SSE:    sse_work_span(ws->sse_buf + ws->off, span); break;
+    case W_AVX:    avx_work_span(ws->avx_buf + ws->off, span); break;
+    case W_AVX2:   avx2_work_span(ws->avx_buf + ws->off, span); break;
+    case W_AVX512: avx512_work_span(ws->avx512_buf + ws->off, span); break;
+    case W_MEMBW:
+        if (work_state_membw(ws))
+            membw_work_span(ws->membw_buf, ws->off * 2, MEMBW_BUFFER_WORDS / 2 / WORK_SLICES_PER_UNIT);
+        else
+            int_work_iters(&ws->int_state, iters);
+        break;
+    case W_CRYPTO: crypto_work_iters(&ws->int_state, iters / 4); break;
+    case W_GATHER: gather_work_span(ws->avx_buf, span, ws->gather_idx); break;
+    case W_SYSCALL:
+    case W_PIPE:
+    case W_PGFAULT:
+    case W_MADVISE:
+        kpath_work_slice(k, ws, iters);
+        break;
+    case W_TLB:
+        if (work_state_tlb(ws)) ws->tlb_cursor = tlb_chase(ws->tlb_cursor, TLB_LOADS_PER_SLICE);
+        else int_work_iters(&ws->int_state, iters);
+        break;
+    case W_LOCK:
+        lock_work_slice(&ws->mcs_node, &ws->int_state, &ws->seed);
+        break;
+    case W_DFLOAT: dfloat_work_iters(&ws->float_state, iters); break;
+    case W_DSSE:   dsse_work_span(ws->sse_buf + ws->off, span); break;
+    case W_DAVX:   davx_work_span(ws->avx_buf + ws->off, span); break;
+    case W_FRONTEND: {
+        const fe_image_t *im = fe_workload_image();
+        if (im) ws->int_state = fe_run(im, &ws->fe_rng, &ws->fe_cursor, ws->int_state, FE_CALLS_PER_SLICE);
+        else int_work_iters(&ws->int_state, iters);
+        break;
+    }
+    case W_COPY:
+        if (work_state_copy(ws)) copy_work_slice(ws);
+        else int_work_iters(&ws->int_state, iters);
+        break;
+    default:       int_work_iters(&ws->int_state, iters); break;
+    }
+
+    ws->off = (ws->off + span) % SIMD_ARRAY_SIZE;
+    if (++ws->slices < WORK_SLICES_PER_UNIT) return 0;
+    ws->slices = 0;
+    return work_unit_ops(t);
+}
+
+/***********************************************************
+ *        CPU SIMD Capabilities Display & Verification
+ ***********************************************************/
+void print_cpu_simd_capabilities() {
+    printf("\n=== CPU SIMD Capabilities ===");
+    printf("\n CPU Architecture Support:");
     
-    printf("\n=== SUMMARY ===\n");
-    printf("\n--- Test Configuration ---\n");
-    printf(" Mode            : %s\n", mode);
+#if defined(__x86_64__)
+    printf("\n  Architecture    : x86_64 (64-bit)");
+#elif defined(__i386__)
+    printf("\n  Architecture    : i386 (32-bit)");
+#else
+    printf("\n  Architecture    : Non-x86 (SIMD detection unavailable)");
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+    int has_sse = cpu_supports_sse();
+    int has_avx = cpu_supports_avx();
+    int has_avx2 = cpu_supports_avx2();
+    int has_avx512 = cpu_supports_avx512();
     
-    const char *workload_name = 
-        (type==W_INT)?"INT (Scalar Integer)":
-        (type==W_FLOAT)?"FLOAT (Scalar FP)":
-        (type==W_SSE)?"SSE (128-bit SIMD)":
-        (type==W_AVX)?"AVX (256-bit SIMD)":
-        (type==W_AVX2)?"AVX2 (256-bit SIMD + FMA)":
-        (type==W_AVX512)?"AVX512 (512-bit SIMD)":
-        (type==W_AUTO)?"AUTO":"MIXED";
-    
-    printf(" Workload        : %s\n", workload_name);
-    printf(" Threads         : %d\n", nthreads);
-    printf(" Target Util     : %.1f%%\n", util);
-    printf(" Duration        : %ld s (elapsed: %ld s)\n", duration, elapsed);
+    printf("\n  SSE4.2          : %s", has_sse ? "✓ YES" : "✗ NO");
+    printf("\n  AVX (256-bit)   : %s", has_avx ? "✓ YES" : "✗ NO");
+    printf("\n  AVX2 + FMA      : %s", has_avx2 ? "✓ YES" : "✗ NO");
+    printf("\n  AVX-512         : %s", has_avx512 ? "✓ YES" : "✗ NO");
     
-    printf("\n--- Aggregate Statistics ---\n");
-    if (util_count > 0)
-        printf(" Avg Utilization : %.2f%%\n", avg_util);
+    printf("\n\n Recommended Workload Types:");
+    if (has_avx512)
+        printf("\n  Best            : --type AVX512 (512-bit vectors)");
+    else if (has_avx2)
+        printf("\n  Best            : --type AVX2 (256-bit with FMA)");
+    else if (has_avx)
+        printf("\n  Best            : --type AVX (256-bit floating point)");
+    else if (has_sse)
+        printf("\n  Best            : --type SSE (128-bit vectors)");
     else
-        printf(" Avg Utilization : N/A\n");
+        printf("\n  Best            : --type FLOAT or INT (scalar only)");
     
-    if (temp_count > 0)
-        printf(" Avg Temperature : %.2f °C\n", avg_temp);
-    else
-        printf(" Avg Temperature : N/A\n");
+    printf("\n  Auto-detect     : --type AUTO (will select best available)");
+#endif
     
-    if (freq_count > 0)
-        printf(" Avg Frequency   : %.2f MHz (%.2f GHz)\n", 
-               avg_freq / 1000.0, avg_freq / 1000000.0);
-    else
-        printf(" Avg Frequency   : N/A\n");
+    printf("\n\n Compile-time Flags:");
+#ifdef __SSE4_2__
+    printf("\n  __SSE4_2__      : Defined (SSE4.2 instructions enabled)");
+#endif
+#ifdef __AVX__
+    printf("\n  __AVX__         : Defined (AVX instructions enabled)");
+#endif
+#ifdef __AVX2__
+    printf("\n  __AVX2__        : Defined (AVX2 instructions enabled)");
+#endif
+#ifdef __FMA__
+    printf("\n  __FMA__         : Defined (FMA instructions enabled)");
+#endif
+#ifdef __AVX512F__
+    printf("\n  __AVX512F__     : Defined (AVX-512 instructions enabled)");
+#endif
     
-    printf(" Total Operations: %.2f Million (%.2fM)\n", total_ops_millions, total_ops_millions);
-    printf(" Avg Ops/Core    : %.2f Million\n", avg_ops_per_core / 1000000.0);
-    printf(" Ops/Second      : %.2f Million/s\n", 
-           elapsed > 0 ? total_ops_millions / elapsed : 0.0);
+    printf("\n\n Note: Compiled with -march=native enables all CPU-supported instructions");
     
-    if (temp_path_ptr && *temp_path_ptr) { 
-        double t=read_temperature(*temp_path_ptr); 
-        if (!isnan(t)) 
-            printf(" Final Temperature: %.2f °C\n", t); 
+    printf("\n\n=== Verification Methods ===");
+    printf("\n\n 1. Check CPU flags:");
+    printf("\n    $ lscpu | grep -i flags");
+    printf("\n    $ cat /proc/cpuinfo | grep flags | head -1");
+    printf("\n");
+    printf("\n 2. Profile with perf (requires root):");
+    printf("\n    $ sudo perf stat ./coreburner --mode multi --util 50 --duration 10 --type AVX2");
+    printf("\n");
+    printf("\n 3. Inspect binary for SIMD instructions:");
+    printf("\n    $ objdump -d coreburner | grep 'ymm'  # AVX/AVX2 (256-bit)");
+    printf("\n    $ objdump -d coreburner | grep 'zmm'  # AVX-512 (512-bit)");
+    printf("\n    $ objdump -d coreburner | grep 'xmm'  # SSE (128-bit)");
+    printf("\n");
+    printf("\n 4. Look for specific instructions:");
+    printf("\n    $ objdump -d coreburner | grep -E '(vfmadd|vmul|vadd)'");
+    printf("\n    - 'v' prefix = AVX family (vmulps, vaddpd, etc.)");
+    printf("\n    - 'vfmadd' = FMA instructions (AVX2)");
+    printf("\n    - 'ymm' registers = 256-bit vectors (AVX/AVX2)");
+    printf("\n    - 'zmm' registers = 512-bit vectors (AVX-512)");
+    printf("\n");
+    printf("\n 5. Use Intel VTune or AMD uProf for detailed profiling");
+    printf("\n\n");
+}
+
+/***********************************************************
+ *             Auto-detect Best SIMD Level
+ ***********************************************************/
+workload_t auto_detect_best_simd() {
+    if (cpu_supports_avx512()) {
+        fprintf(stderr, "Auto-detected: AVX-512 (512-bit SIMD)\n");
+        return W_AVX512;
+    }
+    if (cpu_supports_avx2()) {
+        fprintf(stderr, "Auto-detected: AVX2 (256-bit with FMA)\n");
+        return W_AVX2;
+    }
+    if (cpu_supports_avx()) {
+        fprintf(stderr, "Auto-detected: AVX (256-bit FP)\n");
+        return W_AVX;
+    }
+    if (cpu_supports_sse()) {
+        fprintf(stderr, "Auto-detected: SSE (128-bit)\n");
+        return W_SSE;
+    }
+    fprintf(stderr, "Auto-detected: INT (no SIMD)\n");
+    return W_INT;
+}
+
+/***********************************************************
+ *                 Machine Fingerprint
+ * Captures everything that makes two runs comparable and
+ * hashes it, so results can be grouped across hosts.
+ ***********************************************************/
+
+static uint64_t fnv1a64(uint64_t h, const char *s) {
+    for (; s && *s; ++s) {
+        h ^= (unsigned char)*s;
+        h *= 0x100000001b3ULL;
+    }
+    return h ^ 0xff;  /* field separator */
+}
+
+/* Kernel parameters that change performance; everything else on the
+ * cmdline (root=UUID, BOOT_IMAGE, initrd, ip=, console=...) is per host */
+static const char *fp_cmdline_keys[] = {
+    "isolcpus", "nohz", "nohz_full", "rcu_nocbs", "irqaffinity", "skew_tick",
+    "mitigations", "nospectre_v1", "nospectre_v2", "spectre_v2", "spec_store_bypass_disable",
+    "pti", "nopti", "tsx", "retbleed", "l1tf", "mds",
+    "intel_pstate", "amd_pstate", "cpufreq.default_governor",
+    "idle", "intel_idle.max_cstate", "processor.max_cstate",
+    "hugepages", "hugepagesz", "default_hugepagesz", "transparent_hugepage",
+    "iommu", "intel_iommu", "amd_iommu", "nosmt", "maxcpus", "nr_cpus", "numa_balancing",
+    NULL
+};
+
+static int fp_str_cmp(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/* Space-separated, sorted fp_cmdline_keys parameters of `cmdline` */
+static void fingerprint_cmdline_perf(const char *cmdline, char *out, size_t len) {
+    char buf[512];
+    char *tok[64];
+    int n = 0;
+    snprintf(buf, sizeof(buf), "%s", cmdline);
+    char *save = NULL;
+    for (char *t = strtok_r(buf, " \t", &save); t && n < 64; t = strtok_r(NULL, " \t", &save)) {
+        if (strcmp(t, "--") == 0) break;    /* the rest goes to init */
+        size_t klen = strcspn(t, "=");
+        for (int k = 0; fp_cmdline_keys[k]; ++k)
+            if (strlen(fp_cmdline_keys[k]) == klen && strncmp(t, fp_cmdline_keys[k], klen) == 0) {
+                tok[n++] = t;
+                break;
+            }
+    }
+    qsort(tok, n, sizeof(tok[0]), fp_str_cmp);
+    out[0] = '\0';
+    for (int i = 0; i < n; ++i) {
+        size_t l = strlen(out);
+        snprintf(out + l, len - l, "%s%s", i ? " " : "", tok[i]);
+    }
+}
+
+static void fingerprint_cpuid(machine_fingerprint_t *fp) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+        memcpy(fp->cpu_vendor + 0, &ebx, 4);
+        memcpy(fp->cpu_vendor + 4, &edx, 4);
+        memcpy(fp->cpu_vendor + 8, &ecx, 4);
+        fp->cpu_vendor[12] = '\0';
+    }
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        unsigned int base_family = (eax >> 8) & 0xF;
+        unsigned int base_model  = (eax >> 4) & 0xF;
+        fp->stepping = eax & 0xF;
+        fp->family = base_family == 0xF ? base_family + ((eax >> 20) & 0xFF) : base_family;
+        fp->model = (base_family == 0x6 || base_family == 0xF)
+                  ? (((eax >> 16) & 0xF) << 4) | base_model : base_model;
+    }
+
+    int has_aes = __get_cpuid(1, &eax, &ebx, &ecx, &edx) ? (int)((ecx >> 25) & 1) : 0;
+    unsigned int b7 = 0, c7 = 0, d7 = 0;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) { b7 = ebx; c7 = ecx; d7 = edx; }
+
+    snprintf(fp->cpu_flags, sizeof(fp->cpu_flags), "%s%s%s%s%s%s%s%s%s",
+             cpu_supports_sse() ? "sse4.2 " : "",
+             cpu_supports_avx() ? "avx " : "",
+             cpu_supports_avx2() ? "avx2 fma " : "",
+             cpu_supports_avx512() ? "avx512f " : "",
+             ((b7 >> 30) & 1) ? "avx512bw " : "",
+             ((c7 >> 11) & 1) ? "avx512vnni " : "",
+             ((d7 >> 24) & 1) ? "amx-tile " : "",
+             has_aes ? "aes " : "",
+             ((b7 >> 29) & 1) ? "sha " : "");
+    size_t n = strlen(fp->cpu_flags);
+    if (n > 0 && fp->cpu_flags[n - 1] == ' ') fp->cpu_flags[n - 1] = '\0';
+#else
+    (void)fp;
+#endif
+}
+
+static void fingerprint_cpuinfo(machine_fingerprint_t *fp) {
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char *v = strchr(line, ':');
+        if (!v) continue;
+        v++;
+        while (*v == ' ') v++;
+        v[strcspn(v, "\r\n")] = '\0';
+
+        if (!fp->cpu_model_name[0] && strncmp(line, "model name", 10) == 0)
+            snprintf(fp->cpu_model_name, sizeof(fp->cpu_model_name), "%s", v);
+        else if (!fp->microcode[0] && strncmp(line, "microcode", 9) == 0)
+            snprintf(fp->microcode, sizeof(fp->microcode), "%s", v);
+
+        if (fp->cpu_model_name[0] && fp->microcode[0]) break;
+    }
+    fclose(f);
+}
+
+static void fingerprint_memory(machine_fingerprint_t *fp) {
+    FILE *f = fopen("/proc/meminfo", "r");
+    if (f) {
+        char line[256];
+        long kb = 0;
+        while (fgets(line, sizeof(line), f))
+            if (sscanf(line, "MemTotal: %ld kB", &kb) == 1) break;
+        fclose(f);
+        fp->mem_total_mb = kb / 1024;
+    }
+
+    fp->numa_nodes = 0;
+    char path[128];
+    for (int n = 0; n < 1024; ++n) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", n);
+        if (access(path, F_OK) != 0) break;
+        fp->numa_nodes++;
+    }
+
+    /* "always [madvise] never" -> "madvise" */
+    char buf[128];
+    if (read_sysfs_str("/sys/kernel/mm/transparent_hugepage/enabled", buf, sizeof(buf)) == 0) {
+        char *l = strchr(buf, '['), *r = l ? strchr(l, ']') : NULL;
+        if (l && r) { *r = '\0'; snprintf(fp->thp, sizeof(fp->thp), "%s", l + 1); }
+    }
+}
+
+static void fingerprint_power_limits(machine_fingerprint_t *fp) {
+    char pl1[32] = "", pl2[32] = "";
+    read_sysfs_str("/sys/class/powercap/intel-rapl:0/constraint_0_power_limit_uw", pl1, sizeof(pl1));
+    read_sysfs_str("/sys/class/powercap/intel-rapl:0/constraint_1_power_limit_uw", pl2, sizeof(pl2));
+    if (pl1[0] || pl2[0])
+        snprintf(fp->power_limits, sizeof(fp->power_limits), "PL1=%.1fW PL2=%.1fW",
+                 atol(pl1) / 1e6, atol(pl2) / 1e6);
+}
+
+void collect_machine_fingerprint(machine_fingerprint_t *fp) {
+    memset(fp, 0, sizeof(*fp));
+
+    fingerprint_cpuid(fp);
+    fingerprint_cpuinfo(fp);
+
+    struct utsname un;
+    if (uname(&un) == 0)
+        snprintf(fp->kernel_release, sizeof(fp->kernel_release), "%s", un.release);
+    read_sysfs_str("/proc/cmdline", fp->kernel_cmdline, sizeof(fp->kernel_cmdline));
+    fingerprint_cmdline_perf(fp->kernel_cmdline, fp->cmdline_perf, sizeof(fp->cmdline_perf));
+
+    read_sysfs_str("/sys/devices/system/cpu/cpu0/cpufreq/scaling_driver",
+                   fp->cpufreq_driver, sizeof(fp->cpufreq_driver));
+    read_sysfs_str("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor",
+                   fp->governor, sizeof(fp->governor));
+    read_sysfs_str("/sys/devices/system/cpu/cpu0/cpufreq/energy_performance_preference",
+                   fp->epp, sizeof(fp->epp));
+
+    char buf[32];
+    if (read_sysfs_str("/sys/devices/system/cpu/intel_pstate/no_turbo", buf, sizeof(buf)) == 0)
+        snprintf(fp->boost, sizeof(fp->boost), "%s", atoi(buf) ? "off" : "on");
+    else if (read_sysfs_str("/sys/devices/system/cpu/cpufreq/boost", buf, sizeof(buf)) == 0)
+        snprintf(fp->boost, sizeof(fp->boost), "%s", atoi(buf) ? "on" : "off");
+
+    read_sysfs_str("/sys/devices/system/cpu/smt/control", fp->smt, sizeof(fp->smt));
+
+    fingerprint_memory(fp);
+    fingerprint_power_limits(fp);
+
+    read_sysfs_str("/sys/class/dmi/id/bios_vendor", fp->bios_vendor, sizeof(fp->bios_vendor));
+    read_sysfs_str("/sys/class/dmi/id/bios_version", fp->bios_version, sizeof(fp->bios_version));
+    read_sysfs_str("/sys/class/dmi/id/bios_date", fp->bios_date, sizeof(fp->bios_date));
+    read_sysfs_str("/sys/class/dmi/id/product_name", fp->product_name, sizeof(fp->product_name));
+
+    snprintf(fp->build, sizeof(fp->build), "coreburner %s (%s) gcc %d.%d",
+             COREBURNER_VERSION, COREBURNER_BUILD_ID, __GNUC__, __GNUC_MINOR__);
+    snprintf(fp->isa_dispatch, sizeof(fp->isa_dispatch), "best=%s compiled=%s",
+             cpu_supports_avx512() ? "AVX512" : cpu_supports_avx2() ? "AVX2" :
+             cpu_supports_avx() ? "AVX" : cpu_supports_sse() ? "SSE" : "INT",
+#if defined(__AVX512F__)
+             "avx512f"
+#elif defined(__AVX2__)
+             "avx2"
+#elif defined(__AVX__)
+             "avx"
+#else
+             "baseline"
+#endif
+             );
+
+    /* Hash covers everything that affects comparability (not the BIOS date/product
+     * label, per-host cmdline values, or the build string, which changes every rebuild) */
+    char num[64];
+    uint64_t h = 0xcbf29ce484222325ULL;
+    h = fnv1a64(h, fp->cpu_vendor);
+    snprintf(num, sizeof(num), "%u/%u/%u", fp->family, fp->model, fp->stepping);
+    h = fnv1a64(h, num);
+    h = fnv1a64(h, fp->cpu_flags);
+    h = fnv1a64(h, fp->microcode);
+    h = fnv1a64(h, fp->kernel_release);
+    h = fnv1a64(h, fp->cmdline_perf);
+    h = fnv1a64(h, fp->cpufreq_driver);
+    h = fnv1a64(h, fp->governor);
+    h = fnv1a64(h, fp->epp);
+    h = fnv1a64(h, fp->boost);
+    h = fnv1a64(h, fp->smt);
+    snprintf(num, sizeof(num), "%ldG/%d", (fp->mem_total_mb + 512) / 1024, fp->numa_nodes);
+    h = fnv1a64(h, num);
+    h = fnv1a64(h, fp->thp);
+    h = fnv1a64(h, fp->power_limits);
+    h = fnv1a64(h, fp->bios_version);
+    h = fnv1a64(h, fp->isa_dispatch);
+    snprintf(fp->hash, sizeof(fp->hash), "%016" PRIx64, h);
+}
+
+/* Writes "<prefix>key=value" lines (prefix "# fp." for logs, "" for summaries) */
+void write_machine_fingerprint(FILE *f, const char *prefix, const machine_fingerprint_t *fp) {
+    if (!f || !fp) return;
+    fprintf(f, "%shash=%s\n", prefix, fp->hash);
+    fprintf(f, "%scpu_vendor=%s\n", prefix, fp->cpu_vendor);
+    fprintf(f, "%scpu_model_name=%s\n", prefix, fp->cpu_model_name);
+    fprintf(f, "%scpu_family_model_stepping=%u/%u/%u\n", prefix, fp->family, fp->model, fp->stepping);
+    fprintf(f, "%scpu_flags=%s\n", prefix, fp->cpu_flags);
+    fprintf(f, "%smicrocode=%s\n", prefix, fp->microcode);
+    fprintf(f, "%skernel=%s\n", prefix, fp->kernel_release);
+    fprintf(f, "%skernel_cmdline=%s\n", prefix, fp->kernel_cmdline);
+    fprintf(f, "%scmdline_perf=%s\n", prefix, fp->cmdline_perf);
+    fprintf(f, "%scpufreq_driver=%s\n", prefix, fp->cpufreq_driver);
+    fprintf(f, "%sgovernor=%s\n", prefix, fp->governor);
+    fprintf(f, "%sepp=%s\n", prefix, fp->epp);
+    fprintf(f, "%sboost=%s\n", prefix, fp->boost);
+    fprintf(f, "%ssmt=%s\n", prefix, fp->smt);
+    fprintf(f, "%smem_total_mb=%ld\n", prefix, fp->mem_total_mb);
+    fprintf(f, "%snuma_nodes=%d\n", prefix, fp->numa_nodes);
+    fprintf(f, "%sthp=%s\n", prefix, fp->thp);
+    fprintf(f, "%spower_limits=%s\n", prefix, fp->power_limits);
+    fprintf(f, "%sbios=%s %s (%s)\n", prefix, fp->bios_vendor, fp->bios_version, fp->bios_date);
+    fprintf(f, "%sproduct=%s\n", prefix, fp->product_name);
+    fprintf(f, "%sbuild=%s\n", prefix, fp->build);
+    fprintf(f, "%sisa_dispatch=%s\n", prefix, fp->isa_dispatch);
+}
+
+/***********************************************************
+ *               Predictive Thermal Guard
+ * --thermal-guard fits a least-squares line to the last
+ * --guard-window samples of every temperature sensor and
+ * extrapolates the time until it reaches --temp-threshold.
+ * When the soonest sensor is less than --guard-margin seconds
+ * away, load backs off one step: worker duty cycle (duty) or
+ * one ISA level down (isa: AVX512 > AVX2 > AVX > SSE > FLOAT,
+ * then duty). Steps are undone once every sensor is flat or
+ * far from the limit. The hard auto-stop stays as a backstop.
+ ***********************************************************/
+#define GUARD_MAX_SENSORS 48
+#define GUARD_DUTY_STEP_PM 100      /* per-mille of the target util per step */
+#define GUARD_DUTY_MIN_PM 100
+#define GUARD_MIN_SLOPE 0.005       /* °C/s; flatter counts as not rising */
+#define GUARD_RECOVER_C 3.0         /* recover only this far below the threshold */
+
+static const workload_t guard_isa_ladder[] = { W_AVX512, W_AVX2, W_AVX, W_SSE, W_FLOAT };
+#define GUARD_ISA_LEVELS ((int)(sizeof(guard_isa_ladder) / sizeof(guard_isa_ladder[0])))
+
+typedef struct {
+    int enabled;
+    int isa;                    /* back off by ISA before duty */
+    double margin_sec;
+    int window;
+
+    /* read by the workers */
+    int duty_pm;                /* per-mille of each worker's target util */
+    int isa_down;               /* ISA levels below the requested --type */
+
+    /* sample history, oldest first */
+    int len;
+    double t[GUARD_MAX_WINDOW];
+    double temp[GUARD_MAX_SENSORS][GUARD_MAX_WINDOW];
+    int hold;                   /* samples before the next step may be taken */
+
+    /* run statistics */
+    int backoffs, recoveries;
+    int min_duty_pm, max_isa_down;
+    double min_eta;
+    int guarded_samples;        /* samples spent backed off */
+} thermal_guard_t;
+
+static thermal_guard_t g_guard;
+
+typedef struct {
+    double slope;               /* °C/s of the soonest sensor */
+    double eta;                 /* s to threshold; INFINITY when not rising */
+    int sensor;                 /* index into the caller's sensor list, -1 = none */
+    int action;                 /* -1 backed off, +1 recovered, 0 none */
+} guard_pred_t;
+
+void guard_configure(int enabled, double margin_sec, int window, const char *action) {
+    memset(&g_guard, 0, sizeof(g_guard));
+    g_guard.enabled = enabled;
+    g_guard.isa = action && str_case_equal(action, "isa");
+    g_guard.margin_sec = margin_sec;
+    g_guard.window = window < 3 ? 3 : window > GUARD_MAX_WINDOW ? GUARD_MAX_WINDOW : window;
+    g_guard.duty_pm = 1000;
+    g_guard.min_duty_pm = 1000;
+    g_guard.min_eta = INFINITY;
+}
+
+/* Start of a run: full load, empty history (statistics are per run) */
+void guard_reset(void) {
+    if (!g_guard.enabled) return;
+    guard_configure(1, g_guard.margin_sec, g_guard.window, g_guard.isa ? "isa" : "duty");
+}
+
+/* Kernel a worker runs for its --type under the current ISA back-off */
+static workload_t guard_kernel(workload_t type) {
+    int down = __atomic_load_n(&g_guard.isa_down, __ATOMIC_RELAXED);
+    if (down == 0) return type;
+    for (int i = 0; i < GUARD_ISA_LEVELS; ++i)
+        if (guard_isa_ladder[i] == type)
+            return guard_isa_ladder[i + down < GUARD_ISA_LEVELS ? i + down : GUARD_ISA_LEVELS - 1];
+    return type;
+}
+
+static int guard_isa_room(workload_t type) {
+    for (int i = 0; i < GUARD_ISA_LEVELS; ++i)
+        if (guard_isa_ladder[i] == type) return GUARD_ISA_LEVELS - 1 - i;
+    return 0;
+}
+
+/* Least-squares slope and value at the newest sample; 0 if fewer than 3 points */
+static int guard_fit(const double *t, const double *y, int n, double *slope, double *now) {
+    double st = 0, sy = 0, stt = 0, sty = 0;
+    int k = 0;
+    for (int i = 0; i < n; ++i) {
+        if (isnan(y[i])) continue;
+        st += t[i]; sy += y[i]; stt += t[i] * t[i]; sty += t[i] * y[i];
+        k++;
+    }
+    double d = k * stt - st * st;
+    if (k < 3 || d <= 0) return 0;
+    *slope = (k * sty - st * sy) / d;
+    *now = (sy - *slope * st) / k + *slope * t[n - 1];
+    return 1;
+}
+
+/* One sample of every sensor at time `now` (s); predicts and steps the back-off */
+void guard_update(double now, const double *temps, int nsens, double threshold, workload_t type,
+                  guard_pred_t *out) {
+    thermal_guard_t *g = &g_guard;
+    out->slope = 0.0;
+    out->eta = INFINITY;
+    out->sensor = -1;
+    out->action = 0;
+    if (nsens > GUARD_MAX_SENSORS) nsens = GUARD_MAX_SENSORS;
+
+    if (g->len == g->window) {
+        memmove(g->t, g->t + 1, (g->len - 1) * sizeof(double));
+        for (int s = 0; s < GUARD_MAX_SENSORS; ++s)
+            memmove(g->temp[s], g->temp[s] + 1, (g->len - 1) * sizeof(double));
+        g->len--;
+    }
+    g->t[g->len] = now;
+    for (int s = 0; s < GUARD_MAX_SENSORS; ++s) g->temp[s][g->len] = s < nsens ? temps[s] : NAN;
+    g->len++;
+
+    int any = 0, near = 0;
+    for (int s = 0; s < nsens; ++s) {
+        double slope, fit;
+        if (!guard_fit(g->t, g->temp[s], g->len, &slope, &fit)) continue;
+        any = 1;
+        double eta = fit >= threshold ? 0.0 : slope > GUARD_MIN_SLOPE ? (threshold - fit) / slope : INFINITY;
+        if (out->sensor < 0 || eta < out->eta) {
+            out->eta = eta;
+            out->slope = slope;
+            out->sensor = s;
+        }
+        if (!isnan(temps[s]) && temps[s] > threshold - GUARD_RECOVER_C) near = 1;
+    }
+    if (!any) return;
+    if (out->eta < g->min_eta) g->min_eta = out->eta;
+    if (g->duty_pm < 1000 || g->isa_down > 0) g->guarded_samples++;
+    /* hold after a step, unless the limit is imminent */
+    if (g->hold > 0) {
+        g->hold--;
+        if (out->eta >= g->margin_sec / 3.0) return;
+    }
+
+    if (out->eta < g->margin_sec) {
+        if (g->isa && g->isa_down < guard_isa_room(type)) {
+            __atomic_store_n(&g->isa_down, g->isa_down + 1, __ATOMIC_RELAXED);
+        } else if (g->duty_pm > GUARD_DUTY_MIN_PM) {
+            int pm = g->duty_pm - GUARD_DUTY_STEP_PM;
+            __atomic_store_n(&g->duty_pm, pm < GUARD_DUTY_MIN_PM ? GUARD_DUTY_MIN_PM : pm, __ATOMIC_RELAXED);
+        } else {
+            return;
+        }
+        g->backoffs++;
+        out->action = -1;
+        /* let the new load show in the fit before stepping again */
+        g->hold = g->window / 2;
+    } else if (out->eta > 3.0 * g->margin_sec && !near && (g->duty_pm < 1000 || g->isa_down > 0)) {
+        /* undo in reverse order: duty first, then ISA */
+        if (g->duty_pm < 1000) {
+            int pm = g->duty_pm + GUARD_DUTY_STEP_PM;
+            __atomic_store_n(&g->duty_pm, pm > 1000 ? 1000 : pm, __ATOMIC_RELAXED);
+        } else {
+            __atomic_store_n(&g->isa_down, g->isa_down - 1, __ATOMIC_RELAXED);
+        }
+        g->recoveries++;
+        out->action = 1;
+        g->hold = g->window;
+    }
+    if (g->duty_pm < g->min_duty_pm) g->min_duty_pm = g->duty_pm;
+    if (g->isa_down > g->max_isa_down) g->max_isa_down = g->isa_down;
+}
+
+void guard_report(FILE *f, workload_t type, int samples, int summary) {
+    if (!g_guard.enabled) return;
+    const thermal_guard_t *g = &g_guard;
+    double pct = samples > 0 ? 100.0 * g->guarded_samples / samples : 0.0;
+    workload_t lowest = type;
+    for (int i = 0; i < GUARD_ISA_LEVELS; ++i)
+        if (guard_isa_ladder[i] == type)
+            lowest = guard_isa_ladder[i + g->max_isa_down < GUARD_ISA_LEVELS ? i + g->max_isa_down : GUARD_ISA_LEVELS - 1];
+    if (summary) {
+        fprintf(f, "\n[Thermal Guard]\n");
+        fprintf(f, "action=%s\nmargin_sec=%.0f\nwindow=%d\n", g->isa ? "isa" : "duty", g->margin_sec, g->window);
+        fprintf(f, "backoffs=%d\nrecoveries=%d\n", g->backoffs, g->recoveries);
+        fprintf(f, "min_duty_pct=%.0f\nlowest_isa=%s\n", g->min_duty_pm / 10.0, workload_str(lowest));
+        if (isfinite(g->min_eta)) fprintf(f, "min_eta_sec=%.1f\n", g->min_eta);
+        fprintf(f, "backed_off_pct=%.1f\n", pct);
+    } else {
+        fprintf(f, " Thermal Guard   : %d back-offs, %d recoveries, min duty %.0f%%, lowest ISA %s, "
+                "backed off %.0f%% of samples", g->backoffs, g->recoveries, g->min_duty_pm / 10.0,
+                workload_str(lowest), pct);
+        if (isfinite(g->min_eta)) fprintf(f, ", min ETA %.0f s", g->min_eta);
+        fprintf(f, "\n");
+    }
+}
+
+/***********************************************************
+ *              Trace Record & Replay
+ *
+ * --record-trace samples per-CPU utilization (and optionally
+ * scaling_cur_freq) from /proc/stat at a fixed step into a
+ * compact binary trace:
+ *   trace_header_t, then per step: ncpus x uint8 util in
+ *   half-percent units, [ncpus x uint16 freq MHz]
+ * --replay drives one worker per trace lane: each step the
+ * worker runs its kernel for util% of the (time-scaled) step
+ * and sleeps to the absolute step end. Achieved util is the
+ * worker's thread CPU time over the step.
+ ***********************************************************/
+#define TRACE_MAGIC "CBTRACE1"
+#define TRACE_FLAG_FREQ 0x1
+#define TRACE_DEFAULT_STEP_MS 10
+#define REPLAY_MAX_BANDS 8
+#define REPLAY_ARM_DELAY_NS 20000000L   /* lets all workers spawn before step 0 */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t step_us;
+    uint32_t ncpus;
+    uint32_t flags;
+    uint64_t nsteps;
+    uint64_t start_time;
+    char fp_hash[24];
+} trace_header_t;
+
+typedef struct {
+    trace_header_t hdr;
+    uint8_t *util;          /* [step * ncpus + cpu], half-percent */
+    uint16_t *freq_mhz;     /* same layout, NULL if not recorded */
+} trace_t;
+
+typedef struct {
+    trace_t trace;
+    double speed;
+    long step_ns;           /* replay step after time-scaling */
+    int nlanes;
+    int *cpu_map;           /* lane -> target CPU */
+    int nbands;
+    double band_util[REPLAY_MAX_BANDS];
+    workload_t band_type[REPLAY_MAX_BANDS];
+    workload_t default_type;
+    struct timespec start;
+    float *achieved;        /* [lane * nsteps + step] achieved util %, NAN = missed */
+} trace_replay_t;
+
+static trace_replay_t *g_replay = NULL;
+
+static long long ts_ns(const struct timespec *t) {
+    return (long long)t->tv_sec * 1000000000LL + t->tv_nsec;
+}
+
+static struct timespec ts_from_ns(long long ns) {
+    struct timespec t = { (time_t)(ns / 1000000000LL), (long)(ns % 1000000000LL) };
+    return t;
+}
+
+static void sleep_until_ns(long long deadline) {
+    struct timespec t = ts_from_ns(deadline);
+    while (!stop_flag && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+        ;
+}
+
+/* Parse per-CPU busy/total ticks from a /proc/stat buffer (same idle
+ * definition as read_proc_stat). Returns number of CPUs parsed. */
+static int trace_parse_stat(const char *buf, uint64_t *total, uint64_t *busy, int max_cpus) {
+    int n = 0;
+    const char *p = buf;
+    while (p && strncmp(p, "cpu", 3) == 0) {
+        if (p[3] != ' ' && n < max_cpus) {
+            unsigned long long v[8] = {0};
+            char *q = (char *)p + 3;
+            strtoul(q, &q, 10);
+            for (int k = 0; k < 8; ++k) v[k] = strtoull(q, &q, 10);
+            uint64_t idle_all = v[3] + v[4];
+            uint64_t nonidle = v[0] + v[1] + v[2] + v[5] + v[6] + v[7];
+            total[n] = idle_all + nonidle;
+            busy[n] = nonidle;
+            n++;
+        }
+        p = strchr(p, '\n');
+        if (p) p++;
+    }
+    return n;
+}
+
+static ssize_t trace_read_stat(int fd, char **buf, size_t *cap) {
+    for (;;) {
+        ssize_t r = pread(fd, *buf, *cap - 1, 0);
+        if (r < 0) return -1;
+        if ((size_t)r < *cap - 1) {
+            (*buf)[r] = '\0';
+            return r;
+        }
+        char *nb = realloc(*buf, *cap * 2);
+        if (!nb) return -1;
+        *buf = nb;
+        *cap *= 2;
+    }
+}
+
+/* Record a utilization trace. Uses one persistent fd per source and a
+ * large stdio buffer so sampling costs a pread + parse per step. */
+int trace_record(const char *path, long duration, long step_ms, int with_freq) {
+    int stat_fd = open("/proc/stat", O_RDONLY);
+    if (stat_fd < 0) {
+        fprintf(stderr, "Error: /proc/stat not readable\n");
+        return 1;
+    }
+
+    size_t cap = 65536;
+    char *buf = malloc(cap);
+    int max_cpus = get_affinity_cpu_count();
+    long nconf = sysconf(_SC_NPROCESSORS_CONF);
+    if (nconf > max_cpus) max_cpus = (int)nconf;
+    uint64_t *tot_prev = calloc(max_cpus, sizeof(uint64_t));
+    uint64_t *busy_prev = calloc(max_cpus, sizeof(uint64_t));
+    uint64_t *tot_cur = calloc(max_cpus, sizeof(uint64_t));
+    uint64_t *busy_cur = calloc(max_cpus, sizeof(uint64_t));
+    uint8_t *util_row = calloc(max_cpus, sizeof(uint8_t));
+    uint16_t *freq_row = calloc(max_cpus, sizeof(uint16_t));
+    int *freq_fd = calloc(max_cpus, sizeof(int));
+    FILE *out = NULL;
+    int rc = 1;
+
+    if (freq_fd) for (int c = 0; c < max_cpus; ++c) freq_fd[c] = -1;
+    if (!buf || !tot_prev || !busy_prev || !tot_cur || !busy_cur || !util_row || !freq_row || !freq_fd) {
+        fprintf(stderr, "Memory allocation error\n");
+        goto out;
+    }
+
+    if (trace_read_stat(stat_fd, &buf, &cap) < 0) goto out;
+    int ncpus = trace_parse_stat(buf, tot_prev, busy_prev, max_cpus);
+    if (ncpus <= 0) {
+        fprintf(stderr, "Error: no per-CPU lines in /proc/stat\n");
+        goto out;
+    }
+
+    int have_freq = 0;
+    for (int c = 0; c < ncpus && with_freq; ++c) {
+        char p[128];
+        snprintf(p, sizeof(p), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", c);
+        freq_fd[c] = open(p, O_RDONLY);
+        if (freq_fd[c] >= 0) have_freq = 1;
+    }
+    if (with_freq && !have_freq)
+        fprintf(stderr, "Warning: scaling_cur_freq unavailable, recording utilization only\n");
+
+    out = fopen(path, "wb");
+    if (!out) {
+        fprintf(stderr, "Error: cannot write trace '%s': %s\n", path, strerror(errno));
+        goto out;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+    trace_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version = 1;
+    hdr.step_us = (uint32_t)(step_ms * 1000);
+    hdr.ncpus = (uint32_t)ncpus;
+    hdr.flags = have_freq ? TRACE_FLAG_FREQ : 0;
+    hdr.start_time = (uint64_t)time(NULL);
+    snprintf(hdr.fp_hash, sizeof(hdr.fp_hash), "%s", g_fingerprint.hash);
+    fwrite(&hdr, sizeof(hdr), 1, out);
+
+    printf("Recording %d CPUs every %ld ms for %ld s to %s%s\n",
+           ncpus, step_ms, duration, path, have_freq ? " (with frequency)" : "");
+
+    const long long step_ns = step_ms * 1000000LL;
+    const uint64_t total_steps = (uint64_t)(duration * 1000 / step_ms);
+    uint64_t steps = 0, missed = 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long next = ts_ns(&now) + step_ns;
+
+    while (!stop_flag && steps < total_steps) {
+        sleep_until_ns(next);
+        if (stop_flag) break;
+
+        if (trace_read_stat(stat_fd, &buf, &cap) < 0) break;
+        int n = trace_parse_stat(buf, tot_cur, busy_cur, ncpus);
+        for (int c = 0; c < ncpus; ++c) {
+            if (c < n && tot_cur[c] > tot_prev[c]) {
+                double u = (double)(busy_cur[c] - busy_prev[c]) / (double)(tot_cur[c] - tot_prev[c]);
+                util_row[c] = (uint8_t)lround(fmin(fmax(u, 0.0), 1.0) * 200.0);
+                tot_prev[c] = tot_cur[c];
+                busy_prev[c] = busy_cur[c];
+            }
+            /* No tick elapsed on this CPU: hold the previous value */
+        }
+        fwrite(util_row, 1, ncpus, out);
+
+        if (have_freq) {
+            for (int c = 0; c < ncpus; ++c) {
+                char fb[32];
+                ssize_t r = freq_fd[c] >= 0 ? pread(freq_fd[c], fb, sizeof(fb) - 1, 0) : -1;
+                long khz = 0;
+                if (r > 0) { fb[r] = '\0'; khz = atol(fb); }
+                freq_row[c] = (uint16_t)(khz / 1000 > UINT16_MAX ? UINT16_MAX : khz / 1000);
+            }
+            fwrite(freq_row, sizeof(uint16_t), ncpus, out);
+        }
+        steps++;
+
+        /* Resynchronise after an overrun instead of bursting to catch up */
+        next += step_ns;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (ts_ns(&now) > next) {
+            long long behind = (ts_ns(&now) - next) / step_ns + 1;
+            missed += behind;
+            next += behind * step_ns;
+        }
+    }
+
+    hdr.nsteps = steps;
+    fflush(out);
+    if (fseek(out, 0, SEEK_SET) == 0) fwrite(&hdr, sizeof(hdr), 1, out);
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    double cpu_sec = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+                     (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+    double wall_sec = steps * step_ms / 1000.0;
+    printf("Recorded %" PRIu64 " steps (%" PRIu64 " missed), recorder CPU %.3f s (%.2f%% of one CPU)\n",
+           steps, missed, cpu_sec, wall_sec > 0 ? 100.0 * cpu_sec / wall_sec : 0.0);
+    rc = 0;
+
+out:
+    if (out && fclose(out) != 0) rc = 1;
+    if (freq_fd) for (int c = 0; c < max_cpus; ++c) if (freq_fd[c] >= 0) close(freq_fd[c]);
+    close(stat_fd);
+    free(buf); free(tot_prev); free(busy_prev); free(tot_cur); free(busy_cur);
+    free(util_row); free(freq_row); free(freq_fd);
+    return rc;
+}
+
+int trace_load(const char *path, trace_t *tr) {
+    memset(tr, 0, sizeof(*tr));
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Error: cannot open trace '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (fread(&tr->hdr, sizeof(tr->hdr), 1, f) != 1 ||
+        memcmp(tr->hdr.magic, TRACE_MAGIC, sizeof(tr->hdr.magic)) != 0 ||
+        tr->hdr.ncpus == 0 || tr->hdr.step_us == 0) {
+        fprintf(stderr, "Error: '%s' is not a coreburner trace\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    /* nsteps is patched at the end of recording; fall back to file size */
+    size_t row = tr->hdr.ncpus * (1 + ((tr->hdr.flags & TRACE_FLAG_FREQ) ? sizeof(uint16_t) : 0));
+    struct stat st;
+    if (fstat(fileno(f), &st) == 0) {
+        uint64_t avail = (st.st_size - sizeof(tr->hdr)) / row;
+        if (tr->hdr.nsteps == 0 || tr->hdr.nsteps > avail) tr->hdr.nsteps = avail;
+    }
+
+    uint64_t n = tr->hdr.nsteps;
+    int nc = tr->hdr.ncpus;
+    tr->util = malloc(n * nc + 1);
+    if (tr->hdr.flags & TRACE_FLAG_FREQ) tr->freq_mhz = malloc(n * nc * sizeof(uint16_t) + 1);
+    if (!tr->util || ((tr->hdr.flags & TRACE_FLAG_FREQ) && !tr->freq_mhz)) {
+        fclose(f);
+        goto fail;
+    }
+
+    for (uint64_t s = 0; s < n; ++s) {
+        if (fread(tr->util + s * nc, 1, nc, f) != (size_t)nc) { n = s; break; }
+        if (tr->freq_mhz && fread(tr->freq_mhz + s * nc, sizeof(uint16_t), nc, f) != (size_t)nc) { n = s; break; }
+    }
+    tr->hdr.nsteps = n;
+    fclose(f);
+    if (n > 0) return 0;
+    fprintf(stderr, "Error: trace '%s' has no steps\n", path);
+
+fail:
+    free(tr->util);
+    free(tr->freq_mhz);
+    tr->util = NULL;
+    tr->freq_mhz = NULL;
+    return -1;
+}
+
+static int workload_supported(workload_t t) {
+    if (t == W_SSE || t == W_DSSE) return cpu_supports_sse();
+    if (t == W_AVX || t == W_DAVX || t == W_MIXED) return cpu_supports_avx();
+    if (t == W_AVX2 || t == W_GATHER) return cpu_supports_avx2();
+    if (t == W_CRYPTO) return cpu_supports_aes();
+    if (t == W_AVX512) return cpu_supports_avx512();
+    return 1;
+}
+
+/* Load the trace and kernel bands ("UTIL:TYPE,..."); sets g_replay */
+int trace_replay_load(const replay_spec_t *spec, workload_t default_type) {
+    trace_replay_t *rp = calloc(1, sizeof(*rp));
+    if (!rp || trace_load(spec->path, &rp->trace) != 0) {
+        free(rp);
+        return -1;
+    }
+
+    rp->speed = spec->speed;
+    rp->step_ns = (long)(rp->trace.hdr.step_us * 1000.0 / spec->speed);
+    rp->default_type = default_type;
+    rp->nlanes = (int)rp->trace.hdr.ncpus;
+    if (rp->nlanes > DEFAULT_MAX_THREADS) rp->nlanes = DEFAULT_MAX_THREADS;
+    if (rp->step_ns < 1000000L)
+        fprintf(stderr, "Warning: replay step %.2f ms is below 1 ms; duty cycle will be coarse\n",
+                rp->step_ns / 1e6);
+
+    if (spec->kernels) {
+        char *copy = strdup(spec->kernels);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+            char *colon = strchr(tok, ':');
+            workload_t t = colon ? parse_type(colon + 1) : W_AUTO;
+            if (t == W_AUTO || rp->nbands >= REPLAY_MAX_BANDS) {
+                fprintf(stderr, "Error: invalid --replay-kernels entry '%s'\n", tok);
+                free(copy);
+                free(rp->trace.util); free(rp->trace.freq_mhz); free(rp);
+                return -1;
+            }
+            if (!workload_supported(t)) {
+                fprintf(stderr, "Error: --replay-kernels type '%s' not supported on this CPU\n", colon + 1);
+                free(copy);
+                free(rp->trace.util); free(rp->trace.freq_mhz); free(rp);
+                return -1;
+            }
+            /* keep bands sorted by threshold */
+            int i = rp->nbands++;
+            double u = atof(tok);
+            while (i > 0 && rp->band_util[i - 1] > u) {
+                rp->band_util[i] = rp->band_util[i - 1];
+                rp->band_type[i] = rp->band_type[i - 1];
+                i--;
+            }
+            rp->band_util[i] = u;
+            rp->band_type[i] = t;
+        }
+        free(copy);
+    }
+
+    size_t n = (size_t)rp->nlanes * rp->trace.hdr.nsteps;
+    rp->achieved = malloc(n * sizeof(float) + 1);
+    if (!rp->achieved) {
+        free(rp->trace.util); free(rp->trace.freq_mhz); free(rp);
+        return -1;
+    }
+
+    printf("Replay trace: %s (%d lanes, %" PRIu64 " steps of %u ms, %.2fx speed, fp %s)\n",
+           spec->path, rp->nlanes, rp->trace.hdr.nsteps, rp->trace.hdr.step_us / 1000,
+           rp->speed, rp->trace.hdr.fp_hash[0] ? rp->trace.hdr.fp_hash : "-");
+    g_replay = rp;
+    return 0;
+}
+
+/* Replay wall time in whole seconds (rounded up) */
+long trace_replay_duration_sec(void) {
+    if (!g_replay) return 0;
+    long long ns = (long long)g_replay->trace.hdr.nsteps * g_replay->step_ns;
+    return (long)((ns + 999999999LL) / 1000000000LL) + 1;
+}
+
+/* Map lanes onto this machine's CPUs: "LANE:CPU,..." overrides, default lane % cpus */
+int trace_replay_map(const char *map_str, int ncpus) {
+    trace_replay_t *rp = g_replay;
+    rp->cpu_map = calloc(rp->nlanes, sizeof(int));
+    if (!rp->cpu_map) return -1;
+    for (int l = 0; l < rp->nlanes; ++l) rp->cpu_map[l] = l % ncpus;
+
+    if (map_str) {
+        char *copy = strdup(map_str);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+            int lane, cpu;
+            if (sscanf(tok, "%d:%d", &lane, &cpu) != 2 ||
+                lane < 0 || lane >= rp->nlanes || cpu < 0 || cpu >= ncpus) {
+                fprintf(stderr, "Error: invalid --replay-map entry '%s' (lanes 0-%d, cpus 0-%d)\n",
+                        tok, rp->nlanes - 1, ncpus - 1);
+                free(copy);
+                return -1;
+            }
+            rp->cpu_map[lane] = cpu;
+        }
+        free(copy);
+    }
+
+    if (rp->nlanes > ncpus)
+        printf("Replay: %d trace lanes folded onto %d CPUs\n", rp->nlanes, ncpus);
+    return 0;
+}
+
+/* Mean recorded util of a lane, used as the worker's nominal target */
+double trace_lane_mean_util(int lane) {
+    const trace_t *tr = &g_replay->trace;
+    double sum = 0.0;
+    for (uint64_t s = 0; s < tr->hdr.nsteps; ++s) sum += tr->util[s * tr->hdr.ncpus + lane];
+    return tr->hdr.nsteps ? sum / tr->hdr.nsteps / 2.0 : 0.0;
+}
+
+/* Set step 0 slightly in the future and clear achieved samples */
+void trace_replay_arm(void) {
+    trace_replay_t *rp = g_replay;
+    size_t n = (size_t)rp->nlanes * rp->trace.hdr.nsteps;
+    for (size_t i = 0; i < n; ++i) rp->achieved[i] = NAN;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    rp->start = ts_from_ns(ts_ns(&now) + REPLAY_ARM_DELAY_NS);
+}
+
+static workload_t trace_replay_kernel(const trace_replay_t *rp, double util) {
+    workload_t t = rp->default_type;
+    for (int b = 0; b < rp->nbands; ++b)
+        if (util >= rp->band_util[b]) t = rp->band_type[b];
+    return t;
+}
+
+/* Worker body under --replay; returns only once stop_flag is set */
+void trace_replay_loop(worker_arg_t *w, work_state_t *ws)
+{
+    const trace_replay_t *rp = g_replay;
+    const trace_t *tr = &rp->trace;
+    const uint64_t nsteps = tr->hdr.nsteps;
+    const int lane = w->trace_lane;
+    const long long start = ts_ns(&rp->start);
+    struct timespec now, cpu0, cpu1;
+
+    sleep_until_ns(start);
+
+    while (!stop_flag) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long long since = ts_ns(&now) - start;
+        uint64_t s = since > 0 ? (uint64_t)(since / rp->step_ns) : 0;
+        if (s >= nsteps) break;
+
+        long long step_start = start + (long long)s * rp->step_ns;
+        long long step_end = step_start + rp->step_ns;
+        double u = tr->util[s * tr->hdr.ncpus + lane] / 2.0;
+        workload_t k = trace_replay_kernel(rp, u);
+        if (g_guard.enabled) {
+            u *= __atomic_load_n(&g_guard.duty_pm, __ATOMIC_RELAXED) / 1000.0;
+            k = guard_kernel(k);
+        }
+        long long busy_end = step_start + (long long)(u / 100.0 * rp->step_ns);
+
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu0);
+        while (!stop_flag) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (ts_ns(&now) >= busy_end) break;
+            uint64_t ops = run_work_slice(k, ws);
+            if (ops) __atomic_fetch_add(&w->ops_done, ops, __ATOMIC_RELAXED);
+        }
+        sleep_until_ns(step_end);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu1);
+
+        rp->achieved[(size_t)lane * nsteps + s] =
+            (float)(100.0 * (ts_ns(&cpu1) - ts_ns(&cpu0)) / rp->step_ns);
+    }
+
+    while (!stop_flag) safe_nanosleep(0, CONTROL_PERIOD_MS * 1000000L);
+}
+
+/* Fidelity: achieved vs recorded util per lane-step and for the
+ * whole-machine load shape (mean over lanes per step). */
+void trace_replay_report(FILE *f) {
+    const trace_replay_t *rp = g_replay;
+    const trace_t *tr = &rp->trace;
+    const uint64_t nsteps = tr->hdr.nsteps;
+    double abs_sum = 0.0, sq_sum = 0.0, bias = 0.0, max_err = 0.0;
+    double shape_abs = 0.0;
+    long n = 0, within5 = 0, shape_n = 0, missed = 0;
+
+    for (uint64_t s = 0; s < nsteps; ++s) {
+        double rec_sum = 0.0, ach_sum = 0.0;
+        int lanes_ok = 0;
+        for (int l = 0; l < rp->nlanes; ++l) {
+            float a = rp->achieved[(size_t)l * nsteps + s];
+            if (isnan(a)) { missed++; continue; }
+            double r = tr->util[s * tr->hdr.ncpus + l] / 2.0;
+            double e = a - r;
+            abs_sum += fabs(e);
+            sq_sum += e * e;
+            bias += e;
+            if (fabs(e) > max_err) max_err = fabs(e);
+            if (fabs(e) <= 5.0) within5++;
+            rec_sum += r;
+            ach_sum += a;
+            lanes_ok++;
+            n++;
+        }
+        if (lanes_ok > 0) {
+            shape_abs += fabs(ach_sum - rec_sum) / lanes_ok;
+            shape_n++;
+        }
+    }
+
+    fprintf(f, "\n=== Trace Replay Fidelity ===\n");
+    fprintf(f, "  Trace          : %d lanes x %" PRIu64 " steps, step %.2f ms (%.2fx speed)\n",
+            rp->nlanes, nsteps, rp->step_ns / 1e6, rp->speed);
+    if (n == 0) {
+        fprintf(f, "  No steps replayed\n=============================\n");
+        return;
+    }
+    fprintf(f, "  Lane-steps     : %ld replayed, %ld missed\n", n, missed);
+    fprintf(f, "  Util error     : MAE %.2f pts  RMSE %.2f pts  bias %+.2f pts  max %.1f pts\n",
+            abs_sum / n, sqrt(sq_sum / n), bias / n, max_err);
+    fprintf(f, "  Within ±5 pts  : %.1f%% of lane-steps\n", 100.0 * within5 / n);
+    fprintf(f, "  Load shape MAE : %.2f pts (mean over lanes per step)\n",
+            shape_n ? shape_abs / shape_n : 0.0);
+
+    int lanes_to_show = rp->nlanes < MAX_CORES_TO_LOG ? rp->nlanes : MAX_CORES_TO_LOG;
+    fprintf(f, "  %-5s %-5s %10s %10s %8s\n", "Lane", "CPU", "Recorded", "Achieved", "MAE");
+    for (int l = 0; l < lanes_to_show; ++l) {
+        double rs = 0.0, as = 0.0, es = 0.0;
+        long c = 0;
+        for (uint64_t s = 0; s < nsteps; ++s) {
+            float a = rp->achieved[(size_t)l * nsteps + s];
+            if (isnan(a)) continue;
+            double r = tr->util[s * tr->hdr.ncpus + l] / 2.0;
+            rs += r; as += a; es += fabs(a - r); c++;
+        }
+        if (c == 0) continue;
+        fprintf(f, "  %-5d %-5d %9.2f%% %9.2f%% %8.2f\n", l, rp->cpu_map[l], rs / c, as / c, es / c);
+    }
+    fprintf(f, "=============================\n");
+}
+
+void trace_replay_free(void) {
+    if (!g_replay) return;
+    free(g_replay->trace.util);
+    free(g_replay->trace.freq_mhz);
+    free(g_replay->cpu_map);
+    free(g_replay->achieved);
+    free(g_replay);
+    g_replay = NULL;
+}
+
+void print_record_usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s --record-trace FILE --duration T [--trace-step-ms N] [--trace-freq]\n"
+        "\n"
+        "  --duration T         Recording length (e.g. 600, 10m, 2h)\n"
+        "  --trace-step-ms N    Sampling step in ms (default %d)\n"
+        "  --trace-freq         Also record scaling_cur_freq per CPU\n"
+        "\n"
+        "/proc/stat advances in USER_HZ ticks (usually 10 ms), so per-CPU\n"
+        "values at 10 ms steps are quantized to a few levels.\n",
+        prog, TRACE_DEFAULT_STEP_MS);
+}
+
+int trace_record_main(int argc, char **argv) {
+    const char *path = NULL;
+    long duration = -1, step_ms = TRACE_DEFAULT_STEP_MS;
+    int with_freq = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--record-trace") == 0 && i + 1 < argc) { path = argv[++i]; continue; }
+        if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) { duration = parse_duration_seconds(argv[++i]); continue; }
+        if (strcmp(argv[i], "--trace-step-ms") == 0 && i + 1 < argc) { step_ms = atol(argv[++i]); continue; }
+        if (strcmp(argv[i], "--trace-freq") == 0) { with_freq = 1; continue; }
+        if (strcmp(argv[i], "--help") == 0) { print_record_usage(argv[0]); return 1; }
+
+        fprintf(stderr, "Unknown or malformed record argument: %s\n", argv[i]);
+        print_record_usage(argv[0]);
+        return 1;
+    }
+
+    if (!path || duration <= 0 || step_ms < 1 || step_ms > 60000) {
+        print_record_usage(argv[0]);
+        return 1;
+    }
+
+    collect_machine_fingerprint(&g_fingerprint);
+    signal(SIGINT, sigint_handler);
+    signal(SIGTERM, sigint_handler);
+    return trace_record(path, duration, step_ms, with_freq);
+}
+
+/***********************************************************
+ *                  Sweep Point Window
+ * smt-matrix, ctx-switch, tlb-sweep, copy-sweep, fp-assist and
+ * frontend-sweep measure each point the same way: start the
+ * workers, warm up, open a window (clock, RAPL, APERF/MPERF),
+ * sleep, close it and stop the workers. stop_flag is re-armed
+ * for every point, so a SIGINT/SIGTERM that lands between points
+ * is only visible in user_stop_flag; begin and end check both.
+ ***********************************************************/
+typedef struct {
+    const int *cpus;            /* CPUs whose frequency is sampled; may be NULL */
+    int ncpu;
+    rapl_state_t *rapl;         /* NULL = no power */
+    int use_msr;
+    double base_freq_mhz;
+    struct timespec t0, t1;
+    double freq_mhz;            /* mean over cpus at close, 0 = unknown */
+} sweep_point_t;
+
+/* Before any per-point setup: -1 once the user asked to stop, else 0 with
+ * stop_flag armed for the workers */
+static int sweep_point_begin(void) {
+    if (user_stop_flag) return -1;
+    stop_flag = 0;
+    return 0;
+}
+
+/* After warmup: start the measured window over cpus[0..ncpu) */
+static void sweep_point_open(sweep_point_t *sp, const int *cpus, int ncpu, rapl_state_t *rapl, int use_msr,
+                             double base_freq_mhz) {
+    memset(sp, 0, sizeof(*sp));
+    sp->cpus = cpus;
+    sp->ncpu = ncpu;
+    sp->rapl = rapl;
+    sp->use_msr = use_msr;
+    sp->base_freq_mhz = base_freq_mhz;
+    clock_gettime(CLOCK_MONOTONIC, &sp->t0);
+    if (sp->use_msr)
+        for (int i = 0; i < sp->ncpu; ++i) calculate_frequency_mhz(sp->cpus[i], sp->base_freq_mhz);
+    if (sp->rapl) rapl_read_power(sp->rapl, NULL, NULL, NULL);
+}
+
+/* Sleep through the window; returns its length in seconds. The caller
+ * reads its own counters right after, before sweep_point_close. */
+static double sweep_point_wait(sweep_point_t *sp, double seconds) {
+    safe_nanosleep((long)seconds, (long)((seconds - (long)seconds) * 1e9));
+    clock_gettime(CLOCK_MONOTONIC, &sp->t1);
+    return (sp->t1.tv_sec - sp->t0.tv_sec) + (sp->t1.tv_nsec - sp->t0.tv_nsec) / 1e9;
+}
+
+/* Power over the window (any of the outputs may be NULL) and mean frequency */
+static void sweep_point_close(sweep_point_t *sp, double *pkg_w, double *pp0_w, double *dram_w) {
+    if (sp->rapl) rapl_read_power(sp->rapl, pkg_w, pp0_w, dram_w);
+    double fsum = 0.0;
+    int fcnt = 0;
+    for (int i = 0; i < sp->ncpu; ++i) {
+        double mhz = -1.0;
+        long hz = 0;
+        if (sp->use_msr) mhz = calculate_frequency_mhz(sp->cpus[i], sp->base_freq_mhz);
+        if (mhz <= 0 && read_scaling_cur_freq(sp->cpus[i], &hz) == 0 && hz > 0) mhz = hz / 1000.0;
+        if (mhz > 0) { fsum += mhz; fcnt++; }
+    }
+    sp->freq_mhz = fcnt ? fsum / fcnt : 0.0;
+}
+
+/* Stop the workers (the caller joins them); 1 if the point was cut short */
+static int sweep_point_end(void) {
+    int aborted = stop_flag || user_stop_flag;
+    stop_flag = 1;
+    return aborted;
+}
+
+/***********************************************************
+ *         SMT Co-scheduling Interference Matrix
+ *
+ * Runs each kernel alone on one SMT sibling, then every kernel
+ * pair with one kernel per sibling of the same physical core,
+ * and reports each thread's slowdown vs running alone together
+ * with frequency and package power per pair. Rates are counted
+ * in work-unit slices so a few seconds resolve slow SIMD units.
+ ***********************************************************/
+#define SMT_MAX_KERNELS 16
+#define SMT_WARMUP_NS 500000000L
+
+typedef struct {
+    int cpu;
+    workload_t type;
+    _Atomic uint64_t slices;
+} smt_thread_arg_t;
+
+typedef struct {
+    double rate[2];         /* work units per second per thread */
+    double freq_mhz;
+    double pkg_watts;
+} smt_sample_t;
+
+static void *smt_thread(void *arg) {
+    smt_thread_arg_t *a = (smt_thread_arg_t *)arg;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(a->cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+        fprintf(stderr, "Warning: could not pin SMT thread to cpu%d\n", a->cpu);
+
+    work_state_t ws;
+    if (work_state_init(&ws, a->cpu) == 0) {
+        while (!stop_flag) {
+            run_work_slice(a->type, &ws);
+            __atomic_fetch_add(&a->slices, 1, __ATOMIC_RELAXED);
+        }
+    }
+    work_state_free(&ws);
+    return NULL;
+}
+
+/* Parse a sysfs cpu list ("0,64" or "0-1") */
+static int parse_cpu_list(const char *s, int *out, int max) {
+    int n = 0;
+    while (*s && n < max) {
+        char *end;
+        long a = strtol(s, &end, 10);
+        if (end == s) break;
+        long b = a;
+        if (*end == '-') b = strtol(end + 1, &end, 10);
+        for (long c = a; c <= b && n < max; ++c) out[n++] = (int)c;
+        s = (*end == ',') ? end + 1 : end;
+        if (*s == '\n') break;
+    }
+    return n;
+}
+
+/* Find two SMT siblings of one physical core within our affinity mask.
+ * want_cpu >= 0 selects that CPU's core; otherwise the first eligible core. */
+int smt_find_siblings(int want_cpu, int pair[2]) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return -1;
+
+    for (int cpu = (want_cpu >= 0 ? want_cpu : 0); cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            if (want_cpu >= 0) return -1;
+            continue;
+        }
+
+        char path[128], buf[256];
+        int sib[8];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+        int n = read_sysfs_str(path, buf, sizeof(buf)) == 0 ? parse_cpu_list(buf, sib, 8) : 0;
+
+        for (int i = 0; i < n; ++i) {
+            if (sib[i] == cpu || !CPU_ISSET(sib[i], &allowed)) continue;
+            pair[0] = cpu;
+            pair[1] = sib[i];
+            return 0;
+        }
+        if (want_cpu >= 0) return -1;
+    }
+    return -1;
+}
+
+static int smt_measure(const int cpu[2], const workload_t type[2], int nthr, double seconds,
+                       rapl_state_t *rapl, int use_msr, double base_freq_mhz, smt_sample_t *out)
+{
+    smt_thread_arg_t args[2];
+    pthread_t tids[2];
+    int started = 0;
+
+    memset(out, 0, sizeof(*out));
+    out->pkg_watts = NAN;
+    if (sweep_point_begin() != 0) return -1;
+
+    for (int t = 0; t < nthr; ++t) {
+        args[t].cpu = cpu[t];
+        args[t].type = type[t];
+        __atomic_store_n(&args[t].slices, 0, __ATOMIC_RELAXED);
+        if (pthread_create(&tids[t], NULL, smt_thread, &args[t]) != 0) break;
+        started++;
+    }
+
+    safe_nanosleep(0, SMT_WARMUP_NS);
+
+    sweep_point_t sp;
+    uint64_t s0[2] = {0}, s1[2] = {0};
+    for (int t = 0; t < started; ++t) s0[t] = __atomic_load_n(&args[t].slices, __ATOMIC_RELAXED);
+    sweep_point_open(&sp, cpu, nthr, rapl, use_msr, base_freq_mhz);
+    double dt = sweep_point_wait(&sp, seconds);
+    for (int t = 0; t < started; ++t) s1[t] = __atomic_load_n(&args[t].slices, __ATOMIC_RELAXED);
+    sweep_point_close(&sp, &out->pkg_watts, NULL, NULL);
+    out->freq_mhz = sp.freq_mhz;
+
+    int aborted = sweep_point_end();
+    for (int t = 0; t < started; ++t) pthread_join(tids[t], NULL);
+
+    for (int t = 0; t < started && dt > 0; ++t)
+        out->rate[t] = (double)(s1[t] - s0[t]) / dt / WORK_SLICES_PER_UNIT;
+
+    return (aborted || started < nthr) ? -1 : 0;
+}
+
+int smt_matrix_run(const smt_spec_t *spec, long duration, int enable_rapl,
+                   int use_msr, double base_freq_mhz, const char *log_path)
+{
+    static const workload_t all[] = { W_INT, W_FLOAT, W_SSE, W_AVX, W_AVX2, W_AVX512,
+                                      W_MEMBW, W_CRYPTO, W_GATHER };
+    workload_t kern[SMT_MAX_KERNELS];
+    int nk = 0;
+
+    if (spec->kernels) {
+        char *copy = strdup(spec->kernels);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok && nk < SMT_MAX_KERNELS;
+             tok = strtok_r(NULL, ",", &save)) {
+            workload_t t = parse_type(tok);
+            if (t == W_AUTO || t == W_MIXED) {
+                fprintf(stderr, "Error: invalid --smt-kernels entry '%s'\n", tok);
+                free(copy);
+                return 1;
+            }
+            kern[nk++] = t;
+        }
+        free(copy);
+    } else {
+        for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); ++i) kern[nk++] = all[i];
+    }
+
+    /* Drop kernels this CPU cannot run */
+    int kept = 0;
+    for (int i = 0; i < nk; ++i) {
+        if (workload_supported(kern[i])) kern[kept++] = kern[i];
+        else printf("Info: %s not supported on this CPU, skipped\n", workload_str(kern[i]));
+    }
+    nk = kept;
+    if (nk == 0) {
+        fprintf(stderr, "Error: no runnable kernels for the SMT matrix\n");
+        return 1;
+    }
+
+    int cpu[2];
+    if (spec->pair) {
+        if (sscanf(spec->pair, "%d,%d", &cpu[0], &cpu[1]) != 2 || cpu[0] < 0 || cpu[1] < 0) {
+            fprintf(stderr, "Error: --smt-pair expects A,B\n");
+            return 1;
+        }
+        printf("Warning: --smt-pair bypasses topology; cpu%d/cpu%d may not be siblings\n", cpu[0], cpu[1]);
+    } else if (smt_find_siblings(spec->core_cpu, cpu) != 0) {
+        fprintf(stderr, "Error: no SMT sibling pair found%s (SMT disabled or restricted affinity?)\n",
+                spec->core_cpu >= 0 ? " for --smt-cpu" : "");
+        return 1;
+    }
+
+    rapl_state_t rapl;
+    rapl_state_t *rp = NULL;
+    if (enable_rapl) {
+        if (rapl_init(&rapl, cpu[0]) == 0) rp = &rapl;
+        else rapl_warn_unavailable("Power not measured.");
+    }
+
+    int npairs = nk * (nk + 1) / 2;
+    printf("\n=== SMT Interference Matrix: cpu%d + cpu%d, %d kernels, %d pairs, %ld s each ===\n",
+           cpu[0], cpu[1], nk, npairs, duration);
+    printf("Estimated time: %ld s\n", (long)((nk + npairs) * (duration + SMT_WARMUP_NS / 1e9)));
+
+    smt_sample_t alone[SMT_MAX_KERNELS];
+    smt_sample_t *pair = calloc((size_t)nk * nk, sizeof(smt_sample_t));
+    if (!pair) {
+        if (rp) rapl_close(rp);
+        return 1;
+    }
+
+    int rc = 0;
+    for (int i = 0; i < nk && rc == 0; ++i) {
+        workload_t t[2] = { kern[i], kern[i] };
+        printf("  alone   %-7s ...", workload_str(kern[i]));
+        fflush(stdout);
+        if (smt_measure(cpu, t, 1, duration, rp, use_msr, base_freq_mhz, &alone[i]) != 0) rc = 1;
+        else printf(" %.2f units/s\n", alone[i].rate[0]);
+    }
+
+    for (int i = 0; i < nk && rc == 0; ++i) {
+        for (int j = i; j < nk && rc == 0; ++j) {
+            workload_t t[2] = { kern[i], kern[j] };
+            smt_sample_t *p = &pair[i * nk + j];
+            printf("  paired  %-7s + %-7s ...", workload_str(kern[i]), workload_str(kern[j]));
+            fflush(stdout);
+            if (smt_measure(cpu, t, 2, duration, rp, use_msr, base_freq_mhz, p) != 0) {
+                rc = 1;
+                break;
+            }
+            if (i != j) {
+                pair[j * nk + i] = *p;
+                pair[j * nk + i].rate[0] = p->rate[1];
+                pair[j * nk + i].rate[1] = p->rate[0];
+            }
+            printf(" %.2f / %.2f units/s\n", p->rate[0], p->rate[1]);
+        }
+    }
+    if (rp) rapl_close(rp);
+
+    if (rc != 0) {
+        fprintf(stderr, "SMT matrix interrupted\n");
+        free(pair);
+        return 1;
+    }
+
+    /* slowdown[i][j] = alone rate of i / rate of i while j runs on the sibling */
+    printf("\nSlowdown of ROW kernel co-running with COLUMN kernel (1.00 = no interference)\n");
+    printf("%-8s", "");
+    for (int j = 0; j < nk; ++j) printf(" %7s", workload_str(kern[j]));
+    printf("\n");
+    for (int i = 0; i < nk; ++i) {
+        printf("%-8s", workload_str(kern[i]));
+        for (int j = 0; j < nk; ++j) {
+            double r = pair[i * nk + j].rate[0];
+            if (i == j) r = (pair[i * nk + j].rate[0] + pair[i * nk + j].rate[1]) / 2.0;
+            printf(" %6.2fx", r > 0 ? alone[i].rate[0] / r : 0.0);
+        }
+        printf("\n");
+    }
+
+    printf("\n%-8s %-8s %9s %9s %10s %9s\n", "A", "B", "Slow A", "Slow B", "SMT yield", "Freq MHz");
+    for (int i = 0; i < nk; ++i) {
+        for (int j = i; j < nk; ++j) {
+            const smt_sample_t *p = &pair[i * nk + j];
+            double ra = alone[i].rate[0] > 0 ? p->rate[0] / alone[i].rate[0] : 0.0;
+            double rb = alone[j].rate[0] > 0 ? p->rate[1] / alone[j].rate[0] : 0.0;
+            printf("%-8s %-8s %8.2fx %8.2fx %9.2f", workload_str(kern[i]), workload_str(kern[j]),
+                   ra > 0 ? 1.0 / ra : 0.0, rb > 0 ? 1.0 / rb : 0.0, ra + rb);
+            if (p->freq_mhz > 0) printf(" %9.0f", p->freq_mhz);
+            else printf(" %9s", "-");
+            if (!isnan(p->pkg_watts)) printf("  %.2f W", p->pkg_watts);
+            printf("\n");
+        }
+    }
+    printf("SMT yield = sum of both threads' throughput relative to alone (>1.00 = SMT gain)\n");
+
+    if (log_path) {
+        FILE *f = fopen(log_path, "w");
+        if (!f) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(f, "# coreburner smt-matrix\n# cpus=%d,%d\n# seconds=%ld\n", cpu[0], cpu[1], duration);
+            write_machine_fingerprint(f, "# fp.", &g_fingerprint);
+            fprintf(f, "kernel_a,kernel_b,rate_a,rate_b,alone_a,alone_b,slowdown_a,slowdown_b,smt_yield,freq_mhz,pkg_watts\n");
+            for (int i = 0; i < nk; ++i) {
+                fprintf(f, "%s,,%.4f,,%.4f,,1,,,%.0f,", workload_str(kern[i]), alone[i].rate[0],
+                        alone[i].rate[0], alone[i].freq_mhz);
+                if (!isnan(alone[i].pkg_watts)) fprintf(f, "%.2f", alone[i].pkg_watts);
+                fprintf(f, "\n");
+            }
+            for (int i = 0; i < nk; ++i) {
+                for (int j = i; j < nk; ++j) {
+                    const smt_sample_t *p = &pair[i * nk + j];
+                    double ra = alone[i].rate[0] > 0 ? p->rate[0] / alone[i].rate[0] : 0.0;
+                    double rb = alone[j].rate[0] > 0 ? p->rate[1] / alone[j].rate[0] : 0.0;
+                    fprintf(f, "%s,%s,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.0f,",
+                            workload_str(kern[i]), workload_str(kern[j]), p->rate[0], p->rate[1],
+                            alone[i].rate[0], alone[j].rate[0],
+                            ra > 0 ? 1.0 / ra : 0.0, rb > 0 ? 1.0 / rb : 0.0, ra + rb, p->freq_mhz);
+                    if (!isnan(p->pkg_watts)) fprintf(f, "%.2f", p->pkg_watts);
+                    fprintf(f, "\n");
+                }
+            }
+            fclose(f);
+            printf("\nSMT matrix written to %s\n", log_path);
+        }
+    }
+
+    free(pair);
+    return 0;
+}
+
+/***********************************************************
+ *          Context-Switch & XSAVE Cost per Vector ISA
+ *
+ * --mode ctx-switch pins --single-core-threads threads to one
+ * CPU and forces a switch per iteration (futex ring ping-pong
+ * or sched_yield). The switching syscall is issued from inline
+ * asm right after loading xmm/ymm/zmm registers (or an AMX
+ * tile), so the thread is descheduled with that XSAVE state
+ * dirty; compiler-inserted vzeroupper cannot clean it first.
+ ***********************************************************/
+#define CTX_FUTEX 0
+#define CTX_YIELD 1
+#define CTX_WARMUP_NS 300000000L
+#define CTX_WAIT_TIMEOUT_NS 50000000L
+#define ARCH_REQ_XCOMP_PERM 0x1023
+#define XFEATURE_XTILEDATA 18
+
+typedef enum { VS_NONE, VS_SSE, VS_AVX, VS_AVX512, VS_AMX, VS_COUNT } vector_state_t;
+
+static const char *vector_state_names[VS_COUNT] = { "NONE", "SSE", "AVX", "AVX512", "AMX" };
+
+typedef struct {
+    int idx;
+    int nthr;
+    int cpu;
+    vector_state_t vs;
+    int method;
+    int work_slices;            /* kernel slices between switches, 0 = pure switch */
+    int *words;                 /* futex ring, one word per thread */
+    _Atomic uint64_t switches;
+    _Atomic uint64_t slices;
+} ctx_thread_arg_t;
+
+typedef struct {
+    double switches_per_sec;
+    double latency_ns;
+    double units_per_sec;       /* kernel throughput, all threads */
+} ctx_sample_t;
+
+static int parse_vector_state(const char *s, vector_state_t *out) {
+    for (int v = 0; v < VS_COUNT; ++v)
+        if (str_case_equal(s, vector_state_names[v])) { *out = (vector_state_t)v; return 0; }
+    return -1;
+}
+
+/* Kernel used for the work between switches */
+static workload_t vector_state_kernel(vector_state_t vs) {
+    switch (vs) {
+    case VS_SSE:    return W_SSE;
+    case VS_AVX:    return cpu_supports_avx2() ? W_AVX2 : W_AVX;
+    case VS_AVX512: return W_AVX512;
+    default:        return W_INT;   /* AMX: tiles only hold state, no tile compute */
+    }
+}
+
+static int amx_permitted = -1;
+
+static int vector_state_supported(vector_state_t vs) {
+    switch (vs) {
+    case VS_SSE:
+        return cpu_supports_sse();
+#ifdef __AVX__
+    case VS_AVX:
+        return cpu_supports_avx();
+#endif
+#ifdef __AVX512F__
+    case VS_AVX512:
+        return cpu_supports_avx512();
+#endif
+#ifdef __AMX_TILE__
+    case VS_AMX: {
+        if (amx_permitted < 0) {
+            unsigned int eax, ebx, ecx, edx;
+            int has_tile = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && ((edx >> 24) & 1);
+            /* Tile data is opt-in per process on Linux */
+            amx_permitted = has_tile && syscall(SYS_arch_prctl, ARCH_REQ_XCOMP_PERM, XFEATURE_XTILEDATA) == 0;
+        }
+        return amx_permitted;
+    }
+#endif
+    case VS_NONE:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* XSAVE bytes a dirty thread of this class carries (legacy + header + components) */
+static unsigned int vector_state_xsave_bytes(vector_state_t vs) {
+    static const int comps[VS_COUNT][4] = {
+        { 0 }, { 0 }, { 2 }, { 2, 5, 6, 7 }, { 17, 18 }
+    };
+    unsigned int bytes = 512 + 64;
+    for (int i = 0; i < 4 && comps[vs][i]; ++i) {
+        unsigned int eax, ebx, ecx, edx;
+        if (__get_cpuid_count(0xD, comps[vs][i], &eax, &ebx, &ecx, &edx)) bytes += eax;
+    }
+    if (vs == VS_AMX) bytes += vector_state_xsave_bytes(VS_AVX512);
+    return bytes;
+}
+
+static unsigned int ctx_xsave_max(const vector_state_t *vs, int n) {
+    unsigned int m = 0;
+    for (int i = 0; i < n; ++i) {
+        unsigned int b = vector_state_xsave_bytes(vs[i]);
+        if (b > m) m = b;
+    }
+    return m;
+}
+
+/* Issue a syscall with the given vector state live in registers */
+static long ctx_syscall(vector_state_t vs, const float *dirty, long nr, long a1, long a2, long a3, long a4) {
+    register long r10 __asm__("r10") = a4;
+    long ret;
+
+    switch (vs) {
+#ifdef __AVX512F__
+    case VS_AVX512:
+        __asm__ volatile(
+            "vmovups 0(%[b]), %%zmm8\n\t"
+            "vmovups 64(%[b]), %%zmm9\n\t"
+            "vmovups 128(%[b]), %%zmm10\n\t"
+            "vmovups 192(%[b]), %%zmm11\n\t"
+            "vmovups 256(%[b]), %%zmm12\n\t"
+            "vmovups 320(%[b]), %%zmm13\n\t"
+            "vmovups 384(%[b]), %%zmm14\n\t"
+            "vmovups 448(%[b]), %%zmm15\n\t"
+            "vmovups 0(%[b]), %%zmm16\n\t"
+            "vmovups 64(%[b]), %%zmm17\n\t"
+            "vmovups 128(%[b]), %%zmm18\n\t"
+            "vmovups 192(%[b]), %%zmm19\n\t"
+            "vmovups 256(%[b]), %%zmm20\n\t"
+            "vmovups 320(%[b]), %%zmm21\n\t"
+            "vmovups 384(%[b]), %%zmm22\n\t"
+            "vmovups 448(%[b]), %%zmm23\n\t"
+            "vmovups 0(%[b]), %%zmm24\n\t"
+            "vmovups 64(%[b]), %%zmm25\n\t"
+            "vmovups 128(%[b]), %%zmm26\n\t"
+            "vmovups 192(%[b]), %%zmm27\n\t"
+            "vmovups 256(%[b]), %%zmm28\n\t"
+            "vmovups 320(%[b]), %%zmm29\n\t"
+            "vmovups 384(%[b]), %%zmm30\n\t"
+            "vmovups 448(%[b]), %%zmm31\n\t"
+            "syscall"
+            : "=a"(ret)
+            : "0"(nr), "D"(a1), "S"(a2), "d"(a3), "r"(r10), [b] "r"(dirty)
+            : "rcx", "r11", "memory",
+              "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15",
+              "xmm16", "xmm17", "xmm18", "xmm19", "xmm20", "xmm21", "xmm22", "xmm23",
+              "xmm24", "xmm25", "xmm26", "xmm27", "xmm28", "xmm29", "xmm30", "xmm31");
+        return ret;
+#endif
+#ifdef __AVX__
+    case VS_AVX:
+        __asm__ volatile(
+            "vmovups 0(%[b]), %%ymm8\n\t"
+            "vmovups 32(%[b]), %%ymm9\n\t"
+            "vmovups 64(%[b]), %%ymm10\n\t"
+            "vmovups 96(%[b]), %%ymm11\n\t"
+            "vmovups 128(%[b]), %%ymm12\n\t"
+            "vmovups 160(%[b]), %%ymm13\n\t"
+            "vmovups 192(%[b]), %%ymm14\n\t"
+            "vmovups 224(%[b]), %%ymm15\n\t"
+            "syscall"
+            : "=a"(ret)
+            : "0"(nr), "D"(a1), "S"(a2), "d"(a3), "r"(r10), [b] "r"(dirty)
+            : "rcx", "r11", "memory",
+              "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15");
+        return ret;
+#endif
+    case VS_SSE:
+        __asm__ volatile(
+            "movups 0(%[b]), %%xmm8\n\t"
+            "movups 16(%[b]), %%xmm9\n\t"
+            "movups 32(%[b]), %%xmm10\n\t"
+            "movups 48(%[b]), %%xmm11\n\t"
+            "movups 64(%[b]), %%xmm12\n\t"
+            "movups 80(%[b]), %%xmm13\n\t"
+            "movups 96(%[b]), %%xmm14\n\t"
+            "movups 112(%[b]), %%xmm15\n\t"
+            "syscall"
+            : "=a"(ret)
+            : "0"(nr), "D"(a1), "S"(a2), "d"(a3), "r"(r10), [b] "r"(dirty)
+            : "rcx", "r11", "memory",
+              "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15");
+        return ret;
+    default:
+#ifdef __AMX_TILE__
+        /* Tile registers are never touched by compiler code, so a plain
+         * syscall after tileloadd is descheduled with TILEDATA in use */
+        if (vs == VS_AMX) _tile_loadd(0, dirty, 64);
+#endif
+        return syscall(nr, a1, a2, a3, a4);
+    }
+}
+
+#ifdef __AMX_TILE__
+static void ctx_amx_config(void) {
+    struct { uint8_t palette, start_row, reserved[14]; uint16_t colsb[16]; uint8_t rows[16]; }
+        __attribute__((aligned(64))) cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.palette = 1;
+    cfg.colsb[0] = 64;
+    cfg.rows[0] = 16;
+    _tile_loadconfig(&cfg);
+}
+#endif
+
+static void *ctx_thread(void *arg) {
+    ctx_thread_arg_t *a = (ctx_thread_arg_t *)arg;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(a->cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+        fprintf(stderr, "Warning: could not pin ctx-switch thread to cpu%d\n", a->cpu);
+
+    work_state_t ws;
+    float dirty[256] __attribute__((aligned(64)));   /* 1KB: 16 rows of 64 bytes */
+    for (int i = 0; i < 256; ++i) dirty[i] = 1.0f + i;
+    workload_t kernel = vector_state_kernel(a->vs);
+
+#ifdef __AMX_TILE__
+    if (a->vs == VS_AMX) ctx_amx_config();
+#endif
+
+    if (work_state_init(&ws, a->cpu) == 0) {
+        struct timespec timeout = { 0, CTX_WAIT_TIMEOUT_NS };
+        int next = (a->idx + 1) % a->nthr;
+
+        while (!stop_flag) {
+            if (a->method == CTX_FUTEX) {
+                while (!stop_flag && __atomic_load_n(&a->words[a->idx], __ATOMIC_ACQUIRE) == 0)
+                    ctx_syscall(a->vs, dirty, SYS_futex, (long)&a->words[a->idx],
+                                FUTEX_WAIT_PRIVATE, 0, (long)&timeout);
+                if (stop_flag) break;
+                __atomic_store_n(&a->words[a->idx], 0, __ATOMIC_RELAXED);
+            }
+
+            for (int s = 0; s < a->work_slices; ++s) run_work_slice(kernel, &ws);
+            if (a->work_slices)
+                __atomic_fetch_add(&a->slices, a->work_slices, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&a->switches, 1, __ATOMIC_RELAXED);
+
+            if (a->method == CTX_FUTEX) {
+                __atomic_store_n(&a->words[next], 1, __ATOMIC_RELEASE);
+                syscall(SYS_futex, &a->words[next], FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+            } else if (a->nthr > 1) {
+                ctx_syscall(a->vs, dirty, SYS_sched_yield, 0, 0, 0, 0);
+            }
+        }
+    }
+
+#ifdef __AMX_TILE__
+    if (a->vs == VS_AMX) _tile_release();
+#endif
+    work_state_free(&ws);
+    return NULL;
+}
+
+/* Run nthr threads with the given per-thread vector states for `seconds` */
+static int ctx_measure(int cpu, int nthr, const vector_state_t *vs, int method, int work_slices,
+                       double seconds, ctx_sample_t *out)
+{
+    ctx_thread_arg_t *args = calloc(nthr, sizeof(*args));
+    pthread_t *tids = calloc(nthr, sizeof(*tids));
+    int *words = calloc(nthr, sizeof(int));
+    int started = 0;
+
+    memset(out, 0, sizeof(*out));
+    if (!args || !tids || !words || sweep_point_begin() != 0) {
+        free(args); free(tids); free(words);
+        return -1;
+    }
+
+    words[0] = 1;   /* token starts at thread 0 */
+    for (int t = 0; t < nthr; ++t) {
+        args[t].idx = t;
+        args[t].nthr = nthr;
+        args[t].cpu = cpu;
+        args[t].vs = vs[t];
+        args[t].method = method;
+        args[t].work_slices = work_slices;
+        args[t].words = words;
+        if (pthread_create(&tids[t], NULL, ctx_thread, &args[t]) != 0) break;
+        started++;
+    }
+
+    safe_nanosleep(0, CTX_WARMUP_NS);
+
+    sweep_point_t sp;
+    uint64_t sw0 = 0, sl0 = 0, sw1 = 0, sl1 = 0;
+    for (int t = 0; t < started; ++t) {
+        sw0 += __atomic_load_n(&args[t].switches, __ATOMIC_RELAXED);
+        sl0 += __atomic_load_n(&args[t].slices, __ATOMIC_RELAXED);
+    }
+    sweep_point_open(&sp, NULL, 0, NULL, 0, 0.0);
+    double dt = sweep_point_wait(&sp, seconds);
+    for (int t = 0; t < started; ++t) {
+        sw1 += __atomic_load_n(&args[t].switches, __ATOMIC_RELAXED);
+        sl1 += __atomic_load_n(&args[t].slices, __ATOMIC_RELAXED);
+    }
+
+    int aborted = sweep_point_end();
+    for (int t = 0; t < nthr; ++t) {
+        __atomic_store_n(&words[t], 1, __ATOMIC_RELEASE);
+        syscall(SYS_futex, &words[t], FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+    }
+    for (int t = 0; t < started; ++t) pthread_join(tids[t], NULL);
+
+    if (dt > 0) {
+        out->switches_per_sec = (sw1 - sw0) / dt;
+        out->latency_ns = sw1 > sw0 ? dt * 1e9 / (sw1 - sw0) : 0.0;
+        out->units_per_sec = (double)(sl1 - sl0) / dt / WORK_SLICES_PER_UNIT;
+    }
+
+    int rc = (aborted || started < nthr) ? -1 : 0;
+    free(args); free(tids); free(words);
+    return rc;
+}
+
+int ctx_switch_run(const ctx_spec_t *spec, int cpu, int nthr, long duration, const char *log_path) {
+    if (nthr < 2) {
+        fprintf(stderr, "Error: ctx-switch needs --single-core-threads >= 2\n");
+        return 1;
+    }
+
+    int method = CTX_FUTEX;
+    if (spec->method && str_case_equal(spec->method, "yield")) method = CTX_YIELD;
+    else if (spec->method && !str_case_equal(spec->method, "futex")) {
+        fprintf(stderr, "Error: --switch-method must be futex or yield\n");
+        return 1;
+    }
+
+    /* Scenarios: one per supported vector state, or a single custom mix */
+    int nscen = 0;
+    vector_state_t *scen = calloc((size_t)(VS_COUNT + 1) * nthr, sizeof(vector_state_t));
+    char labels[VS_COUNT + 1][64];
+    if (!scen) return 1;
+
+    if (spec->thread_types) {
+        vector_state_t list[64];
+        int nl = 0;
+        char *copy = strdup(spec->thread_types);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok && nl < 64; tok = strtok_r(NULL, ",", &save)) {
+            if (parse_vector_state(tok, &list[nl]) != 0 || !vector_state_supported(list[nl])) {
+                fprintf(stderr, "Error: --thread-types entry '%s' invalid or unsupported "
+                                "(NONE|SSE|AVX|AVX512|AMX)\n", tok);
+                free(copy);
+                free(scen);
+                return 1;
+            }
+            nl++;
+        }
+        free(copy);
+        if (nl == 0) { free(scen); return 1; }
+        for (int t = 0; t < nthr; ++t) scen[t] = list[t % nl];
+        snprintf(labels[0], sizeof(labels[0]), "%.63s", spec->thread_types);
+        nscen = 1;
+    } else {
+        for (int v = 0; v < VS_COUNT; ++v) {
+            if (!vector_state_supported((vector_state_t)v)) {
+                printf("Info: %s state not available, skipped\n", vector_state_names[v]);
+                continue;
+            }
+            for (int t = 0; t < nthr; ++t) scen[nscen * nthr + t] = (vector_state_t)v;
+            snprintf(labels[nscen], sizeof(labels[nscen]), "%s", vector_state_names[v]);
+            nscen++;
+        }
+    }
+
+    printf("\n=== Context-Switch / XSAVE Cost: cpu%d, %d threads, %s, %d slice(s) per switch, %ld s each ===\n",
+           cpu, nthr, method == CTX_FUTEX ? "futex ring" : "sched_yield", spec->work_slices, duration);
+
+    ctx_sample_t pure[VS_COUNT + 1], alone[VS_COUNT + 1], loaded[VS_COUNT + 1];
+    double alone_rate[VS_COUNT] = { 0 };
+    int rc = 0;
+    for (int s = 0; s < nscen && rc == 0; ++s) {
+        vector_state_t *vs = &scen[s * nthr];
+        printf("  %-12s ...", labels[s]);
+        fflush(stdout);
+        /* pure switch latency, then the switched kernel throughput */
+        if (ctx_measure(cpu, nthr, vs, method, 0, duration, &pure[s]) != 0 ||
+            ctx_measure(cpu, nthr, vs, method, spec->work_slices, duration, &loaded[s]) != 0) {
+            rc = 1;
+            break;
+        }
+        /* Unswitched reference: each state alone on the CPU. Threads take
+         * equal turns, so the expected mixed rate is the harmonic mean. */
+        double inv = 0.0;
+        memset(&alone[s], 0, sizeof(alone[s]));
+        for (int t = 0; t < nthr && rc == 0 && spec->work_slices > 0; ++t) {
+            if (alone_rate[vs[t]] == 0.0) {
+                ctx_sample_t one;
+                if (ctx_measure(cpu, 1, &vs[t], CTX_YIELD, spec->work_slices, duration, &one) != 0) rc = 1;
+                alone_rate[vs[t]] = one.units_per_sec;
+            }
+            if (alone_rate[vs[t]] > 0) inv += 1.0 / alone_rate[vs[t]];
+        }
+        if (rc != 0) break;
+        if (inv > 0) alone[s].units_per_sec = nthr / inv;
+        printf(" %.0f ns/switch\n", pure[s].latency_ns);
+    }
+
+    if (rc != 0) {
+        fprintf(stderr, "ctx-switch benchmark interrupted\n");
+        free(scen);
+        return 1;
+    }
+
+    printf("\n%-12s %9s %12s %11s %9s %12s %12s %7s\n", "State", "XSAVE B", "Switches/s",
+           "Latency ns", "vs first", "Alone u/s", "Switched u/s", "Loss %");
+    for (int s = 0; s < nscen; ++s) {
+        double loss = alone[s].units_per_sec > 0
+            ? 100.0 * (1.0 - loaded[s].units_per_sec / alone[s].units_per_sec) : 0.0;
+        printf("%-12s %9u %12.0f %11.0f %+8.0f%% %12.2f %12.2f %7.2f\n", labels[s],
+               ctx_xsave_max(&scen[s * nthr], nthr), pure[s].switches_per_sec, pure[s].latency_ns,
+               pure[0].latency_ns > 0 ? 100.0 * (pure[s].latency_ns / pure[0].latency_ns - 1.0) : 0.0,
+               alone[s].units_per_sec, loaded[s].units_per_sec, loss);
+    }
+    printf("Loss = kernel throughput lost vs the same states run unswitched (includes the switch work itself)\n");
+
+    if (log_path) {
+        FILE *f = fopen(log_path, "w");
+        if (!f) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(f, "# coreburner ctx-switch\n# cpu=%d\n# threads=%d\n# method=%s\n# work_slices=%d\n",
+                    cpu, nthr, method == CTX_FUTEX ? "futex" : "yield", spec->work_slices);
+            write_machine_fingerprint(f, "# fp.", &g_fingerprint);
+            fprintf(f, "state,xsave_bytes,switches_per_sec,latency_ns,alone_units_per_sec,"
+                       "switched_units_per_sec,loss_pct\n");
+            for (int s = 0; s < nscen; ++s) {
+                double loss = alone[s].units_per_sec > 0
+                    ? 100.0 * (1.0 - loaded[s].units_per_sec / alone[s].units_per_sec) : 0.0;
+                fprintf(f, "\"%s\",%u,%.0f,%.1f,%.4f,%.4f,%.2f\n", labels[s],
+                        ctx_xsave_max(&scen[s * nthr], nthr), pure[s].switches_per_sec,
+                        pure[s].latency_ns, alone[s].units_per_sec, loaded[s].units_per_sec, loss);
+            }
+            fclose(f);
+            printf("\nctx-switch results written to %s\n", log_path);
+        }
+    }
+
+    free(scen);
+    return 0;
+}
+
+/***********************************************************
+ *              TLB Huge-Page Comparison Sweep
+ * --mode tlb-sweep: for each footprint and page size, one
+ * pinned thread chases the TLB buffer while the main thread
+ * counts dTLB misses on it (perf) and package power (RAPL).
+ ***********************************************************/
+#define TLB_WARMUP_NS 300000000L
+#define TLB_DEFAULT_SWEEP_FOOTPRINTS "64M,1G,8G"
+#define TLB_DEFAULT_SWEEP_PAGES "4k,thp,2m,1g"
+
+typedef struct {
+    int cpu;
+    void **start;
+    _Atomic pid_t tid;
+    _Atomic uint64_t loads;
+} tlb_thread_arg_t;
+
+typedef struct {
+    uint64_t bytes;
+    tlb_page_t kind;
+    int ok;                     /* 0 = skipped (allocation refused or too large) */
+    double loads_per_sec;
+    double miss_per_load;       /* dTLB load misses per access, <0 = no perf */
+    double pkg_watts;
+    double huge_pct;            /* THP only: share of the footprint THP-backed */
+} tlb_sample_t;
+
+static void *tlb_thread(void *arg) {
+    tlb_thread_arg_t *a = (tlb_thread_arg_t *)arg;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(a->cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+        fprintf(stderr, "Warning: could not pin TLB thread to cpu%d\n", a->cpu);
+    __atomic_store_n(&a->tid, (pid_t)syscall(SYS_gettid), __ATOMIC_RELEASE);
+
+    void **p = a->start;
+    while (!stop_flag) {
+        p = tlb_chase(p, TLB_LOADS_PER_SLICE);
+        __atomic_fetch_add(&a->loads, TLB_LOADS_PER_SLICE, __ATOMIC_RELAXED);
+    }
+    a->start = p;   /* keep the chase live */
+    return NULL;
+}
+
+static int tlb_measure(int cpu, uint64_t bytes, tlb_page_t kind, double seconds,
+                       rapl_state_t *rapl, tlb_sample_t *out)
+{
+    tlb_buf_t buf;
+    memset(out, 0, sizeof(*out));
+    out->bytes = bytes;
+    out->kind = kind;
+    out->miss_per_load = -1.0;
+    if (sweep_point_begin() != 0) return -1;
+
+    long thp_before = tlb_thp_kb();
+    if (tlb_buf_build(&buf, bytes, kind, (unsigned int)bytes) != 0) {
+        printf("    %s: cannot map %s pages (%s), skipped\n", tlb_page_names[kind],
+               tlb_page_names[kind], strerror(errno));
+        return 0;
+    }
+    if (kind == TLB_PAGE_THP) {
+        long thp_after = tlb_thp_kb();
+        if (thp_before >= 0 && thp_after >= 0)
+            out->huge_pct = 100.0 * (double)(thp_after - thp_before) * 1024.0 / (double)buf.map_len;
+    }
+
+    tlb_thread_arg_t arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.cpu = cpu;
+    arg.start = buf.start;
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, tlb_thread, &arg) != 0) {
+        tlb_buf_free(&buf);
+        return -1;
+    }
+    safe_nanosleep(0, TLB_WARMUP_NS);
+
+    perf_group_t pg;
+    perf_group_init(&pg, __atomic_load_n(&arg.tid, __ATOMIC_ACQUIRE), -1);
+    perf_group_add(&pg, "dtlb-load-misses", PERF_TYPE_HW_CACHE,
+                   PERF_HW_CACHE(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                 PERF_COUNT_HW_CACHE_RESULT_MISS));
+    perf_group_add(&pg, "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    perf_group_start(&pg);
+
+    sweep_point_t sp;
+    uint64_t l0 = __atomic_load_n(&arg.loads, __ATOMIC_RELAXED), l1;
+    sweep_point_open(&sp, NULL, 0, rapl, 0, 0.0);
+    double dt = sweep_point_wait(&sp, seconds);
+    l1 = __atomic_load_n(&arg.loads, __ATOMIC_RELAXED);
+    sweep_point_close(&sp, &out->pkg_watts, NULL, NULL);
+
+    double vals[PERF_GROUP_MAX];
+    int have_perf = perf_group_read(&pg, vals) == 0;
+    perf_group_stop(&pg);
+
+    int aborted = sweep_point_end();
+    pthread_join(tid, NULL);
+    tlb_buf_free(&buf);
+
+    if (dt > 0) out->loads_per_sec = (double)(l1 - l0) / dt;
+    int mi = perf_group_has(&pg, "dtlb-load-misses");
+    if (have_perf && mi >= 0 && l1 > l0) {
+        /* counters started after warmup; scale misses to the load window */
+        out->miss_per_load = vals[mi] / (double)(l1 - l0);
+    }
+    perf_group_close(&pg);
+    out->ok = 1;
+    return aborted ? -1 : 0;
+}
+
+int tlb_sweep_run(const tlb_spec_t *spec, int cpu, long duration, int enable_rapl, const char *log_path) {
+    if (cpu < 0 || cpu >= get_affinity_cpu_count()) {
+        fprintf(stderr, "Error: --single-core-id=%d out of range for tlb-sweep\n", cpu);
+        return 1;
+    }
+
+    uint64_t foot[32];
+    tlb_page_t kinds[TLB_PAGE_KINDS];
+    int nfoot = 0, nkinds = 0;
+    char *copy = strdup(spec->footprints ? spec->footprints : TLB_DEFAULT_SWEEP_FOOTPRINTS);
+    char *save = NULL;
+    for (char *tok = strtok_r(copy, ",", &save); tok && nfoot < 32; tok = strtok_r(NULL, ",", &save)) {
+        if (parse_size_bytes(tok, &foot[nfoot]) != 0 || foot[nfoot] < 2 * TLB_NODE_STRIDE) {
+            fprintf(stderr, "Error: bad --tlb-footprint entry '%s'\n", tok);
+            free(copy);
+            return 1;
+        }
+        nfoot++;
+    }
+    free(copy);
+    copy = strdup(spec->pages ? spec->pages : TLB_DEFAULT_SWEEP_PAGES);
+    for (char *tok = strtok_r(copy, ",", &save); tok && nkinds < TLB_PAGE_KINDS; tok = strtok_r(NULL, ",", &save)) {
+        if (parse_tlb_page(tok, &kinds[nkinds]) != 0) {
+            fprintf(stderr, "Error: bad --tlb-pages entry '%s' (4k|thp|2m|1g)\n", tok);
+            free(copy);
+            return 1;
+        }
+        nkinds++;
+    }
+    free(copy);
+
+    rapl_state_t rapl;
+    rapl_state_t *rp = NULL;
+    double idle_watts = NAN;
+    if (enable_rapl) {
+        if (rapl_init(&rapl, cpu) == 0) {
+            rp = &rapl;
+            /* idle reference for the power delta */
+            safe_nanosleep(1, 0);
+            if (rapl_read_power(rp, &idle_watts, NULL, NULL) != 0) idle_watts = NAN;
+        } else {
+            rapl_warn_unavailable("Power not measured.");
+        }
+    }
+
+    printf("\n=== TLB / Page-Walk Sweep: cpu%d, %ld s per point ===\n", cpu, duration);
+
+    tlb_sample_t *res = calloc((size_t)nfoot * nkinds, sizeof(tlb_sample_t));
+    if (!res) { if (rp) rapl_close(rp); return 1; }
+
+    int rc = 0;
+    for (int f = 0; f < nfoot && rc == 0; ++f) {
+        long avail_kb = read_meminfo_kb("MemAvailable");
+        printf("  footprint %.0f MB\n", foot[f] / 1048576.0);
+        for (int k = 0; k < nkinds; ++k) {
+            tlb_sample_t *r = &res[f * nkinds + k];
+            r->bytes = foot[f];
+            r->kind = kinds[k];
+            /* hugetlb pages come from the reserved pool, not MemAvailable */
+            if (kinds[k] == TLB_PAGE_2M || kinds[k] == TLB_PAGE_1G) {
+                size_t huge = kinds[k] == TLB_PAGE_1G ? (1UL << 30) : (1UL << 21);
+                long pool_kb = read_hugepages_free_kb(huge);
+                if (pool_kb >= 0 && (foot[f] + huge - 1) / huge * (huge >> 10) > (uint64_t)pool_kb) {
+                    printf("    %s: footprint exceeds the %ld MB of free %s hugepages, skipped\n",
+                           tlb_page_names[kinds[k]], pool_kb / 1024, tlb_page_names[kinds[k]]);
+                    continue;
+                }
+            } else if (avail_kb > 0 && foot[f] / 1024 > (uint64_t)avail_kb * 9 / 10) {
+                printf("    %s: footprint exceeds 90%% of MemAvailable, skipped\n", tlb_page_names[kinds[k]]);
+                continue;
+            }
+            if (tlb_measure(cpu, foot[f], kinds[k], duration, rp, r) != 0) { rc = 1; break; }
+            if (r->ok) printf("    %-4s %10.1f M loads/s\n", tlb_page_names[kinds[k]], r->loads_per_sec / 1e6);
+        }
+    }
+    int have_rapl = rp != NULL;
+    if (rp) rapl_close(rp);
+
+    if (rc != 0) {
+        fprintf(stderr, "tlb-sweep interrupted\n");
+        free(res);
+        return 1;
+    }
+
+    printf("\n%10s %5s %11s %8s %10s %8s %8s %8s %7s\n", "Footprint", "Page", "M loads/s", "ns/load",
+           "Miss/load", "vs 4k", "Pkg W", "dPkg W", "Huge %");
+    for (int f = 0; f < nfoot; ++f) {
+        const tlb_sample_t *ref = NULL;
+        for (int k = 0; k < nkinds; ++k)
+            if (res[f * nkinds + k].ok && res[f * nkinds + k].kind == TLB_PAGE_4K) ref = &res[f * nkinds + k];
+        for (int k = 0; k < nkinds; ++k) {
+            const tlb_sample_t *r = &res[f * nkinds + k];
+            if (!r->ok) continue;
+            char miss[16], vs[16], pw[16], dpw[16], huge[16];
+            snprintf(miss, sizeof(miss), r->miss_per_load >= 0 ? "%.4f" : "n/a", r->miss_per_load);
+            snprintf(vs, sizeof(vs), ref && ref->loads_per_sec > 0 ? "%.2fx" : "-",
+                     ref ? r->loads_per_sec / ref->loads_per_sec : 0.0);
+            snprintf(pw, sizeof(pw), have_rapl ? "%.2f" : "n/a", r->pkg_watts);
+            snprintf(dpw, sizeof(dpw), have_rapl && !isnan(idle_watts) ? "%+.2f" : "n/a", r->pkg_watts - idle_watts);
+            snprintf(huge, sizeof(huge), r->kind == TLB_PAGE_THP ? "%.0f" : "-", r->huge_pct);
+            printf("%8.0fMB %5s %11.2f %8.2f %10s %8s %8s %8s %7s\n", r->bytes / 1048576.0,
+                   tlb_page_names[r->kind], r->loads_per_sec / 1e6,
+                   r->loads_per_sec > 0 ? 1e9 / r->loads_per_sec : 0.0, miss, vs, pw, dpw, huge);
+        }
+    }
+    printf("dPkg W = package power over the idle reference; Huge %% = THP-backed share\n");
+
+    if (log_path) {
+        FILE *lf = fopen(log_path, "w");
+        if (!lf) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(lf, "# coreburner tlb-sweep\n# cpu=%d\n# duration=%ld\n", cpu, duration);
+            if (!isnan(idle_watts)) fprintf(lf, "# idle_pkg_watts=%.3f\n", idle_watts);
+            write_machine_fingerprint(lf, "# fp.", &g_fingerprint);
+            fprintf(lf, "footprint_bytes,page,loads_per_sec,ns_per_load,dtlb_miss_per_load,pkg_watts,huge_pct\n");
+            for (int i = 0; i < nfoot * nkinds; ++i) {
+                const tlb_sample_t *r = &res[i];
+                if (!r->ok) continue;
+                fprintf(lf, "%" PRIu64 ",%s,%.0f,%.3f,", r->bytes, tlb_page_names[r->kind], r->loads_per_sec,
+                        r->loads_per_sec > 0 ? 1e9 / r->loads_per_sec : 0.0);
+                if (r->miss_per_load >= 0) fprintf(lf, "%.6f", r->miss_per_load);
+                fprintf(lf, ",");
+                if (have_rapl) fprintf(lf, "%.3f", r->pkg_watts);
+                fprintf(lf, ",");
+                if (r->kind == TLB_PAGE_THP) fprintf(lf, "%.1f", r->huge_pct);
+                fprintf(lf, "\n");
+            }
+            fclose(lf);
+            printf("\ntlb-sweep results written to %s\n", log_path);
+        }
+    }
+
+    free(res);
+    return 0;
+}
+
+/***********************************************************
+ *               Copy / Fill Bandwidth Sweep
+ * --mode copy-sweep: every method x transfer size, with
+ * --copy-threads workers each copying between private
+ * buffers. Reports GB/s, package / core / DRAM power and the
+ * average core frequency, relative to the first method.
+ ***********************************************************/
+#define COPY_WARMUP_NS 200000000L
+#define COPY_DEFAULT_SWEEP_SIZES "4K,64K,1M,16M,256M"
+
+typedef struct {
+    int cpu;
+    int method;
+    size_t size;
+    char *src;
+    char *dst;
+    _Atomic uint64_t bytes;
+} copy_thread_arg_t;
+
+typedef struct {
+    int method;
+    size_t size;
+    int ok;
+    double gbps;
+    double freq_mhz;
+    double pkg_watts;
+    double pp0_watts;
+    double dram_watts;
+} copy_sample_t;
+
+static void *copy_thread(void *arg) {
+    copy_thread_arg_t *a = (copy_thread_arg_t *)arg;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(a->cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+        fprintf(stderr, "Warning: could not pin copy thread to cpu%d\n", a->cpu);
+
+    copy_fn_t fn = copy_methods[a->method].fn;
+    /* repeat small transfers so the counter update is amortized */
+    int reps = a->size >= COPY_CHUNK_MAX ? 1 : (int)(COPY_CHUNK_MAX / a->size);
+    while (!stop_flag) {
+        for (int r = 0; r < reps; ++r) fn(a->dst, a->src, a->size);
+        __atomic_fetch_add(&a->bytes, (uint64_t)a->size * reps, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+static int copy_measure(const int *cpus, int nthr, int method, size_t size, double seconds,
+                        rapl_state_t *rapl, int use_msr, double base_freq_mhz, copy_sample_t *out)
+{
+    copy_thread_arg_t *args = calloc(nthr, sizeof(*args));
+    pthread_t *tids = calloc(nthr, sizeof(*tids));
+    int started = 0, rc = 0;
+
+    memset(out, 0, sizeof(*out));
+    out->method = method;
+    out->size = size;
+    if (!args || !tids || sweep_point_begin() != 0) { free(args); free(tids); return -1; }
+
+    for (int t = 0; t < nthr; ++t) {
+        args[t].cpu = cpus[t];
+        args[t].method = method;
+        args[t].size = size;
+        args[t].src = aligned_alloc(64, size);
+        args[t].dst = aligned_alloc(64, size);
+        if (!args[t].src || !args[t].dst) {
+            fprintf(stderr, "Warning: cannot allocate 2x%zu bytes for copy thread\n", size);
+            rc = 1;
+            break;
+        }
+        memset(args[t].src, 0x33, size);
+        memset(args[t].dst, 0, size);
+    }
+
+    if (rc == 0) {
+        for (int t = 0; t < nthr; ++t) {
+            if (pthread_create(&tids[t], NULL, copy_thread, &args[t]) != 0) break;
+            started++;
+        }
+        safe_nanosleep(0, COPY_WARMUP_NS);
+
+        sweep_point_t sp;
+        uint64_t b0 = 0, b1 = 0;
+        for (int t = 0; t < started; ++t) b0 += __atomic_load_n(&args[t].bytes, __ATOMIC_RELAXED);
+        sweep_point_open(&sp, cpus, started, rapl, use_msr, base_freq_mhz);
+        double dt = sweep_point_wait(&sp, seconds);
+        for (int t = 0; t < started; ++t) b1 += __atomic_load_n(&args[t].bytes, __ATOMIC_RELAXED);
+        sweep_point_close(&sp, &out->pkg_watts, &out->pp0_watts, &out->dram_watts);
+        out->freq_mhz = sp.freq_mhz;
+
+        if (sweep_point_end() || started < nthr) rc = -1;
+        for (int t = 0; t < started; ++t) pthread_join(tids[t], NULL);
+
+        if (dt > 0) out->gbps = (double)(b1 - b0) / dt / 1e9;
+        out->ok = 1;
+    }
+
+    for (int t = 0; t < nthr; ++t) { free(args[t].src); free(args[t].dst); }
+    free(args);
+    free(tids);
+    return rc < 0 ? -1 : 0;
+}
+
+int copy_sweep_run(const copy_spec_t *spec, int first_cpu, long duration, int enable_rapl,
+                   int use_msr, double base_freq_mhz, const char *log_path)
+{
+    int methods[COPY_METHODS];
+    size_t sizes[32];
+    int nm = 0, ns = 0;
+    char *save = NULL;
+
+    char *copy = strdup(spec->methods ? spec->methods : "libc,movsb,avx2,avx512,nt,stosb,ntfill");
+    for (char *tok = strtok_r(copy, ",", &save); tok && nm < COPY_METHODS; tok = strtok_r(NULL, ",", &save)) {
+        int m = parse_copy_method(tok);
+        if (m < 0) {
+            fprintf(stderr, "Error: unknown --copy-method '%s'\n", tok);
+            free(copy);
+            return 1;
+        }
+        if (!copy_method_supported(m)) {
+            printf("Info: %s not supported on this CPU, skipped\n", copy_methods[m].name);
+            continue;
+        }
+        methods[nm++] = m;
+    }
+    free(copy);
+
+    copy = strdup(spec->sizes ? spec->sizes : COPY_DEFAULT_SWEEP_SIZES);
+    for (char *tok = strtok_r(copy, ",", &save); tok && ns < 32; tok = strtok_r(NULL, ",", &save)) {
+        uint64_t b;
+        if (parse_size_bytes(tok, &b) != 0) {
+            fprintf(stderr, "Error: bad --copy-size entry '%s'\n", tok);
+            free(copy);
+            return 1;
+        }
+        sizes[ns++] = copy_round(b);
+    }
+    free(copy);
+    if (nm == 0 || ns == 0) return 1;
+
+    int nthr = spec->threads > 0 ? spec->threads : 1;
+    int *cpus = calloc(nthr, sizeof(int));
+    if (!cpus) return 1;
+    int avail = get_affinity_cpu_count();
+    /* --single-core-id names a CPU; with --spread the threads follow g_cpu_order from its position */
+    int first_pos = -1;
+    for (int i = 0; i < g_cpu_order_len && first_pos < 0; ++i)
+        if (g_cpu_order[i] == first_cpu) first_pos = i;
+    if (g_cpu_order_len && first_pos < 0) {
+        fprintf(stderr, "Warning: cpu%d not in the --spread order; starting at cpu%d\n", first_cpu, g_cpu_order[0]);
+        first_pos = 0;
+    }
+    for (int t = 0; t < nthr; ++t)
+        cpus[t] = g_cpu_order_len ? g_cpu_order[(first_pos + t) % g_cpu_order_len] : (first_cpu + t) % avail;
+
+    rapl_state_t rapl;
+    rapl_state_t *rp = NULL;
+    if (enable_rapl) {
+        if (rapl_init(&rapl, cpus[0]) == 0) rp = &rapl;
+        else rapl_warn_unavailable("Power not measured.");
+    }
+
+    printf("\n=== Copy / Fill Sweep: %d thread(s) from cpu%d, %ld s per point ===\n", nthr, cpus[0], duration);
+
+    copy_sample_t *res = calloc((size_t)nm * ns, sizeof(copy_sample_t));
+    int rc = 0;
+    for (int si = 0; si < ns && res && rc == 0; ++si) {
+        printf("  size %zu KB\n", sizes[si] / 1024);
+        for (int mi = 0; mi < nm; ++mi) {
+            copy_sample_t *r = &res[si * nm + mi];
+            if (copy_measure(cpus, nthr, methods[mi], sizes[si], duration, rp, use_msr, base_freq_mhz, r) != 0) {
+                rc = 1;
+                break;
+            }
+            if (r->ok) printf("    %-7s %8.2f GB/s\n", copy_methods[methods[mi]].name, r->gbps);
+        }
+    }
+    int have_rapl = rp != NULL;
+    if (rp) rapl_close(rp);
+
+    if (!res || rc != 0) {
+        fprintf(stderr, "copy-sweep interrupted\n");
+        free(res);
+        free(cpus);
+        return 1;
+    }
+
+    printf("\n%10s %-7s %9s %8s %9s %8s %8s %8s %8s\n", "Size", "Method", "GB/s", "vs 1st",
+           "MHz", "dMHz", "Pkg W", "Uncore W", "DRAM W");
+    for (int si = 0; si < ns; ++si) {
+        const copy_sample_t *ref = &res[si * nm];
+        for (int mi = 0; mi < nm; ++mi) {
+            const copy_sample_t *r = &res[si * nm + mi];
+            if (!r->ok) continue;
+            char pw[16], uw[16], dw[16], mhz[16], dmhz[16];
+            snprintf(mhz, sizeof(mhz), r->freq_mhz > 0 ? "%.0f" : "n/a", r->freq_mhz);
+            snprintf(dmhz, sizeof(dmhz), r->freq_mhz > 0 && ref->freq_mhz > 0 ? "%+.0f" : "n/a",
+                     r->freq_mhz - ref->freq_mhz);
+            snprintf(pw, sizeof(pw), have_rapl ? "%.2f" : "n/a", r->pkg_watts);
+            snprintf(uw, sizeof(uw), have_rapl ? "%.2f" : "n/a", r->pkg_watts - r->pp0_watts);
+            snprintf(dw, sizeof(dw), have_rapl ? "%.2f" : "n/a", r->dram_watts);
+            printf("%8zuKB %-7s %9.2f %7.2fx %9s %8s %8s %8s %8s\n", r->size / 1024,
+                   copy_methods[r->method].name, r->gbps, ref->gbps > 0 ? r->gbps / ref->gbps : 0.0,
+                   mhz, dmhz, pw, uw, dw);
+        }
+    }
+    printf("GB/s counts bytes written; Uncore W = package minus core (PP0) power\n");
+
+    if (log_path) {
+        FILE *lf = fopen(log_path, "w");
+        if (!lf) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(lf, "# coreburner copy-sweep\n# threads=%d\n# first_cpu=%d\n# duration=%ld\n",
+                    nthr, cpus[0], duration);
+            write_machine_fingerprint(lf, "# fp.", &g_fingerprint);
+            fprintf(lf, "size_bytes,method,fill,gbps,freq_mhz,pkg_watts,uncore_watts,dram_watts\n");
+            for (int i = 0; i < nm * ns; ++i) {
+                const copy_sample_t *r = &res[i];
+                if (!r->ok) continue;
+                fprintf(lf, "%zu,%s,%d,%.4f,", r->size, copy_methods[r->method].name,
+                        copy_methods[r->method].fill, r->gbps);
+                if (r->freq_mhz > 0) fprintf(lf, "%.1f", r->freq_mhz);
+                if (have_rapl)
+                    fprintf(lf, ",%.3f,%.3f,%.3f\n", r->pkg_watts, r->pkg_watts - r->pp0_watts, r->dram_watts);
+                else
+                    fprintf(lf, ",,,\n");
+            }
+            fclose(lf);
+            printf("\ncopy-sweep results written to %s\n", log_path);
+        }
+    }
+
+    free(res);
+    free(cpus);
+    return 0;
+}
+
+/***********************************************************
+ *               FP Assist (Denormal) Sweep
+ * --mode fp-assist: FLOAT/SSE/AVX next to their denormal
+ * variants under each --mxcsr setting, one pinned thread on
+ * --single-core-id. Assists come from a model-specific raw
+ * PMU event (override with --assist-event).
+ ***********************************************************/
+#define FPA_WARMUP_NS 200000000L
+
+typedef struct {
+    int cpu;
+    workload_t type;
+    unsigned int mxcsr;
+    _Atomic pid_t tid;          /* 0 until running, -1 = work_state_init failed */
+    _Atomic uint64_t slices;
+} fpa_thread_arg_t;
+
+typedef struct {
+    workload_t type;
+    int mxcsr_mode;
+    double units_per_sec;
+    double assists_per_sec;     /* <0 = not counted */
+    double ipc;                 /* <0 = not counted */
+    double freq_mhz;
+    double pkg_watts;
+    int ok;                     /* 0 = kernel thread could not start */
+} fpa_sample_t;
+
+/* Raw PERF_TYPE_RAW config for FP assists on this CPU, 0 if unknown */
+static uint64_t fp_assist_raw_event(void) {
+    if (strcmp(g_fingerprint.cpu_vendor, "GenuineIntel") != 0 || g_fingerprint.family != 6) return 0;
+    switch (g_fingerprint.model) {
+    case 0x4E: case 0x5E: case 0x55: case 0x8E: case 0x9E: case 0xA5: case 0xA6:
+        return 0x1ECA;      /* FP_ASSIST.ANY (Skylake .. Comet Lake, Cascade Lake) */
+    case 0x6A: case 0x6C: case 0x7D: case 0x7E: case 0x8C: case 0x8D: case 0x8F:
+    case 0x97: case 0x9A: case 0xA7: case 0xB7: case 0xBA: case 0xBF: case 0xCF:
+    case 0xAD: case 0xAE:
+        return 0x02C1;      /* ASSISTS.FP (Ice Lake and later P-cores) */
+    default:
+        return 0;
+    }
+}
+
+static void *fpa_thread(void *arg) {
+    fpa_thread_arg_t *a = (fpa_thread_arg_t *)arg;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(a->cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+        fprintf(stderr, "Warning: could not pin fp-assist thread to cpu%d\n", a->cpu);
+
+    work_state_t ws;
+    if (work_state_init(&ws, a->cpu) == 0) {
+        _mm_setcsr((_mm_getcsr() & ~(MXCSR_FTZ | MXCSR_DAZ)) | a->mxcsr);
+        __atomic_store_n(&a->tid, (pid_t)syscall(SYS_gettid), __ATOMIC_RELEASE);
+        while (!stop_flag) {
+            run_work_slice(a->type, &ws);
+            __atomic_fetch_add(&a->slices, 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        __atomic_store_n(&a->tid, (pid_t)-1, __ATOMIC_RELEASE);
+    }
+    work_state_free(&ws);
+    return NULL;
+}
+
+static int fpa_measure(int cpu, workload_t type, int mxcsr_mode, double seconds, uint64_t assist_cfg,
+                       rapl_state_t *rapl, int use_msr, double base_freq_mhz, fpa_sample_t *out)
+{
+    fpa_thread_arg_t arg;
+    memset(&arg, 0, sizeof(arg));
+    memset(out, 0, sizeof(*out));
+    out->type = type;
+    out->mxcsr_mode = mxcsr_mode;
+    out->assists_per_sec = -1.0;
+    out->ipc = -1.0;
+    arg.cpu = cpu;
+    arg.type = type;
+    arg.mxcsr = mxcsr_modes[mxcsr_mode].bits;
+
+    if (sweep_point_begin() != 0) return -1;
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, fpa_thread, &arg) != 0) return -1;
+    /* perf must attach to the kernel thread, never to pid 0 (this thread) */
+    pid_t ktid;
+    while ((ktid = __atomic_load_n(&arg.tid, __ATOMIC_ACQUIRE)) == 0 && !user_stop_flag)
+        safe_nanosleep(0, 1000000L);
+    if (ktid <= 0) {
+        int aborted = sweep_point_end();
+        pthread_join(tid, NULL);
+        return aborted ? -1 : 0;
+    }
+    safe_nanosleep(0, FPA_WARMUP_NS);
+
+    perf_group_t pg;
+    perf_group_init(&pg, ktid, -1);
+    perf_group_add(&pg, "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    perf_group_add(&pg, "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    if (assist_cfg) perf_group_add(&pg, "fp-assists", PERF_TYPE_RAW, assist_cfg);
+    perf_group_start(&pg);
+
+    sweep_point_t sp;
+    uint64_t s0 = __atomic_load_n(&arg.slices, __ATOMIC_RELAXED), s1;
+    sweep_point_open(&sp, &cpu, 1, rapl, use_msr, base_freq_mhz);
+    double dt = sweep_point_wait(&sp, seconds);
+    s1 = __atomic_load_n(&arg.slices, __ATOMIC_RELAXED);
+    sweep_point_close(&sp, &out->pkg_watts, NULL, NULL);
+    out->freq_mhz = sp.freq_mhz;
+
+    double vals[PERF_GROUP_MAX];
+    int have_perf = perf_group_read(&pg, vals) == 0;
+    perf_group_stop(&pg);
+
+    int aborted = sweep_point_end();
+    pthread_join(tid, NULL);
+
+    out->ok = 1;
+    if (dt > 0) {
+        out->units_per_sec = (double)(s1 - s0) / dt / WORK_SLICES_PER_UNIT;
+        int ci = perf_group_has(&pg, "cycles"), ii = perf_group_has(&pg, "instructions");
+        int ai = perf_group_has(&pg, "fp-assists");
+        if (have_perf && ci >= 0 && ii >= 0 && vals[ci] > 0) out->ipc = vals[ii] / vals[ci];
+        /* perf counts from start to read, which brackets the window within a few ms */
+        if (have_perf && ai >= 0) out->assists_per_sec = vals[ai] / dt;
+    }
+    perf_group_close(&pg);
+    return aborted ? -1 : 0;
+}
+
+int fp_assist_run(int cpu, long duration, const char *assist_event, int enable_rapl,
+                  int use_msr, double base_freq_mhz, const char *log_path)
+{
+    static const workload_t pairs[][2] = { { W_FLOAT, W_DFLOAT }, { W_SSE, W_DSSE }, { W_AVX, W_DAVX } };
+    const int npairs = (int)(sizeof(pairs) / sizeof(pairs[0]));
+    const int modes[] = { MXCSR_MODE_OFF, MXCSR_MODE_FTZ_DAZ };
+    const int nmodes = 2;
+
+    if (cpu < 0 || cpu >= get_affinity_cpu_count()) {
+        fprintf(stderr, "Error: --single-core-id=%d out of range for fp-assist\n", cpu);
+        return 1;
+    }
+
+    uint64_t assist_cfg = fp_assist_raw_event();
+    if (assist_event) assist_cfg = strtoull(assist_event, NULL, 0);
+    if (!assist_cfg)
+        printf("Info: no known FP-assist PMU event for this CPU; use --assist-event 0xUUEE\n");
+
+    rapl_state_t rapl;
+    rapl_state_t *rp = NULL;
+    if (enable_rapl) {
+        if (rapl_init(&rapl, cpu) == 0) rp = &rapl;
+        else rapl_warn_unavailable("Power not measured.");
+    }
+
+    printf("\n=== FP Assist Sweep: cpu%d, %ld s per point, assist event 0x%" PRIx64 " ===\n",
+           cpu, duration, assist_cfg);
+
+    fpa_sample_t res[3][2][2];
+    int rc = 0, done = 0;
+    memset(res, 0, sizeof(res));
+    for (int p = 0; p < npairs && rc == 0; ++p) {
+        if (!workload_supported(pairs[p][0])) continue;
+        for (int m = 0; m < nmodes && rc == 0; ++m)
+            for (int v = 0; v < 2 && rc == 0; ++v) {
+                if (fpa_measure(cpu, pairs[p][v], modes[m], duration, assist_cfg, rp, use_msr,
+                                base_freq_mhz, &res[p][m][v]) != 0) rc = 1;
+                else if (!res[p][m][v].ok) printf("  %-7s %-8s could not start, skipped\n",
+                                                  workload_str(pairs[p][v]), mxcsr_modes[modes[m]].name);
+                else printf("  %-7s %-8s %10.3f units/s\n", workload_str(pairs[p][v]),
+                            mxcsr_modes[modes[m]].name, res[p][m][v].units_per_sec);
+            }
+        done = p + 1;
+    }
+    int have_rapl = rp != NULL;
+    if (rp) rapl_close(rp);
+
+    if (rc != 0) {
+        fprintf(stderr, "fp-assist sweep interrupted\n");
+        return 1;
+    }
+
+    printf("\n%-7s %-8s %10s %9s %12s %6s %8s %8s\n", "Kernel", "MXCSR", "Units/s", "vs normal",
+           "Assists/s", "IPC", "MHz", "Pkg W");
+    for (int p = 0; p < done; ++p) {
+        if (!workload_supported(pairs[p][0])) continue;
+        for (int m = 0; m < nmodes; ++m)
+            for (int v = 0; v < 2; ++v) {
+                const fpa_sample_t *r = &res[p][m][v];
+                const fpa_sample_t *n = &res[p][m][0];
+                if (!r->ok) continue;
+                char as[20], ipc[12], mhz[12], pw[12];
+                snprintf(as, sizeof(as), r->assists_per_sec >= 0 ? "%.3g" : "n/a", r->assists_per_sec);
+                snprintf(ipc, sizeof(ipc), r->ipc >= 0 ? "%.2f" : "n/a", r->ipc);
+                snprintf(mhz, sizeof(mhz), r->freq_mhz > 0 ? "%.0f" : "n/a", r->freq_mhz);
+                snprintf(pw, sizeof(pw), have_rapl ? "%.2f" : "n/a", r->pkg_watts);
+                printf("%-7s %-8s %10.3f %8.3fx %12s %6s %8s %8s\n", workload_str(r->type),
+                       mxcsr_modes[r->mxcsr_mode].name, r->units_per_sec,
+                       n->units_per_sec > 0 ? r->units_per_sec / n->units_per_sec : 0.0, as, ipc, mhz, pw);
+            }
+    }
+    printf("vs normal = throughput relative to the normal kernel under the same MXCSR\n");
+
+    if (log_path) {
+        FILE *lf = fopen(log_path, "w");
+        if (!lf) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(lf, "# coreburner fp-assist\n# cpu=%d\n# duration=%ld\n# assist_event=0x%" PRIx64 "\n",
+                    cpu, duration, assist_cfg);
+            write_machine_fingerprint(lf, "# fp.", &g_fingerprint);
+            fprintf(lf, "kernel,mxcsr,units_per_sec,assists_per_sec,ipc,freq_mhz,pkg_watts\n");
+            for (int p = 0; p < done; ++p) {
+                if (!workload_supported(pairs[p][0])) continue;
+                for (int m = 0; m < nmodes; ++m)
+                    for (int v = 0; v < 2; ++v) {
+                        const fpa_sample_t *r = &res[p][m][v];
+                        if (!r->ok) continue;
+                        fprintf(lf, "%s,%s,%.4f,", workload_str(r->type), mxcsr_modes[r->mxcsr_mode].name,
+                                r->units_per_sec);
+                        if (r->assists_per_sec >= 0) fprintf(lf, "%.0f", r->assists_per_sec);
+                        fprintf(lf, ",");
+                        if (r->ipc >= 0) fprintf(lf, "%.3f", r->ipc);
+                        fprintf(lf, ",");
+                        if (r->freq_mhz > 0) fprintf(lf, "%.1f", r->freq_mhz);
+                        fprintf(lf, ",");
+                        if (have_rapl) fprintf(lf, "%.3f", r->pkg_watts);
+                        fprintf(lf, "\n");
+                    }
+            }
+            fclose(lf);
+            printf("\nfp-assist results written to %s\n", log_path);
+        }
+    }
+    return 0;
+}
+
+/***********************************************************
+ *               Front-End Footprint Sweep
+ * --mode frontend-sweep: every --fe-footprint x --fe-random
+ * point on one pinned thread. Reports block calls/s, IPC,
+ * branch-miss rate and MPKI, L1i MPKI (perf_event), core MHz
+ * and package power.
+ ***********************************************************/
+#define FE_WARMUP_NS 300000000L
+#define FE_DEFAULT_SWEEP_FOOTPRINTS "16K,256K,4M,32M"
+#define FE_DEFAULT_SWEEP_RANDOM "0,10,50"
+
+typedef struct {
+    int cpu;
+    const fe_image_t *im;
+    _Atomic pid_t tid;
+    _Atomic uint64_t calls;
+} fe_thread_arg_t;
+
+typedef struct {
+    size_t footprint;
+    int random_pct;
+    double calls_per_sec;
+    double ipc;                 /* <0 = not counted */
+    double br_miss_pct;
+    double br_mpki;
+    double l1i_mpki;
+    double freq_mhz;
+    double pkg_watts;
+} fe_sample_t;
+
+static void *fe_thread(void *arg) {
+    fe_thread_arg_t *a = (fe_thread_arg_t *)arg;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(a->cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+        fprintf(stderr, "Warning: could not pin frontend thread to cpu%d\n", a->cpu);
+
+    uint64_t rng = 0x2545F4914F6CDD1DULL ^ (uint64_t)a->cpu, acc = 1;
+    uint32_t cursor = 0;
+    __atomic_store_n(&a->tid, (pid_t)syscall(SYS_gettid), __ATOMIC_RELEASE);
+    while (!stop_flag) {
+        acc = fe_run(a->im, &rng, &cursor, acc, FE_CALLS_PER_SLICE);
+        __atomic_fetch_add(&a->calls, FE_CALLS_PER_SLICE, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+static int fe_measure(int cpu, const fe_image_t *im, double seconds, rapl_state_t *rapl,
+                      int use_msr, double base_freq_mhz, fe_sample_t *out)
+{
+    fe_thread_arg_t arg;
+    memset(&arg, 0, sizeof(arg));
+    out->ipc = out->br_miss_pct = out->br_mpki = out->l1i_mpki = -1.0;
+    arg.cpu = cpu;
+    arg.im = im;
+
+    if (sweep_point_begin() != 0) return -1;
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, fe_thread, &arg) != 0) return -1;
+    safe_nanosleep(0, FE_WARMUP_NS);
+
+    perf_group_t pg;
+    perf_group_init(&pg, __atomic_load_n(&arg.tid, __ATOMIC_ACQUIRE), -1);
+    perf_group_add(&pg, "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    perf_group_add(&pg, "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    perf_group_add(&pg, "branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+    perf_group_add(&pg, "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    perf_group_add(&pg, "l1i-misses", PERF_TYPE_HW_CACHE,
+                   PERF_HW_CACHE(PERF_COUNT_HW_CACHE_L1I, PERF_COUNT_HW_CACHE_OP_READ,
+                                 PERF_COUNT_HW_CACHE_RESULT_MISS));
+    perf_group_start(&pg);
+
+    sweep_point_t sp;
+    uint64_t c0 = __atomic_load_n(&arg.calls, __ATOMIC_RELAXED), c1;
+    sweep_point_open(&sp, &cpu, 1, rapl, use_msr, base_freq_mhz);
+    double dt = sweep_point_wait(&sp, seconds);
+    c1 = __atomic_load_n(&arg.calls, __ATOMIC_RELAXED);
+    sweep_point_close(&sp, &out->pkg_watts, NULL, NULL);
+    out->freq_mhz = sp.freq_mhz;
+
+    double vals[PERF_GROUP_MAX];
+    int have_perf = perf_group_read(&pg, vals) == 0;
+    perf_group_stop(&pg);
+
+    int aborted = sweep_point_end();
+    pthread_join(tid, NULL);
+
+    if (dt > 0) out->calls_per_sec = (double)(c1 - c0) / dt;
+    if (have_perf) {
+        int ci = perf_group_has(&pg, "cycles"), ii = perf_group_has(&pg, "instructions");
+        int bi = perf_group_has(&pg, "branches"), mi = perf_group_has(&pg, "branch-misses");
+        int li = perf_group_has(&pg, "l1i-misses");
+        double kinst = ii >= 0 ? vals[ii] / 1000.0 : 0.0;
+        if (ci >= 0 && ii >= 0 && vals[ci] > 0) out->ipc = vals[ii] / vals[ci];
+        if (bi >= 0 && mi >= 0 && vals[bi] > 0) out->br_miss_pct = 100.0 * vals[mi] / vals[bi];
+        if (mi >= 0 && kinst > 0) out->br_mpki = vals[mi] / kinst;
+        if (li >= 0 && kinst > 0) out->l1i_mpki = vals[li] / kinst;
+    }
+    perf_group_close(&pg);
+    return aborted ? -1 : 0;
+}
+
+int fe_sweep_run(const fe_spec_t *spec, int cpu, long duration, int enable_rapl,
+                 int use_msr, double base_freq_mhz, const char *log_path)
+{
+    size_t fps[32];
+    int pcts[32];
+    int nf = 0, np = 0;
+    char *save = NULL;
+
+    if (cpu < 0 || cpu >= get_affinity_cpu_count()) {
+        fprintf(stderr, "Error: --single-core-id=%d out of range for frontend-sweep\n", cpu);
+        return 1;
+    }
+
+    char *copy = strdup(spec->footprints ? spec->footprints : FE_DEFAULT_SWEEP_FOOTPRINTS);
+    for (char *tok = strtok_r(copy, ",", &save); tok && nf < 32; tok = strtok_r(NULL, ",", &save)) {
+        uint64_t b;
+        if (parse_size_bytes(tok, &b) != 0 || b < 2 * FE_BLOCK_BYTES) {
+            fprintf(stderr, "Error: bad --fe-footprint entry '%s'\n", tok);
+            free(copy);
+            return 1;
+        }
+        fps[nf++] = (size_t)b;
+    }
+    free(copy);
+
+    copy = strdup(spec->random ? spec->random : FE_DEFAULT_SWEEP_RANDOM);
+    for (char *tok = strtok_r(copy, ",", &save); tok && np < 32; tok = strtok_r(NULL, ",", &save)) {
+        int v = atoi(tok);
+        if (v < 0 || v > 100) {
+            fprintf(stderr, "Error: --fe-random entries must be 0-100\n");
+            free(copy);
+            return 1;
+        }
+        pcts[np++] = v;
+    }
+    free(copy);
+    if (nf == 0 || np == 0) return 1;
+
+    rapl_state_t rapl;
+    rapl_state_t *rp = NULL;
+    if (enable_rapl) {
+        if (rapl_init(&rapl, cpu) == 0) rp = &rapl;
+        else rapl_warn_unavailable("Power not measured.");
+    }
+
+    printf("\n=== Front-End Sweep: cpu%d, %ld s per point, %d-byte blocks ===\n",
+           cpu, duration, FE_BLOCK_BYTES);
+
+    fe_sample_t *res = calloc((size_t)nf * np, sizeof(fe_sample_t));
+    int rc = 0, done = 0;
+    for (int fi = 0; fi < nf && res && rc == 0; ++fi) {
+        fe_image_t im;
+        if (fe_image_build(&im, fps[fi], 0) != 0) {
+            fprintf(stderr, "Error: cannot build a %zu KB code image\n", fps[fi] / 1024);
+            rc = 1;
+            break;
+        }
+        printf("  footprint %zu KB (%u blocks)\n", fps[fi] / 1024, im.nblocks);
+        for (int pi = 0; pi < np; ++pi) {
+            fe_sample_t *r = &res[fi * np + pi];
+            r->footprint = fps[fi];
+            r->random_pct = pcts[pi];
+            im.rand_thresh = (uint32_t)(pcts[pi] * 65536 / 100);
+            if (fe_measure(cpu, &im, duration, rp, use_msr, base_freq_mhz, r) != 0) {
+                rc = 1;
+                break;
+            }
+            printf("    random %3d%%  %10.3f M calls/s\n", pcts[pi], r->calls_per_sec / 1e6);
+        }
+        fe_image_free(&im);
+        if (rc == 0) done = fi + 1;
+    }
+    int have_rapl = rp != NULL;
+    if (rp) rapl_close(rp);
+
+    if (!res || rc != 0) {
+        fprintf(stderr, "frontend-sweep interrupted\n");
+        free(res);
+        return 1;
+    }
+
+    printf("\n%10s %7s %12s %6s %8s %8s %8s %8s %8s\n", "Footprint", "Random", "M calls/s", "IPC",
+           "BrMiss%", "BrMPKI", "L1iMPKI", "MHz", "Pkg W");
+    for (int i = 0; i < done * np; ++i) {
+        const fe_sample_t *r = &res[i];
+        char ipc[12], bm[12], bk[12], lk[12], mhz[12], pw[12];
+        snprintf(ipc, sizeof(ipc), r->ipc >= 0 ? "%.2f" : "n/a", r->ipc);
+        snprintf(bm, sizeof(bm), r->br_miss_pct >= 0 ? "%.2f" : "n/a", r->br_miss_pct);
+        snprintf(bk, sizeof(bk), r->br_mpki >= 0 ? "%.2f" : "n/a", r->br_mpki);
+        snprintf(lk, sizeof(lk), r->l1i_mpki >= 0 ? "%.2f" : "n/a", r->l1i_mpki);
+        snprintf(mhz, sizeof(mhz), r->freq_mhz > 0 ? "%.0f" : "n/a", r->freq_mhz);
+        snprintf(pw, sizeof(pw), have_rapl ? "%.2f" : "n/a", r->pkg_watts);
+        printf("%8zuKB %6d%% %12.3f %6s %8s %8s %8s %8s %8s\n", r->footprint / 1024, r->random_pct,
+               r->calls_per_sec / 1e6, ipc, bm, bk, lk, mhz, pw);
+    }
+
+    if (log_path) {
+        FILE *lf = fopen(log_path, "w");
+        if (!lf) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(lf, "# coreburner frontend-sweep\n# cpu=%d\n# duration=%ld\n# block_bytes=%d\n",
+                    cpu, duration, FE_BLOCK_BYTES);
+            write_machine_fingerprint(lf, "# fp.", &g_fingerprint);
+            fprintf(lf, "footprint_bytes,random_pct,calls_per_sec,ipc,branch_miss_pct,branch_mpki,"
+                        "l1i_mpki,freq_mhz,pkg_watts\n");
+            for (int i = 0; i < done * np; ++i) {
+                const fe_sample_t *r = &res[i];
+                fprintf(lf, "%zu,%d,%.1f,", r->footprint, r->random_pct, r->calls_per_sec);
+                if (r->ipc >= 0) fprintf(lf, "%.3f", r->ipc);
+                fprintf(lf, ",");
+                if (r->br_miss_pct >= 0) fprintf(lf, "%.3f", r->br_miss_pct);
+                fprintf(lf, ",");
+                if (r->br_mpki >= 0) fprintf(lf, "%.3f", r->br_mpki);
+                fprintf(lf, ",");
+                if (r->l1i_mpki >= 0) fprintf(lf, "%.3f", r->l1i_mpki);
+                fprintf(lf, ",");
+                if (r->freq_mhz > 0) fprintf(lf, "%.1f", r->freq_mhz);
+                fprintf(lf, ",");
+                if (have_rapl) fprintf(lf, "%.3f", r->pkg_watts);
+                fprintf(lf, "\n");
+            }
+            fclose(lf);
+            printf("\nfrontend-sweep results written to %s\n", log_path);
+        }
+    }
+    free(res);
+    return 0;
+}
+
+/***********************************************************
+ *                  Uncore Frequency
+ * intel_uncore_frequency exposes one directory per package/die
+ * (package_XX_die_YY, or uncoreNN on TPMI parts) with
+ * current_freq_khz and writable min/max_freq_khz. The sampler
+ * logs the current clock of every domain; --uncore-min/max pin
+ * the limits for a run and --mode uncore-sweep steps them.
+ * Original limits are saved on first write and restored at exit.
+ ***********************************************************/
+#define UNCORE_SYSFS "/sys/devices/system/cpu/intel_uncore_frequency"
+#define UNCORE_MAX_DOMAINS 16
+#define UNCORE_MAX_STEPS 16
+#define UNCORE_DEFAULT_STEPS 5
+#define UNCORE_SETTLE_NS 200000000L
+#define UNCORE_COPY_BYTES (32UL << 20)
+
+typedef struct {
+    char name[32];              /* package_00_die_00 / uncore00 */
+    char path[128];
+    long saved_min_khz;         /* 0 until the first write */
+    long saved_max_khz;
+} uncore_domain_t;
+
+static uncore_domain_t g_uncore[UNCORE_MAX_DOMAINS];
+static int g_uncore_n = -1;     /* -1 = not probed yet */
+
+static long uncore_read_khz(const uncore_domain_t *d, const char *file) {
+    char path[192], buf[32];
+    snprintf(path, sizeof(path), "%s/%s", d->path, file);
+    if (read_sysfs_str(path, buf, sizeof(buf)) != 0) return -1;
+    return atol(buf);
+}
+
+static int uncore_write_khz(const uncore_domain_t *d, const char *file, long khz) {
+    char path[192];
+    snprintf(path, sizeof(path), "%s/%s", d->path, file);
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    int ok = fprintf(f, "%ld", khz) > 0;
+    if (fclose(f) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+static int uncore_cmp_name(const void *a, const void *b) {
+    return strcmp(((const uncore_domain_t *)a)->name, ((const uncore_domain_t *)b)->name);
+}
+
+/* Enumerate domains once; returns the count (0 = no driver) */
+int uncore_init(void) {
+    if (g_uncore_n >= 0) return g_uncore_n;
+    g_uncore_n = 0;
+    DIR *dir = opendir(UNCORE_SYSFS);
+    if (!dir) return 0;
+    int legacy = 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL && g_uncore_n < UNCORE_MAX_DOMAINS) {
+        int is_pkg = strncmp(de->d_name, "package_", 8) == 0;
+        if (!is_pkg && strncmp(de->d_name, "uncore", 6) != 0) continue;
+        uncore_domain_t *d = &g_uncore[g_uncore_n];
+        memset(d, 0, sizeof(*d));
+        snprintf(d->name, sizeof(d->name), "%.31s", de->d_name);
+        snprintf(d->path, sizeof(d->path), "%s/%.31s", UNCORE_SYSFS, de->d_name);
+        if (uncore_read_khz(d, "max_freq_khz") <= 0) continue;
+        legacy |= is_pkg;
+        g_uncore_n++;
+    }
+    closedir(dir);
+    /* kernels with both layouts: keep the package_XX_die_YY view */
+    if (legacy) {
+        int k = 0;
+        for (int i = 0; i < g_uncore_n; ++i)
+            if (strncmp(g_uncore[i].name, "package_", 8) == 0) g_uncore[k++] = g_uncore[i];
+        g_uncore_n = k;
+    }
+    qsort(g_uncore, g_uncore_n, sizeof(uncore_domain_t), uncore_cmp_name);
+    return g_uncore_n;
+}
+
+/* Current uncore clock of domain i in MHz, NAN if unreadable */
+double uncore_cur_mhz(int i) {
+    long khz = uncore_read_khz(&g_uncore[i], "current_freq_khz");
+    return khz > 0 ? khz / 1000.0 : NAN;
+}
+
+/* Mean current clock over all domains in MHz, NAN without a driver */
+double uncore_mean_mhz(void) {
+    double sum = 0.0;
+    int cnt = 0;
+    for (int i = 0; i < g_uncore_n; ++i) {
+        double m = uncore_cur_mhz(i);
+        if (!isnan(m)) { sum += m; cnt++; }
+    }
+    return cnt ? sum / cnt : NAN;
+}
+
+/* Put back the limits saved by the first uncore_set_limits() */
+void uncore_restore(void) {
+    for (int i = 0; i < g_uncore_n; ++i) {
+        uncore_domain_t *d = &g_uncore[i];
+        if (d->saved_max_khz <= 0) continue;
+        /* widest first so neither write is rejected against the other */
+        uncore_write_khz(d, "max_freq_khz", d->saved_max_khz);
+        uncore_write_khz(d, "min_freq_khz", d->saved_min_khz);
+        uncore_write_khz(d, "max_freq_khz", d->saved_max_khz);
+        d->saved_min_khz = d->saved_max_khz = 0;
+    }
+}
+
+/* Set min/max on every domain (<=0 keeps a field); 0 or -1 */
+int uncore_set_limits(long min_khz, long max_khz) {
+    static int registered = 0;
+    int rc = 0;
+    if (uncore_init() == 0) return -1;
+    if (!registered) {
+        atexit(uncore_restore);
+        registered = 1;
+    }
+    for (int i = 0; i < g_uncore_n; ++i) {
+        uncore_domain_t *d = &g_uncore[i];
+        long cur_min = uncore_read_khz(d, "min_freq_khz");
+        long cur_max = uncore_read_khz(d, "max_freq_khz");
+        if (d->saved_max_khz <= 0) {
+            d->saved_min_khz = cur_min;
+            d->saved_max_khz = cur_max;
+        }
+        /* lowering max below the current min must move min first */
+        int min_first = max_khz > 0 && max_khz < cur_min;
+        if (min_first && min_khz > 0 && uncore_write_khz(d, "min_freq_khz", min_khz) != 0) rc = -1;
+        if (max_khz > 0 && uncore_write_khz(d, "max_freq_khz", max_khz) != 0) rc = -1;
+        if (!min_first && min_khz > 0 && uncore_write_khz(d, "min_freq_khz", min_khz) != 0) rc = -1;
+    }
+    return rc;
+}
+
+/* Cache size of `index` on cpu0 in bytes, 0 if unknown */
+static uint64_t uncore_cache_bytes(int index) {
+    char path[96], buf[32];
+    uint64_t b = 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+    if (read_sysfs_str(path, buf, sizeof(buf)) != 0 || parse_size_bytes(buf, &b) != 0) return 0;
+    return b;
+}
+
+/*
+ * --mode uncore-sweep: pin min = max = each step on every domain,
+ * then measure libc copy bandwidth on all CPUs and a dependent
+ * load chase on --single-core-id. The chase touches one line per
+ * 4K node, so the footprint is sized for data between L2 and LLC
+ * (4x L2, at most half the LLC) and runs on THP to keep it out of
+ * the TLB: its ns/load is an LLC round trip across the mesh.
+ */
+int uncore_sweep_run(const uncore_spec_t *spec, int cpu, long duration, int enable_rapl, int use_msr,
+                     double base_freq_mhz, const char *log_path)
+{
+    if (uncore_init() == 0) {
+        fprintf(stderr, "Error: uncore-sweep needs the intel_uncore_frequency driver (%s)\n", UNCORE_SYSFS);
+        return 1;
+    }
+    if (cpu < 0 || cpu >= get_affinity_cpu_count()) {
+        fprintf(stderr, "Error: --single-core-id=%d out of range for uncore-sweep\n", cpu);
+        return 1;
+    }
+
+    double steps[UNCORE_MAX_STEPS];
+    int ns = 0;
+    long lo = uncore_read_khz(&g_uncore[0], "initial_min_freq_khz");
+    long hi = uncore_read_khz(&g_uncore[0], "initial_max_freq_khz");
+    if (lo <= 0) lo = uncore_read_khz(&g_uncore[0], "min_freq_khz");
+    if (hi <= 0) hi = uncore_read_khz(&g_uncore[0], "max_freq_khz");
+    if (spec->freqs) {
+        char *copy = strdup(spec->freqs);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok && ns < UNCORE_MAX_STEPS; tok = strtok_r(NULL, ",", &save))
+            if (atof(tok) > 0) steps[ns++] = atof(tok);
+        free(copy);
+    } else if (lo > 0 && hi > lo) {
+        for (int s = 0; s < UNCORE_DEFAULT_STEPS; ++s)
+            steps[ns++] = (lo + (hi - lo) * s / (UNCORE_DEFAULT_STEPS - 1)) / 1000.0;
+    }
+    if (ns == 0) {
+        fprintf(stderr, "Error: no uncore steps (give --uncore-freqs)\n");
+        return 1;
+    }
+
+    int ncpu = g_cpu_order_len ? g_cpu_order_len : get_affinity_cpu_count();
+    int *cpus = calloc(ncpu, sizeof(int));
+    if (!cpus) return 1;
+    for (int i = 0; i < ncpu; ++i) cpus[i] = g_cpu_order_len ? g_cpu_order[i] : i;
+
+    uint64_t l2 = uncore_cache_bytes(2), llc = uncore_cache_bytes(3);
+    uint64_t data = l2 ? 4 * l2 : (8UL << 20);
+    if (llc && data > llc / 2) data = llc / 2;
+    uint64_t foot = data / 64 * TLB_NODE_STRIDE;
+    if (foot > (1UL << 30)) foot = 1UL << 30;
+
+    rapl_state_t rapl;
+    rapl_state_t *rp = NULL;
+    if (enable_rapl) {
+        if (rapl_init(&rapl, cpus[0]) == 0) rp = &rapl;
+        else rapl_warn_unavailable("Power not measured.");
+    }
+
+    printf("\n=== Uncore Sweep: %d domain(s), %d step(s), copy on %d CPU(s), chase on cpu%d (%llu MB), %ld s per point ===\n",
+           g_uncore_n, ns, ncpu, cpu, (unsigned long long)(foot >> 20), duration);
+    printf("  %8s %9s %10s %9s %9s %10s %9s\n", "set MHz", "unc MHz", "copy GB/s", "core MHz", "copy W",
+           "chase ns", "chase W");
+
+    copy_sample_t *cs = calloc(ns, sizeof(copy_sample_t));
+    tlb_sample_t *ts = calloc(ns, sizeof(tlb_sample_t));
+    double *unc = calloc(ns, sizeof(double));
+    int rc = (cs && ts && unc) ? 0 : 1;
+    for (int s = 0; s < ns && rc == 0; ++s) {
+        long khz = (long)(steps[s] * 1000);
+        if (uncore_set_limits(khz, khz) != 0) {
+            fprintf(stderr, "Error: cannot write uncore limits (needs root)\n");
+            rc = 1;
+            break;
+        }
+        safe_nanosleep(0, UNCORE_SETTLE_NS);
+        if (copy_measure(cpus, ncpu, 0, UNCORE_COPY_BYTES, duration, rp, use_msr, base_freq_mhz, &cs[s]) != 0) {
+            rc = 1;
+            break;
+        }
+        unc[s] = uncore_mean_mhz();
+        if (tlb_measure(cpu, foot, TLB_PAGE_THP, duration, rp, &ts[s]) != 0) {
+            rc = 1;
+            break;
+        }
+        printf("  %8.0f %9.0f %10.2f %9.0f ", steps[s], unc[s], cs[s].gbps, cs[s].freq_mhz);
+        if (rp) printf("%9.1f ", cs[s].pkg_watts); else printf("%9s ", "n/a");
+        if (ts[s].ok && ts[s].loads_per_sec > 0) printf("%10.2f ", 1e9 / ts[s].loads_per_sec);
+        else printf("%10s ", "n/a");
+        if (rp && ts[s].ok) printf("%9.1f\n", ts[s].pkg_watts); else printf("%9s\n", "n/a");
+    }
+    if (rp) rapl_close(rp);
+    uncore_restore();
+    if (rc != 0) {
+        fprintf(stderr, "uncore-sweep interrupted\n");
+        free(cpus); free(cs); free(ts); free(unc);
+        return 1;
+    }
+
+    if (log_path) {
+        FILE *lf = fopen(log_path, "w");
+        if (!lf) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(lf, "# coreburner uncore-sweep\n# domains=%d\n# copy_cpus=%d\n# chase_cpu=%d\n"
+                    "# chase_bytes=%llu\n# duration=%ld\n",
+                    g_uncore_n, ncpu, cpu, (unsigned long long)foot, duration);
+            write_machine_fingerprint(lf, "# fp.", &g_fingerprint);
+            fprintf(lf, "set_mhz,uncore_mhz,copy_gbps,core_mhz,copy_pkg_w,chase_ns,chase_pkg_w\n");
+            for (int s = 0; s < ns; ++s) {
+                fprintf(lf, "%.0f,", steps[s]);
+                if (!isnan(unc[s])) fprintf(lf, "%.0f", unc[s]);
+                fprintf(lf, ",%.3f,%.1f,", cs[s].gbps, cs[s].freq_mhz);
+                if (rp) fprintf(lf, "%.2f", cs[s].pkg_watts);
+                fprintf(lf, ",");
+                if (ts[s].ok && ts[s].loads_per_sec > 0) fprintf(lf, "%.3f", 1e9 / ts[s].loads_per_sec);
+                fprintf(lf, ",");
+                if (rp && ts[s].ok) fprintf(lf, "%.2f", ts[s].pkg_watts);
+                fprintf(lf, "\n");
+            }
+            fclose(lf);
+            printf("\nuncore-sweep results written to %s\n", log_path);
+        }
+    }
+    free(cpus); free(cs); free(ts); free(unc);
+    return 0;
+}
+
+/***********************************************************
+ *                 Hybrid Core Types
+ * Hybrid parts (CPUID.7.EDX[15]) mix P-cores and E-cores.
+ * The type of each CPU comes from the cpu_core / cpu_atom
+ * PMU cpu lists, else from CPUID leaf 0x1A run on that CPU.
+ * --core-type then filters or orders the worker CPUs, the ISA
+ * of --type is checked on every type used, and main_runtime
+ * splits throughput, frequency and cycle share per type.
+ ***********************************************************/
+#define CORE_TYPE_UNKNOWN 0
+#define CORE_TYPE_P 1
+#define CORE_TYPE_E 2
+#define CORE_TYPES 3
+#define HYBRID_MAX_CPUS 1024
+
+static const char *core_type_names[CORE_TYPES] = { "other", "P-core", "E-core" };
+static unsigned char g_core_type[HYBRID_MAX_CPUS];
+static int g_hybrid = 0;            /* both types present */
+static const char *g_hybrid_src = "none";
+
+static int hybrid_from_pmu(void) {
+    static const char *pmu[] = { "/sys/devices/cpu_core/cpus", "/sys/devices/cpu_atom/cpus" };
+    int found = 0;
+    for (int k = 0; k < 2; ++k) {
+        char buf[1024];
+        int list[HYBRID_MAX_CPUS];
+        if (read_sysfs_str(pmu[k], buf, sizeof(buf)) != 0) continue;
+        int n = parse_cpu_list(buf, list, HYBRID_MAX_CPUS);
+        for (int i = 0; i < n; ++i)
+            if (list[i] >= 0 && list[i] < HYBRID_MAX_CPUS) g_core_type[list[i]] = k ? CORE_TYPE_E : CORE_TYPE_P;
+        found += n > 0;
+    }
+    return found;
+}
+
+/* CPUID.1A.EAX[31:24] on each allowed CPU: 0x40 Core, 0x20 Atom */
+static int hybrid_from_cpuid(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) || !((edx >> 15) & 1)) return 0;
+    cpu_set_t saved, one;
+    if (sched_getaffinity(0, sizeof(saved), &saved) != 0) return 0;
+    int found = 0;
+    for (int c = 0; c < CPU_SETSIZE && c < HYBRID_MAX_CPUS; ++c) {
+        if (!CPU_ISSET(c, &saved)) continue;
+        CPU_ZERO(&one);
+        CPU_SET(c, &one);
+        if (sched_setaffinity(0, sizeof(one), &one) != 0) continue;
+        if (__get_cpuid_count(0x1A, 0, &eax, &ebx, &ecx, &edx)) {
+            unsigned int t = eax >> 24;
+            g_core_type[c] = t == 0x40 ? CORE_TYPE_P : t == 0x20 ? CORE_TYPE_E : CORE_TYPE_UNKNOWN;
+            found++;
+        }
+    }
+    sched_setaffinity(0, sizeof(saved), &saved);
+    return found;
+#else
+    return 0;
+#endif
+}
+
+static int core_type_of(int cpu) {
+    return (cpu >= 0 && cpu < HYBRID_MAX_CPUS) ? g_core_type[cpu] : CORE_TYPE_UNKNOWN;
+}
+
+/* Detect core types once; returns 1 on a hybrid part */
+int hybrid_init(void) {
+    memset(g_core_type, 0, sizeof(g_core_type));
+    if (hybrid_from_pmu()) g_hybrid_src = "pmu";
+    else if (hybrid_from_cpuid()) g_hybrid_src = "cpuid";
+    int seen[CORE_TYPES] = { 0 };
+    for (int c = 0; c < HYBRID_MAX_CPUS; ++c) seen[g_core_type[c]]++;
+    g_hybrid = seen[CORE_TYPE_P] > 0 && seen[CORE_TYPE_E] > 0;
+    return g_hybrid;
+}
+
+/* Apply --core-type any|p|e|p-first|e-first to the worker CPU order */
+int hybrid_apply_policy(const char *policy) {
+    if (!policy || str_case_equal(policy, "any")) return 0;
+    int want = 0, first = 0;
+    if (str_case_equal(policy, "p")) want = CORE_TYPE_P;
+    else if (str_case_equal(policy, "e")) want = CORE_TYPE_E;
+    else if (str_case_equal(policy, "p-first")) first = CORE_TYPE_P;
+    else if (str_case_equal(policy, "e-first")) first = CORE_TYPE_E;
+    else {
+        fprintf(stderr, "Error: --core-type must be any, p, e, p-first or e-first\n");
+        return -1;
+    }
+    if (!g_hybrid) {
+        fprintf(stderr, "Warning: --core-type %s ignored: not a hybrid CPU\n", policy);
+        return 0;
+    }
+
+    /* start from the --spread order, or the affinity mask */
+    if (g_cpu_order_len == 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) return -1;
+        free(g_cpu_order);
+        g_cpu_order = calloc(CPU_COUNT(&set), sizeof(int));
+        if (!g_cpu_order) return -1;
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &set)) g_cpu_order[g_cpu_order_len++] = c;
+    }
+    int *tmp = malloc(g_cpu_order_len * sizeof(int));
+    if (!tmp) return -1;
+    int k = 0;
+    for (int pass = 0; pass < 2; ++pass)
+        for (int i = 0; i < g_cpu_order_len; ++i) {
+            int t = core_type_of(g_cpu_order[i]);
+            if (want ? (pass == 0 && t == want) : ((t == first) == (pass == 0))) tmp[k++] = g_cpu_order[i];
+        }
+    if (k == 0) {
+        fprintf(stderr, "Error: no %s in the affinity mask\n", core_type_names[want]);
+        free(tmp);
+        return -1;
+    }
+    memcpy(g_cpu_order, tmp, k * sizeof(int));
+    g_cpu_order_len = k;
+    free(tmp);
+    return 0;
+}
+
+/* --type must run on every core type that gets a worker: CPUID
+ * is evaluated on one CPU of each type (E-cores lack AVX-512,
+ * and some parts fuse features off per type) */
+int hybrid_isa_check(workload_t type, int nworkers) {
+    if (!g_hybrid) return 0;
+    int n = g_cpu_order_len ? g_cpu_order_len : get_affinity_cpu_count();
+    if (nworkers > 0 && nworkers < n) n = nworkers;
+    cpu_set_t saved, one;
+    if (sched_getaffinity(0, sizeof(saved), &saved) != 0) return 0;
+    int checked[CORE_TYPES] = { 0 }, rc = 0;
+    for (int i = 0; i < n; ++i) {
+        int cpu = g_cpu_order_len ? g_cpu_order[i] : i;
+        int t = core_type_of(cpu);
+        if (checked[t]) continue;
+        checked[t] = 1;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        if (sched_setaffinity(0, sizeof(one), &one) != 0) continue;
+        if (!workload_supported(type)) {
+            fprintf(stderr, "Error: %s is not supported on the %ss (cpu%d); use --core-type to exclude them\n",
+                    workload_str(type), core_type_names[t], cpu);
+            rc = -1;
+        }
+    }
+    sched_setaffinity(0, sizeof(saved), &saved);
+    return rc;
+}
+
+/* Per-type split of one run, printed and written to the summary */
+typedef struct {
+    int ncpu;                   /* CPUs of this type that carried a worker */
+    uint64_t ops;
+    double mhz_sum;
+    int mhz_cnt;
+    double busy_ghz;            /* sum of util x GHz: cycle share, the power proxy */
+} core_type_stats_t;
+
+void hybrid_report(FILE *f, const core_type_stats_t *st, double elapsed, double pp0_watts, int summary) {
+    double total = 0.0;
+    for (int t = 0; t < CORE_TYPES; ++t) total += st[t].busy_ghz;
+    if (summary) fprintf(f, "\n[Core Types]\n");
+    for (int t = 0; t < CORE_TYPES; ++t) {
+        if (st[t].ncpu == 0) continue;
+        double ops = elapsed > 0 ? st[t].ops / elapsed : 0.0;
+        double mhz = st[t].mhz_cnt ? st[t].mhz_sum / st[t].mhz_cnt : 0.0;
+        double share = total > 0 ? 100.0 * st[t].busy_ghz / total : 0.0;
+        if (summary) {
+            const char *key = t == CORE_TYPE_P ? "pcore" : t == CORE_TYPE_E ? "ecore" : "other";
+            fprintf(f, "%s_cpus=%d\n%s_ops_per_second=%.1f\n", key, st[t].ncpu, key, ops);
+            if (mhz > 0) fprintf(f, "%s_avg_frequency_mhz=%.0f\n", key, mhz);
+            if (total > 0) fprintf(f, "%s_cycle_share_pct=%.1f\n", key, share);
+            if (total > 0 && !isnan(pp0_watts)) fprintf(f, "%s_est_core_watts=%.2f\n", key, pp0_watts * share / 100.0);
+        } else {
+            fprintf(f, " %-6s x%-3d     : %.1f ops/s", core_type_names[t], st[t].ncpu, ops);
+            if (mhz > 0) fprintf(f, ", avg %.0f MHz", mhz);
+            if (total > 0) fprintf(f, ", cycle share %.1f%%", share);
+            if (total > 0 && !isnan(pp0_watts)) fprintf(f, " (~%.1f W of cores)", pp0_watts * share / 100.0);
+            fprintf(f, "\n");
+        }
+    }
+}
+
+/***********************************************************
+ *             Environment Validation
+ ***********************************************************/
+int validate_environment(
+    const char *mode,
+    workload_t type,
+    int max_threads,
+    int *out_nthreads,
+    char **temp_path,
+    double temp_threshold,
+    int wants_cpufreq_write,
+    const char *mixed_ratio_str,
+    int single_core_id,
+    int single_core_threads)
+{
+    if (access("/proc/stat", R_OK) != 0) {
+        fprintf(stderr, "Error: /proc/stat not readable\n");
+        return -1;
+    }
+
+    /* Determine worker thread count */
+    int affinity = get_affinity_cpu_count();
+    g_available_cpus = affinity;
+
+    int nthreads;
+    if (str_case_equal(mode, "single")) {
+        nthreads = 1;
+    } else if (str_case_equal(mode, "single-core-multi") || str_case_equal(mode, "ctx-switch")) {
+        /* Validate single-core-multi parameters */
+        if (single_core_id < 0 || single_core_id >= affinity) {
+            fprintf(stderr,
+                    "Error: --single-core-id=%d is out of range (0-%d)\n",
+                    single_core_id, affinity - 1);
+            return -1;
+        }
+        if (single_core_threads <= 0 || single_core_threads > max_threads) {
+            fprintf(stderr,
+                    "Error: --single-core-threads=%d must be 1-%d\n",
+                    single_core_threads, max_threads);
+            return -1;
+        }
+        nthreads = single_core_threads;
+    } else if (str_case_equal(mode, "replay") && g_replay) {
+        nthreads = g_replay->nlanes;
+    } else if (str_case_equal(mode, "smt-matrix")) {
+        nthreads = 2;
+    } else if (str_case_equal(mode, "tlb-sweep") || str_case_equal(mode, "copy-sweep") ||
+               str_case_equal(mode, "fp-assist") || str_case_equal(mode, "frontend-sweep") ||
+               str_case_equal(mode, "uncore-sweep")) {
+        nthreads = 1;
+    } else {
+        /* --core-type p|e may have narrowed the worker CPUs */
+        nthreads = g_cpu_order_len ? g_cpu_order_len : affinity;
+    }
+
+    /* NEW BEHAVIOR: Clamp instead of error */
+    if (nthreads > max_threads) {
+        fprintf(stderr,
+                "Info: system shows %d CPUs but --max-threads=%d. "
+                "Clamping thread count to %d.\n",
+                nthreads, max_threads, max_threads);
+        nthreads = max_threads;
+    }
+
+    if (nthreads > DEFAULT_MAX_THREADS)
+        nthreads = DEFAULT_MAX_THREADS;
+
+    /* SIMD capability checks (skip for AUTO as it's already validated) */
+    if (type == W_AUTO) {
+        /* AUTO type will be resolved to actual type before here */
+        return 0;
+    }
+    
+    if (type == W_SSE && !cpu_supports_sse()) {
+        fprintf(stderr,
+                "Error: CPU does not support SSE4.2.\n");
+        return -1;
+    }
+
+    if (type == W_AVX && !cpu_supports_avx()) {
+        fprintf(stderr,
+                "Error: CPU or OS does not support AVX (XGETBV/xsave).\n");
+        return -1;
+    }
+
+    if (type == W_AVX2 && !cpu_supports_avx2()) {
+        fprintf(stderr,
+                "Error: CPU does not support AVX2 or FMA.\n");
+        return -1;
+    }
+
+    if (type == W_AVX512 && !cpu_supports_avx512()) {
+        fprintf(stderr,
+                "Error: CPU or OS does not support AVX-512F.\n");
+        return -1;
+    }
+
+    if (type == W_DAVX && !cpu_supports_avx()) {
+        fprintf(stderr,
+                "Error: DAVX requires AVX.\n");
+        return -1;
+    }
+
+    if (type == W_GATHER && !cpu_supports_avx2()) {
+        fprintf(stderr,
+                "Error: GATHER requires AVX2.\n");
+        return -1;
+    }
+
+    if (type == W_CRYPTO && !cpu_supports_aes()) {
+        fprintf(stderr,
+                "Error: CPU does not support AES-NI.\n");
+        return -1;
+    }
+
+    if (type == W_MIXED && !cpu_supports_avx()) {
+        fprintf(stderr,
+                "Error: MIXED mode requires AVX support.\n");
+        return -1;
+    }
+
+    /* Temperature sensor detection */
+    *temp_path = find_temperature_input_path();
+    if (!*temp_path) {
+        fprintf(stderr,
+                "Warning: Could not find CPU temp sensor. "
+                "Thermal auto-stop disabled.\n");
+    } else {
+        double t = read_temperature(*temp_path);
+        if (isnan(t))
+            fprintf(stderr, "Warning: CPU temp sensor unreadable.\n");
+    }
+
+    /* cpufreq write checks */
+    if (wants_cpufreq_write && geteuid() != 0) {
+        fprintf(stderr,
+                "Error: root required for CPU frequency settings.\n");
+        return -1;
+    }
+
+    /* MIXED ratio must be provided; cdyn-fit may list MIXED under any --type */
+    if (type == W_MIXED && !mixed_ratio_str) {
+        fprintf(stderr,
+                "Error: MIXED mode requires --mixed-ratio A:B:C\n");
+        return -1;
+    }
+
+    if (mixed_ratio_str) {
+        mixed_ratio_t mr;
+        if (parse_mixed_ratio(mixed_ratio_str, &mr) != 0) {
+            fprintf(stderr,
+                    "Error: invalid --mixed-ratio format\n");
+            return -1;
+        }
+
+        g_mixed_ratio = mr;
+    }
+
+    *out_nthreads = nthreads;
+    return 0;
+}
+
+
+/*******************************************************
+ * CoreBurner — CHUNK 4 / 5
+ *  - Corrected worker_thread (uses g_mixed_ratio weights)
+ *  - Main runtime loop: spawn workers, monitor, logging
+ *  - Dynamic frequency tuner
+ *  - Graceful shutdown & summary
+ *******************************************************/
+
+
+
+void *worker_thread(void *arg) {
+    worker_arg_t *w = (worker_arg_t *)arg;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(w->cpu_id, &cpuset);
+
+    /* Try to pin thread */
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0) {
+        cpu_set_t cur;
+        CPU_ZERO(&cur);
+        if (sched_getaffinity(0, sizeof(cur), &cur) == 0) {
+            int fallback = -1;
+            for (int i = 0; i < CPU_SETSIZE; ++i)
+                if (CPU_ISSET(i, &cur)) { fallback = i; break; }
+            if (fallback >= 0) {
+                CPU_ZERO(&cpuset);
+                CPU_SET(fallback, &cpuset);
+                pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+                w->cpu_id = fallback;
+            }
+        }
+    }
+
+    /* Local workload state */
+    work_state_t ws;
+    if (work_state_init(&ws, w->cpu_id) != 0) {
+        work_state_free(&ws);
+        return NULL;
+    }
+
+    const long period_ns = CONTROL_PERIOD_MS * 1000000L;
+    double util = w->target_util;
+    if (util < 0) util = 0;
+    if (util > 100) util = 100;
+
+    long busy_ns = (long)round((util / 100.0) * period_ns);
+    long sleep_ns = period_ns - busy_ns;
+
+    struct timespec t0, t1;
+
+    /* Trace replay drives duty cycle and kernel per step; returns on stop */
+    if (g_replay)
+        trace_replay_loop(w, &ws);
+
+    while (!stop_flag) {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+
+        /* --thermal-guard may lower the duty cycle or the ISA each period */
+        workload_t k = w->type;
+        if (g_guard.enabled) {
+            busy_ns = (long)round((util / 100.0) * __atomic_load_n(&g_guard.duty_pm, __ATOMIC_RELAXED) / 1000.0 * period_ns);
+            sleep_ns = period_ns - busy_ns;
+            k = guard_kernel(w->type);
+        }
+
+        if (busy_ns > 0) {
+            for (;;) {
+                /* execute workload */
+                run_work_unit(k, &ws);
+
+                /* Scale operations counter to reflect actual work done (see work_unit_ops) */
+                __atomic_fetch_add(&w->ops_done, work_unit_ops(k), __ATOMIC_RELAXED);
+
+                clock_gettime(CLOCK_MONOTONIC, &t1);
+                long elapsed = (t1.tv_sec - t0.tv_sec) * 1000000000L + (t1.tv_nsec - t0.tv_nsec);
+
+                if (elapsed >= busy_ns || stop_flag)
+                    break;
+            }
+        }
+
+        if (sleep_ns > 0 && !stop_flag)
+            safe_nanosleep(0, sleep_ns);
+    }
+
+    /* Cleanup allocated workload buffers */
+    work_state_free(&ws);
+
+    return NULL;
+}
+
+/* ---------------- main runtime logic (spawn threads, monitoring, logging) ---------------- */
+int main_runtime(
+    const char *mode,
+    double util,
+    long duration,
+    workload_t type,
+    int nthreads,
+    double temp_threshold,
+    const char *log_path,
+    int log_interval,
+    int log_append,
+    int dynamic_freq,
+    long *current_max_freq,
+    char **temp_path_ptr,
+    worker_arg_t **out_wargs,
+    pthread_t **out_tids,
+    int single_core_id,
+    int enable_rapl,
+    const char *phase_label,
+    run_stats_t *out_stats)
+{
+    /* allocate worker structures */
+    pthread_t *tids = calloc(nthreads, sizeof(pthread_t));
+    worker_arg_t *wargs = calloc(nthreads, sizeof(worker_arg_t));
+    if (!tids || !wargs) {
+        fprintf(stderr, "Allocation failed for threads\n");
+        return -1;
+    }
+
+    for (int i = 0; i < nthreads; ++i) {
+        /* For single-core-multi mode, all threads go to the same core */
+        if (str_case_equal(mode, "single-core-multi")) {
+            wargs[i].cpu_id = single_core_id;
+        } else if (g_replay) {
+            wargs[i].cpu_id = g_replay->cpu_map[i];
+        } else {
+            wargs[i].cpu_id = g_cpu_order_len ? g_cpu_order[i % g_cpu_order_len] : i % g_available_cpus;
+        }
+        wargs[i].target_util = g_replay ? trace_lane_mean_util(i) : util;
+        wargs[i].type = type;
+        wargs[i].trace_lane = i;
+        __atomic_store_n(&wargs[i].ops_done, 0, __ATOMIC_RELAXED);
+    }
+
+    /* signal handlers already set up by caller if needed */
+
+    guard_reset();
+    if (g_replay) trace_replay_arm();
+
+    /* spawn worker threads */
+    for (int i = 0; i < nthreads; ++i) {
+        if (pthread_create(&tids[i], NULL, worker_thread, &wargs[i]) != 0) {
+            fprintf(stderr, "Failed to create thread %d: %s\n", i, strerror(errno));
+            stop_flag = 1;
+            break;
+        }
+    }
+
+    /* start monitor thread */
+    pthread_t mon_tid = 0;
+    if (pthread_create(&mon_tid, NULL, monitor_thread, NULL) != 0) {
+        fprintf(stderr, "Warning: failed to start monitor thread\n");
+        mon_tid = 0;
+    }
+
+    /* logging set up */
+    FILE *logf = NULL;
+    FILE *summaryf = NULL;
+    char *summary_path = NULL;
+    uint64_t *prev_ops = NULL;
+    int logging_enabled = 0;
+
+    uncore_init();
+
+    /* hwmon channels (--hwmon): sized before the log header names their columns */
+    hwmon_stats_t *hw_stats = calloc(g_hwmon_n + 1, sizeof(*hw_stats));
+    double *hw_val = calloc(g_hwmon_n + 1, sizeof(*hw_val));
+    if (!hw_stats || !hw_val) {
+        fprintf(stderr, "Warning: out of memory for --hwmon statistics; channels not logged\n");
+        hwmon_close();
+        g_hwmon_n = 0;
+    }
+
+    /* AMD per-CCD temperatures (k10temp Tccd) */
+    char tccd_path[AMD_MAX_CCDS][64];
+    int tccd_id[AMD_MAX_CCDS];
+    int n_tccd = cpu_vendor() == CPU_VENDOR_AMD ? amd_tccd_find(tccd_path, tccd_id, AMD_MAX_CCDS) : 0;
+
+    /* RAPL package power (optional) */
+    rapl_state_t rapl;
+    int rapl_active = 0;
+    if (enable_rapl) {
+        if (rapl_init(&rapl, 0) == 0)
+            rapl_active = 1;
+        else
+            rapl_warn_unavailable("Power not logged.");
+    }
+
+    if (log_path) {
+        logf = fopen(log_path, log_append ? "a" : "w");
+        if (!logf) {
+            fprintf(stderr, "Failed to open log file '%s' for writing: %s\n", log_path, strerror(errno));
+            logging_enabled = 0;
+        } else {
+            logging_enabled = 1;
+            if (!log_append) {
+                time_t ts = time(NULL);
+                safe_fprintf_flush(logf, "# coreburner log\n");
+                safe_fprintf_flush(logf, "# mode=%s\n", mode);
+                safe_fprintf_flush(logf, "# workload=%s\n", workload_str(type));
+                if (type == W_LOCK)
+                    safe_fprintf_flush(logf, "# lock=%s cs=%ld ncs=%ld read_pct=%d\n", lock_kind_names[g_lock.kind],
+                                       g_lock.cs_iters, g_lock.ncs_iters, g_lock.read_pct);
+                if (g_memp.running)
+                    safe_fprintf_flush(logf, "# mem_pressure=%zuMB touch=%.0fMB/s cycle=%ds\n",
+                                       g_memp.bytes >> 20, g_memp.touch_mbps, g_memp.cycle_sec);
+                for (int u = 0; u < g_uncore_n; ++u)
+                    safe_fprintf_flush(logf, "# uncore.%s=min %ld max %ld kHz\n", g_uncore[u].name,
+                                       uncore_read_khz(&g_uncore[u], "min_freq_khz"),
+                                       uncore_read_khz(&g_uncore[u], "max_freq_khz"));
+                if (rapl_active)
+                    safe_fprintf_flush(logf, "# power_source=%s %s\n", cpu_vendor_names[cpu_vendor()],
+                                       rapl_src_names[rapl.src]);
+                for (int h = 0; h < g_hwmon_n; ++h)
+                    safe_fprintf_flush(logf, "# hwmon.%s=hwmon%d/%s %s/%s\n", g_hwmon[h].column, g_hwmon[h].hwmon,
+                                       g_hwmon[h].chan, g_hwmon[h].chip, g_hwmon[h].label);
+                if (g_guard.enabled)
+                    safe_fprintf_flush(logf, "# thermal_guard=%s margin=%.0fs window=%d\n",
+                                       g_guard.isa ? "isa" : "duty", g_guard.margin_sec, g_guard.window);
+                safe_fprintf_flush(logf, "# util=%.1f\n", util);
+                safe_fprintf_flush(logf, "# threads=%d\n", nthreads);
+                safe_fprintf_flush(logf, "# interval=%ds\n", log_interval);
+                safe_fprintf_flush(logf, "# temp_threshold=%.1f\n", temp_threshold);
+                safe_fprintf_flush(logf, "# start_time=%ld\n", (long)ts);
+                write_machine_fingerprint(logf, "# fp.", &g_fingerprint);
+                fflush(logf);
+            }
+            if (phase_label)
+                safe_fprintf_flush(logf, "# phase=%s\n", phase_label);
+
+            /* CSV header */
+            safe_fprintf_flush(logf, "timestamp,elapsed_sec,cpu_temp");
+            int cores_to_log = (g_available_cpus > MAX_CORES_TO_LOG) ? MAX_CORES_TO_LOG : g_available_cpus;
+            for (int c = 0; c < cores_to_log; ++c) safe_fprintf_flush(logf, ",cpu%d_util,cpu%d_freq", c, c);
+            if (g_available_cpus > cores_to_log) safe_fprintf_flush(logf, ",cpu_others_util,cpu_others_freq");
+            for (int t = 0; t < nthreads; ++t) safe_fprintf_flush(logf, ",thread%d_ops_delta", t);
+            if (rapl_active) safe_fprintf_flush(logf, ",pkg_watts,pp0_watts,dram_watts");
+            if (rapl_active && rapl.has[RAPL_PSYS]) safe_fprintf_flush(logf, ",psys_watts");
+            safe_fprintf_flush(logf, ",user_pct,sys_pct");
+            for (int c = 0; c < cores_to_log; ++c) safe_fprintf_flush(logf, ",cpu%d_user,cpu%d_sys", c, c);
+            if (g_memp.running)
+                safe_fprintf_flush(logf, ",rss_mb,mem_touch_mbps,kswapd_pct,pgscan_kswapd_s,pgscan_direct_s,majflt_s");
+            for (int u = 0; u < g_uncore_n; ++u) safe_fprintf_flush(logf, ",%s_mhz", g_uncore[u].name);
+            for (int d = 0; d < n_tccd; ++d) safe_fprintf_flush(logf, ",ccd%d_temp", tccd_id[d]);
+            for (int h = 0; h < g_hwmon_n; ++h) safe_fprintf_flush(logf, ",%s", g_hwmon[h].column);
+            if (g_guard.enabled)
+                safe_fprintf_flush(logf, ",guard_sensor,guard_slope_c_s,guard_eta_s,guard_duty_pct,guard_isa_down");
+            safe_fprintf_flush(logf, "\n");
+
+            fflush(logf);
+            prev_ops = calloc(nthreads, sizeof(uint64_t));
+            if (prev_ops) for (int t = 0; t < nthreads; ++t) prev_ops[t] = 0;
+
+            summary_path = malloc(strlen(log_path) + 20);
+            if (summary_path) { strcpy(summary_path, log_path); strcat(summary_path, ".summary.txt"); summaryf = fopen(summary_path, log_append ? "a" : "w"); if (!summaryf) { free(summary_path); summary_path = NULL; } }
+        }
+    }
+
+    time_t start = time(NULL);
+    time_t end_time = start + duration;
+    time_t now = start;
+
+    /* prepare /proc.stat buffers for monitoring */
+    uint64_t *total_prev = calloc(g_available_cpus, sizeof(uint64_t));
+    uint64_t *idle_prev  = calloc(g_available_cpus, sizeof(uint64_t));
+    uint64_t *total_curr = calloc(g_available_cpus, sizeof(uint64_t));
+    uint64_t *idle_curr  = calloc(g_available_cpus, sizeof(uint64_t));
+    uint64_t *user_prev  = calloc(g_available_cpus, sizeof(uint64_t));
+    uint64_t *sys_prev   = calloc(g_available_cpus, sizeof(uint64_t));
+    uint64_t *user_curr  = calloc(g_available_cpus, sizeof(uint64_t));
+    uint64_t *sys_curr   = calloc(g_available_cpus, sizeof(uint64_t));
+    if (!total_prev || !idle_prev || !total_curr || !idle_curr ||
+        !user_prev || !sys_prev || !user_curr || !sys_curr) {
+        fprintf(stderr, "Memory allocation failed\n");
+        stop_flag = 1;
+    } else {
+        if (read_proc_stat_split(total_prev, idle_prev, user_prev, sys_prev, g_available_cpus) <= 0) {
+            fprintf(stderr, "Failed to read /proc/stat initial snapshot\n");
+            stop_flag = 1;
+        }
+    }
+
+    int cores_to_log = (g_available_cpus > MAX_CORES_TO_LOG) ? MAX_CORES_TO_LOG : g_available_cpus;
+
+    /* Statistics tracking */
+    double temp_sum = 0.0;
+    long freq_sum = 0;
+    int temp_count = 0;
+    int freq_count = 0;
+    double util_sum = 0.0;
+    int util_count = 0;
+    double user_sum = 0.0, sys_sum = 0.0;
+    double pkg_watts_sum = 0.0;
+    int pkg_watts_count = 0;
+    double pp0_watts_sum = 0.0;
+    int pp0_watts_count = 0;
+    int core_slots = g_available_cpus;
+    double *core_util_sum = calloc(core_slots, sizeof(double));
+    double *core_freq_sum = calloc(core_slots, sizeof(double));
+    int *core_freq_cnt = calloc(core_slots, sizeof(int));
+    int core_samples = 0;
+
+    /* memory-pressure counters (--mem-pressure) */
+    memp_stats_t mp_prev, mp_curr;
+    struct timespec mp_ts_prev, mp_ts_curr;
+    uint64_t mp_touched_prev = __atomic_load_n(&g_memp.touched, __ATOMIC_RELAXED);
+    uint64_t mp_cycles0 = __atomic_load_n(&g_memp.cycles, __ATOMIC_RELAXED);
+    memp_stats_t mp_first;
+    double kswapd_pct_sum = 0.0;
+    long rss_peak_kb = 0;
+    int mp_samples = 0;
+    memp_read_stats(&mp_prev);
+
+    /* uncore clock per domain (intel_uncore_frequency) */
+    double unc_sum[UNCORE_MAX_DOMAINS] = {0};
+    int unc_cnt[UNCORE_MAX_DOMAINS] = {0};
+
+    /* CPU temperature the hwmon channels are related to */
+    double temp_start = NAN;
+    if (g_hwmon_n > 0) hwmon_stats_init(hw_stats, g_hwmon_n);
+
+    /* thermal guard sensors: CPU, CCDs, then hwmon temperature channels */
+    char guard_name[GUARD_MAX_SENSORS][48];
+    int guard_n = 0;
+    snprintf(guard_name[guard_n++], sizeof(guard_name[0]), "cpu");
+    for (int d = 0; d < n_tccd && guard_n < GUARD_MAX_SENSORS; ++d)
+        snprintf(guard_name[guard_n++], sizeof(guard_name[0]), "ccd%d", tccd_id[d]);
+    for (int h = 0; h < g_hwmon_n && guard_n < GUARD_MAX_SENSORS; ++h)
+        if (g_hwmon[h].kind == HWMON_TEMP)
+            snprintf(guard_name[guard_n++], sizeof(guard_name[0]), "%.47s", g_hwmon[h].label);
+    int guard_samples = 0;
+    struct timespec guard_t0;
+    clock_gettime(CLOCK_MONOTONIC, &guard_t0);
+    mp_first = mp_prev;
+    clock_gettime(CLOCK_MONOTONIC, &mp_ts_prev);
+
+    /* dynamic freq tracking */
+    if (dynamic_freq && current_max_freq) {
+        for (int c = 0; c < g_available_cpus; ++c) {
+            long hz = 0;
+            if (read_scaling_cur_freq(c, &hz) == 0) current_max_freq[c] = hz;
+            else current_max_freq[c] = 0;
+        }
+    }
+
+    /* Main monitoring & logging loop */
+    while (!stop_flag && now < end_time) {
+        for (int s = 0; s < log_interval && !stop_flag; ++s) sleep(1);
+        if (stop_flag) break;
+
+        int cpus_read = read_proc_stat_split(total_curr, idle_curr, user_curr, sys_curr, g_available_cpus);
+        if (cpus_read <= 0) cpus_read = g_available_cpus;
+        if (cpus_read > g_available_cpus) cpus_read = g_available_cpus;
+
+        double *util_pct = calloc(cpus_read, sizeof(double));
+        double *user_pct = calloc(cpus_read, sizeof(double));
+        double *sys_pct = calloc(cpus_read, sizeof(double));
+        long *freqs = calloc(cpus_read, sizeof(long));
+        if (!util_pct || !user_pct || !sys_pct || !freqs) {
+            free(util_pct); free(user_pct); free(sys_pct); free(freqs);
+            break;
+        }
+        double user_all = 0.0, sys_all = 0.0;
+
+        for (int c = 0; c < cpus_read; ++c) {
+            uint64_t totald = total_curr[c] - total_prev[c];
+            uint64_t idled  = idle_curr[c] - idle_prev[c];
+            double usage = 0.0;
+            if (totald > 0) usage = 100.0 * (double)(totald - idled) / (double)totald;
+            util_pct[c] = usage;
+            if (totald > 0) {
+                user_pct[c] = 100.0 * (double)(user_curr[c] - user_prev[c]) / (double)totald;
+                sys_pct[c] = 100.0 * (double)(sys_curr[c] - sys_prev[c]) / (double)totald;
+            }
+            user_all += user_pct[c];
+            sys_all += sys_pct[c];
+            total_prev[c] = total_curr[c];
+            idle_prev[c] = idle_curr[c];
+            user_prev[c] = user_curr[c];
+            sys_prev[c] = sys_curr[c];
+
+            if (read_scaling_cur_freq(c, &freqs[c]) != 0) freqs[c] = 0;
+        }
+
+        double tempC = NAN;
+        if (temp_path_ptr && *temp_path_ptr) tempC = read_temperature(*temp_path_ptr);
+
+        /* Accumulate statistics */
+        if (!isnan(tempC)) {
+            if (temp_count == 0) temp_start = tempC;
+            temp_sum += tempC;
+            temp_count++;
+        }
+        for (int c = 0; c < cpus_read; ++c) {
+            if (freqs[c] > 0) {
+                freq_sum += freqs[c];
+                freq_count++;
+            }
+            util_sum += util_pct[c];
+            util_count++;
+            if (core_util_sum && core_freq_sum && core_freq_cnt && c < core_slots) {
+                core_util_sum[c] += util_pct[c];
+                if (freqs[c] > 0) { core_freq_sum[c] += freqs[c] / 1000.0; core_freq_cnt[c]++; }
+            }
+        }
+        core_samples++;
+        user_all /= cpus_read;
+        sys_all /= cpus_read;
+        user_sum += user_all;
+        sys_sum += sys_all;
+
+        now = time(NULL);
+        int elapsed_sec = (int)(now - start);
+
+        /* Console output */
+        printf("\n=== time: %lds elapsed (%lds remaining) ===\n", (long)(now - start), (long)(end_time - now));
+        for (int c = 0; c < cpus_read; ++c) {
+            if (c < cores_to_log) printf(" core %2d : %6.2f%% (usr %5.1f sys %5.1f)  freq=%ld kHz\n",
+                                         c, util_pct[c], user_pct[c], sys_pct[c], freqs[c]);
+        }
+        if (cpus_read > cores_to_log) {
+            double agg_util = 0; long agg_freq = 0; int agg_cnt = 0;
+            for (int c = cores_to_log; c < cpus_read; ++c) { agg_util += util_pct[c]; if (freqs[c] > 0) { agg_freq += freqs[c]; agg_cnt++; } }
+            if (agg_cnt > 0) agg_freq /= agg_cnt;
+            printf(" cores %d..%d : avg_util=%.2f%% avg_freq=%ld kHz\n", cores_to_log, cpus_read - 1, agg_util / (cpus_read - cores_to_log), agg_freq);
+        }
+        if (!isnan(tempC)) printf(" CPU temp : %.2f °C\n", tempC); else printf(" CPU temp : (unavailable)\n");
+        double tccd[AMD_MAX_CCDS];
+        if (n_tccd > 0) {
+            printf(" CCD temp :");
+            for (int d = 0; d < n_tccd; ++d) {
+                tccd[d] = read_temperature(tccd_path[d]);
+                printf(" ccd%d=%.1f", tccd_id[d], isnan(tccd[d]) ? 0.0 : tccd[d]);
+            }
+            printf(" °C\n");
+        }
+
+        double pkg_w = NAN, pp0_w = NAN, dram_w = NAN;
+        if (rapl_active && rapl_read_power(&rapl, &pkg_w, &pp0_w, &dram_w) == 0) {
+            pkg_watts_sum += pkg_w;
+            pkg_watts_count++;
+            if (!isnan(pp0_w)) { pp0_watts_sum += pp0_w; pp0_watts_count++; }
+            printf(" Power    : pkg=%.2f W  cores=%.2f W  dram=%.2f W", pkg_w, pp0_w, dram_w);
+            if (rapl.has[RAPL_PSYS]) printf("  psys=%.2f W", rapl.psys_watts);
+            printf("\n");
+        }
+        double kswapd_pct = NAN, touch_mbps = 0.0, scan_k = 0.0, scan_d = 0.0, majflt = 0.0;
+        if (g_memp.running) {
+            memp_read_stats(&mp_curr);
+            clock_gettime(CLOCK_MONOTONIC, &mp_ts_curr);
+            double mdt = (mp_ts_curr.tv_sec - mp_ts_prev.tv_sec) + (mp_ts_curr.tv_nsec - mp_ts_prev.tv_nsec) / 1e9;
+            uint64_t touched = __atomic_load_n(&g_memp.touched, __ATOMIC_RELAXED);
+            if (mdt > 0) {
+                if (g_memp.kswapd_n > 0)
+                    kswapd_pct = 100.0 * (double)(mp_curr.kswapd_ticks - mp_prev.kswapd_ticks) /
+                                 (double)sysconf(_SC_CLK_TCK) / mdt;
+                touch_mbps = (double)(touched - mp_touched_prev) / 1048576.0 / mdt;
+                scan_k = (double)(mp_curr.pgscan_kswapd - mp_prev.pgscan_kswapd) / mdt;
+                scan_d = (double)(mp_curr.pgscan_direct - mp_prev.pgscan_direct) / mdt;
+                majflt = (double)(mp_curr.pgmajfault - mp_prev.pgmajfault) / mdt;
+            }
+            if (!isnan(kswapd_pct)) { kswapd_pct_sum += kswapd_pct; mp_samples++; }
+            if (mp_curr.rss_kb > rss_peak_kb) rss_peak_kb = mp_curr.rss_kb;
+            printf(" Memory   : rss=%ld MB  touch=%.0f MB/s  kswapd=%.1f%%  scan kswapd/direct=%.0f/%.0f pg/s  majflt=%.0f/s\n",
+                   mp_curr.rss_kb / 1024, touch_mbps, isnan(kswapd_pct) ? 0.0 : kswapd_pct, scan_k, scan_d, majflt);
+            mp_prev = mp_curr;
+            mp_ts_prev = mp_ts_curr;
+            mp_touched_prev = touched;
+        }
+        double unc_mhz[UNCORE_MAX_DOMAINS];
+        if (g_uncore_n > 0) {
+            printf(" Uncore   :");
+            for (int u = 0; u < g_uncore_n; ++u) {
+                unc_mhz[u] = uncore_cur_mhz(u);
+                if (!isnan(unc_mhz[u])) { unc_sum[u] += unc_mhz[u]; unc_cnt[u]++; }
+                printf(" %s=%.0f MHz", g_uncore[u].name, isnan(unc_mhz[u]) ? 0.0 : unc_mhz[u]);
+            }
+            printf("\n");
+        }
+        if (g_hwmon_n > 0) {
+            printf(" hwmon    :");
+            for (int h = 0; h < g_hwmon_n; ++h) {
+                hw_val[h] = hwmon_read(&g_hwmon[h]);
+                hwmon_stats_add(&hw_stats[h], &g_hwmon[h], hw_val[h], tempC, elapsed_sec);
+                if (isnan(hw_val[h])) printf(" %s=n/a", g_hwmon[h].label);
+                else printf(" %s=%.*f %s", g_hwmon[h].label, g_hwmon[h].kind == HWMON_FAN ? 0 : 2, hw_val[h],
+                            hwmon_unit[g_hwmon[h].kind]);
+            }
+            printf("\n");
+        }
+        guard_pred_t gp = { 0.0, INFINITY, -1, 0 };
+        if (g_guard.enabled) {
+            double gtemp[GUARD_MAX_SENSORS];
+            int k = 0;
+            gtemp[k++] = tempC;
+            for (int d = 0; d < n_tccd && k < guard_n; ++d) gtemp[k++] = tccd[d];
+            for (int h = 0; h < g_hwmon_n && k < guard_n; ++h)
+                if (g_hwmon[h].kind == HWMON_TEMP) gtemp[k++] = hw_val[h];
+            struct timespec gts;
+            clock_gettime(CLOCK_MONOTONIC, &gts);
+            guard_update((gts.tv_sec - guard_t0.tv_sec) + (gts.tv_nsec - guard_t0.tv_nsec) / 1e9, gtemp, k,
+                         temp_threshold, type, &gp);
+            guard_samples++;
+            printf(" Guard    :");
+            if (gp.sensor >= 0) {
+                printf(" %+.3f °C/s on %s, ", gp.slope, guard_name[gp.sensor]);
+                if (isfinite(gp.eta)) printf("%.0f s to %.1f °C", gp.eta, temp_threshold);
+                else printf("not rising");
+            } else {
+                printf(" collecting samples");
+            }
+            printf(", duty %.0f%%, %s%s\n", g_guard.duty_pm / 10.0, workload_str(guard_kernel(type)),
+                   gp.action < 0 ? "  [back-off]" : gp.action > 0 ? "  [recover]" : "");
+        }
+        for (int t = 0; t < nthreads; ++t) { uint64_t ops = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED); printf(" thread %2d pinned->cpu%2d : ops_total=%" PRIu64 " target=%.1f%%\n", t, wargs[t].cpu_id, ops, wargs[t].target_util); }
+
+        /* Logging to CSV */
+        if (logf && logging_enabled) {
+            if (safe_fprintf_flush(logf, "%ld,%d,", (long)now, elapsed_sec) != 0) {
+                fprintf(stderr, "Warning: log write failed. Disabling logging.\n");
+                fclose(logf); logf = NULL; logging_enabled = 0;
+            } else {
+                if (!isnan(tempC)) fprintf(logf, "%.2f", tempC);
+                for (int c = 0; c < cores_to_log; ++c) fprintf(logf, ",%.2f,%ld", util_pct[c], freqs[c]);
+                if (cpus_read > cores_to_log) {
+                    double agg_util = 0; long agg_freq = 0; int agg_cnt = 0;
+                    for (int c = cores_to_log; c < cpus_read; ++c) { agg_util += util_pct[c]; if (freqs[c] > 0) { agg_freq += freqs[c]; agg_cnt++; } }
+                    double avg_util = (cpus_read - cores_to_log) ? agg_util / (cpus_read - cores_to_log) : 0.0;
+                    long avg_freq = agg_cnt ? agg_freq / agg_cnt : 0;
+                    fprintf(logf, ",%.2f,%ld", avg_util, avg_freq);
+                }
+                for (int t = 0; t < nthreads; ++t) {
+                    uint64_t ops = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED);
+                    uint64_t prev = prev_ops ? prev_ops[t] : 0ULL;
+                    uint64_t delta = (ops >= prev) ? (ops - prev) : (UINT64_MAX - prev + ops + 1);
+                    if (prev_ops) prev_ops[t] = ops;
+                    fprintf(logf, ",%" PRIu64, delta);
+                }
+                if (rapl_active) {
+                    if (!isnan(pkg_w)) {
+                        fprintf(logf, ",%.2f,", pkg_w);
+                        if (!isnan(pp0_w)) fprintf(logf, "%.2f", pp0_w);
+                        fprintf(logf, ",");
+                        if (!isnan(dram_w)) fprintf(logf, "%.2f", dram_w);
+                    } else {
+                        fprintf(logf, ",,,");
+                    }
+                    if (rapl.has[RAPL_PSYS]) {
+                        fprintf(logf, ",");
+                        if (!isnan(pkg_w) && !isnan(rapl.psys_watts)) fprintf(logf, "%.2f", rapl.psys_watts);
+                    }
+                }
+                fprintf(logf, ",%.2f,%.2f", user_all, sys_all);
+                for (int c = 0; c < cores_to_log; ++c) {
+                    if (c < cpus_read) fprintf(logf, ",%.2f,%.2f", user_pct[c], sys_pct[c]);
+                    else fprintf(logf, ",,");
+                }
+                if (g_memp.running) {
+                    fprintf(logf, ",%ld,%.1f,", mp_curr.rss_kb / 1024, touch_mbps);
+                    if (!isnan(kswapd_pct)) fprintf(logf, "%.2f", kswapd_pct);
+                    fprintf(logf, ",%.0f,%.0f,%.0f", scan_k, scan_d, majflt);
+                }
+                for (int u = 0; u < g_uncore_n; ++u) {
+                    fprintf(logf, ",");
+                    if (!isnan(unc_mhz[u])) fprintf(logf, "%.0f", unc_mhz[u]);
+                }
+                for (int d = 0; d < n_tccd; ++d) {
+                    fprintf(logf, ",");
+                    if (!isnan(tccd[d])) fprintf(logf, "%.1f", tccd[d]);
+                }
+                for (int h = 0; h < g_hwmon_n; ++h) {
+                    fprintf(logf, ",");
+                    if (!isnan(hw_val[h])) fprintf(logf, "%.3f", hw_val[h]);
+                }
+                if (g_guard.enabled) {
+                    if (gp.sensor >= 0) fprintf(logf, ",%s,%.4f,", guard_name[gp.sensor], gp.slope);
+                    else fprintf(logf, ",,,");
+                    if (isfinite(gp.eta)) fprintf(logf, "%.1f", gp.eta);
+                    fprintf(logf, ",%.0f,%d", g_guard.duty_pm / 10.0, g_guard.isa_down);
+                }
+                fprintf(logf, "\n"); fflush(logf);
+            }
+        }
+
+        /* Dynamic freq tuner */
+        if (dynamic_freq && !isnan(tempC) && current_max_freq) {
+            if (tempC >= temp_threshold) {
+                for (int c = 0; c < g_available_cpus; ++c) {
+                    long cur = current_max_freq[c];
+                    if (cur <= 0) { long r=0; if (read_scaling_cur_freq(c, &r) == 0) cur = r; }
+                    long new_max = (long)(cur * (100 - DYN_FREQ_STEP_PCT) / 100.0);
+                    if (new_max < 100000) new_max = 100000;
+                    if (write_scaling_min_max(c, -1, new_max) == 0) {
+                        current_max_freq[c] = new_max;
+                        fprintf(stderr, "dynamic-freq: reduced cpu %d max_freq to %ld kHz due to temp %.2f\n", c, new_max, tempC);
+                    }
+                }
+            }
+        }
+
+        /* temp safety auto-stop */
+        if (!isnan(tempC) && tempC >= temp_threshold) {
+            fprintf(stderr, "ALERT: CPU temperature %.2f°C >= threshold %.2f°C. Stopping.\n", tempC, temp_threshold);
+            stop_flag = 1;
+            free(util_pct); free(user_pct); free(sys_pct); free(freqs);
+            break;
+        }
+
+        free(util_pct); free(user_pct); free(sys_pct); free(freqs);
+    }
+
+    /* Stop workers and monitor */
+    stop_flag = 1;
+    for (int i = 0; i < nthreads; ++i) pthread_join(tids[i], NULL);
+    if (mon_tid) pthread_join(mon_tid, NULL);
+
+    /* Final summary with statistics */
+    if (total_curr && idle_curr) read_proc_stat(total_curr, idle_curr, g_available_cpus);
+    
+    /* Calculate final statistics */
+    uint64_t total_ops = 0;
+    for (int t = 0; t < nthreads; ++t) {
+        total_ops += __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED);
+    }
+    long elapsed = (long)(time(NULL) - start);
+    double avg_temp = temp_count > 0 ? temp_sum / temp_count : 0.0;
+    long avg_freq = freq_count > 0 ? freq_sum / freq_count : 0;
+    double avg_util = util_count > 0 ? util_sum / util_count : 0.0;
+    double avg_pkg_watts = pkg_watts_count > 0 ? pkg_watts_sum / pkg_watts_count : NAN;
+    double avg_ops_per_core = nthreads > 0 ? (double)total_ops / nthreads : 0.0;
+    double total_ops_millions = total_ops / 1000000.0;
+    
+    printf("\n=== SUMMARY ===\n");
+    printf("\n--- Test Configuration ---\n");
+    printf(" Mode            : %s\n", mode);
+    
+    const char *workload_name = 
+        (type==W_INT)?"INT (Scalar Integer)":
+        (type==W_FLOAT)?"FLOAT (Scalar FP)":
+        (type==W_SSE)?"SSE (128-bit SIMD)":
+        (type==W_AVX)?"AVX (256-bit SIMD)":
+        (type==W_AVX2)?"AVX2 (256-bit SIMD + FMA)":
+        (type==W_AVX512)?"AVX512 (512-bit SIMD)":
+        (type==W_MEMBW)?"MEMBW (Memory Bandwidth)":
+        (type==W_CRYPTO)?"CRYPTO (AES-NI)":
+        (type==W_GATHER)?"GATHER (AVX2 Gather)":
+        (type==W_SYSCALL)?"SYSCALL (getppid loop)":
+        (type==W_PIPE)?"PIPE (pipe/eventfd round trips)":
+        (type==W_PGFAULT)?"PGFAULT (mmap/munmap fault churn)":
+        (type==W_MADVISE)?"MADVISE (MADV_DONTNEED refault)":
+        (type==W_TLB)?"TLB (page-walk pointer chase)":
+        (type==W_LOCK)?"LOCK (shared-lock contention)":
+        (type==W_COPY)?"COPY (memcpy/fill method)":
+        (type==W_DFLOAT)?"DFLOAT (Scalar FP, denormal)":
+        (type==W_DSSE)?"DSSE (128-bit SIMD, denormal)":
+        (type==W_DAVX)?"DAVX (256-bit SIMD, denormal)":
+        (type==W_FRONTEND)?"FRONTEND (generated code, branchy)":
+        (type==W_AUTO)?"AUTO":"MIXED";
+    
+    printf(" Workload        : %s\n", workload_name);
+    printf(" Threads         : %d\n", nthreads);
+    printf(" Target Util     : %.1f%%\n", util);
+    printf(" Duration        : %ld s (elapsed: %ld s)\n", duration, elapsed);
+    printf(" Fingerprint     : %s\n", g_fingerprint.hash);
+    
+    printf("\n--- Aggregate Statistics ---\n");
+    if (util_count > 0) {
+        printf(" Avg Utilization : %.2f%%\n", avg_util);
+        printf(" Avg User/System : %.2f%% / %.2f%%\n",
+               core_samples ? user_sum / core_samples : 0.0, core_samples ? sys_sum / core_samples : 0.0);
+    } else {
+        printf(" Avg Utilization : N/A\n");
+    }
+    
+    if (temp_count > 0)
+        printf(" Avg Temperature : %.2f °C\n", avg_temp);
+    else
+        printf(" Avg Temperature : N/A\n");
+    
+    if (freq_count > 0)
+        printf(" Avg Frequency   : %.2f MHz (%.2f GHz)\n", 
+               avg_freq / 1000.0, avg_freq / 1000000.0);
+    else
+        printf(" Avg Frequency   : N/A\n");
+    
+    printf(" Total Operations: %.2f Million (%.2fM)\n", total_ops_millions, total_ops_millions);
+    printf(" Avg Ops/Core    : %.2f Million\n", avg_ops_per_core / 1000000.0);
+    printf(" Ops/Second      : %.2f Million/s\n", 
+           elapsed > 0 ? total_ops_millions / elapsed : 0.0);
+    if (pkg_watts_count > 0)
+        printf(" Avg Pkg Power   : %.2f W\n", avg_pkg_watts);
+    
+    if (temp_path_ptr && *temp_path_ptr) { 
+        double t=read_temperature(*temp_path_ptr); 
+        if (!isnan(t)) 
+            printf(" Final Temperature: %.2f °C\n", t); 
+    }
+    
+    printf("\n--- Per-Thread Details ---\n");
+    for (int t = 0; t < nthreads; ++t) { 
+        uint64_t ops = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED); 
+        printf(" thread %2d -> cpu%2d : %" PRIu64 " ops (%.2fM)\n", 
+               t, wargs[t].cpu_id, ops, ops / 1000000.0); 
+    }
+
+    /* Lock handoff fairness across threads */
+    double fairness = NAN, min_max = NAN;
+    if (type == W_LOCK && nthreads > 1) {
+        uint64_t *acq = calloc(nthreads, sizeof(uint64_t));
+        if (acq) {
+            uint64_t lo = UINT64_MAX, hi = 0;
+            for (int t = 0; t < nthreads; ++t) {
+                acq[t] = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED);
+                if (acq[t] < lo) lo = acq[t];
+                if (acq[t] > hi) hi = acq[t];
+            }
+            fairness = jain_fairness(acq, nthreads);
+            min_max = hi ? (double)lo / (double)hi : 0.0;
+            printf(" Lock %-6s     : %.0f acquisitions/s, Jain fairness %.3f, min/max %.3f\n",
+                   lock_kind_names[g_lock.kind], elapsed > 0 ? (double)total_ops / elapsed : 0.0,
+                   fairness, min_max);
+            free(acq);
+        }
+    }
+
+    /* Hybrid parts: throughput, frequency and cycle share per core type */
+    core_type_stats_t ctype[CORE_TYPES];
+    memset(ctype, 0, sizeof(ctype));
+    double avg_pp0_watts = pp0_watts_count > 0 ? pp0_watts_sum / pp0_watts_count : NAN;
+    if (g_hybrid) {
+        unsigned char *counted = calloc(HYBRID_MAX_CPUS, 1);
+        for (int t = 0; t < nthreads && counted; ++t) {
+            int cpu = wargs[t].cpu_id, k = core_type_of(cpu);
+            ctype[k].ops += __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED);
+            if (cpu < 0 || cpu >= HYBRID_MAX_CPUS || counted[cpu]) continue;
+            counted[cpu] = 1;
+            ctype[k].ncpu++;
+            if (cpu < core_slots && core_freq_cnt && core_freq_cnt[cpu] && core_samples > 0) {
+                double mhz = core_freq_sum[cpu] / core_freq_cnt[cpu];
+                ctype[k].mhz_sum += mhz;
+                ctype[k].mhz_cnt++;
+                ctype[k].busy_ghz += core_util_sum[cpu] / core_samples / 100.0 * mhz / 1000.0;
+            }
+        }
+        free(counted);
+        hybrid_report(stdout, ctype, (double)elapsed, avg_pp0_watts, 0);
+    }
+
+    hwmon_report(stdout, hw_stats, temp_start, 0);
+    guard_report(stdout, type, guard_samples, 0);
+
+    /* Memory pressure over the whole run */
+    uint64_t mp_direct = 0, mp_cycles = 0;
+    if (g_memp.running) {
+        memp_read_stats(&mp_curr);
+        mp_direct = mp_curr.pgscan_direct - mp_first.pgscan_direct;
+        mp_cycles = __atomic_load_n(&g_memp.cycles, __ATOMIC_RELAXED) - mp_cycles0;
+        printf(" Mem Pressure    : %zu MB held, peak RSS %ld MB, avg kswapd %.1f%%, %" PRIu64
+               " direct scans, %" PRIu64 " cycles\n", g_memp.bytes >> 20, rss_peak_kb / 1024,
+               mp_samples ? kswapd_pct_sum / mp_samples : 0.0, mp_direct, mp_cycles);
+    }
+
+    for (int u = 0; u < g_uncore_n; ++u)
+        if (unc_cnt[u]) printf(" Uncore %-9s: avg %.0f MHz\n", g_uncore[u].name, unc_sum[u] / unc_cnt[u]);
+
+    /* Write summary file */
+    if (summaryf) {
+        fprintf(summaryf, "=== CoreBurner Test Summary ===\n\n");
+        if (phase_label)
+            fprintf(summaryf, "phase=%s\n\n", phase_label);
+        fprintf(summaryf, "[Configuration]\n");
+        fprintf(summaryf, "mode=%s\n", mode);
+        fprintf(summaryf, "workload=%s\n", workload_str(type));
+        fprintf(summaryf, "target_util=%.1f%%\n", util);
+        fprintf(summaryf, "threads=%d\n", nthreads);
+        fprintf(summaryf, "duration_requested=%ld\n", duration);
+        fprintf(summaryf, "time_elapsed=%ld\n", elapsed);
+        
+        fprintf(summaryf, "\n[Fingerprint]\n");
+        write_machine_fingerprint(summaryf, "", &g_fingerprint);
+
+        fprintf(summaryf, "\n[Aggregate Statistics]\n");
+        if (temp_count > 0)
+            fprintf(summaryf, "avg_temperature=%.2f\n", avg_temp);
+        if (freq_count > 0)
+            fprintf(summaryf, "avg_frequency_mhz=%.2f\n", avg_freq / 1000.0);
+        fprintf(summaryf, "total_operations=%.2f\n", total_ops_millions);
+        fprintf(summaryf, "avg_ops_per_core_millions=%.2f\n", avg_ops_per_core / 1000000.0);
+        fprintf(summaryf, "ops_per_second_millions=%.2f\n", 
+                elapsed > 0 ? total_ops_millions / elapsed : 0.0);
+        if (pkg_watts_count > 0)
+            fprintf(summaryf, "avg_pkg_watts=%.2f\n", avg_pkg_watts);
+        
+        if (temp_path_ptr && *temp_path_ptr) { 
+            double t=read_temperature(*temp_path_ptr); 
+            if (!isnan(t)) 
+                fprintf(summaryf, "final_temp=%.2f\n", t); 
+        }
+        
+        fprintf(summaryf, "\n[Per-Thread Results]\n");
+        for (int t = 0; t < nthreads; ++t) { 
+            uint64_t ops = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED); 
+            fprintf(summaryf, "thread%02d_cpu%02d_ops=%" PRIu64 "\n", t, wargs[t].cpu_id, ops); 
+            fprintf(summaryf, "thread%02d_cpu%02d_ops_millions=%.2f\n", t, wargs[t].cpu_id, ops / 1000000.0); 
+        }
+        if (!isnan(fairness)) {
+            fprintf(summaryf, "\n[Lock Contention]\n");
+            fprintf(summaryf, "lock_kind=%s\n", lock_kind_names[g_lock.kind]);
+            fprintf(summaryf, "acquisitions_per_sec=%.0f\n", elapsed > 0 ? (double)total_ops / elapsed : 0.0);
+            fprintf(summaryf, "jain_fairness=%.4f\n", fairness);
+            fprintf(summaryf, "min_max_ratio=%.4f\n", min_max);
+        }
+        if (g_memp.running) {
+            fprintf(summaryf, "\n[Memory Pressure]\n");
+            fprintf(summaryf, "held_mb=%zu\n", g_memp.bytes >> 20);
+            fprintf(summaryf, "touch_mbps=%.0f\n", g_memp.touch_mbps);
+            fprintf(summaryf, "cycle_sec=%d\n", g_memp.cycle_sec);
+            fprintf(summaryf, "peak_rss_mb=%ld\n", rss_peak_kb / 1024);
+            if (mp_samples) fprintf(summaryf, "avg_kswapd_pct=%.2f\n", kswapd_pct_sum / mp_samples);
+            fprintf(summaryf, "pgscan_direct=%" PRIu64 "\n", mp_direct);
+            fprintf(summaryf, "cycles=%" PRIu64 "\n", mp_cycles);
+        }
+        if (g_hybrid) hybrid_report(summaryf, ctype, (double)elapsed, avg_pp0_watts, 1);
+        hwmon_report(summaryf, hw_stats, temp_start, 1);
+        guard_report(summaryf, type, guard_samples, 1);
+        if (g_uncore_n > 0) {
+            fprintf(summaryf, "\n[Uncore]\n");
+            for (int u = 0; u < g_uncore_n; ++u) {
+                fprintf(summaryf, "%s_min_khz=%ld\n", g_uncore[u].name, uncore_read_khz(&g_uncore[u], "min_freq_khz"));
+                fprintf(summaryf, "%s_max_khz=%ld\n", g_uncore[u].name, uncore_read_khz(&g_uncore[u], "max_freq_khz"));
+                if (unc_cnt[u]) fprintf(summaryf, "%s_avg_mhz=%.0f\n", g_uncore[u].name, unc_sum[u] / unc_cnt[u]);
+            }
+        }
+        fclose(summaryf);
+        if (summary_path) printf("\nSummary written to %s\n", summary_path);
+    }
+
+    /* Cleanup */
+    if (logf) fclose(logf);
+    if (rapl_active) rapl_close(&rapl);
+    free(prev_ops);
+    free(hw_stats); free(hw_val);
+    free(summary_path);
+    free(total_prev); free(idle_prev); free(total_curr); free(idle_curr);
+    free(user_prev); free(sys_prev); free(user_curr); free(sys_curr);
+
+    /* return allocated arrays to caller for potential further inspection */
+    if (out_wargs) *out_wargs = wargs; else free(wargs);
+    if (out_tids)  *out_tids  = tids;  else free(tids);
+    if (out_stats) {
+        out_stats->elapsed_sec = elapsed;
+        out_stats->avg_util = avg_util;
+        out_stats->avg_temp = temp_count > 0 ? avg_temp : NAN;
+        out_stats->avg_freq_mhz = avg_freq / 1000.0;
+        out_stats->avg_pkg_watts = avg_pkg_watts;
+        out_stats->total_ops_millions = total_ops_millions;
+        out_stats->ops_per_sec = elapsed > 0 ? total_ops_millions / elapsed : 0.0;
+        out_stats->ncores = 0;
+        out_stats->core_avg_util = calloc(core_slots, sizeof(double));
+        out_stats->core_avg_freq_mhz = calloc(core_slots, sizeof(double));
+        if (out_stats->core_avg_util && out_stats->core_avg_freq_mhz &&
+            core_util_sum && core_freq_sum && core_freq_cnt) {
+            out_stats->ncores = core_slots;
+            for (int c = 0; c < core_slots; ++c) {
+                out_stats->core_avg_util[c] = core_samples > 0 ? core_util_sum[c] / core_samples : 0.0;
+                out_stats->core_avg_freq_mhz[c] = core_freq_cnt[c] > 0 ? core_freq_sum[c] / core_freq_cnt[c] : 0.0;
+            }
+        }
+    }
+    free(core_util_sum); free(core_freq_sum); free(core_freq_cnt);
+
+    return 0;
+}
+
+/*******************************************************
+ *     Parse CSV Log and Calculate True Averages
+ *******************************************************/
+typedef struct {
+    double avg_temp;
+    double avg_freq_mhz;
+    double avg_util_pct;
+    double avg_ops_per_core_millions;
+    double ops_per_sec_millions;
+    int sample_count;
+} csv_statistics_t;
+
+int parse_csv_log_for_stats(const char *csv_path, int nthreads, csv_statistics_t *stats) {
+    FILE *f = fopen(csv_path, "r");
+    if (!f) return -1;
+    
+    memset(stats, 0, sizeof(*stats));
+    
+    char line[65536];
+    int data_lines = 0;
+    
+    /* Skip comments and find header */
+    int found_header = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        if (strstr(line, "timestamp,elapsed_sec,cpu_temp")) {
+            found_header = 1;
+            break;
+        }
+    }
+    
+    if (!found_header) {
+        fclose(f);
+        return -1;
+    }
+    
+    /* Parse data lines */
+    while (fgets(line, sizeof(line), f)) {
+        /* Parse: timestamp,elapsed_sec,cpu_temp,cpu0_util,cpu0_freq,cpu1_util,cpu1_freq,... */
+        char *ptr = line;
+        char *endptr;
+        
+        /* Skip timestamp */
+        strtol(ptr, &endptr, 10);
+        if (*endptr != ',') continue;
+        ptr = endptr + 1;
+        
+        /* Skip elapsed_sec */
+        strtol(ptr, &endptr, 10);
+        if (*endptr != ',') continue;
+        ptr = endptr + 1;
+        
+        /* Read cpu_temp */
+        double temp = strtod(ptr, &endptr);
+        int temp_valid = (temp > 0 && endptr != ptr);
+        if (*endptr == ',') ptr = endptr + 1;
+        else continue;
+        
+        /* Read alternating util,freq pairs until we hit thread ops */
+        double total_util = 0.0;
+        double total_freq = 0.0;
+        int core_count = 0;
+        
+        /* We expect cores followed by thread ops (much larger numbers) */
+        while (*ptr && *ptr != '\n' && *ptr != '\r') {
+            /* Read util (should be 0-100) */
+            double util = strtod(ptr, &endptr);
+            if (endptr == ptr) break;
+            ptr = endptr;
+            if (*ptr == ',') ptr++;
+            
+            /* Read freq (should be in kHz, like 1800000-3500000) */
+            long freq = strtol(ptr, &endptr, 10);
+            if (endptr == ptr) break;
+            ptr = endptr;
+            if (*ptr == ',') ptr++;
+            
+            /* Check if this looks like core data (not thread ops) */
+            /* Thread ops are usually > 1M, freq is 1M-4M, util is 0-100 */
+            if (util >= 0 && util <= 100 && freq >= 100000 && freq <= 5000000) {
+                total_util += util;
+                total_freq += freq;
+                core_count++;
+            } else {
+                /* Likely hit thread operations data, stop parsing */
+                break;
+            }
+        }
+        
+        /* Accumulate statistics for this sample */
+        if (temp_valid) stats->avg_temp += temp;
+        if (core_count > 0) {
+            stats->avg_freq_mhz += (total_freq / core_count) / 1000.0;
+            stats->avg_util_pct += total_util / core_count;
+        }
+        
+        data_lines++;
+    }
+    
+    fclose(f);
+    
+    if (data_lines == 0) return -1;
+    
+    /* Calculate averages across all samples */
+    stats->avg_temp /= data_lines;
+    stats->avg_freq_mhz /= data_lines;
+    stats->avg_util_pct /= data_lines;
+    stats->sample_count = data_lines;
+    
+    return 0;
+}
+
+/*******************************************************
+ *         Repeat-and-Aggregate Statistics
+ *******************************************************/
+typedef struct {
+    int n;
+    double mean;
+    double stdev;
+    double ci_lo;   /* 95% confidence interval of the mean */
+    double ci_hi;
+} metric_summary_t;
+
+/* Two-sided 95% Student t quantile (t_0.975) for df degrees of freedom */
+double t_quantile_975(int df) {
+    static const double table[] = {
+        0.0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df <= 0) return NAN;
+    if (df <= 30) return table[df];
+    if (df <= 60) return 2.000;
+    if (df <= 120) return 1.980;
+    return 1.960;
+}
+
+/* Summarize n samples, ignoring NAN entries */
+void summarize_metric(const double *v, int n, metric_summary_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->mean = out->stdev = out->ci_lo = out->ci_hi = NAN;
+
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) if (!isnan(v[i])) { sum += v[i]; out->n++; }
+    if (out->n == 0) return;
+
+    out->mean = sum / out->n;
+    if (out->n < 2) return;
+
+    double ss = 0.0;
+    for (int i = 0; i < n; ++i) if (!isnan(v[i])) ss += (v[i] - out->mean) * (v[i] - out->mean);
+    out->stdev = sqrt(ss / (out->n - 1));
+
+    double half = t_quantile_975(out->n - 1) * out->stdev / sqrt((double)out->n);
+    out->ci_lo = out->mean - half;
+    out->ci_hi = out->mean + half;
+}
+
+/* Aggregate ops/s, frequency, power and temperature across repetitions */
+void aggregate_runs(const run_stats_t *runs, int n,
+                    metric_summary_t *ops, metric_summary_t *freq,
+                    metric_summary_t *power, metric_summary_t *temp)
+{
+    double *v = calloc(n > 0 ? n : 1, sizeof(double));
+    if (!v) return;
+
+    for (int i = 0; i < n; ++i) v[i] = runs[i].ops_per_sec;
+    summarize_metric(v, n, ops);
+    for (int i = 0; i < n; ++i) v[i] = runs[i].avg_freq_mhz > 0 ? runs[i].avg_freq_mhz : NAN;
+    summarize_metric(v, n, freq);
+    for (int i = 0; i < n; ++i) v[i] = runs[i].avg_pkg_watts;
+    summarize_metric(v, n, power);
+    for (int i = 0; i < n; ++i) v[i] = runs[i].avg_temp;
+    summarize_metric(v, n, temp);
+
+    free(v);
+}
+
+static void print_metric_summary(FILE *f, const char *name, const char *unit,
+                                 const metric_summary_t *m)
+{
+    if (m->n == 0) {
+        fprintf(f, " %-16s: N/A\n", name);
+        return;
+    }
+    if (m->n < 2) {
+        fprintf(f, " %-16s: %.2f %s (single sample)\n", name, m->mean, unit);
+        return;
+    }
+    fprintf(f, " %-16s: mean=%.2f %s  stdev=%.2f  95%% CI=[%.2f, %.2f] (±%.2f%%)\n",
+            name, m->mean, unit, m->stdev, m->ci_lo, m->ci_hi,
+            m->mean != 0 ? 100.0 * (m->ci_hi - m->mean) / fabs(m->mean) : 0.0);
+}
+
+void print_repeat_aggregate(FILE *f, const run_stats_t *runs, int n) {
+    metric_summary_t ops, freq, power, temp;
+    aggregate_runs(runs, n, &ops, &freq, &power, &temp);
+
+    fprintf(f, "\n=== Repeat Aggregate (%d repetitions) ===\n", n);
+    fprintf(f, " %-4s %12s %12s %10s %10s %9s\n",
+            "Rep", "Ops/s (M)", "Freq (MHz)", "Power (W)", "Temp (C)", "Elapsed");
+    for (int i = 0; i < n; ++i)
+        fprintf(f, " %-4d %12.2f %12.2f %10.2f %10.2f %8lds\n",
+                i + 1, runs[i].ops_per_sec, runs[i].avg_freq_mhz,
+                runs[i].avg_pkg_watts, runs[i].avg_temp, runs[i].elapsed_sec);
+    fprintf(f, "\n");
+    print_metric_summary(f, "Ops/Second", "M/s", &ops);
+    print_metric_summary(f, "Frequency", "MHz", &freq);
+    print_metric_summary(f, "Package Power", "W", &power);
+    print_metric_summary(f, "Temperature", "°C", &temp);
+    fprintf(f, "==========================================\n");
+}
+
+/* Returns 1 when the ops/s CI is narrower than target_pct of the mean */
+int repeat_ci_converged(const run_stats_t *runs, int n, double target_pct) {
+    if (target_pct <= 0 || n < CI_MIN_REPS) return 0;
+
+    metric_summary_t ops, freq, power, temp;
+    aggregate_runs(runs, n, &ops, &freq, &power, &temp);
+    if (ops.n < 2 || ops.mean == 0) return 0;
+
+    double half_pct = 100.0 * (ops.ci_hi - ops.mean) / fabs(ops.mean);
+    return half_pct <= target_pct;
+}
+
+/* Idle between repetitions: at least min_sec, then until temp <= target_temp */
+void cooldown_wait(const char *temp_path, int min_sec, double target_temp) {
+    if (min_sec > 0)
+        printf("\nCooling down for %d s before next repetition...\n", min_sec);
+
+    for (int s = 0; s < min_sec && !user_stop_flag; ++s) sleep(1);
+
+    if (target_temp <= 0 || !temp_path) return;
+
+    for (int s = 0; s < COOLDOWN_TEMP_MAX_SEC && !user_stop_flag; ++s) {
+        double t = read_temperature(temp_path);
+        if (isnan(t) || t <= target_temp) return;
+        if (s % 10 == 0)
+            printf(" waiting for temp %.2f °C <= %.2f °C\n", t, target_temp);
+        sleep(1);
+    }
+
+    if (!user_stop_flag)
+        fprintf(stderr, "Warning: cool-down target %.1f °C not reached after %d s, continuing\n",
+                target_temp, COOLDOWN_TEMP_MAX_SEC);
+}
+
+/*******************************************************
+ *            Central Results CSV Logger
+ *******************************************************/
+void write_results_csv(
+    const char *mode,
+    workload_t type,
+    int nthreads,
+    double target_util,
+    long duration,
+    long elapsed,
+    double avg_util,
+    double avg_temp,
+    long avg_freq,
+    double total_ops_millions,
+    double ops_per_second,
+    const char *command_line,
+    time_t start_time,
+    const char *rep_label,
+    double avg_pkg_watts,
+    const metric_summary_t *ops_ci)
+{
+    static const char header[] =
+        "timestamp,date,time,mode,workload,threads,target_util,"
+        "duration_sec,elapsed_sec,avg_util_pct,avg_temp_c,avg_freq_mhz,"
+        "total_ops_millions,ops_per_sec_millions,avg_ops_per_core_per_sec_millions,"
+        "command,rep,avg_pkg_watts,ops_per_sec_stdev,ops_per_sec_ci95_lo,ops_per_sec_ci95_hi,"
+        "fingerprint";
+    int ncols = 1;
+    for (const char *p = header; *p; ++p) ncols += *p == ',';
+
+    /* results.csv written by an older build has fewer columns: never mix
+     * row widths under one header, continue in results-<N>col.csv */
+    char path[64] = "results.csv";
+    FILE *results = NULL;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        results = fopen(path, "a+");
+        if (!results) {
+            fprintf(stderr, "Warning: Could not open %s for writing\n", path);
+            return;
+        }
+
+        /* Serialize concurrent runs; check the header under the lock */
+        flock(fileno(results), LOCK_EX);
+        struct stat st;
+        if (fstat(fileno(results), &st) != 0 || st.st_size == 0) {
+            fprintf(results, "%s\n", header);
+            break;
+        }
+        char first[1024];
+        rewind(results);
+        if (fgets(first, sizeof(first), results)) first[strcspn(first, "\r\n")] = '\0';
+        else first[0] = '\0';
+        if (strcmp(first, header) == 0) break;
+
+        flock(fileno(results), LOCK_UN);
+        fclose(results);
+        results = NULL;
+        if (attempt == 0) {
+            fprintf(stderr, "Warning: results.csv has a different column layout; writing results-%dcol.csv\n", ncols);
+            snprintf(path, sizeof(path), "results-%dcol.csv", ncols);
+        }
+    }
+    if (!results) {
+        fprintf(stderr, "Warning: %s has a different column layout; result row not written\n", path);
+        return;
+    }
+    fseek(results, 0, SEEK_END);
+    
+    /* Format timestamp */
+    char date_str[32], time_str[32];
+    struct tm *tm_info = localtime(&start_time);
+    strftime(date_str, sizeof(date_str), "%Y-%m-%d", tm_info);
+    strftime(time_str, sizeof(time_str), "%H:%M:%S", tm_info);
+    
+    const char *workload_name = workload_str(type);
+    
+    double avg_ops_per_core_per_sec = (nthreads > 0 && elapsed > 0) ? total_ops_millions / (elapsed * nthreads) : 0.0;
+    
+    /* Write data row */
+    fprintf(results, "%ld,%s,%s,%s,%s,%d,%.1f,%ld,%ld,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,\"%s\",",
+            (long)start_time,
+            date_str,
+            time_str,
+            mode,
+            workload_name,
+            nthreads,
+            target_util,
+            duration,
+            elapsed,
+            avg_util,
+            avg_temp,
+            avg_freq / 1000.0,  /* Convert kHz to MHz */
+            total_ops_millions,
+            ops_per_second,
+            avg_ops_per_core_per_sec,
+            command_line ? command_line : "N/A");
+
+    /* Repeat columns: blank when not applicable */
+    fprintf(results, "%s,", rep_label ? rep_label : "1");
+    if (!isnan(avg_pkg_watts)) fprintf(results, "%.2f", avg_pkg_watts);
+    if (ops_ci && ops_ci->n >= 2)
+        fprintf(results, ",%.2f,%.2f,%.2f", ops_ci->stdev, ops_ci->ci_lo, ops_ci->ci_hi);
+    else
+        fprintf(results, ",,,");
+    fprintf(results, ",%s\n", g_fingerprint.hash);
+    
+    fflush(results);
+    flock(fileno(results), LOCK_UN);
+    fclose(results);
+    printf("\n✓ Results appended to %s (rep=%s)\n", path, rep_label ? rep_label : "1");
+}
+
+/*******************************************************
+ *                 Indexed Results Store
+ *
+ * <dir>/records.jsonl : one self-describing JSON record per run
+ * <dir>/index.bin     : fixed-size entries pointing into records.jsonl
+ *
+ * Appends take an exclusive flock on records.jsonl and write each
+ * record with a single write(), so concurrent runs never interleave.
+ * --query reads only the index (under a shared lock).
+ *******************************************************/
+#define RESULTS_INDEX_MAGIC "CBIDX1\0"
+#define RESULTS_INDEX_VERSION 1
+
+typedef struct {
+    uint64_t offset;        /* record offset in records.jsonl */
+    uint32_t length;        /* record length in bytes (incl. newline) */
+    uint32_t nreps;
+    int64_t  timestamp;     /* run start (epoch seconds) */
+    uint64_t fp_hash;
+    char     kernel[32];
+    char     workload[12];
+    char     mode[20];
+    float    util;
+    float    ops_per_sec;   /* Million ops/s (mean over reps) */
+    float    freq_mhz;
+    float    pkg_watts;     /* NAN if not measured */
+    float    temp_c;        /* NAN if not measured */
+    uint32_t reserved;
+} results_index_entry_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_size;
+} results_index_header_t;
+
+static void json_str(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; s && *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+static void json_num(FILE *f, double v) {
+    if (isnan(v) || isinf(v)) fputs("null", f);
+    else fprintf(f, "%.4f", v);
+}
+
+static int write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int results_store_paths(const char *dir, char *rec, char *idx, size_t len) {
+    struct stat st;
+    if (stat(dir, &st) != 0 && mkdir(dir, 0755) != 0 && errno != EEXIST)
+        return -1;
+    snprintf(rec, len, "%s/records.jsonl", dir);
+    snprintf(idx, len, "%s/index.bin", dir);
+    return 0;
+}
+
+static int results_index_append(int idx_fd, const results_index_entry_t *e) {
+    struct stat st;
+    if (fstat(idx_fd, &st) != 0) return -1;
+
+    if (st.st_size == 0) {
+        results_index_header_t h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, RESULTS_INDEX_MAGIC, sizeof(h.magic));
+        h.version = RESULTS_INDEX_VERSION;
+        h.entry_size = sizeof(results_index_entry_t);
+        if (write_all(idx_fd, (const char *)&h, sizeof(h)) != 0) return -1;
+    }
+    return write_all(idx_fd, (const char *)e, sizeof(*e));
+}
+
+/* Append one run (all repetitions) as a single record + index entry */
+int results_store_append(
+    const char *dir,
+    const char *mode,
+    workload_t type,
+    int nthreads,
+    double target_util,
+    long duration,
+    const char *command_line,
+    time_t start_time,
+    const run_stats_t *runs,
+    int nruns)
+{
+    if (!dir || nruns <= 0) return -1;
+
+    char rec_path[1024], idx_path[1024];
+    if (results_store_paths(dir, rec_path, idx_path, sizeof(rec_path)) != 0) {
+        fprintf(stderr, "Warning: cannot create results store '%s': %s\n", dir, strerror(errno));
+        return -1;
+    }
+
+    metric_summary_t ops, freq, power, temp;
+    aggregate_runs(runs, nruns, &ops, &freq, &power, &temp);
+
+    char host[128] = "";
+    gethostname(host, sizeof(host) - 1);
+
+    /* Build the record in memory so it can be written atomically */
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *m = open_memstream(&buf, &len);
+    if (!m) return -1;
+
+    const machine_fingerprint_t *fp = &g_fingerprint;
+    fprintf(m, "{\"v\":1,\"ts\":%ld,\"host\":", (long)start_time);
+    json_str(m, host);
+
+    fprintf(m, ",\"config\":{\"mode\":");
+    json_str(m, mode);
+    fprintf(m, ",\"workload\":");
+    json_str(m, workload_str(type));
+    fprintf(m, ",\"threads\":%d,\"util\":%.1f,\"duration\":%ld,\"reps\":%d,\"command\":",
+            nthreads, target_util, duration, nruns);
+    json_str(m, command_line);
+    fputc('}', m);
+
+    fprintf(m, ",\"fingerprint\":{\"hash\":");
+    json_str(m, fp->hash);
+    fprintf(m, ",\"cpu_vendor\":"); json_str(m, fp->cpu_vendor);
+    fprintf(m, ",\"cpu_model_name\":"); json_str(m, fp->cpu_model_name);
+    fprintf(m, ",\"family\":%u,\"model\":%u,\"stepping\":%u", fp->family, fp->model, fp->stepping);
+    fprintf(m, ",\"cpu_flags\":"); json_str(m, fp->cpu_flags);
+    fprintf(m, ",\"microcode\":"); json_str(m, fp->microcode);
+    fprintf(m, ",\"kernel\":"); json_str(m, fp->kernel_release);
+    fprintf(m, ",\"kernel_cmdline\":"); json_str(m, fp->kernel_cmdline);
+    fprintf(m, ",\"cmdline_perf\":"); json_str(m, fp->cmdline_perf);
+    fprintf(m, ",\"cpufreq_driver\":"); json_str(m, fp->cpufreq_driver);
+    fprintf(m, ",\"governor\":"); json_str(m, fp->governor);
+    fprintf(m, ",\"epp\":"); json_str(m, fp->epp);
+    fprintf(m, ",\"boost\":"); json_str(m, fp->boost);
+    fprintf(m, ",\"smt\":"); json_str(m, fp->smt);
+    fprintf(m, ",\"mem_total_mb\":%ld,\"numa_nodes\":%d", fp->mem_total_mb, fp->numa_nodes);
+    fprintf(m, ",\"thp\":"); json_str(m, fp->thp);
+    fprintf(m, ",\"power_limits\":"); json_str(m, fp->power_limits);
+    fprintf(m, ",\"bios_version\":"); json_str(m, fp->bios_version);
+    fprintf(m, ",\"product\":"); json_str(m, fp->product_name);
+    fprintf(m, ",\"build\":"); json_str(m, fp->build);
+    fprintf(m, ",\"isa_dispatch\":"); json_str(m, fp->isa_dispatch);
+    fputc('}', m);
+
+    fprintf(m, ",\"stats\":{\"ops_per_sec_m\":"); json_num(m, ops.mean);
+    fprintf(m, ",\"ops_per_sec_stdev\":"); json_num(m, ops.stdev);
+    fprintf(m, ",\"ops_per_sec_ci95\":["); json_num(m, ops.ci_lo);
+    fputc(',', m); json_num(m, ops.ci_hi);
+    fprintf(m, "],\"avg_freq_mhz\":"); json_num(m, freq.mean);
+    fprintf(m, ",\"avg_pkg_watts\":"); json_num(m, power.mean);
+    fprintf(m, ",\"avg_temp_c\":"); json_num(m, temp.mean);
+    fputc('}', m);
+
+    fprintf(m, ",\"phases\":[");
+    for (int r = 0; r < nruns; ++r) {
+        fprintf(m, "%s{\"name\":\"rep%d\",\"elapsed\":%ld,\"avg_util\":", r ? "," : "", r + 1,
+                runs[r].elapsed_sec);
+        json_num(m, runs[r].avg_util);
+        fprintf(m, ",\"ops_per_sec_m\":"); json_num(m, runs[r].ops_per_sec);
+        fprintf(m, ",\"total_ops_m\":"); json_num(m, runs[r].total_ops_millions);
+        fprintf(m, ",\"avg_freq_mhz\":"); json_num(m, runs[r].avg_freq_mhz);
+        fprintf(m, ",\"avg_pkg_watts\":"); json_num(m, runs[r].avg_pkg_watts);
+        fprintf(m, ",\"avg_temp_c\":"); json_num(m, runs[r].avg_temp);
+        fputc('}', m);
+    }
+
+    /* Per-core summary: averaged over repetitions */
+    fprintf(m, "],\"cores\":[");
+    int ncores = runs[0].ncores;
+    for (int c = 0; c < ncores; ++c) {
+        double u = 0.0, f = 0.0;
+        int fn = 0;
+        for (int r = 0; r < nruns; ++r) {
+            if (c >= runs[r].ncores) continue;
+            u += runs[r].core_avg_util[c];
+            if (runs[r].core_avg_freq_mhz[c] > 0) { f += runs[r].core_avg_freq_mhz[c]; fn++; }
+        }
+        fprintf(m, "%s{\"cpu\":%d,\"avg_util\":", c ? "," : "", c);
+        json_num(m, u / nruns);
+        fprintf(m, ",\"avg_freq_mhz\":");
+        json_num(m, fn > 0 ? f / fn : NAN);
+        fputc('}', m);
+    }
+    fprintf(m, "]}\n");
+
+    if (fclose(m) != 0 || !buf) {
+        free(buf);
+        return -1;
+    }
+
+    int rc = -1;
+    int rec_fd = open(rec_path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    int idx_fd = open(idx_path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (rec_fd < 0 || idx_fd < 0) {
+        fprintf(stderr, "Warning: cannot open results store '%s': %s\n", dir, strerror(errno));
+        goto out;
+    }
+
+    if (flock(rec_fd, LOCK_EX) != 0) goto out;
+
+    struct stat st;
+    if (fstat(rec_fd, &st) == 0 && write_all(rec_fd, buf, len) == 0) {
+        results_index_entry_t e;
+        memset(&e, 0, sizeof(e));
+        e.offset = (uint64_t)st.st_size;
+        e.length = (uint32_t)len;
+        e.nreps = (uint32_t)nruns;
+        e.timestamp = (int64_t)start_time;
+        e.fp_hash = strtoull(fp->hash, NULL, 16);
+        snprintf(e.kernel, sizeof(e.kernel), "%.31s", fp->kernel_release);
+        snprintf(e.workload, sizeof(e.workload), "%s", workload_str(type));
+        snprintf(e.mode, sizeof(e.mode), "%s", mode);
+        e.util = (float)target_util;
+        e.ops_per_sec = (float)ops.mean;
+        e.freq_mhz = (float)(freq.n > 0 ? freq.mean : 0.0);
+        e.pkg_watts = (float)power.mean;
+        e.temp_c = (float)temp.mean;
+
+        fdatasync(rec_fd);
+        if (results_index_append(idx_fd, &e) == 0) {
+            fdatasync(idx_fd);
+            rc = 0;
+        }
+    }
+
+    flock(rec_fd, LOCK_UN);
+
+out:
+    if (rec_fd >= 0) close(rec_fd);
+    if (idx_fd >= 0) close(idx_fd);
+    free(buf);
+
+    if (rc == 0)
+        printf("✓ Run stored in %s (fingerprint %s)\n", rec_path, fp->hash);
+    else
+        fprintf(stderr, "Warning: failed to append run to results store '%s'\n", dir);
+    return rc;
+}
+
+/* Loads the index under a shared lock. Returns entry count or -1. */
+static long results_index_load(const char *dir, results_index_entry_t **out) {
+    char rec_path[1024], idx_path[1024];
+    snprintf(rec_path, sizeof(rec_path), "%s/records.jsonl", dir);
+    snprintf(idx_path, sizeof(idx_path), "%s/index.bin", dir);
+    *out = NULL;
+
+    int rec_fd = open(rec_path, O_RDONLY);
+    if (rec_fd < 0) return -1;
+    flock(rec_fd, LOCK_SH);
+
+    long n = -1;
+    FILE *f = fopen(idx_path, "rb");
+    if (f) {
+        results_index_header_t h;
+        if (fread(&h, sizeof(h), 1, f) == 1 &&
+            memcmp(h.magic, RESULTS_INDEX_MAGIC, sizeof(h.magic)) == 0 &&
+            h.entry_size == sizeof(results_index_entry_t))
+        {
+            struct stat st;
+            fstat(fileno(f), &st);
+            long cap = (long)((st.st_size - (off_t)sizeof(h)) / sizeof(results_index_entry_t));
+            *out = calloc(cap > 0 ? cap : 1, sizeof(results_index_entry_t));
+            if (*out)
+                n = (long)fread(*out, sizeof(results_index_entry_t), cap, f);
+        } else {
+            fprintf(stderr, "Error: %s is not a CoreBurner index (try --reindex)\n", idx_path);
+        }
+        fclose(f);
+    }
+
+    flock(rec_fd, LOCK_UN);
+    close(rec_fd);
+    return n;
+}
+
+/* Minimal extractors for our own records ("key":value, first occurrence after 'from') */
+static const char *json_find(const char *rec, const char *from, const char *key) {
+    char pat[64];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const char *p = strstr(from ? from : rec, pat);
+    return p ? p + strlen(pat) : NULL;
+}
+
+static double json_get_num(const char *rec, const char *from, const char *key) {
+    const char *p = json_find(rec, from, key);
+    if (!p || strncmp(p, "null", 4) == 0) return NAN;
+    return strtod(p, NULL);
+}
+
+static void json_get_str(const char *rec, const char *from, const char *key, char *out, size_t len) {
+    out[0] = '\0';
+    const char *p = json_find(rec, from, key);
+    if (!p || *p != '"') return;
+    p++;
+    size_t i = 0;
+    while (*p && *p != '"' && i + 1 < len) {
+        if (*p == '\\' && p[1]) p++;
+        out[i++] = *p++;
+    }
+    out[i] = '\0';
+}
+
+/* Rebuilds index.bin from records.jsonl (e.g. after a crash between the two writes) */
+int results_store_reindex(const char *dir) {
+    char rec_path[1024], idx_path[1024], tmp_path[1100];
+    snprintf(rec_path, sizeof(rec_path), "%s/records.jsonl", dir);
+    snprintf(idx_path, sizeof(idx_path), "%s/index.bin", dir);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", idx_path);
+
+    int rec_fd = open(rec_path, O_RDONLY);
+    if (rec_fd < 0) {
+        fprintf(stderr, "Error: %s: %s\n", rec_path, strerror(errno));
+        return -1;
+    }
+    flock(rec_fd, LOCK_EX);
+
+    FILE *rf = fdopen(dup(rec_fd), "r");
+    int tmp_fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    long count = 0;
+    int rc = -1;
+
+    if (rf && tmp_fd >= 0) {
+        char *line = NULL;
+        size_t cap = 0;
+        ssize_t n;
+        uint64_t off = 0;
+
+        while ((n = getline(&line, &cap, rf)) > 0) {
+            results_index_entry_t e;
+            memset(&e, 0, sizeof(e));
+            char buf[64];
+            const char *stats = strstr(line, "\"stats\":");
+
+            e.offset = off;
+            e.length = (uint32_t)n;
+            e.timestamp = (int64_t)json_get_num(line, NULL, "ts");
+            e.nreps = (uint32_t)json_get_num(line, NULL, "reps");
+            e.util = (float)json_get_num(line, NULL, "util");
+            json_get_str(line, NULL, "mode", e.mode, sizeof(e.mode));
+            json_get_str(line, NULL, "workload", e.workload, sizeof(e.workload));
+            json_get_str(line, NULL, "kernel", e.kernel, sizeof(e.kernel));
+            json_get_str(line, NULL, "hash", buf, sizeof(buf));
+            e.fp_hash = strtoull(buf, NULL, 16);
+            if (stats) {
+                e.ops_per_sec = (float)json_get_num(line, stats, "ops_per_sec_m");
+                double f = json_get_num(line, stats, "avg_freq_mhz");
+                e.freq_mhz = (float)(isnan(f) ? 0.0 : f);
+                e.pkg_watts = (float)json_get_num(line, stats, "avg_pkg_watts");
+                e.temp_c = (float)json_get_num(line, stats, "avg_temp_c");
+            }
+
+            if (results_index_append(tmp_fd, &e) != 0) break;
+            off += (uint64_t)n;
+            count++;
+        }
+        free(line);
+        rc = (fsync(tmp_fd) == 0 && rename(tmp_path, idx_path) == 0) ? 0 : -1;
+    }
+
+    if (rf) fclose(rf);
+    if (tmp_fd >= 0) close(tmp_fd);
+    flock(rec_fd, LOCK_UN);
+    close(rec_fd);
+
+    if (rc == 0) printf("Reindexed %ld records in %s\n", count, dir);
+    else fprintf(stderr, "Error: reindex of %s failed\n", dir);
+    return rc;
+}
+
+/***********************************************************
+ *          Fleet Baseline & Out-of-Family Screening
+ *
+ * A baseline is a per-(fingerprint, workload, mode, util)
+ * distribution of ops/s, frequency, power and temperature,
+ * kept as Welford (n, mean, M2) so accepted runs can be
+ * folded in incrementally. Text file format, one line per
+ * key and metric:
+ *   <fp> <workload> <mode> <util> <metric> <n> <mean> <m2>
+ ***********************************************************/
+#define BASELINE_METRICS 4
+
+static const char *baseline_metric_names[BASELINE_METRICS] = {
+    "ops_per_sec", "freq_mhz", "pkg_watts", "temp_c"
+};
+
+typedef struct {
+    char fp[17];
+    char workload[12];
+    char mode[20];
+    float util;
+    uint64_t n[BASELINE_METRICS];
+    double mean[BASELINE_METRICS];
+    double m2[BASELINE_METRICS];
+} baseline_entry_t;
+
+typedef struct {
+    baseline_entry_t *e;
+    int n;
+    int cap;
+} baseline_db_t;
+
+static baseline_entry_t *baseline_lookup(baseline_db_t *db, const char *fp, const char *workload,
+                                         const char *mode, double util, int create)
+{
+    for (int i = 0; i < db->n; ++i) {
+        baseline_entry_t *e = &db->e[i];
+        if (strcmp(e->fp, fp) == 0 && str_case_equal(e->workload, workload) &&
+            str_case_equal(e->mode, mode) && fabs(e->util - util) < 0.05)
+            return e;
+    }
+    if (!create) return NULL;
+
+    if (db->n == db->cap) {
+        int cap = db->cap ? db->cap * 2 : 16;
+        baseline_entry_t *ne = realloc(db->e, cap * sizeof(*ne));
+        if (!ne) return NULL;
+        db->e = ne;
+        db->cap = cap;
+    }
+    baseline_entry_t *e = &db->e[db->n++];
+    memset(e, 0, sizeof(*e));
+    snprintf(e->fp, sizeof(e->fp), "%s", fp);
+    snprintf(e->workload, sizeof(e->workload), "%s", workload);
+    snprintf(e->mode, sizeof(e->mode), "%s", mode);
+    e->util = (float)util;
+    return e;
+}
+
+/* Fold one run's metrics (NAN = not measured) into the distribution */
+static void baseline_fold(baseline_entry_t *e, const double *v) {
+    for (int k = 0; k < BASELINE_METRICS; ++k) {
+        if (isnan(v[k]) || (k == 1 && v[k] <= 0)) continue;
+        e->n[k]++;
+        double d = v[k] - e->mean[k];
+        e->mean[k] += d / e->n[k];
+        e->m2[k] += d * (v[k] - e->mean[k]);
+    }
+}
+
+int baseline_load(const char *path, baseline_db_t *db) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+
+        char fp[32], wl[32], mode[32], metric[32];
+        float util;
+        unsigned long long n;
+        double mean, m2;
+        if (sscanf(line, "%31s %31s %31s %f %31s %llu %lf %lf",
+                   fp, wl, mode, &util, metric, &n, &mean, &m2) != 8)
+            continue;
+
+        baseline_entry_t *e = baseline_lookup(db, fp, wl, mode, util, 1);
+        if (!e) break;
+        for (int k = 0; k < BASELINE_METRICS; ++k) {
+            if (strcmp(metric, baseline_metric_names[k]) != 0) continue;
+            e->n[k] = n;
+            e->mean[k] = mean;
+            e->m2[k] = m2;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Atomically replace the baseline file (tmp + rename) */
+int baseline_save(const char *path, const baseline_db_t *db) {
+    char tmp[1024];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%d", path, (int)getpid());
+
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        fprintf(stderr, "Warning: cannot write baseline %s: %s\n", tmp, strerror(errno));
+        return -1;
+    }
+
+    fprintf(f, "# coreburner baseline v1\n");
+    fprintf(f, "# fingerprint workload mode util metric n mean m2\n");
+    for (int i = 0; i < db->n; ++i) {
+        const baseline_entry_t *e = &db->e[i];
+        for (int k = 0; k < BASELINE_METRICS; ++k) {
+            if (e->n[k] == 0) continue;
+            fprintf(f, "%s %s %s %.1f %s %" PRIu64 " %.10g %.10g\n",
+                    e->fp, e->workload, e->mode, e->util, baseline_metric_names[k],
+                    e->n[k], e->mean[k], e->m2[k]);
+        }
+    }
+
+    int rc = (fflush(f) == 0 && fsync(fileno(f)) == 0) ? 0 : -1;
+    if (fclose(f) != 0) rc = -1;
+    if (rc == 0 && rename(tmp, path) != 0) rc = -1;
+    if (rc != 0) {
+        fprintf(stderr, "Warning: failed to save baseline %s\n", path);
+        unlink(tmp);
+    }
+    return rc;
+}
+
+static void baseline_free(baseline_db_t *db) {
+    free(db->e);
+    memset(db, 0, sizeof(*db));
+}
+
+/* Build a baseline from results-store index entries */
+static void baseline_fold_index(baseline_db_t *db, const results_index_entry_t *e) {
+    char fp[17];
+    snprintf(fp, sizeof(fp), "%016" PRIx64, e->fp_hash);
+    baseline_entry_t *b = baseline_lookup(db, fp, e->workload, e->mode, e->util, 1);
+    if (!b) return;
+    double v[BASELINE_METRICS] = { e->ops_per_sec, e->freq_mhz, e->pkg_watts, e->temp_c };
+    baseline_fold(b, v);
+}
+
+int baseline_from_store(const char *dir, baseline_db_t *db) {
+    results_index_entry_t *idx = NULL;
+    long n = results_index_load(dir, &idx);
+    if (n < 0) {
+        free(idx);
+        return -1;
+    }
+    for (long i = 0; i < n; ++i) baseline_fold_index(db, &idx[i]);
+    free(idx);
+    return 0;
+}
+
+/* Returns 1 = pass, 0 = out-of-family, -1 = no baseline for this key */
+int baseline_screen(const baseline_entry_t *e, const double *v, const baseline_spec_t *spec) {
+    printf("\n=== Fleet Baseline Screening ===\n");
+    if (!e) {
+        printf("  No baseline for fingerprint %s (%s)\n", g_fingerprint.hash,
+               spec->source ? spec->source : spec->update_path ? spec->update_path : "-");
+        printf("================================\n");
+        return -1;
+    }
+
+    printf("  Fingerprint : %s  scenario=%s/%s/util%.0f\n", e->fp, e->workload, e->mode, e->util);
+    printf("  %-12s %10s %10s %10s %6s %8s  %s\n", "Metric", "Current", "Mean", "Stdev", "N", "z", "Verdict");
+
+    int judged = 0, failed = 0;
+    for (int k = 0; k < BASELINE_METRICS; ++k) {
+        if (e->n[k] == 0 || isnan(v[k])) continue;
+
+        double sd = e->n[k] > 1 ? sqrt(e->m2[k] / (e->n[k] - 1)) : 0.0;
+        double d = v[k] - e->mean[k];
+        /* identical samples give sd 0: any delta beyond the relative tolerance fails */
+        double z = sd > 0 ? d / sd
+                 : fabs(d) > spec->tol_pct / 100.0 * fabs(e->mean[k]) ? copysign(INFINITY, d) : 0.0;
+        const char *verdict = "ok";
+
+        if ((int)e->n[k] < spec->min_samples) {
+            verdict = "too few samples";
+        } else {
+            judged++;
+            if (fabs(z) > spec->z_max) {
+                verdict = "OUT-OF-FAMILY";
+                failed++;
+            }
+        }
+        printf("  %-12s %10.4g %10.4g %10.4g %6" PRIu64 " %+8.2f  %s\n",
+               baseline_metric_names[k], v[k], e->mean[k], sd, e->n[k], z, verdict);
+    }
+
+    int pass = (failed == 0);
+    printf("  Threshold   : |z| <= %.2f (min %d samples)\n", spec->z_max, spec->min_samples);
+    printf("  Result      : %s\n", judged == 0 ? "NO VERDICT" : pass ? "PASS" : "FAIL");
+    printf("================================\n");
+    return judged == 0 ? -1 : pass;
+}
+
+/* Fold one run into the baseline file under an exclusive lock */
+int baseline_update(const char *path, const char *workload, const char *mode,
+                    double util, const double *v)
+{
+    char lock_path[1024];
+    snprintf(lock_path, sizeof(lock_path), "%s.lock", path);
+    int lfd = open(lock_path, O_RDWR | O_CREAT, 0644);
+    if (lfd < 0 || flock(lfd, LOCK_EX) != 0) {
+        fprintf(stderr, "Warning: cannot lock baseline %s: %s\n", lock_path, strerror(errno));
+        if (lfd >= 0) close(lfd);
+        return -1;
+    }
+
+    baseline_db_t db = {0};
+    baseline_load(path, &db);
+    baseline_entry_t *e = baseline_lookup(&db, g_fingerprint.hash, workload, mode, util, 1);
+    int rc = -1;
+    if (e) {
+        baseline_fold(e, v);
+        rc = baseline_save(path, &db);
+    }
+    baseline_free(&db);
+
+    flock(lfd, LOCK_UN);
+    close(lfd);
+    if (rc == 0) printf("Baseline updated: %s\n", path);
+    return rc;
+}
+
+/*
+ * Screen the finished run against its fleet baseline and optionally fold it in.
+ * Must run before results_store_append so a store-sourced baseline excludes it.
+ * Returns 0 = pass or no verdict, 1 = out-of-family.
+ */
+int baseline_check_run(const baseline_spec_t *spec, const char *results_dir,
+                       const char *mode, workload_t type, double util,
+                       const run_stats_t *runs, int nruns)
+{
+    metric_summary_t ops, freq, power, temp;
+    aggregate_runs(runs, nruns, &ops, &freq, &power, &temp);
+    double v[BASELINE_METRICS] = {
+        ops.mean,
+        freq.n > 0 ? freq.mean : NAN,
+        power.n > 0 ? power.mean : NAN,
+        temp.n > 0 ? temp.mean : NAN
+    };
+    const char *workload = workload_str(type);
+
+    /* --update-baseline alone screens against the file it updates,
+     * so a regressed run never becomes the reference */
+    const char *source = spec->source ? spec->source : spec->update_path;
+    int verdict = -1;
+    if (source) {
+        baseline_db_t db = {0};
+        int loaded = (strcmp(source, "store") == 0)
+            ? baseline_from_store(results_dir, &db)
+            : baseline_load(source, &db);
+        if (loaded != 0 && spec->source)
+            fprintf(stderr, "Warning: baseline source '%s' not readable\n", source);
+
+        verdict = baseline_screen(baseline_lookup(&db, g_fingerprint.hash, workload, mode, util, 0),
+                                  v, spec);
+        baseline_free(&db);
+    }
+
+    /* Only accepted runs are folded in; with no verdict the run seeds the baseline */
+    if (spec->update_path) {
+        if (verdict != 0)
+            baseline_update(spec->update_path, workload, mode, util, v);
+        else
+            printf("Baseline not updated: run is out-of-family\n");
+    }
+
+    return verdict == 0 ? 1 : 0;
+}
+
+/***********************************************************
+ *                 Results Store Query
+ ***********************************************************/
+typedef struct {
+    const char *dir;
+    const char *fp;         /* hash prefix */
+    const char *kernel;     /* exact kernel release */
+    const char *workload;
+    const char *mode;
+    double util;            /* < 0 = any */
+    time_t since;
+    time_t until;
+    const char *group_by;   /* fp|kernel|workload|util|date|NULL */
+    int list;
+    int reindex;
+    const char *export_baseline;    /* write matching runs as a baseline file */
+} results_query_t;
+
+/* YYYY-MM-DD in local time; (time_t)-1 = malformed */
+static time_t parse_query_date(const char *s, int end_of_day) {
+    struct tm tm;
+    char extra;
+    memset(&tm, 0, sizeof(tm));
+    if (sscanf(s, "%d-%d-%d%c", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &extra) != 3) return (time_t)-1;
+    if (tm.tm_year < 1970 || tm.tm_mon < 1 || tm.tm_mon > 12 || tm.tm_mday < 1 || tm.tm_mday > 31)
+        return (time_t)-1;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    if (end_of_day) { tm.tm_hour = 23; tm.tm_min = 59; tm.tm_sec = 59; }
+    return mktime(&tm);
+}
+
+static void query_group_key(const results_query_t *q, const results_index_entry_t *e,
+                            char *key, size_t len)
+{
+    const char *g = q->group_by ? q->group_by : "";
+    if (strcmp(g, "fp") == 0) snprintf(key, len, "%016" PRIx64, e->fp_hash);
+    else if (strcmp(g, "kernel") == 0) snprintf(key, len, "%s", e->kernel);
+    else if (strcmp(g, "workload") == 0) snprintf(key, len, "%s", e->workload);
+    else if (strcmp(g, "util") == 0) snprintf(key, len, "%.0f", e->util);
+    else if (strcmp(g, "date") == 0) {
+        time_t t = (time_t)e->timestamp;
+        strftime(key, len, "%Y-%m-%d", localtime(&t));
+    } else snprintf(key, len, "all");
+}
+
+typedef struct {
+    char key[40];
+    long n;
+    double sum[4], sumsq[4], min[4], max[4];
+    long cnt[4];
+} query_group_t;
+
+int results_query(const results_query_t *q) {
+    if (q->reindex) return results_store_reindex(q->dir) == 0 ? 0 : 1;
+
+    results_index_entry_t *idx = NULL;
+    long n = results_index_load(q->dir, &idx);
+    if (n < 0) {
+        fprintf(stderr, "Error: no results store in '%s'\n", q->dir);
+        free(idx);
+        return 1;
+    }
+
+    query_group_t *groups = calloc(n > 0 ? n : 1, sizeof(query_group_t));
+    int ngroups = 0;
+    long matched = 0;
+    baseline_db_t export_db = {0};
+
+    if (q->list)
+        printf("%-19s %-16s %-18s %-8s %-16s %5s %4s %10s %9s %8s %7s\n",
+               "Date", "Fingerprint", "Kernel", "Workload", "Mode", "Util", "Reps",
+               "Ops/s(M)", "Freq", "Power", "Temp");
+
+    for (long i = 0; i < n && groups; ++i) {
+        const results_index_entry_t *e = &idx[i];
+        char hash[17];
+        snprintf(hash, sizeof(hash), "%016" PRIx64, e->fp_hash);
+
+        if (q->fp && strncmp(hash, q->fp, strlen(q->fp)) != 0) continue;
+        if (q->kernel && strcmp(e->kernel, q->kernel) != 0) continue;
+        if (q->workload && !str_case_equal(e->workload, q->workload)) continue;
+        if (q->mode && !str_case_equal(e->mode, q->mode)) continue;
+        if (q->util >= 0 && fabs(e->util - q->util) > 0.05) continue;
+        if (q->since != (time_t)-1 && e->timestamp < q->since) continue;
+        if (q->until != (time_t)-1 && e->timestamp > q->until) continue;
+
+        matched++;
+        if (q->export_baseline) baseline_fold_index(&export_db, e);
+        if (q->list) {
+            char date[32];
+            time_t t = (time_t)e->timestamp;
+            strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&t));
+            printf("%-19s %-16s %-18.18s %-8s %-16.16s %5.1f %4u %10.2f %9.1f %8.2f %7.2f\n",
+                   date, hash, e->kernel, e->workload, e->mode, e->util, e->nreps,
+                   e->ops_per_sec, e->freq_mhz, e->pkg_watts, e->temp_c);
+        }
+
+        char key[40];
+        query_group_key(q, e, key, sizeof(key));
+        int g;
+        for (g = 0; g < ngroups; ++g)
+            if (strcmp(groups[g].key, key) == 0) break;
+        if (g == ngroups) {
+            snprintf(groups[g].key, sizeof(groups[g].key), "%s", key);
+            for (int k = 0; k < 4; ++k) { groups[g].min[k] = INFINITY; groups[g].max[k] = -INFINITY; }
+            ngroups++;
+        }
+
+        double v[4] = { e->ops_per_sec, e->freq_mhz > 0 ? e->freq_mhz : NAN, e->pkg_watts, e->temp_c };
+        groups[g].n++;
+        for (int k = 0; k < 4; ++k) {
+            if (isnan(v[k])) continue;
+            groups[g].sum[k] += v[k];
+            groups[g].sumsq[k] += v[k] * v[k];
+            groups[g].cnt[k]++;
+            if (v[k] < groups[g].min[k]) groups[g].min[k] = v[k];
+            if (v[k] > groups[g].max[k]) groups[g].max[k] = v[k];
+        }
+    }
+
+    static const char *names[4] = { "ops/s(M)", "freq_mhz", "pkg_watts", "temp_c" };
+    printf("\n%ld of %ld runs matched\n", matched, n);
+    for (int g = 0; g < ngroups; ++g) {
+        printf("\n[%s=%s] runs=%ld\n", q->group_by ? q->group_by : "group", groups[g].key, groups[g].n);
+        for (int k = 0; k < 4; ++k) {
+            long c = groups[g].cnt[k];
+            if (c == 0) continue;
+            double mean = groups[g].sum[k] / c;
+            double var = c > 1 ? (groups[g].sumsq[k] - c * mean * mean) / (c - 1) : 0.0;
+            printf("  %-10s mean=%10.2f stdev=%9.2f min=%10.2f max=%10.2f n=%ld\n",
+                   names[k], mean, var > 0 ? sqrt(var) : 0.0,
+                   groups[g].min[k], groups[g].max[k], c);
+        }
+    }
+
+    int rc = 0;
+    if (q->export_baseline) {
+        rc = baseline_save(q->export_baseline, &export_db) == 0 ? 0 : 1;
+        if (rc == 0)
+            printf("\nBaseline exported: %s (%d scenarios)\n", q->export_baseline, export_db.n);
+        baseline_free(&export_db);
+    }
+
+    free(groups);
+    free(idx);
+    return rc;
+}
+
+void print_query_usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s --query [--results-dir DIR] [filters] [--group-by KEY] [--list]\n"
+        "\n"
+        "Filters:\n"
+        "  --fp HASH            Fingerprint hash (prefix match)\n"
+        "  --kernel RELEASE     Kernel release (exact)\n"
+        "  --type T             Workload type\n"
+        "  --mode M             Run mode\n"
+        "  --util N             Target utilization\n"
+        "  --since YYYY-MM-DD   Runs started on/after date\n"
+        "  --until YYYY-MM-DD   Runs started on/before date\n"
+        "\n"
+        "  --group-by KEY       fp|kernel|workload|util|date (default: all)\n"
+        "  --list               Print every matching run\n"
+        "  --reindex            Rebuild index.bin from records.jsonl\n"
+        "  --export-baseline F  Write matching runs as a fleet baseline file\n",
+        prog);
+}
+
+int parse_query_args(int argc, char **argv, results_query_t *q) {
+    memset(q, 0, sizeof(*q));
+    q->dir = RESULTS_STORE_DEFAULT_DIR;
+    q->util = -1;
+    q->since = q->until = (time_t)-1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--query") == 0) continue;
+        if (strcmp(argv[i], "--results-dir") == 0 && i + 1 < argc) { q->dir = argv[++i]; continue; }
+        if (strcmp(argv[i], "--fp") == 0 && i + 1 < argc) { q->fp = argv[++i]; continue; }
+        if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) { q->kernel = argv[++i]; continue; }
+        if (strcmp(argv[i], "--type") == 0 && i + 1 < argc) { q->workload = argv[++i]; continue; }
+        if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) { q->mode = argv[++i]; continue; }
+        if (strcmp(argv[i], "--util") == 0 && i + 1 < argc) { q->util = atof(argv[++i]); continue; }
+        if ((strcmp(argv[i], "--since") == 0 || strcmp(argv[i], "--until") == 0) && i + 1 < argc) {
+            int until = argv[i][2] == 'u';
+            time_t t = parse_query_date(argv[i + 1], until);
+            if (t == (time_t)-1) {
+                fprintf(stderr, "Invalid %s '%s' (expected YYYY-MM-DD)\n", argv[i], argv[i + 1]);
+                return -1;
+            }
+            if (until) q->until = t;
+            else q->since = t;
+            ++i;
+            continue;
+        }
+        if (strcmp(argv[i], "--group-by") == 0 && i + 1 < argc) { q->group_by = argv[++i]; continue; }
+        if (strcmp(argv[i], "--list") == 0) { q->list = 1; continue; }
+        if (strcmp(argv[i], "--reindex") == 0) { q->reindex = 1; continue; }
+        if (strcmp(argv[i], "--export-baseline") == 0 && i + 1 < argc) { q->export_baseline = argv[++i]; continue; }
+        if (strcmp(argv[i], "--help") == 0) { print_query_usage(argv[0]); return -1; }
+
+        fprintf(stderr, "Unknown or malformed query argument: %s\n", argv[i]);
+        print_query_usage(argv[0]);
+        return -1;
+    }
+
+    if (q->group_by &&
+        strcmp(q->group_by, "fp") && strcmp(q->group_by, "kernel") &&
+        strcmp(q->group_by, "workload") && strcmp(q->group_by, "util") &&
+        strcmp(q->group_by, "date")) {
+        fprintf(stderr, "Invalid --group-by '%s'\n", q->group_by);
+        return -1;
+    }
+    return 0;
+}
+
+/***********************************************************
+ *          DCL Spec Files & Multi-Point Validation
+ * One versioned spec file per SKU, keyed by CPU vendor,
+ * family, model and (optionally) stepping. --mode dcl-validate
+ * loads the best match from --dcl-spec FILE|DIR and checks,
+ * per logical CPU and per package:
+ *   p0n    all-core frequency per license level
+ *   turbo  frequency with N active cores per license level
+ *   p1     floor under the all-core sse point (AVX licenses
+ *          legally run below P1)
+ *   pl1/2  configured (powercap) and drawn (RAPL) package power
+ * File format, one directive per line, '#' starts a comment:
+ *   sku NAME            version V
+ *   cpu VENDOR FAMILY MODEL [STEPPING|*]
+ *   tolerance PCT       power_tolerance PCT
+ *   p1 MHZ [TOL]        p0n LICENSE MHZ [TOL]
+ *   turbo LICENSE ACTIVE_CORES MHZ [TOL]
+ *   pl1 W [TOL]         pl2 W [TOL]
+ ***********************************************************/
+#define DCL_LICENSES 5
+#define DCL_MAX_BINS 64
+#define DCL_MAX_PKGS 8
+#define DCL_SAMPLE_NS 200000000L
+#define DCL_PL1_MIN_SEC 30          /* shorter points may legally run at PL2 */
+#define DCL_EXIT_FAIL 4
+#define DCL_EXIT_INCONCLUSIVE 5    /* nothing could be measured */
+
+static const char *dcl_license_names[DCL_LICENSES] = { "sse", "avx", "avx2", "avx512", "amx" };
+/* W_AUTO = no kernel for that license in this build */
+static const workload_t dcl_license_types[DCL_LICENSES] = { W_SSE, W_AVX, W_AVX2, W_AVX512, W_AUTO };
+
+typedef struct {
+    int license;
+    int cores;
+    double mhz;
+    double tol_pct;
+} dcl_bin_t;
+
+typedef struct {
+    char path[512];
+    char sku[64];
+    char version[64];
+    char vendor[64];
+    int family;
+    int model;
+    int stepping;                   /* -1 = any */
+    double tol_pct;                 /* default frequency tolerance */
+    double power_tol_pct;           /* default power tolerance */
+    double p1_mhz, p1_tol;
+    double p0n_mhz[DCL_LICENSES], p0n_tol[DCL_LICENSES];
+    dcl_bin_t bins[DCL_MAX_BINS];
+    int nbins;
+    double pl1_w, pl1_tol;
+    double pl2_w, pl2_tol;
+} dcl_file_t;
+
+typedef struct {
+    const char *check;              /* p0n|turbo|p1|pl1|pl2 */
+    const char *source;             /* measured|configured */
+    int license;                    /* -1 = n/a */
+    int active_cores;
+    char scope[16];                 /* cpuN | pkgN */
+    double expected;
+    double measured;
+    double tol_pct;
+    double deviation_pct;
+    int result;                     /* 1 pass, 0 fail, -1 skipped */
+    double settle_sec;              /* of the load point behind the row */
+    double cool_sec;
+    double temp_c;
+    int steady;
+} dcl_result_t;
+
+typedef struct {
+    dcl_result_t *r;
+    int n;
+    int cap;
+} dcl_report_t;
+
+static int dcl_license_index(const char *s) {
+    for (int i = 0; i < DCL_LICENSES; ++i)
+        if (str_case_equal(s, dcl_license_names[i])) return i;
+    return -1;
+}
+
+int dcl_file_load(const char *path, dcl_file_t *d) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: cannot open DCL spec %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    memset(d, 0, sizeof(*d));
+    snprintf(d->path, sizeof(d->path), "%s", path);
+    d->stepping = -1;
+    d->tol_pct = 3.0;
+    d->power_tol_pct = 5.0;
+    d->p1_tol = d->pl1_tol = d->pl2_tol = -1.0;
+    for (int l = 0; l < DCL_LICENSES; ++l) d->p0n_tol[l] = -1.0;
+
+    char line[256];
+    int lineno = 0, rc = 0, have_cpu = 0;
+    while (rc == 0 && fgets(line, sizeof(line), f)) {
+        lineno++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        char key[32], a[64], b[32], c[32], e[32];
+        int n = sscanf(line, "%31s %63s %31s %31s %31s", key, a, b, c, e);
+        if (n <= 0) continue;
+
+        if (str_case_equal(key, "sku") && n >= 2) {
+            snprintf(d->sku, sizeof(d->sku), "%s", a);
+        } else if (str_case_equal(key, "version") && n >= 2) {
+            snprintf(d->version, sizeof(d->version), "%s", a);
+        } else if (str_case_equal(key, "cpu") && n >= 4) {
+            snprintf(d->vendor, sizeof(d->vendor), "%s", a);
+            d->family = (int)strtol(b, NULL, 0);
+            d->model = (int)strtol(c, NULL, 0);
+            d->stepping = (n >= 5 && strcmp(e, "*") != 0) ? (int)strtol(e, NULL, 0) : -1;
+            have_cpu = 1;
+        } else if (str_case_equal(key, "tolerance") && n >= 2) {
+            d->tol_pct = atof(a);
+        } else if (str_case_equal(key, "power_tolerance") && n >= 2) {
+            d->power_tol_pct = atof(a);
+        } else if (str_case_equal(key, "p1") && n >= 2) {
+            d->p1_mhz = atof(a);
+            if (n >= 3) d->p1_tol = atof(b);
+        } else if (str_case_equal(key, "p0n") && n >= 3 && dcl_license_index(a) >= 0) {
+            int l = dcl_license_index(a);
+            d->p0n_mhz[l] = atof(b);
+            if (n >= 4) d->p0n_tol[l] = atof(c);
+        } else if (str_case_equal(key, "turbo") && n >= 4 && dcl_license_index(a) >= 0) {
+            if (d->nbins == DCL_MAX_BINS) continue;
+            dcl_bin_t *bin = &d->bins[d->nbins++];
+            bin->license = dcl_license_index(a);
+            bin->cores = atoi(b);
+            bin->mhz = atof(c);
+            bin->tol_pct = n >= 5 ? atof(e) : -1.0;
+        } else if (str_case_equal(key, "pl1") && n >= 2) {
+            d->pl1_w = atof(a);
+            if (n >= 3) d->pl1_tol = atof(b);
+        } else if (str_case_equal(key, "pl2") && n >= 2) {
+            d->pl2_w = atof(a);
+            if (n >= 3) d->pl2_tol = atof(b);
+        } else {
+            fprintf(stderr, "Error: %s:%d: bad directive '%s'\n", path, lineno, key);
+            rc = -1;
+        }
+    }
+    fclose(f);
+
+    if (rc == 0 && !have_cpu) {
+        fprintf(stderr, "Error: %s: missing 'cpu VENDOR FAMILY MODEL' line\n", path);
+        rc = -1;
+    }
+
+    /* unset per-point tolerances take the file defaults */
+    if (d->p1_tol < 0) d->p1_tol = d->tol_pct;
+    for (int l = 0; l < DCL_LICENSES; ++l)
+        if (d->p0n_tol[l] < 0) d->p0n_tol[l] = d->tol_pct;
+    for (int i = 0; i < d->nbins; ++i)
+        if (d->bins[i].tol_pct < 0) d->bins[i].tol_pct = d->tol_pct;
+    if (d->pl1_tol < 0) d->pl1_tol = d->power_tol_pct;
+    if (d->pl2_tol < 0) d->pl2_tol = d->power_tol_pct;
+    return rc;
+}
+
+/* 2 = exact stepping, 1 = any stepping, 0 = other CPU */
+static int dcl_file_match(const dcl_file_t *d, const machine_fingerprint_t *fp) {
+    if (strcmp(d->vendor, fp->cpu_vendor) != 0 || d->family != (int)fp->family || d->model != (int)fp->model)
+        return 0;
+    if (d->stepping < 0) return 1;
+    return d->stepping == (int)fp->stepping ? 2 : 0;
+}
+
+/* Load FILE, or the best *.dcl in DIR for this CPU (stepping match
+ * first, then the highest version) */
+int dcl_spec_find(const char *path, const machine_fingerprint_t *fp, dcl_file_t *out) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "Error: --dcl-spec %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        if (dcl_file_load(path, out) != 0) return -1;
+        if (dcl_file_match(out, fp) == 0) {
+            fprintf(stderr, "Error: %s is for %s %d/0x%X, this CPU is %s %u/0x%X stepping %u\n", path,
+                    out->vendor, out->family, out->model, fp->cpu_vendor, fp->family, fp->model, fp->stepping);
+            return -1;
+        }
+        return 0;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) return -1;
+    dcl_file_t *cand = malloc(sizeof(*cand));
+    int best = 0;
+    struct dirent *e;
+    while (cand && (e = readdir(dir))) {
+        size_t len = strlen(e->d_name);
+        if (len < 5 || strcmp(e->d_name + len - 4, ".dcl") != 0) continue;
+        char file[1024];
+        snprintf(file, sizeof(file), "%s/%s", path, e->d_name);
+        if (dcl_file_load(file, cand) != 0) continue;
+        int score = dcl_file_match(cand, fp);
+        if (score == 0) continue;
+        if (score > best || (score == best && strverscmp(cand->version, out->version) > 0)) {
+            *out = *cand;
+            best = score;
+        }
+    }
+    closedir(dir);
+    free(cand);
+
+    if (best == 0) {
+        fprintf(stderr, "Error: no DCL spec in %s for %s family %u model 0x%X stepping %u\n",
+                path, fp->cpu_vendor, fp->family, fp->model, fp->stepping);
+        return -1;
+    }
+    return 0;
+}
+
+/* Fill empty --dcl-*-freq values of a single-type run from the spec */
+int dcl_spec_apply(dcl_spec_t *dcl, const machine_fingerprint_t *fp) {
+    dcl_file_t d;
+    if (dcl_spec_find(dcl->spec_path, fp, &d) != 0) return -1;
+    if (dcl->sse_p0n_mhz <= 0) dcl->sse_p0n_mhz = d.p0n_mhz[0];
+    if (dcl->avx_p0n_mhz <= 0) dcl->avx_p0n_mhz = d.p0n_mhz[1];
+    if (dcl->avx2_p0n_mhz <= 0) dcl->avx2_p0n_mhz = d.p0n_mhz[2];
+    if (dcl->avx512_p0n_mhz <= 0) dcl->avx512_p0n_mhz = d.p0n_mhz[3];
+    if (dcl->p1_mhz <= 0) dcl->p1_mhz = d.p1_mhz;
+    if (!dcl->tolerance_set) dcl->tolerance_pct = d.tol_pct;
+    dcl->enabled = 1;
+    printf("DCL spec: %s version %s (%s)\n", d.sku, d.version, d.path);
+    return 0;
+}
+
+static dcl_result_t *dcl_report_add(dcl_report_t *rep, const char *check, const char *source, int license,
+                                    int active, const char *scope, double expected, double measured,
+                                    double tol_pct)
+{
+    if (rep->n == rep->cap) {
+        int cap = rep->cap ? rep->cap * 2 : 64;
+        dcl_result_t *nr = realloc(rep->r, cap * sizeof(*nr));
+        if (!nr) return NULL;
+        rep->r = nr;
+        rep->cap = cap;
+    }
+    dcl_result_t *r = &rep->r[rep->n++];
+    memset(r, 0, sizeof(*r));
+    r->check = check;
+    r->source = source;
+    r->license = license;
+    r->active_cores = active;
+    snprintf(r->scope, sizeof(r->scope), "%s", scope);
+    r->expected = expected;
+    r->measured = measured;
+    r->tol_pct = tol_pct;
+    r->settle_sec = r->cool_sec = r->temp_c = NAN;
+    if (measured > 0 && expected > 0) {
+        r->deviation_pct = (measured - expected) / expected * 100.0;
+        r->result = fabs(r->deviation_pct) <= tol_pct;
+    } else {
+        r->deviation_pct = NAN;
+        r->result = -1;
+    }
+    return r;
+}
+
+/* Warm worker pool: one pinned thread per CPU, created once per run.
+ * A worker runs its `type` (W_AUTO = idle) so switching license level
+ * between points costs no thread creation or buffer setup. */
+#define DCL_IDLE_NS 1000000L
+#define DCL_SETTLE_MIN_NS 500000000L
+#define DCL_SETTLE_MAX_SEC 20
+#define DCL_STEADY_SAMPLES 5        /* 1 s window at DCL_SAMPLE_NS */
+#define DCL_STEADY_PCT 1.0          /* max-min spread of the window, % of mean */
+#define DCL_GATE_DELTA_C 5.0        /* start a point within this of the idle temp */
+#define DCL_GATE_MAX_SEC 120
+
+typedef struct {
+    int cpu;
+    int type;                       /* workload_t, W_AUTO = idle */
+    volatile int *quit;
+} dcl_worker_t;
+
+typedef struct {
+    dcl_worker_t *w;
+    pthread_t *tids;
+    int n;
+    int started;
+    volatile int quit;
+} dcl_pool_t;
+
+/* Per-point bookkeeping shared by every row the point produces */
+typedef struct {
+    double cool_sec;                /* thermal gate wait before the point */
+    double settle_sec;              /* time to steady frequency */
+    int steady;                     /* 0 = settle timed out */
+    double temp_c;                  /* at the end of the point */
+} dcl_point_t;
+
+static void *dcl_worker(void *arg) {
+    dcl_worker_t *w = (dcl_worker_t *)arg;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(w->cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+        fprintf(stderr, "Warning: could not pin DCL worker to cpu%d\n", w->cpu);
+
+    work_state_t ws;
+    if (work_state_init(&ws, w->cpu) == 0) {
+        while (!*w->quit && !user_stop_flag) {
+            int t = __atomic_load_n(&w->type, __ATOMIC_RELAXED);
+            if (t == W_AUTO) safe_nanosleep(0, DCL_IDLE_NS);
+            else run_work_slice((workload_t)t, &ws);
+        }
+    }
+    work_state_free(&ws);
+    return NULL;
+}
+
+static int dcl_pool_start(dcl_pool_t *pool, const int *cpus, int n) {
+    memset(pool, 0, sizeof(*pool));
+    pool->w = calloc(n, sizeof(*pool->w));
+    pool->tids = calloc(n, sizeof(*pool->tids));
+    if (!pool->w || !pool->tids) return -1;
+    pool->n = n;
+    for (int i = 0; i < n; ++i) {
+        pool->w[i].cpu = cpus[i];
+        pool->w[i].quit = &pool->quit;
+        pool->w[i].type = W_AUTO;
+        if (pthread_create(&pool->tids[i], NULL, dcl_worker, &pool->w[i]) != 0) return -1;
+        pool->started++;
+    }
+    return 0;
+}
+
+/* First `active` workers run `type`, the rest idle */
+static void dcl_pool_set(dcl_pool_t *pool, int active, workload_t type) {
+    for (int i = 0; i < pool->n; ++i)
+        __atomic_store_n(&pool->w[i].type, i < active ? (int)type : W_AUTO, __ATOMIC_RELAXED);
+}
+
+static void dcl_pool_stop(dcl_pool_t *pool) {
+    pool->quit = 1;
+    for (int i = 0; i < pool->started; ++i) pthread_join(pool->tids[i], NULL);
+    free(pool->w);
+    free(pool->tids);
+    memset(pool, 0, sizeof(*pool));
+}
+
+/* One MHz reading per CPU: APERF/MPERF since the previous call when
+ * available, else scaling_cur_freq. Returns the mean over readable CPUs. */
+static double dcl_sample_mhz(const int *cpus, int n, int use_msr, double base_freq_mhz, double *out) {
+    double sum = 0.0;
+    int cnt = 0;
+    for (int i = 0; i < n; ++i) {
+        double m = use_msr ? calculate_frequency_mhz(cpus[i], base_freq_mhz) : -1.0;
+        long hz = 0;
+        if (m <= 0 && read_scaling_cur_freq(cpus[i], &hz) == 0 && hz > 0) m = hz / 1000.0;
+        out[i] = m > 0 ? m : 0.0;
+        if (m > 0) { sum += m; cnt++; }
+    }
+    return cnt ? sum / cnt : 0.0;
+}
+
+/* Idle the pool until the package is back within DCL_GATE_DELTA_C of
+ * its idle temperature, so each point starts from the same state */
+static double dcl_thermal_gate(dcl_pool_t *pool, const char *temp_path, double idle_temp) {
+    dcl_pool_set(pool, 0, W_AUTO);
+    if (!temp_path || isnan(idle_temp)) return 0.0;
+
+    struct timespec t0, now;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int s = 0; s < DCL_GATE_MAX_SEC * 2 && !user_stop_flag; ++s) {
+        double t = read_temperature(temp_path);
+        if (isnan(t) || t <= idle_temp + DCL_GATE_DELTA_C) break;
+        if (s % 20 == 0) printf("    cooling: %.1f °C -> %.1f °C\n", t, idle_temp + DCL_GATE_DELTA_C);
+        safe_nanosleep(0, 500000000L);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - t0.tv_sec) + (now.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+/* Run `type` on the first n pool CPUs: settle until the mean frequency
+ * is steady, then average per-CPU MHz and per-package watts over
+ * `seconds` (pkg_w NAN when RAPL is unavailable) */
+static int dcl_pool_point(dcl_pool_t *pool, const int *cpus, int n, workload_t type, long seconds,
+                          int use_msr, double base_freq_mhz, rapl_state_t *rapl, const int *rapl_ok,
+                          int npkg, double *mhz, double *pkg_w, dcl_point_t *pt)
+{
+    double *s = calloc(n, sizeof(double));
+    double *fsum = calloc(n, sizeof(double));
+    int *fcnt = calloc(n, sizeof(int));
+    if (!s || !fsum || !fcnt) {
+        free(s); free(fsum); free(fcnt);
+        return -1;
+    }
+
+    struct timespec t0, now;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    dcl_pool_set(pool, n, type);
+    safe_nanosleep(0, DCL_SETTLE_MIN_NS);
+    dcl_sample_mhz(cpus, n, use_msr, base_freq_mhz, s);
+
+    double win[DCL_STEADY_SAMPLES];
+    int nwin = 0;
+    pt->steady = 0;
+    while (!user_stop_flag) {
+        safe_nanosleep(0, DCL_SAMPLE_NS);
+        double mean = dcl_sample_mhz(cpus, n, use_msr, base_freq_mhz, s);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (mean <= 0) { pt->steady = 1; break; }   /* nothing to watch */
+        win[nwin++ % DCL_STEADY_SAMPLES] = mean;
+        if (nwin >= DCL_STEADY_SAMPLES) {
+            double lo = win[0], hi = win[0], sum = 0.0;
+            for (int k = 0; k < DCL_STEADY_SAMPLES; ++k) {
+                if (win[k] < lo) lo = win[k];
+                if (win[k] > hi) hi = win[k];
+                sum += win[k];
+            }
+            if ((hi - lo) / (sum / DCL_STEADY_SAMPLES) * 100.0 <= DCL_STEADY_PCT) { pt->steady = 1; break; }
+        }
+        if (now.tv_sec - t0.tv_sec >= DCL_SETTLE_MAX_SEC) break;
     }
-    
-    printf("\n--- Per-Thread Details ---\n");
-    for (int t = 0; t < nthreads; ++t) { 
-        uint64_t ops = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED); 
-        printf(" thread %2d -> cpu%2d : %" PRIu64 " ops (%.2fM)\n", 
-               t, wargs[t].cpu_id, ops, ops / 1000000.0); 
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    pt->settle_sec = (now.tv_sec - t0.tv_sec) + (now.tv_nsec - t0.tv_nsec) / 1e9;
+
+    for (int p = 0; p < npkg; ++p) if (rapl_ok[p]) rapl_read_power(&rapl[p], NULL, NULL, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    do {
+        safe_nanosleep(0, DCL_SAMPLE_NS);
+        dcl_sample_mhz(cpus, n, use_msr, base_freq_mhz, s);
+        for (int i = 0; i < n; ++i) if (s[i] > 0) { fsum[i] += s[i]; fcnt[i]++; }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (!user_stop_flag && now.tv_sec - t0.tv_sec < seconds);
+
+    for (int p = 0; p < npkg; ++p) {
+        pkg_w[p] = NAN;
+        if (rapl_ok[p]) rapl_read_power(&rapl[p], &pkg_w[p], NULL, NULL);
     }
+    for (int i = 0; i < n; ++i) mhz[i] = fcnt[i] ? fsum[i] / fcnt[i] : 0.0;
 
-    /* Write summary file */
-    if (summaryf) {
-        fprintf(summaryf, "=== CoreBurner Test Summary ===\n\n");
-        fprintf(summaryf, "[Configuration]\n");
-        fprintf(summaryf, "mode=%s\n", mode);
-        fprintf(summaryf, "workload=%s\n", 
-            (type==W_INT)?"INT":
-            (type==W_FLOAT)?"FLOAT":
-            (type==W_SSE)?"SSE":
-            (type==W_AVX)?"AVX":
-            (type==W_AVX2)?"AVX2":
-            (type==W_AVX512)?"AVX512":
-            (type==W_AUTO)?"AUTO":"MIXED");
-        fprintf(summaryf, "target_util=%.1f%%\n", util);
-        fprintf(summaryf, "threads=%d\n", nthreads);
-        fprintf(summaryf, "duration_requested=%ld\n", duration);
-        fprintf(summaryf, "time_elapsed=%ld\n", elapsed);
-        
-        fprintf(summaryf, "\n[Aggregate Statistics]\n");
-        if (temp_count > 0)
-            fprintf(summaryf, "avg_temperature=%.2f\n", avg_temp);
-        if (freq_count > 0)
-            fprintf(summaryf, "avg_frequency_mhz=%.2f\n", avg_freq / 1000.0);
-        fprintf(summaryf, "total_operations=%.2f\n", total_ops_millions);
-        fprintf(summaryf, "avg_ops_per_core_millions=%.2f\n", avg_ops_per_core / 1000000.0);
-        fprintf(summaryf, "ops_per_second_millions=%.2f\n", 
-                elapsed > 0 ? total_ops_millions / elapsed : 0.0);
-        
-        if (temp_path_ptr && *temp_path_ptr) { 
-            double t=read_temperature(*temp_path_ptr); 
-            if (!isnan(t)) 
-                fprintf(summaryf, "final_temp=%.2f\n", t); 
+    free(s); free(fsum); free(fcnt);
+    return user_stop_flag ? -1 : 0;
+}
+
+/* Per-package mean of the loaded CPUs' MHz, checked against one spec value */
+static void dcl_check_point(dcl_report_t *rep, const char *check, int license, const int *cpus, int n,
+                            const int *pkg_of, const int *pkg_ids, int npkg, const double *mhz,
+                            double expected, double tol)
+{
+    char scope[16];
+    for (int i = 0; i < n; ++i) {
+        snprintf(scope, sizeof(scope), "cpu%d", cpus[i]);
+        dcl_report_add(rep, check, "measured", license, n, scope, expected, mhz[i], tol);
+    }
+    for (int p = 0; p < npkg; ++p) {
+        double sum = 0.0;
+        int cnt = 0;
+        for (int i = 0; i < n; ++i) if (pkg_of[i] == p && mhz[i] > 0) { sum += mhz[i]; cnt++; }
+        if (!cnt) continue;
+        snprintf(scope, sizeof(scope), "pkg%d", pkg_ids[p]);
+        dcl_report_add(rep, check, "measured", license, n, scope, expected, sum / cnt, tol);
+    }
+}
+
+static void dcl_report_json(FILE *f, const dcl_file_t *d, const dcl_report_t *rep, long duration,
+                            double elapsed, const char *verdict)
+{
+    fprintf(f, "{\"v\":1,\"spec\":{\"file\":");
+    json_str(f, d->path);
+    fprintf(f, ",\"sku\":");
+    json_str(f, d->sku);
+    fprintf(f, ",\"version\":");
+    json_str(f, d->version);
+    fprintf(f, "},\"fingerprint\":");
+    json_str(f, g_fingerprint.hash);
+    fprintf(f, ",\"cpu\":{\"vendor\":");
+    json_str(f, g_fingerprint.cpu_vendor);
+    fprintf(f, ",\"family\":%u,\"model\":%u,\"stepping\":%u},\"duration\":%ld,\"elapsed_sec\":%.1f,\"result\":\"%s\",\"points\":[",
+            g_fingerprint.family, g_fingerprint.model, g_fingerprint.stepping, duration, elapsed, verdict);
+    for (int i = 0; i < rep->n; ++i) {
+        const dcl_result_t *r = &rep->r[i];
+        int power = r->check[0] == 'p' && r->check[1] == 'l';
+        fprintf(f, "%s\n{\"check\":\"%s\",\"source\":\"%s\",\"license\":", i ? "," : "", r->check, r->source);
+        if (r->license >= 0) json_str(f, dcl_license_names[r->license]);
+        else fputs("null", f);
+        fprintf(f, ",\"active_cores\":%d,\"scope\":\"%s\",\"unit\":\"%s\",\"expected\":", r->active_cores,
+                r->scope, power ? "W" : "MHz");
+        json_num(f, r->expected);
+        fprintf(f, ",\"measured\":");
+        json_num(f, r->measured);
+        fprintf(f, ",\"deviation_pct\":");
+        json_num(f, r->deviation_pct);
+        fprintf(f, ",\"tolerance_pct\":");
+        json_num(f, r->tol_pct);
+        fprintf(f, ",\"settle_sec\":");
+        json_num(f, r->settle_sec);
+        fprintf(f, ",\"steady\":%s,\"cool_sec\":", r->steady ? "true" : "false");
+        json_num(f, r->cool_sec);
+        fprintf(f, ",\"temp_c\":");
+        json_num(f, r->temp_c);
+        fprintf(f, ",\"result\":\"%s\"}", r->result < 0 ? (r->measured > 0 ? "info" : "skip")
+                                                       : r->result ? "pass" : "fail");
+    }
+    fprintf(f, "\n]}\n");
+}
+
+/* --dcl-suite without a spec file: P0n expectations from the command line */
+static void dcl_file_from_cli(const dcl_spec_t *cli, dcl_file_t *d) {
+    memset(d, 0, sizeof(*d));
+    snprintf(d->path, sizeof(d->path), "(command line)");
+    snprintf(d->sku, sizeof(d->sku), "command-line");
+    snprintf(d->version, sizeof(d->version), "-");
+    snprintf(d->vendor, sizeof(d->vendor), "%s", g_fingerprint.cpu_vendor);
+    d->family = (int)g_fingerprint.family;
+    d->model = (int)g_fingerprint.model;
+    d->stepping = (int)g_fingerprint.stepping;
+    d->tol_pct = d->p1_tol = cli->tolerance_pct;
+    d->p1_mhz = cli->p1_mhz;
+    d->p0n_mhz[0] = cli->sse_p0n_mhz;
+    d->p0n_mhz[1] = cli->avx_p0n_mhz;
+    d->p0n_mhz[2] = cli->avx2_p0n_mhz;
+    d->p0n_mhz[3] = cli->avx512_p0n_mhz;
+    for (int l = 0; l < DCL_LICENSES; ++l) d->p0n_tol[l] = cli->tolerance_pct;
+}
+
+/* Stamp the rows [from, rep->n) with the point they came from */
+static void dcl_report_mark(dcl_report_t *rep, int from, const dcl_point_t *pt) {
+    for (int i = from; i < rep->n; ++i) {
+        rep->r[i].settle_sec = pt->settle_sec;
+        rep->r[i].cool_sec = pt->cool_sec;
+        rep->r[i].temp_c = pt->temp_c;
+        rep->r[i].steady = pt->steady;
+    }
+}
+
+static void dcl_point_print(const dcl_point_t *pt, const double *mhz, int n) {
+    double sum = 0.0;
+    int cnt = 0;
+    for (int i = 0; i < n; ++i) if (mhz[i] > 0) { sum += mhz[i]; cnt++; }
+    printf("    %s %.1f s, cooled %.1f s", pt->steady ? "steady after" : "NOT steady after", pt->settle_sec,
+           pt->cool_sec);
+    if (cnt) printf(", %.0f MHz mean", sum / cnt);
+    if (!isnan(pt->temp_c)) printf(", %.1f °C", pt->temp_c);
+    printf("\n");
+}
+
+/* --mode dcl-validate / --dcl-suite: every applicable spec point in one
+ * run on one warm worker pool, with a thermal gate before each point.
+ * Returns 0 when all checks pass, DCL_EXIT_FAIL when any fails and
+ * DCL_EXIT_INCONCLUSIVE when no check could be measured. */
+int dcl_validate_run(const dcl_spec_t *cli, long duration, int enable_rapl, int use_msr,
+                     double base_freq_mhz, const char *temp_path, const char *log_path)
+{
+    dcl_file_t d;
+    if (cli->spec_path) {
+        if (dcl_spec_find(cli->spec_path, &g_fingerprint, &d) != 0) return 1;
+    } else if (cli->suite) {
+        dcl_file_from_cli(cli, &d);
+    } else {
+        fprintf(stderr, "Error: --mode dcl-validate needs --dcl-spec FILE|DIR (or use --dcl-suite)\n");
+        return 1;
+    }
+    if (cli->tolerance_set) {
+        /* --dcl-tolerance overrides every frequency tolerance in the file */
+        d.p1_tol = cli->tolerance_pct;
+        for (int l = 0; l < DCL_LICENSES; ++l) d.p0n_tol[l] = cli->tolerance_pct;
+        for (int i = 0; i < d.nbins; ++i) d.bins[i].tol_pct = cli->tolerance_pct;
+    }
+
+    /* physical cores first, so turbo bins load one thread per core */
+    if (g_cpu_order_len == 0) topology_spread_init("cores");
+    int ncpu = g_cpu_order_len ? g_cpu_order_len : get_affinity_cpu_count();
+    int *cpus = calloc(ncpu, sizeof(int));
+    int *pkg_of = calloc(ncpu, sizeof(int));
+    double *mhz = calloc(ncpu, sizeof(double));
+    double *p1_min = calloc(ncpu, sizeof(double));
+    if (!cpus || !pkg_of || !mhz || !p1_min) {
+        free(cpus); free(pkg_of); free(mhz); free(p1_min);
+        return 1;
+    }
+
+    int pkg_ids[DCL_MAX_PKGS], rapl_ok[DCL_MAX_PKGS] = { 0 }, npkg = 0;
+    rapl_state_t rapl[DCL_MAX_PKGS];
+    for (int i = 0; i < ncpu; ++i) {
+        cpus[i] = g_cpu_order_len ? g_cpu_order[i] : i;
+        int id = read_topology_int(cpus[i], "physical_package_id");
+        int p = 0;
+        while (p < npkg && pkg_ids[p] != id) p++;
+        if (p == npkg && npkg < DCL_MAX_PKGS) {
+            pkg_ids[npkg++] = id;
+            if (enable_rapl) rapl_ok[p] = rapl_init(&rapl[p], cpus[i]) == 0;
         }
-        
-        fprintf(summaryf, "\n[Per-Thread Results]\n");
-        for (int t = 0; t < nthreads; ++t) { 
-            uint64_t ops = __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED); 
-            fprintf(summaryf, "thread%02d_cpu%02d_ops=%" PRIu64 "\n", t, wargs[t].cpu_id, ops); 
-            fprintf(summaryf, "thread%02d_cpu%02d_ops_millions=%.2f\n", t, wargs[t].cpu_id, ops / 1000000.0); 
+        pkg_of[i] = p < npkg ? p : 0;
+        p1_min[i] = INFINITY;
+    }
+    if (enable_rapl && !rapl_ok[0])
+        rapl_warn_unavailable("Drawn power not checked.");
+
+    printf("\n=== DCL Validation: %s version %s ===\n", d.sku[0] ? d.sku : "(unnamed)", d.version);
+    printf("  Spec   : %s\n", d.path);
+    printf("  CPUs   : %d logical in %d package(s), %ld s per point\n", ncpu, npkg, duration);
+    if (cpu_vendor() == CPU_VENDOR_AMD)
+        printf("  Vendor : amd: no AVX license offsets, p0n is the all-core clock per ISA; "
+               "pl1/pl2 checked as drawn PPT only\n");
+
+    dcl_report_t rep = { 0 };
+    dcl_pool_t pool;
+    dcl_point_t pt;
+    double pkg_w[DCL_MAX_PKGS];
+    int rc = 0, have_p1 = 0;
+    struct timespec run_t0, run_t1;
+    clock_gettime(CLOCK_MONOTONIC, &run_t0);
+
+    if (dcl_pool_start(&pool, cpus, ncpu) != 0) {
+        fprintf(stderr, "Error: cannot start DCL worker pool\n");
+        rc = 1;
+    }
+    /* thermal gate reference: the idle package before any load */
+    safe_nanosleep(0, DCL_SAMPLE_NS);
+    double idle_temp = read_temperature(temp_path);
+    if (!isnan(idle_temp))
+        printf("  Gate   : start each point at <= %.1f °C (idle %.1f + %.1f)\n", idle_temp + DCL_GATE_DELTA_C,
+               idle_temp, DCL_GATE_DELTA_C);
+
+    /* P0n per license: all CPUs loaded; the suite always cycles SSE..AVX512, and a
+       P1 check needs the SSE point */
+    for (int l = 0; l < DCL_LICENSES && rc == 0; ++l) {
+        workload_t t = dcl_license_types[l];
+        if (d.p0n_mhz[l] <= 0 && !(cli->suite && t != W_AUTO) && !(l == 0 && d.p1_mhz > 0)) continue;
+        if (t == W_AUTO || !workload_supported(t)) {
+            printf("  p0n %-7s: no %s kernel on this CPU/build, skipped\n", dcl_license_names[l],
+                   dcl_license_names[l]);
+            dcl_report_add(&rep, "p0n", "measured", l, ncpu, "all", d.p0n_mhz[l], 0.0, d.p0n_tol[l]);
+            continue;
         }
-        fclose(summaryf);
-        if (summary_path) printf("\nSummary written to %s\n", summary_path);
+        printf("  p0n %-7s: %d CPUs ...\n", dcl_license_names[l], ncpu);
+        pt.cool_sec = dcl_thermal_gate(&pool, temp_path, idle_temp);
+        if (dcl_pool_point(&pool, cpus, ncpu, t, duration, use_msr, base_freq_mhz, rapl, rapl_ok, npkg, mhz,
+                           pkg_w, &pt) != 0) {
+            rc = 1;
+            break;
+        }
+        pt.temp_c = read_temperature(temp_path);
+        dcl_point_print(&pt, mhz, ncpu);
+        int from = rep.n;
+        dcl_check_point(&rep, "p0n", l, cpus, ncpu, pkg_of, pkg_ids, npkg, mhz, d.p0n_mhz[l], d.p0n_tol[l]);
+        if (l == 0) {
+            for (int i = 0; i < ncpu; ++i) if (mhz[i] > 0 && mhz[i] < p1_min[i]) p1_min[i] = mhz[i];
+            have_p1 = 1;
+        }
+
+        for (int p = 0; p < npkg; ++p) {
+            char scope[16];
+            if (isnan(pkg_w[p])) continue;
+            snprintf(scope, sizeof(scope), "pkg%d", pkg_ids[p]);
+            /* drawn power is a ceiling: only exceeding the limit fails */
+            if (d.pl2_w > 0) {
+                dcl_result_t *r = dcl_report_add(&rep, "pl2", "measured", l, ncpu, scope, d.pl2_w, pkg_w[p], d.pl2_tol);
+                if (r) r->result = pkg_w[p] <= d.pl2_w * (1.0 + d.pl2_tol / 100.0);
+            }
+            if (d.pl1_w > 0 && duration >= DCL_PL1_MIN_SEC) {
+                dcl_result_t *r = dcl_report_add(&rep, "pl1", "measured", l, ncpu, scope, d.pl1_w, pkg_w[p], d.pl1_tol);
+                if (r) r->result = pkg_w[p] <= d.pl1_w * (1.0 + d.pl1_tol / 100.0);
+            }
+        }
+        dcl_report_mark(&rep, from, &pt);
     }
 
-    /* Cleanup */
-    if (logf) fclose(logf);
-    free(prev_ops);
-    free(total_prev); free(idle_prev); free(total_curr); free(idle_curr);
+    /* P1: guaranteed floor under the all-core SSE point */
+    if (rc == 0 && d.p1_mhz > 0 && have_p1) {
+        char scope[16];
+        for (int i = 0; i < ncpu; ++i) {
+            snprintf(scope, sizeof(scope), "cpu%d", cpus[i]);
+            dcl_result_t *r = dcl_report_add(&rep, "p1", "measured", -1, ncpu, scope, d.p1_mhz,
+                                             isinf(p1_min[i]) ? 0.0 : p1_min[i], d.p1_tol);
+            if (r && r->result >= 0) r->result = p1_min[i] >= d.p1_mhz * (1.0 - d.p1_tol / 100.0);
+        }
+        for (int p = 0; p < npkg; ++p) {
+            double lo = INFINITY;
+            for (int i = 0; i < ncpu; ++i) if (pkg_of[i] == p && p1_min[i] < lo) lo = p1_min[i];
+            snprintf(scope, sizeof(scope), "pkg%d", pkg_ids[p]);
+            dcl_result_t *r = dcl_report_add(&rep, "p1", "measured", -1, ncpu, scope, d.p1_mhz,
+                                             isinf(lo) ? 0.0 : lo, d.p1_tol);
+            if (r && r->result >= 0) r->result = lo >= d.p1_mhz * (1.0 - d.p1_tol / 100.0);
+        }
+    }
 
-    /* return allocated arrays to caller for potential further inspection */
-    if (out_wargs) *out_wargs = wargs; else free(wargs);
-    if (out_tids)  *out_tids  = tids;  else free(tids);
-    if (out_avg_util) *out_avg_util = avg_util;
+    /* Turbo bins: the first N CPUs in cores-first order */
+    for (int b = 0; b < d.nbins && rc == 0; ++b) {
+        const dcl_bin_t *bin = &d.bins[b];
+        workload_t t = dcl_license_types[bin->license];
+        if (bin->cores <= 0 || bin->cores > ncpu || t == W_AUTO || !workload_supported(t)) {
+            printf("  turbo %-7s %3d active: not applicable here, skipped\n", dcl_license_names[bin->license],
+                   bin->cores);
+            dcl_report_add(&rep, "turbo", "measured", bin->license, bin->cores, "all", bin->mhz, 0.0, bin->tol_pct);
+            continue;
+        }
+        printf("  turbo %-7s %3d active ...\n", dcl_license_names[bin->license], bin->cores);
+        pt.cool_sec = dcl_thermal_gate(&pool, temp_path, idle_temp);
+        if (dcl_pool_point(&pool, cpus, bin->cores, t, duration, use_msr, base_freq_mhz, rapl, rapl_ok, npkg,
+                           mhz, pkg_w, &pt) != 0) {
+            rc = 1;
+            break;
+        }
+        pt.temp_c = read_temperature(temp_path);
+        dcl_point_print(&pt, mhz, bin->cores);
+        int from = rep.n;
+        dcl_check_point(&rep, "turbo", bin->license, cpus, bin->cores, pkg_of, pkg_ids, npkg, mhz,
+                        bin->mhz, bin->tol_pct);
+        dcl_report_mark(&rep, from, &pt);
+    }
+    dcl_pool_stop(&pool);
+    clock_gettime(CLOCK_MONOTONIC, &run_t1);
+    double elapsed = (run_t1.tv_sec - run_t0.tv_sec) + (run_t1.tv_nsec - run_t0.tv_nsec) / 1e9;
+
+    /* Configured limits from powercap (long_term = PL1, short_term = PL2);
+     * AMD PPT is firmware-owned and has no powercap constraint */
+    for (int p = 0; p < npkg && rc == 0 && cpu_vendor() != CPU_VENDOR_AMD; ++p) {
+        char path[128], scope[16];
+        snprintf(scope, sizeof(scope), "pkg%d", pkg_ids[p]);
+        for (int k = 0; k < 2; ++k) {
+            double spec_w = k ? d.pl2_w : d.pl1_w;
+            if (spec_w <= 0) continue;
+            char val[32] = "";
+            snprintf(path, sizeof(path), "/sys/class/powercap/intel-rapl:%d/constraint_%d_power_limit_uw",
+                     pkg_ids[p], k);
+            long uw = read_sysfs_str(path, val, sizeof(val)) == 0 ? atol(val) : 0;
+            dcl_report_add(&rep, k ? "pl2" : "pl1", "configured", -1, 0, scope, spec_w, uw / 1e6,
+                           k ? d.pl2_tol : d.pl1_tol);
+        }
+    }
 
-    return 0;
+    for (int p = 0; p < npkg; ++p) if (rapl_ok[p]) rapl_close(&rapl[p]);
+    if (rc != 0) {
+        fprintf(stderr, "dcl-validate interrupted\n");
+        free(rep.r); free(cpus); free(pkg_of); free(mhz); free(p1_min);
+        return 1;
+    }
+
+    /* Package-scope table; per-CPU rows only when they fail */
+    int failed = 0, cpu_fail = 0, skipped = 0, passed = 0;
+    printf("\n%-6s %-10s %-7s %6s %-6s %10s %10s %8s %6s  %s\n", "Check", "Source", "License", "Active", "Scope",
+           "Expected", "Measured", "Dev%", "Tol%", "Result");
+    for (int i = 0; i < rep.n; ++i) {
+        const dcl_result_t *r = &rep.r[i];
+        if (r->result == 0) failed++;
+        if (r->result < 0) skipped++;
+        if (r->result > 0) passed++;
+        int is_cpu = strncmp(r->scope, "cpu", 3) == 0;
+        if (is_cpu && r->result == 0) cpu_fail++;
+        if (is_cpu && r->result != 0) continue;
+        printf("%-6s %-10s %-7s %6d %-6s %10.1f %10.1f %8.2f %6.2f  %s\n", r->check, r->source,
+               r->license >= 0 ? dcl_license_names[r->license] : "-", r->active_cores, r->scope, r->expected,
+               r->measured, isnan(r->deviation_pct) ? 0.0 : r->deviation_pct, r->tol_pct,
+               r->result < 0 ? (r->measured > 0 ? "INFO" : "SKIP") : r->result ? "PASS" : "FAIL");
+    }
+    /* nothing measurable (no cpufreq, no MSR) is not a pass */
+    const char *verdict = failed ? "fail" : passed ? "pass" : "inconclusive";
+    printf("\n%d checks: %d failed (%d per-CPU), %d skipped/info -> %s in %.0f s\n", rep.n, failed, cpu_fail,
+           skipped, verdict, elapsed);
+
+    /* default: the log path with .csv swapped for .dcl.json */
+    char out[512];
+    if (cli->report_path) {
+        snprintf(out, sizeof(out), "%s", cli->report_path);
+    } else {
+        snprintf(out, sizeof(out), "%s", log_path ? log_path : "dcl");
+        size_t len = strlen(out);
+        if (len > 4 && strcmp(out + len - 4, ".csv") == 0) out[len - 4] = '\0';
+        strncat(out, ".dcl.json", sizeof(out) - strlen(out) - 1);
+    }
+    FILE *rf = fopen(out, "w");
+    if (!rf) {
+        fprintf(stderr, "Warning: cannot write %s: %s\n", out, strerror(errno));
+    } else {
+        dcl_report_json(rf, &d, &rep, duration, elapsed, verdict);
+        fclose(rf);
+        printf("DCL report written to %s\n", out);
+    }
+
+    free(rep.r); free(cpus); free(pkg_of); free(mhz); free(p1_min);
+    return failed ? DCL_EXIT_FAIL : passed ? 0 : DCL_EXIT_INCONCLUSIVE;
 }
 
-/*******************************************************
- *     Parse CSV Log and Calculate True Averages
- *******************************************************/
+/***********************************************************
+ *                 Measured Cdyn (Power Fit)
+ * --mode cdyn-fit pins every CPU to each --cdyn-freqs step
+ * (scaling_min = scaling_max), runs each --cdyn-kernels kernel
+ * on the warm DCL pool and records package power (RAPL), core
+ * voltage (IA32_PERF_STATUS) and effective frequency. Per kernel
+ * it fits  P = Cdyn * V^2 * f + leakage  by least squares over
+ * the steps. Cdyn is reported per loaded CPU; leakage absorbs
+ * uncore and static power at the gated temperature. The class
+ * comes from the ratio to the lowest-Cdyn kernel of the run, so
+ * MIXED and new kernels are classed by data, not by table.
+ ***********************************************************/
+#define CDYN_MAX_KERNELS 24
+#define CDYN_MAX_STEPS 16
+#define CDYN_DEFAULT_STEPS 5
+#define CDYN_VOLT_SAMPLES 5
+#define CDYN_CLASS1_RATIO 1.3       /* >= this x the lowest Cdyn: class 1 */
+#define CDYN_CLASS2_RATIO 1.8       /* >= this x: class 2 */
+
 typedef struct {
-    double avg_temp;
-    double avg_freq_mhz;
-    double avg_util_pct;
-    double avg_ops_per_core_millions;
-    double ops_per_sec_millions;
-    int sample_count;
-} csv_statistics_t;
+    double set_mhz;                 /* 0 = frequency left alone */
+    double mhz;                     /* mean effective over loaded CPUs */
+    double volts;                   /* mean over loaded CPUs, NAN = unreadable */
+    double watts;                   /* package sum, NAN = no RAPL */
+} cdyn_point_t;
 
-int parse_csv_log_for_stats(const char *csv_path, int nthreads, csv_statistics_t *stats) {
-    FILE *f = fopen(csv_path, "r");
-    if (!f) return -1;
-    
-    memset(stats, 0, sizeof(*stats));
-    
-    char line[65536];
-    int data_lines = 0;
-    
-    /* Skip comments and find header */
-    int found_header = 0;
-    while (fgets(line, sizeof(line), f)) {
-        if (line[0] == '#') continue;
-        if (strstr(line, "timestamp,elapsed_sec,cpu_temp")) {
-            found_header = 1;
-            break;
+typedef struct {
+    double cdyn_nf;                 /* per loaded CPU */
+    double leak_w;
+    double r2;
+    int npts;
+} cdyn_fit_t;
+
+/* Least squares of watts on V^2*f; npts < 2 leaves the fit NAN */
+static void cdyn_fit(const cdyn_point_t *pts, int n, int ncpu, cdyn_fit_t *fit) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+    int k = 0;
+    for (int i = 0; i < n; ++i) {
+        if (isnan(pts[i].volts) || isnan(pts[i].watts) || pts[i].mhz <= 0) continue;
+        double x = pts[i].volts * pts[i].volts * pts[i].mhz * 1e6;
+        double y = pts[i].watts;
+        sx += x; sy += y; sxx += x * x; sxy += x * y; syy += y * y;
+        k++;
+    }
+    fit->npts = k;
+    fit->cdyn_nf = fit->leak_w = fit->r2 = NAN;
+    double den = k * sxx - sx * sx;
+    if (k < 2 || den <= 0) return;
+
+    double slope = (k * sxy - sx * sy) / den;
+    fit->leak_w = (sy - slope * sx) / k;
+    fit->cdyn_nf = slope / ncpu * 1e9;
+    double vy = k * syy - sy * sy;
+    fit->r2 = vy > 0 ? (k * sxy - sx * sy) * (k * sxy - sx * sy) / (den * vy) : NAN;
+}
+
+static cdyn_class_t cdyn_class_from_ratio(double ratio) {
+    if (isnan(ratio)) return CDYN_CLASS_UNKNOWN;
+    if (ratio >= CDYN_CLASS2_RATIO) return CDYN_CLASS_2;
+    if (ratio >= CDYN_CLASS1_RATIO) return CDYN_CLASS_1;
+    return CDYN_CLASS_0;
+}
+
+/* Mean core voltage over the loaded CPUs, a few reads apart */
+static double cdyn_sample_volts(const int *cpus, int n) {
+    double sum = 0.0;
+    int cnt = 0;
+    for (int s = 0; s < CDYN_VOLT_SAMPLES; ++s) {
+        for (int i = 0; i < n; ++i) {
+            double v = read_core_voltage(cpus[i]);
+            if (!isnan(v)) { sum += v; cnt++; }
         }
+        safe_nanosleep(0, DCL_SAMPLE_NS / 2);
     }
-    
-    if (!found_header) {
-        fclose(f);
+    return cnt ? sum / cnt : NAN;
+}
+
+/* Pin every CPU to one frequency: min first to the floor so max can drop */
+static int cdyn_pin_freq(const int *cpus, int n, long khz, long floor_khz) {
+    int rc = 0;
+    for (int i = 0; i < n; ++i) {
+        if (write_scaling_min_max(cpus[i], floor_khz, -1) != 0 ||
+            write_scaling_min_max(cpus[i], -1, khz) != 0 ||
+            write_scaling_min_max(cpus[i], khz, -1) != 0)
+            rc = -1;
+    }
+    return rc;
+}
+
+static long cdyn_read_khz(int cpu, const char *name) {
+    char path[128], buf[32];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/%s", cpu, name);
+    return read_sysfs_str(path, buf, sizeof(buf)) == 0 ? atol(buf) : -1;
+}
+
+/* scaling_min/max of the CPUs a pinned sweep (cdyn-fit, vf-curve) writes,
+ * read before the first write and put back on every exit */
+typedef struct {
+    int n;
+    long *min_khz, *max_khz;        /* -1 = unreadable, left alone */
+} cpufreq_saved_t;
+
+static int cpufreq_save(cpufreq_saved_t *sv, const int *cpus, int n) {
+    sv->n = 0;
+    sv->min_khz = calloc(n, sizeof(long));
+    sv->max_khz = calloc(n, sizeof(long));
+    if (!sv->min_khz || !sv->max_khz) {
+        free(sv->min_khz); free(sv->max_khz);
+        sv->min_khz = sv->max_khz = NULL;
         return -1;
     }
-    
-    /* Parse data lines */
-    while (fgets(line, sizeof(line), f)) {
-        /* Parse: timestamp,elapsed_sec,cpu_temp,cpu0_util,cpu0_freq,cpu1_util,cpu1_freq,... */
-        char *ptr = line;
-        char *endptr;
-        
-        /* Skip timestamp */
-        strtol(ptr, &endptr, 10);
-        if (*endptr != ',') continue;
-        ptr = endptr + 1;
-        
-        /* Skip elapsed_sec */
-        strtol(ptr, &endptr, 10);
-        if (*endptr != ',') continue;
-        ptr = endptr + 1;
-        
-        /* Read cpu_temp */
-        double temp = strtod(ptr, &endptr);
-        int temp_valid = (temp > 0 && endptr != ptr);
-        if (*endptr == ',') ptr = endptr + 1;
-        else continue;
-        
-        /* Read alternating util,freq pairs until we hit thread ops */
-        double total_util = 0.0;
-        double total_freq = 0.0;
-        int core_count = 0;
-        
-        /* We expect cores followed by thread ops (much larger numbers) */
-        while (*ptr && *ptr != '\n' && *ptr != '\r') {
-            /* Read util (should be 0-100) */
-            double util = strtod(ptr, &endptr);
-            if (endptr == ptr) break;
-            ptr = endptr;
-            if (*ptr == ',') ptr++;
-            
-            /* Read freq (should be in kHz, like 1800000-3500000) */
-            long freq = strtol(ptr, &endptr, 10);
-            if (endptr == ptr) break;
-            ptr = endptr;
-            if (*ptr == ',') ptr++;
-            
-            /* Check if this looks like core data (not thread ops) */
-            /* Thread ops are usually > 1M, freq is 1M-4M, util is 0-100 */
-            if (util >= 0 && util <= 100 && freq >= 100000 && freq <= 5000000) {
-                total_util += util;
-                total_freq += freq;
-                core_count++;
-            } else {
-                /* Likely hit thread operations data, stop parsing */
+    for (int i = 0; i < n; ++i) {
+        sv->min_khz[i] = cdyn_read_khz(cpus[i], "scaling_min_freq");
+        sv->max_khz[i] = cdyn_read_khz(cpus[i], "scaling_max_freq");
+    }
+    sv->n = n;
+    return 0;
+}
+
+/* Restore and release; safe on a zeroed or already restored set */
+static void cpufreq_restore(cpufreq_saved_t *sv, const int *cpus) {
+    /* max first when the original window widens upwards */
+    for (int i = 0; i < sv->n; ++i) {
+        write_scaling_min_max(cpus[i], -1, sv->max_khz[i]);
+        write_scaling_min_max(cpus[i], sv->min_khz[i], -1);
+    }
+    free(sv->min_khz); free(sv->max_khz);
+    sv->min_khz = sv->max_khz = NULL;
+    sv->n = 0;
+}
+
+int cdyn_fit_run(const cdyn_spec_t *spec, long duration, int enable_rapl, int use_msr, double base_freq_mhz,
+                 const char *temp_path, const char *log_path)
+{
+    static const workload_t defaults[] = { W_INT, W_FLOAT, W_SSE, W_AVX, W_AVX2, W_AVX512 };
+    workload_t kern[CDYN_MAX_KERNELS];
+    double steps[CDYN_MAX_STEPS];
+    int nk = 0, ns = 0;
+
+    if (spec->kernels) {
+        char *copy = strdup(spec->kernels);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok && nk < CDYN_MAX_KERNELS;
+             tok = strtok_r(NULL, ",", &save)) {
+            workload_t t = parse_type(tok);
+            if (t == W_AUTO) {
+                fprintf(stderr, "Error: invalid --cdyn-kernels entry '%s'\n", tok);
+                free(copy);
+                return 1;
+            }
+            kern[nk++] = t;
+        }
+        free(copy);
+    } else {
+        for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); ++i) kern[nk++] = defaults[i];
+    }
+    int kept = 0;
+    for (int i = 0; i < nk; ++i) {
+        if (workload_supported(kern[i])) kern[kept++] = kern[i];
+        else printf("Info: %s not supported on this CPU, skipped\n", workload_str(kern[i]));
+    }
+    nk = kept;
+
+    /* all CPUs in affinity order, as for dcl-validate */
+    int ncpu = g_cpu_order_len ? g_cpu_order_len : get_affinity_cpu_count();
+    int *cpus = calloc(ncpu, sizeof(int));
+    double *mhz = calloc(ncpu, sizeof(double));
+    cdyn_point_t *pts = calloc((size_t)CDYN_MAX_KERNELS * CDYN_MAX_STEPS, sizeof(cdyn_point_t));
+    cpufreq_saved_t saved = { 0 };
+    if (cpus)
+        for (int i = 0; i < ncpu; ++i) cpus[i] = g_cpu_order_len ? g_cpu_order[i] : i;
+    if (!cpus || !mhz || !pts || nk == 0 || cpufreq_save(&saved, cpus, ncpu) != 0) {
+        if (nk == 0) fprintf(stderr, "Error: no runnable kernels for cdyn-fit\n");
+        free(cpus); free(mhz); free(pts);
+        return 1;
+    }
+
+    long hw_min = cdyn_read_khz(cpus[0], "cpuinfo_min_freq");
+    long hw_max = cdyn_read_khz(cpus[0], "cpuinfo_max_freq");
+    if (spec->freqs) {
+        char *copy = strdup(spec->freqs);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok && ns < CDYN_MAX_STEPS; tok = strtok_r(NULL, ",", &save))
+            if (atof(tok) > 0) steps[ns++] = atof(tok);
+        free(copy);
+    } else if (hw_min > 0 && hw_max > hw_min) {
+        for (int s = 0; s < CDYN_DEFAULT_STEPS; ++s)
+            steps[ns++] = (hw_min + (hw_max - hw_min) * s / (CDYN_DEFAULT_STEPS - 1)) / 1000.0;
+    }
+    int can_pin = ns > 0 && hw_min > 0 &&
+                  cdyn_pin_freq(cpus, 1, saved.max_khz[0] > 0 ? saved.max_khz[0] : hw_max, hw_min) == 0;
+    if (!can_pin) {
+        fprintf(stderr, "Warning: cannot pin cpufreq (needs root and a cpufreq driver); "
+                        "one point per kernel, no fit\n");
+        ns = 1;
+        steps[0] = 0.0;
+    }
+
+    /* every loaded package draws power: one RAPL state per package, summed */
+    int pkg_ids[DCL_MAX_PKGS], rapl_ok[DCL_MAX_PKGS] = { 0 }, npkg = 0, rapl_all = enable_rapl;
+    rapl_state_t rapl[DCL_MAX_PKGS];
+    for (int i = 0; i < ncpu; ++i) {
+        int id = read_topology_int(cpus[i], "physical_package_id");
+        int p = 0;
+        while (p < npkg && pkg_ids[p] != id) p++;
+        if (p < npkg) continue;
+        if (npkg == DCL_MAX_PKGS) {
+            rapl_all = 0;
+            break;
+        }
+        pkg_ids[npkg++] = id;
+        if (enable_rapl) rapl_ok[p] = rapl_init(&rapl[p], cpus[i]) == 0;
+        if (!rapl_ok[p]) rapl_all = 0;
+    }
+    if (!enable_rapl)
+        fprintf(stderr, "Warning: no package power without --enable-rapl; no fit\n");
+    else if (!rapl_all)
+        rapl_warn_unavailable("Not every loaded package has power; no fit.");
+    if (isnan(read_core_voltage(cpus[0])))
+        fprintf(stderr, "Warning: IA32_PERF_STATUS voltage unreadable (root, msr module, Intel); no fit\n");
+
+    printf("\n=== Cdyn Fit: %d kernel(s) x %d step(s), %d CPUs, %ld s per point ===\n", nk, ns, ncpu, duration);
+
+    dcl_pool_t pool;
+    dcl_point_t pt;
+    int rc = dcl_pool_start(&pool, cpus, ncpu) == 0 ? 0 : 1;
+    double idle_temp = read_temperature(temp_path);
+
+    /* frequency outer: one cpufreq write per step */
+    for (int s = 0; s < ns && rc == 0; ++s) {
+        if (can_pin && cdyn_pin_freq(cpus, ncpu, (long)(steps[s] * 1000), hw_min) != 0)
+            fprintf(stderr, "Warning: could not pin all CPUs to %.0f MHz\n", steps[s]);
+        for (int k = 0; k < nk && rc == 0; ++k) {
+            double pkg_w[DCL_MAX_PKGS];
+            cdyn_point_t *p = &pts[k * CDYN_MAX_STEPS + s];
+            if (steps[s] > 0) printf("  %-8s @ %5.0f MHz ...", workload_str(kern[k]), steps[s]);
+            else printf("  %-8s @ current ...", workload_str(kern[k]));
+            fflush(stdout);
+            pt.cool_sec = dcl_thermal_gate(&pool, temp_path, idle_temp);
+            if (dcl_pool_point(&pool, cpus, ncpu, kern[k], duration, use_msr, base_freq_mhz, rapl, rapl_ok, npkg,
+                               mhz, pkg_w, &pt) != 0) {
+                rc = 1;
                 break;
             }
+            /* the pool keeps running the kernel while voltage is read */
+            p->set_mhz = steps[s];
+            p->volts = cdyn_sample_volts(cpus, ncpu);
+            /* Cdyn is per loaded CPU, so the power must cover all of them */
+            p->watts = rapl_all ? 0.0 : NAN;
+            for (int q = 0; q < npkg && rapl_all; ++q) p->watts += pkg_w[q];
+            p->mhz = 0.0;
+            for (int i = 0; i < ncpu; ++i) p->mhz += mhz[i] / ncpu;
+            if (p->mhz <= 0) p->mhz = steps[s];
+            printf(" %6.0f MHz %6.3f V %7.1f W\n", p->mhz, p->volts, p->watts);
+        }
+    }
+    dcl_pool_stop(&pool);
+    for (int p = 0; p < npkg; ++p) if (rapl_ok[p]) rapl_close(&rapl[p]);
+
+    /* also undoes a probe that failed after its first write */
+    cpufreq_restore(&saved, cpus);
+
+    if (rc != 0) {
+        fprintf(stderr, "cdyn-fit interrupted\n");
+        free(cpus); free(mhz); free(pts);
+        return 1;
+    }
+
+    cdyn_fit_t fits[CDYN_MAX_KERNELS];
+    double lowest = NAN;
+    for (int k = 0; k < nk; ++k) {
+        cdyn_fit(&pts[k * CDYN_MAX_STEPS], ns, ncpu, &fits[k]);
+        if (fits[k].cdyn_nf > 0 && (isnan(lowest) || fits[k].cdyn_nf < lowest)) lowest = fits[k].cdyn_nf;
+    }
+
+    printf("\n%-8s %5s %14s %10s %6s %7s  %-16s %s\n", "Kernel", "Pts", "Cdyn/CPU (nF)", "Leak (W)", "R2",
+           "Ratio", "Measured class", "Table class");
+    for (int k = 0; k < nk; ++k) {
+        double ratio = fits[k].cdyn_nf > 0 ? fits[k].cdyn_nf / lowest : NAN;
+        printf("%-8s %5d %14.3f %10.1f %6.3f %7.2f  %-16s %s\n", workload_str(kern[k]), fits[k].npts,
+               fits[k].cdyn_nf, fits[k].leak_w, fits[k].r2, ratio, cdyn_class_name(cdyn_class_from_ratio(ratio)),
+               cdyn_class_name(get_cdyn_class(kern[k])));
+    }
+    printf("(class: ratio to the lowest Cdyn of this run; >= %.1f Cdyn1, >= %.1f Cdyn2)\n",
+           CDYN_CLASS1_RATIO, CDYN_CLASS2_RATIO);
+
+    if (log_path) {
+        FILE *lf = fopen(log_path, "w");
+        if (!lf) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(lf, "# coreburner cdyn-fit\n# cpus=%d\n# duration=%ld\n", ncpu, duration);
+            write_machine_fingerprint(lf, "# fp.", &g_fingerprint);
+            for (int k = 0; k < nk; ++k) {
+                double ratio = fits[k].cdyn_nf > 0 ? fits[k].cdyn_nf / lowest : NAN;
+                fprintf(lf, "# fit.%s=cdyn_nf:%.4f,leak_w:%.2f,r2:%.4f,points:%d,class:%d,table_class:%d\n",
+                        workload_str(kern[k]), fits[k].cdyn_nf, fits[k].leak_w, fits[k].r2, fits[k].npts,
+                        (int)cdyn_class_from_ratio(ratio), (int)get_cdyn_class(kern[k]));
+            }
+            fprintf(lf, "kernel,set_mhz,mhz,volts,pkg_w,v2f\n");
+            for (int k = 0; k < nk; ++k) {
+                for (int s = 0; s < ns; ++s) {
+                    const cdyn_point_t *p = &pts[k * CDYN_MAX_STEPS + s];
+                    fprintf(lf, "%s,%.0f,%.1f,%.4f,%.2f,%.4e\n", workload_str(kern[k]), p->set_mhz, p->mhz,
+                            p->volts, p->watts, p->volts * p->volts * p->mhz * 1e6);
+                }
+            }
+            fclose(lf);
+            printf("\ncdyn-fit results written to %s\n", log_path);
+        }
+    }
+
+    free(cpus); free(mhz); free(pts);
+    return 0;
+}
+
+/***********************************************************
+ *              Voltage / Frequency Curves
+ * --mode vf-curve pins cpufreq to each step (--vf-freqs, or
+ * --vf-steps evenly from cpuinfo min to max) under --type and
+ * records per CPU the effective frequency and core voltage:
+ * IA32_PERF_STATUS where readable, else the first hwmon
+ * in0_input (a board rail, the same for every CPU). --vf-cores
+ * all loads every CPU at once; each loads one CPU at a time so
+ * each reading is that core's own request. At every step CPUs
+ * whose voltage sits more than max(3 MAD, VF_OUTLIER_MIN_MV)
+ * from the median are flagged as guard-band outliers.
+ ***********************************************************/
+#define VF_MAX_STEPS 32
+#define VF_DEFAULT_STEPS 8
+#define VF_VOLT_SAMPLES 5
+#define VF_OUTLIER_MIN_MV 10.0
+
+static char *vf_find_hwmon_vin(void) {
+    for (int h = 0; h < 32; ++h) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/in0_input", h);
+        if (access(path, R_OK) == 0) return strdup(path);
+    }
+    return NULL;
+}
+
+/* Mean of a few reads; *src says where it came from */
+static double vf_sample_volts(int cpu, const char *hwmon, const char **src) {
+    double sum = 0.0;
+    int cnt = 0;
+    *src = "none";
+    for (int s = 0; s < VF_VOLT_SAMPLES; ++s) {
+        double v = read_core_voltage(cpu);
+        if (!isnan(v)) {
+            *src = "msr";
+        } else if (hwmon) {
+            char buf[32];
+            if (read_sysfs_str(hwmon, buf, sizeof(buf)) == 0 && atol(buf) > 0) {
+                v = atol(buf) / 1000.0;
+                *src = "hwmon";
+            }
         }
-        
-        /* Accumulate statistics for this sample */
-        if (temp_valid) stats->avg_temp += temp;
-        if (core_count > 0) {
-            stats->avg_freq_mhz += (total_freq / core_count) / 1000.0;
-            stats->avg_util_pct += total_util / core_count;
-        }
-        
-        data_lines++;
+        if (!isnan(v)) { sum += v; cnt++; }
+        safe_nanosleep(0, DCL_SAMPLE_NS / 4);
     }
-    
-    fclose(f);
-    
-    if (data_lines == 0) return -1;
-    
-    /* Calculate averages across all samples */
-    stats->avg_temp /= data_lines;
-    stats->avg_freq_mhz /= data_lines;
-    stats->avg_util_pct /= data_lines;
-    stats->sample_count = data_lines;
-    
-    return 0;
+    return cnt ? sum / cnt : NAN;
 }
 
-/*******************************************************
- *            Central Results CSV Logger
- *******************************************************/
-void write_results_csv(
-    const char *mode,
-    workload_t type,
-    int nthreads,
-    double target_util,
-    long duration,
-    long elapsed,
-    double avg_util,
-    double avg_temp,
-    long avg_freq,
-    double total_ops_millions,
-    double ops_per_second,
-    const char *command_line,
-    time_t start_time)
+static int vf_cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Flag out[i] = 1 for CPUs beyond max(3 MAD, VF_OUTLIER_MIN_MV) of the median */
+static double vf_flag_outliers(const double *volts, int n, int *out) {
+    double *v = malloc(n * sizeof(double));
+    double *dev = malloc(n * sizeof(double));
+    int k = 0;
+    for (int i = 0; i < n; ++i) {
+        out[i] = 0;
+        if (v && !isnan(volts[i])) v[k++] = volts[i];
+    }
+    if (!v || !dev || k < 3) {
+        free(v); free(dev);
+        return k ? volts[0] : NAN;
+    }
+    qsort(v, k, sizeof(double), vf_cmp_double);
+    double med = k % 2 ? v[k / 2] : (v[k / 2 - 1] + v[k / 2]) / 2;
+    for (int i = 0; i < k; ++i) dev[i] = fabs(v[i] - med);
+    qsort(dev, k, sizeof(double), vf_cmp_double);
+    double mad = k % 2 ? dev[k / 2] : (dev[k / 2 - 1] + dev[k / 2]) / 2;
+    double limit = fmax(3.0 * mad, VF_OUTLIER_MIN_MV / 1000.0);
+    for (int i = 0; i < n; ++i) out[i] = !isnan(volts[i]) && fabs(volts[i] - med) > limit;
+    free(v); free(dev);
+    return med;
+}
+
+int vf_curve_run(const vf_spec_t *spec, workload_t type, long duration, int enable_rapl, int use_msr,
+                 double base_freq_mhz, const char *temp_path, const char *log_path)
 {
-    FILE *results = NULL;
-    int file_exists = (access("results.csv", F_OK) == 0);
-    
-    results = fopen("results.csv", "a");
-    if (!results) {
-        fprintf(stderr, "Warning: Could not open results.csv for writing\n");
-        return;
+    int ncpu = g_cpu_order_len ? g_cpu_order_len : get_affinity_cpu_count();
+    int *cpus = calloc(ncpu, sizeof(int));
+    double *mhz = calloc(ncpu, sizeof(double));
+    /* [step][cpu] */
+    double *eff = calloc((size_t)VF_MAX_STEPS * ncpu, sizeof(double));
+    double *volts = calloc((size_t)VF_MAX_STEPS * ncpu, sizeof(double));
+    double *watts = calloc((size_t)VF_MAX_STEPS * ncpu, sizeof(double));
+    int *outlier = calloc((size_t)VF_MAX_STEPS * ncpu, sizeof(int));
+    const char *vsrc = "none";
+    char *hwmon = vf_find_hwmon_vin();
+    double steps[VF_MAX_STEPS];
+    int ns = 0, rc = 0;
+    cpufreq_saved_t saved = { 0 };
+
+    if (!cpus || !mhz || !eff || !volts || !watts || !outlier) {
+        rc = 1;
+        goto out;
     }
-    
-    /* Write header if file is new */
-    if (!file_exists) {
-        fprintf(results, "timestamp,date,time,mode,workload,threads,target_util,"
-                        "duration_sec,elapsed_sec,avg_util_pct,avg_temp_c,avg_freq_mhz,"
-                        "total_ops_millions,ops_per_sec_millions,avg_ops_per_core_per_sec_millions,"
-                        "command\n");
+    for (int i = 0; i < ncpu; ++i) cpus[i] = g_cpu_order_len ? g_cpu_order[i] : i;
+    /* from here on every exit goes through `out`, which puts the limits back */
+    if (cpufreq_save(&saved, cpus, ncpu) != 0) {
+        rc = 1;
+        goto out;
     }
-    
-    /* Format timestamp */
-    char date_str[32], time_str[32];
-    struct tm *tm_info = localtime(&start_time);
-    strftime(date_str, sizeof(date_str), "%Y-%m-%d", tm_info);
-    strftime(time_str, sizeof(time_str), "%H:%M:%S", tm_info);
-    
-    const char *workload_str = 
-        (type==W_INT)?"INT":
-        (type==W_FLOAT)?"FLOAT":
-        (type==W_SSE)?"SSE":
-        (type==W_AVX)?"AVX":
-        (type==W_AVX2)?"AVX2":
-        (type==W_AVX512)?"AVX512":
-        (type==W_AUTO)?"AUTO":"MIXED";
-    
-    double avg_ops_per_core_per_sec = (nthreads > 0 && elapsed > 0) ? total_ops_millions / (elapsed * nthreads) : 0.0;
-    
-    /* Write data row */
-    fprintf(results, "%ld,%s,%s,%s,%s,%d,%.1f,%ld,%ld,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,\"%s\"\n",
-            (long)start_time,
-            date_str,
-            time_str,
-            mode,
-            workload_str,
-            nthreads,
-            target_util,
-            duration,
-            elapsed,
-            avg_util,
-            avg_temp,
-            avg_freq / 1000.0,  /* Convert kHz to MHz */
-            total_ops_millions,
-            ops_per_second,
-            avg_ops_per_core_per_sec,
-            command_line ? command_line : "N/A");
-    
-    fclose(results);
-    printf("\n✓ Results appended to results.csv\n");
+
+    long hw_min = cdyn_read_khz(cpus[0], "cpuinfo_min_freq");
+    long hw_max = cdyn_read_khz(cpus[0], "cpuinfo_max_freq");
+    if (spec->freqs) {
+        char *copy = strdup(spec->freqs);
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok && ns < VF_MAX_STEPS; tok = strtok_r(NULL, ",", &save))
+            if (atof(tok) > 0) steps[ns++] = atof(tok);
+        free(copy);
+    } else if (hw_min > 0 && hw_max > hw_min) {
+        int n = spec->steps > 1 ? spec->steps : VF_DEFAULT_STEPS;
+        if (n > VF_MAX_STEPS) n = VF_MAX_STEPS;
+        for (int s = 0; s < n; ++s) steps[ns++] = (hw_min + (hw_max - hw_min) * s / (n - 1)) / 1000.0;
+    }
+    if (ns == 0 || hw_min <= 0 || cdyn_pin_freq(cpus, 1, saved.max_khz[0] > 0 ? saved.max_khz[0] : hw_max, hw_min) != 0) {
+        fprintf(stderr, "Error: vf-curve needs writable cpufreq limits (root and a cpufreq driver)\n");
+        rc = 1;
+        goto out;
+    }
+    vf_sample_volts(cpus[0], hwmon, &vsrc);
+    if (strcmp(vsrc, "none") == 0)
+        fprintf(stderr, "Warning: no voltage source (IA32_PERF_STATUS needs root + msr; no hwmon in0_input)\n");
+    else if (strcmp(vsrc, "hwmon") == 0)
+        fprintf(stderr, "Warning: voltage from %s is a board rail, not per core\n", hwmon);
+
+    int rapl_ok = 0;
+    rapl_state_t rapl;
+    if (enable_rapl && !(rapl_ok = rapl_init(&rapl, cpus[0]) == 0)) rapl_warn_unavailable("Power not measured.");
+
+    printf("\n=== V/F Curve: %s, %d step(s), %d CPUs (%s), %ld s per point, voltage: %s ===\n",
+           workload_str(type), ns, ncpu, spec->each ? "one at a time" : "all loaded", duration, vsrc);
+
+    double idle_temp = read_temperature(temp_path);
+    dcl_pool_t pool;
+    dcl_point_t pt;
+    /* each: one single-CPU pool per CPU; all: one pool, every CPU loaded */
+    int rounds = spec->each ? ncpu : 1;
+    for (int r = 0; r < rounds && rc == 0; ++r) {
+        const int *pc = spec->each ? &cpus[r] : cpus;
+        int pn = spec->each ? 1 : ncpu;
+        if (dcl_pool_start(&pool, pc, pn) != 0) {
+            rc = 1;
+            dcl_pool_stop(&pool);
+            break;
+        }
+        for (int s = 0; s < ns && rc == 0; ++s) {
+            double pkg_w = NAN;
+            if (cdyn_pin_freq(cpus, ncpu, (long)(steps[s] * 1000), hw_min) != 0)
+                fprintf(stderr, "Warning: could not pin all CPUs to %.0f MHz\n", steps[s]);
+            pt.cool_sec = dcl_thermal_gate(&pool, temp_path, idle_temp);
+            if (dcl_pool_point(&pool, pc, pn, type, duration, use_msr, base_freq_mhz, &rapl, &rapl_ok, 1, mhz,
+                               &pkg_w, &pt) != 0) {
+                rc = 1;
+                break;
+            }
+            for (int i = 0; i < pn; ++i) {
+                int idx = spec->each ? r : i;
+                const char *src;
+                eff[s * ncpu + idx] = mhz[i];
+                volts[s * ncpu + idx] = vf_sample_volts(pc[i], hwmon, &src);
+                watts[s * ncpu + idx] = pkg_w;
+            }
+            if (spec->each)
+                printf("  cpu%-3d %5.0f MHz: %6.0f MHz eff, %6.3f V\n", cpus[r], steps[s], mhz[0],
+                       volts[s * ncpu + r]);
+            else
+                printf("  %5.0f MHz: settled %.1f s, %.1f W\n", steps[s], pt.settle_sec, pkg_w);
+        }
+        dcl_pool_stop(&pool);
+    }
+    if (rapl_ok) rapl_close(&rapl);
+
+    if (rc != 0) {
+        fprintf(stderr, "vf-curve interrupted\n");
+        goto out;
+    }
+
+    /* Table: one row per CPU, voltage in mV per step */
+    int nout = 0;
+    double med[VF_MAX_STEPS];
+    for (int s = 0; s < ns; ++s) {
+        med[s] = vf_flag_outliers(&volts[s * ncpu], ncpu, &outlier[s * ncpu]);
+        for (int i = 0; i < ncpu; ++i) nout += outlier[s * ncpu + i];
+    }
+    printf("\nCore voltage (mV) per set frequency (MHz); * = outlier vs the median\n%-6s", "CPU");
+    for (int s = 0; s < ns; ++s) printf(" %6.0f", steps[s]);
+    printf("\n");
+    for (int i = 0; i < ncpu; ++i) {
+        printf("cpu%-3d", cpus[i]);
+        for (int s = 0; s < ns; ++s) {
+            double v = volts[s * ncpu + i];
+            if (isnan(v)) printf(" %6s", "n/a");
+            else printf(" %5.0f%c", v * 1000.0, outlier[s * ncpu + i] ? '*' : ' ');
+        }
+        printf("\n");
+    }
+    printf("%-6s", "median");
+    for (int s = 0; s < ns; ++s) {
+        if (isnan(med[s])) printf(" %6s", "n/a");
+        else printf(" %5.0f ", med[s] * 1000.0);
+    }
+    printf("\n%d outlier point(s)\n", nout);
+
+    if (log_path) {
+        FILE *lf = fopen(log_path, "w");
+        if (!lf) {
+            fprintf(stderr, "Warning: cannot write %s: %s\n", log_path, strerror(errno));
+        } else {
+            fprintf(lf, "# coreburner vf-curve\n# type=%s\n# cores=%s\n# duration=%ld\n# voltage_source=%s\n",
+                    workload_str(type), spec->each ? "each" : "all", duration, vsrc);
+            write_machine_fingerprint(lf, "# fp.", &g_fingerprint);
+            fprintf(lf, "cpu,set_mhz,mhz,volts,pkg_w,median_volts,outlier\n");
+            for (int i = 0; i < ncpu; ++i)
+                for (int s = 0; s < ns; ++s)
+                    fprintf(lf, "%d,%.0f,%.1f,%.4f,%.2f,%.4f,%d\n", cpus[i], steps[s], eff[s * ncpu + i],
+                            volts[s * ncpu + i], watts[s * ncpu + i], med[s], outlier[s * ncpu + i]);
+            fclose(lf);
+            printf("\nvf-curve results written to %s\n", log_path);
+        }
+    }
+
+out:
+    cpufreq_restore(&saved, cpus);
+    free(cpus); free(mhz);
+    free(eff); free(volts); free(watts); free(outlier); free(hwmon);
+    return rc;
 }
 
 /*******************************************************
@@ -2373,6 +11661,7 @@ int main(int argc, char **argv)
 
     int dynamic_freq = 0;
     char *mixed_ratio_str = NULL;
+    double kernel_fraction = 1.0;
     int single_core_id = 0;
     int single_core_threads = 2;
     
@@ -2381,6 +11670,36 @@ int main(int argc, char **argv)
     int enable_msr_freq = 0;
     int enable_rapl = 0;
     double base_freq_mhz = 2000.0;
+    repeat_spec_t repeat;
+    char *results_dir = NULL;
+    baseline_spec_t baseline;
+    int baseline_failed = 0;
+    replay_spec_t replay;
+    smt_spec_t smt;
+    ctx_spec_t ctx;
+    tlb_spec_t tlb;
+    lock_spec_t lock;
+    copy_spec_t copy;
+    fpa_spec_t fpa;
+    fe_spec_t fe;
+    memp_spec_t memp;
+    cdyn_spec_t cdyn;
+    vf_spec_t vf;
+    uncore_spec_t uncore;
+    cppc_spec_t cppc;
+    hwmon_spec_t hwmon;
+    guard_spec_t guard;
+
+    /* Results store query mode: no workload, separate argument set */
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--query") == 0) {
+            results_query_t q;
+            if (parse_query_args(argc, argv, &q) != 0) return 1;
+            return results_query(&q);
+        }
+        if (strcmp(argv[i], "--record-trace") == 0)
+            return trace_record_main(argc, argv);
+    }
 
     /* Parse CLI */
     if (parse_args(
@@ -2394,17 +11713,62 @@ int main(int argc, char **argv)
             &freq_table_str,
             &dynamic_freq,
             &mixed_ratio_str,
+            &kernel_fraction,
             &single_core_id, &single_core_threads,
-            &dcl_spec, &enable_msr_freq, &enable_rapl, &base_freq_mhz) != 0)
+            &dcl_spec, &enable_msr_freq, &enable_rapl, &base_freq_mhz,
+            &repeat, &results_dir, &baseline, &replay, &smt, &ctx, &tlb, &lock, &copy, &fpa, &fe, &memp, &cdyn, &vf, &uncore, &cppc, &hwmon, &guard) != 0)
     {
         return 1;
     }
+    g_kernel_fraction = kernel_fraction;
+    if (tlb_apply_workload_spec(&tlb) != 0) return 1;
+    g_hwmon_ramp_pct = hwmon.fan_ramp_pct;
+    if (hwmon_select(hwmon.select) != 0) return 1;
+    guard_configure(guard.enabled, guard.margin_sec, guard.window, guard.action);
+    if (lock.kind && parse_lock_kind(lock.kind, &g_lock.kind) != 0) {
+        fprintf(stderr, "Error: --lock-kind must be mutex, spin, ticket, mcs or rwlock\n");
+        return 1;
+    }
+    g_lock.cs_iters = lock.cs_iters;
+    g_lock.ncs_iters = lock.ncs_iters;
+    g_lock.read_pct = lock.read_pct;
+    if (topology_spread_init(lock.spread) != 0) return 1;
+    if (hybrid_init()) {
+        int np = 0, ne = 0;
+        for (int c = 0; c < HYBRID_MAX_CPUS; ++c) {
+            np += g_core_type[c] == CORE_TYPE_P;
+            ne += g_core_type[c] == CORE_TYPE_E;
+        }
+        printf("Info: hybrid CPU, %d P-core and %d E-core CPUs (from %s)\n", np, ne, g_hybrid_src);
+    }
+    if (hybrid_apply_policy(lock.core_type) != 0) return 1;
+    if (copy_apply_workload_spec(&copy) != 0) return 1;
+    if (fe_apply_workload_spec(&fe) != 0) return 1;
+    if (fpa.mxcsr && (g_mxcsr_mode = parse_mxcsr_mode(fpa.mxcsr)) < 0) {
+        fprintf(stderr, "Error: --mxcsr must be off, ftz, daz or ftz+daz\n");
+        return 1;
+    }
+
+    /* Capture machine fingerprint once; stored in log header, summary and results */
+    collect_machine_fingerprint(&g_fingerprint);
+
+    /* Spec file fills the single-type P0n checks; dcl-validate loads it itself */
+    if (dcl_spec.spec_path && !str_case_equal(mode, "dcl-validate") &&
+        dcl_spec_apply(&dcl_spec, &g_fingerprint) != 0) {
+        return 1;
+    }
 
     /* Auto-detect best SIMD level if AUTO was specified */
     if (type == W_AUTO) {
         type = auto_detect_best_simd();
     }
 
+    /* Trace replay: one worker per trace lane, duration from the trace */
+    if (replay.path) {
+        if (trace_replay_load(&replay, type) != 0) return 1;
+        if (duration <= 0) duration = trace_replay_duration_sec();
+    }
+
     /* Auto-generate log path if not specified */
     if (!log_path) {
         /* Create log directory if it doesn't exist */
@@ -2415,14 +11779,9 @@ int main(int argc, char **argv)
             }
         }
         
-        const char *workload_short = 
-            (type == W_INT) ? "int" :
-            (type == W_FLOAT) ? "float" :
-            (type == W_SSE) ? "sse" :
-            (type == W_AVX) ? "avx" :
-            (type == W_AVX2) ? "avx2" :
-            (type == W_AVX512) ? "avx512" :
-            (type == W_AUTO) ? "auto" : "mixed";
+        char workload_short[16];
+        snprintf(workload_short, sizeof(workload_short), "%s", workload_str(type));
+        for (char *p = workload_short; *p; ++p) *p = (char)tolower((unsigned char)*p);
         
         char auto_log_name[256];
         time_t now = time(NULL);
@@ -2452,7 +11811,10 @@ int main(int argc, char **argv)
         (set_min_freq != -1) ||
         (set_max_freq != -1) ||
         (freq_table_str != NULL) ||
-        (dynamic_freq);
+        (dynamic_freq) ||
+        (uncore.min_mhz > 0 || uncore.max_mhz > 0) ||
+        (cppc.epp != NULL) ||
+        (cppc.pstate_mode != NULL);
 
     /* Validate environment */
     char *temp_path = NULL;
@@ -2472,9 +11834,24 @@ if (validate_environment(
     ) != 0)
 {
     free(temp_path);
+    trace_replay_free();
     return 1;
 }
 
+    if (type == W_TLB) tlb_cap_workload_footprint(nthreads);
+
+    if (type != W_AUTO && hybrid_isa_check(type, nthreads) != 0) {
+        free(temp_path);
+        trace_replay_free();
+        return 1;
+    }
+
+    if (g_replay && trace_replay_map(replay.cpu_map, g_available_cpus) != 0) {
+        free(temp_path);
+        trace_replay_free();
+        return 1;
+    }
+
 
     /* --check mode */
     if (check_only) {
@@ -2482,20 +11859,25 @@ if (validate_environment(
         printf("Planned configuration:\n");
         printf("  Mode            : %s\n", mode);
         printf("  Threads         : %d\n", nthreads);
-        printf("  Workload        : %s\n",
-               (type == W_INT) ? "INT" :
-               (type == W_FLOAT) ? "FLOAT" :
-               (type == W_SSE) ? "SSE" :
-               (type == W_AVX) ? "AVX" :
-               (type == W_AVX2) ? "AVX2" :
-               (type == W_AVX512) ? "AVX512" :
-               (type == W_AUTO) ? "AUTO" : "MIXED");
+        printf("  Workload        : %s\n", workload_str(type));
         printf("  Utilization     : %.1f%%\n", util);
         printf("  Duration        : %ld s\n", duration);
 
+        printf("  Platform        : %s\n", cpu_vendor_names[cpu_vendor()]);
+
+        if (g_hybrid)
+            printf("  Core types      : hybrid (%s), --core-type %s\n", g_hybrid_src,
+                   lock.core_type ? lock.core_type : "any");
+
         if (set_governor)
             printf("  Governor        : %s\n", set_governor);
 
+        if (cppc.pstate_mode)
+            printf("  amd-pstate mode : %s\n", cppc.pstate_mode);
+
+        if (cppc.epp)
+            printf("  EPP             : %s\n", cppc.epp);
+
         if (set_min_freq != -1 || set_max_freq != -1)
             printf("  Min/Max freq    : min=%ld  max=%ld\n",
                    set_min_freq, set_max_freq);
@@ -2503,11 +11885,24 @@ if (validate_environment(
         if (freq_table_str)
             printf("  Per-core freq   : %s\n", freq_table_str);
 
+        if (uncore.min_mhz > 0 || uncore.max_mhz > 0)
+            printf("  Uncore min/max  : min=%ld  max=%ld MHz\n", uncore.min_mhz, uncore.max_mhz);
+
+        if (hwmon.select)
+            printf("  hwmon channels  : %d matching %s\n", g_hwmon_n, hwmon.select);
+
         if (dynamic_freq)
             printf("  Dynamic freq    : enabled\n");
 
+        if (guard.enabled)
+            printf("  Thermal guard   : %s, margin %.0f s, window %d samples\n", guard.action,
+                   guard.margin_sec, g_guard.window);
+
         if (mixed_ratio_str)
             printf("  Mixed ratio     : %s\n", mixed_ratio_str);
+
+        if (workload_is_kernel_path(type))
+            printf("  Kernel fraction : %.2f\n", g_kernel_fraction);
         
         if (str_case_equal(mode, "single-core-multi"))
             printf("  Single core ID  : %d (with %d threads)\n",
@@ -2516,6 +11911,11 @@ if (validate_environment(
         if (log_path)
             printf("  Log file        : %s\n", log_path);
 
+        if (repeat.count > 1)
+            printf("  Repetitions     : %d (cool-down %d s%s)\n",
+                   repeat.count, repeat.cooldown_sec,
+                   repeat.ci_target_pct > 0 ? ", adaptive CI stop" : "");
+
         printf("\n✔ No workload executed (because --check).\n");
         free(temp_path);
         return 0;
@@ -2525,12 +11925,28 @@ if (validate_environment(
      * Apply cpufreq writes (if requested)
      ***************************************************************/
     if (wants_cpufreq_write) {
+        /* mode first: switching amd-pstate resets governor and EPP */
+        if (cppc.pstate_mode &&
+            write_sysfs_str("/sys/devices/system/cpu/amd_pstate/status", cppc.pstate_mode) != 0)
+            fprintf(stderr, "Warning: failed to set amd-pstate mode %s (amd-pstate driver loaded?)\n",
+                    cppc.pstate_mode);
+
         if (set_governor) {
             for (int c = 0; c < g_available_cpus; ++c)
                 if (write_scaling_governor(c, set_governor) != 0)
                     fprintf(stderr, "Warning: failed to set governor on CPU %d\n", c);
         }
 
+        if (cppc.epp) {
+            for (int c = 0; c < g_available_cpus; ++c) {
+                char path[96];
+                snprintf(path, sizeof(path),
+                         "/sys/devices/system/cpu/cpu%d/cpufreq/energy_performance_preference", c);
+                if (write_sysfs_str(path, cppc.epp) != 0)
+                    fprintf(stderr, "Warning: failed to set EPP on CPU %d (active mode, not 'performance' governor?)\n", c);
+            }
+        }
+
         if (set_min_freq != -1 || set_max_freq != -1) {
             for (int c = 0; c < g_available_cpus; ++c)
                 if (write_scaling_min_max(c, set_min_freq, set_max_freq) != 0)
@@ -2564,6 +11980,13 @@ if (validate_environment(
             free(ft_cpu);
             free(ft_freq);
         }
+
+        if (uncore.min_mhz > 0 || uncore.max_mhz > 0) {
+            if (uncore_init() == 0)
+                fprintf(stderr, "Warning: --uncore-min/max ignored: no %s\n", UNCORE_SYSFS);
+            else if (uncore_set_limits(uncore.min_mhz * 1000, uncore.max_mhz * 1000) != 0)
+                fprintf(stderr, "Warning: failed to set uncore min/max on some domains\n");
+        }
     }
 
     /***************************************************************
@@ -2586,13 +12009,152 @@ if (validate_environment(
     signal(SIGTERM, sigint_handler);
 
     /***************************************************************
-     * Launch main runtime
+     * SMT interference matrix: its own measurement loop, no workers
+     ***************************************************************/
+    if (str_case_equal(mode, "smt-matrix")) {
+        int smt_rc = smt_matrix_run(&smt, duration, enable_rapl, enable_msr_freq,
+                                    base_freq_mhz, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return smt_rc;
+    }
+
+    /***************************************************************
+     * Context-switch cost: threads ping-pong on --single-core-id
+     ***************************************************************/
+    if (str_case_equal(mode, "ctx-switch")) {
+        int ctx_rc = ctx_switch_run(&ctx, single_core_id, single_core_threads, duration, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return ctx_rc;
+    }
+
+    /***************************************************************
+     * TLB sweep: footprint x page-size grid on --single-core-id
+     ***************************************************************/
+    if (str_case_equal(mode, "tlb-sweep")) {
+        int tlb_rc = tlb_sweep_run(&tlb, single_core_id, duration, enable_rapl, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return tlb_rc;
+    }
+
+    /***************************************************************
+     * Copy sweep: method x transfer size from --single-core-id
+     ***************************************************************/
+    if (str_case_equal(mode, "copy-sweep")) {
+        int copy_rc = copy_sweep_run(&copy, single_core_id, duration, enable_rapl, enable_msr_freq,
+                                     base_freq_mhz, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return copy_rc;
+    }
+
+    /***************************************************************
+     * FP assist sweep: normal vs denormal kernels on --single-core-id
+     ***************************************************************/
+    if (str_case_equal(mode, "fp-assist")) {
+        int fpa_rc = fp_assist_run(single_core_id, duration, fpa.assist_event, enable_rapl,
+                                   enable_msr_freq, base_freq_mhz, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return fpa_rc;
+    }
+
+    /***************************************************************
+     * Front-end sweep: code footprint x randomness on --single-core-id
+     ***************************************************************/
+    if (str_case_equal(mode, "frontend-sweep")) {
+        int fe_rc = fe_sweep_run(&fe, single_core_id, duration, enable_rapl, enable_msr_freq,
+                                 base_freq_mhz, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return fe_rc;
+    }
+
+    /***************************************************************
+     * DCL validation: every point of the SKU spec, all CPUs
+     ***************************************************************/
+    if (str_case_equal(mode, "dcl-validate")) {
+        int dcl_rc = dcl_validate_run(&dcl_spec, duration, enable_rapl, enable_msr_freq,
+                                      base_freq_mhz, temp_path, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return dcl_rc;
+    }
+
+    /***************************************************************
+     * Cdyn fit: kernels x pinned frequencies, all CPUs
+     ***************************************************************/
+    if (str_case_equal(mode, "cdyn-fit")) {
+        int cdyn_rc = cdyn_fit_run(&cdyn, duration, enable_rapl, enable_msr_freq, base_freq_mhz,
+                                   temp_path, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return cdyn_rc;
+    }
+
+    /***************************************************************
+     * V/F curve: --type at pinned frequencies, voltage per CPU
+     ***************************************************************/
+    if (str_case_equal(mode, "vf-curve")) {
+        int vf_rc = vf_curve_run(&vf, type, duration, enable_rapl, enable_msr_freq, base_freq_mhz,
+                                 temp_path, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return vf_rc;
+    }
+
+    /***************************************************************
+     * Uncore sweep: copy bandwidth, LLC latency, power per uncore MHz
+     ***************************************************************/
+    if (str_case_equal(mode, "uncore-sweep")) {
+        int unc_rc = uncore_sweep_run(&uncore, single_core_id, duration, enable_rapl, enable_msr_freq,
+                                      base_freq_mhz, log_path);
+        free(temp_path);
+        free(current_max_freq);
+        return unc_rc;
+    }
+
+    /***************************************************************
+     * Launch main runtime (once, or once per repetition)
      ***************************************************************/
     worker_arg_t *wargs = NULL;
     pthread_t *tids = NULL;
-    double avg_util_actual = 0.0;
+    int rc = 0;
 
-    int rc = main_runtime(
+    run_stats_t *runs = calloc(repeat.count, sizeof(run_stats_t));
+    if (!runs) {
+        fprintf(stderr, "Memory allocation error\n");
+        free(temp_path);
+        free(current_max_freq);
+        return 1;
+    }
+    int nruns = 0;
+
+    if (memp.size && memp_start(&memp) != 0) {
+        free(runs);
+        free(temp_path);
+        free(current_max_freq);
+        return 1;
+    }
+
+    for (int r = 0; r < repeat.count && !user_stop_flag; ++r) {
+        if (r > 0) {
+            cooldown_wait(temp_path, repeat.cooldown_sec, repeat.cooldown_temp);
+            if (user_stop_flag) break;
+        }
+
+        char phase_label[32];
+        snprintf(phase_label, sizeof(phase_label), "rep%d", r + 1);
+        if (repeat.count > 1)
+            printf("\n##### Repetition %d/%d #####\n", r + 1, repeat.count);
+
+        stop_flag = 0;
+        free(wargs); wargs = NULL;
+        free(tids);  tids = NULL;
+
+        rc = main_runtime(
                 mode,
                 util,
                 duration,
@@ -2601,63 +12163,106 @@ if (validate_environment(
                 temp_threshold,
                 log_path,
                 log_interval,
-                log_append,
+                r > 0 ? 1 : log_append,
                 dynamic_freq,
                 current_max_freq,
                 &temp_path,
                 &wargs,
                 &tids,
                 single_core_id,
-                &avg_util_actual
+                enable_rapl,
+                repeat.count > 1 ? phase_label : NULL,
+                &runs[r]
             );
+        if (rc != 0) break;
+        nruns++;
+
+        if (g_replay) {
+            trace_replay_report(stdout);
+            if (log_path) {
+                char fid_path[1024];
+                snprintf(fid_path, sizeof(fid_path), "%s.summary.txt", log_path);
+                FILE *ff = fopen(fid_path, "a");
+                if (ff) { trace_replay_report(ff); fclose(ff); }
+            }
+        }
+
+        /* Thermal auto-stop ends the whole series, not just this repetition */
+        if (temp_path) {
+            double t = read_temperature(temp_path);
+            if (!isnan(t) && t >= temp_threshold) break;
+        }
+
+        if (repeat_ci_converged(runs, nruns, repeat.ci_target_pct)) {
+            printf("\n✓ ops/s 95%% CI within ±%.2f%% after %d repetitions, stopping early\n",
+                   repeat.ci_target_pct, nruns);
+            break;
+        }
+    }
+    memp_stop();
 
     /***************************************************************
      * Post-Run Analysis & Validation
      ***************************************************************/
-    if (rc == 0 && wargs) {
-        /* Calculate statistics from completed run */
-        uint64_t total_ops = 0;
-        for (int t = 0; t < nthreads; ++t) {
-            total_ops += __atomic_load_n(&wargs[t].ops_done, __ATOMIC_RELAXED);
-        }
-        
-        long elapsed = (long)(time(NULL) - start_timestamp);
-        double total_ops_millions = total_ops / 1000000.0;
-        double ops_per_second = elapsed > 0 ? total_ops_millions / elapsed : 0.0;
-        double avg_ops_per_core = nthreads > 0 ? total_ops_millions / nthreads : 0.0;
-        
-        /* Try to get accurate statistics from CSV log file */
-        csv_statistics_t csv_stats = {0};
+    if (nruns > 0) {
         double final_temp = 0.0;
-        double final_util = avg_util_actual;
+        double final_util = runs[0].avg_util;
         double final_freq_mhz = 0.0;
-        
-        if (log_path && parse_csv_log_for_stats(log_path, nthreads, &csv_stats) == 0) {
-            /* Successfully parsed CSV - use those statistics */
-            final_temp = csv_stats.avg_temp;
-            final_freq_mhz = csv_stats.avg_freq_mhz;
-            final_util = csv_stats.avg_util_pct;
-            printf("\n✓ Calculated statistics from %d CSV samples in %s\n", 
-                   csv_stats.sample_count, log_path);
-        } else {
-            /* Fallback: use final readings */
-            if (temp_path) {
-                double t = read_temperature(temp_path);
-                if (!isnan(t)) final_temp = t;
+        double final_pkg_watts = runs[0].avg_pkg_watts;
+        metric_summary_t ops_ci, freq_ci, power_ci, temp_ci;
+
+        aggregate_runs(runs, nruns, &ops_ci, &freq_ci, &power_ci, &temp_ci);
+
+        if (nruns > 1) {
+            /* Aggregate across repetitions (per-rep values are in-process averages) */
+            double util_sum = 0.0;
+            for (int r = 0; r < nruns; ++r) util_sum += runs[r].avg_util;
+            final_util = util_sum / nruns;
+            final_temp = temp_ci.n > 0 ? temp_ci.mean : 0.0;
+            final_freq_mhz = freq_ci.n > 0 ? freq_ci.mean : 0.0;
+            final_pkg_watts = power_ci.mean;
+
+            print_repeat_aggregate(stdout, runs, nruns);
+            if (log_path) {
+                char agg_path[1024];
+                snprintf(agg_path, sizeof(agg_path), "%s.summary.txt", log_path);
+                FILE *af = fopen(agg_path, "a");
+                if (af) {
+                    print_repeat_aggregate(af, runs, nruns);
+                    fclose(af);
+                }
             }
-            
-            long avg_freq_hz = 0;
-            int freq_samples = 0;
-            for (int c = 0; c < g_available_cpus && c < 64; ++c) {
-                long hz = 0;
-                if (read_scaling_cur_freq(c, &hz) == 0 && hz > 0) {
-                    avg_freq_hz += hz;
-                    freq_samples++;
+        } else {
+            /* Try to get accurate statistics from CSV log file */
+            csv_statistics_t csv_stats = {0};
+
+            if (log_path && parse_csv_log_for_stats(log_path, nthreads, &csv_stats) == 0) {
+                /* Successfully parsed CSV - use those statistics */
+                final_temp = csv_stats.avg_temp;
+                final_freq_mhz = csv_stats.avg_freq_mhz;
+                final_util = csv_stats.avg_util_pct;
+                printf("\n✓ Calculated statistics from %d CSV samples in %s\n", 
+                       csv_stats.sample_count, log_path);
+            } else {
+                /* Fallback: use final readings */
+                if (temp_path) {
+                    double t = read_temperature(temp_path);
+                    if (!isnan(t)) final_temp = t;
+                }
+                
+                long avg_freq_hz = 0;
+                int freq_samples = 0;
+                for (int c = 0; c < g_available_cpus && c < 64; ++c) {
+                    long hz = 0;
+                    if (read_scaling_cur_freq(c, &hz) == 0 && hz > 0) {
+                        avg_freq_hz += hz;
+                        freq_samples++;
+                    }
                 }
+                if (freq_samples > 0) final_freq_mhz = (avg_freq_hz / freq_samples) / 1000.0;
+                
+                printf("\n⚠ Using final snapshot (CSV log not available or invalid)\n");
             }
-            if (freq_samples > 0) final_freq_mhz = (avg_freq_hz / freq_samples) / 1000.0;
-            
-            printf("\n⚠ Using final snapshot (CSV log not available or invalid)\n");
         }
         
         /***************************************************************
@@ -2665,14 +12270,7 @@ if (validate_environment(
          ***************************************************************/
         cdyn_class_t cdyn = get_cdyn_class(type);
         printf("\n=== Cdyn Class Analysis ===\n");
-        printf("  Workload Type: %s\n", 
-            (type == W_INT) ? "INT" :
-            (type == W_FLOAT) ? "FLOAT" :
-            (type == W_SSE) ? "SSE" :
-            (type == W_AVX) ? "AVX" :
-            (type == W_AVX2) ? "AVX2" :
-            (type == W_AVX512) ? "AVX512" :
-            (type == W_MIXED) ? "MIXED" : "AUTO");
+        printf("  Workload Type: %s\n", workload_str(type));
         printf("  Cdyn Class   : %s\n", cdyn_class_name(cdyn));
         printf("===========================\n");
         
@@ -2684,24 +12282,68 @@ if (validate_environment(
         }
         
         /***************************************************************
-         * Write results to central CSV file
+         * Write results to central CSV file (per-rep rows + aggregate)
          ***************************************************************/
-        
-        write_results_csv(
-            mode,
-            type,
-            nthreads,
-            util,
-            duration,
-            elapsed,
-            final_util,
-            final_temp,
-            (long)(final_freq_mhz * 1000),  /* Convert MHz back to kHz for function signature */
-            total_ops_millions,
-            ops_per_second,
-            command_line,
-            start_timestamp
-        );
+        for (int r = 0; r < nruns; ++r) {
+            char rep_label[16];
+            snprintf(rep_label, sizeof(rep_label), "%d", r + 1);
+
+            write_results_csv(
+                mode,
+                type,
+                nthreads,
+                util,
+                duration,
+                runs[r].elapsed_sec,
+                nruns > 1 ? runs[r].avg_util : final_util,
+                nruns > 1 ? (isnan(runs[r].avg_temp) ? 0.0 : runs[r].avg_temp) : final_temp,
+                (long)((nruns > 1 ? runs[r].avg_freq_mhz : final_freq_mhz) * 1000),  /* MHz -> kHz */
+                runs[r].total_ops_millions,
+                runs[r].ops_per_sec,
+                command_line,
+                start_timestamp,
+                rep_label,
+                runs[r].avg_pkg_watts,
+                NULL
+            );
+        }
+
+        if (nruns > 1) {
+            long elapsed_sum = 0;
+            double ops_sum = 0.0;
+            for (int r = 0; r < nruns; ++r) {
+                elapsed_sum += runs[r].elapsed_sec;
+                ops_sum += runs[r].total_ops_millions;
+            }
+
+            write_results_csv(
+                mode,
+                type,
+                nthreads,
+                util,
+                duration,
+                elapsed_sum / nruns,
+                final_util,
+                final_temp,
+                (long)(final_freq_mhz * 1000),
+                ops_sum / nruns,
+                ops_ci.mean,
+                command_line,
+                start_timestamp,
+                "mean",
+                final_pkg_watts,
+                &ops_ci
+            );
+        }
+
+        /* Fleet baseline screening (before this run is added to the store) */
+        if (baseline.source || baseline.update_path) {
+            baseline_failed = baseline_check_run(&baseline, results_dir, mode, type, util,
+                                                 runs, nruns);
+        }
+
+        results_store_append(results_dir, mode, type, nthreads, util, duration,
+                             command_line, start_timestamp, runs, nruns);
     }
 
     /***************************************************************
@@ -2712,7 +12354,14 @@ if (validate_environment(
 
     if (wargs) free(wargs);
     if (tids)  free(tids);
+    for (int r = 0; r < nruns; ++r) {
+        free(runs[r].core_avg_util);
+        free(runs[r].core_avg_freq_mhz);
+    }
+    free(runs);
+    trace_replay_free();
 
-    return rc == 0 ? 0 : 1;
+    if (rc != 0) return 1;
+    return baseline_failed ? 3 : 0;
 }
 
@@ -3,9 +3,13 @@
 # Official DCL Frequency Validation Script
 # 
 # Purpose: Validate CPU frequencies against official DCL specifications for
-#          all license levels (Cdyn classes) under all-core turbo conditions.
+#          all license levels (Cdyn classes), turbo bins and power limits,
+#          using the versioned DCL spec file that matches this CPU.
 #
-# Usage: ./official_dcl_validation.sh
+# Usage: DCL_SPEC=../dcl ./official_dcl_validation.sh
+#
+# Exit status: 0 all checks passed, 4 at least one check failed,
+#              5 inconclusive (nothing could be measured), 1 error.
 #
 # Requirements:
 # - CoreBurner binary in same directory
@@ -22,20 +26,18 @@ BLUE='\033[0;34m'
 NC='\033[0m' # No Color
 
 ################################################################################
-# DCL SPECIFICATIONS - UPDATE THESE WITH YOUR OFFICIAL DCL VALUES
+# DCL SPECIFICATIONS
 ################################################################################
 
-# All-Core Turbo Frequencies (MHz) for each license level
-# TODO: Replace these with actual DCL specifications from PRC team
-DCL_SSE_ALLCORE=2800      # Cdyn0 (License Level 0) - SSE all-core turbo
-DCL_AVX_ALLCORE=2800      # Cdyn1 (License Level 1) - AVX all-core turbo
-DCL_AVX2_ALLCORE=2800     # Cdyn2 (License Level 2) - AVX2 all-core turbo
+# Spec file, or a directory of *.dcl files matched by CPU family/model/stepping.
+# The values themselves live in the spec file (see dcl/template.dcl.example).
+DCL_SPEC=${DCL_SPEC:-../dcl}
 
-# Validation tolerance (percentage)
-DCL_TOLERANCE=3.0         # 3% tolerance for frequency deviation
+# Optional: override every frequency tolerance in the spec file (percentage)
+DCL_TOLERANCE=${DCL_TOLERANCE:-}
 
 # Test duration (seconds)
-TEST_DURATION=60          # 60 seconds per test
+TEST_DURATION=${TEST_DURATION:-60}   # seconds per spec point
 
 ################################################################################
 # Configuration
@@ -46,8 +48,10 @@ TIMESTAMP=$(date +%Y%m%d_%H%M%S)
 LOG_DIR="../dcl_validation_${TIMESTAMP}"
 mkdir -p "$LOG_DIR"
 
-# Log file
+# Log files
 REPORT_FILE="$LOG_DIR/DCL_VALIDATION_REPORT.txt"
+JSON_REPORT="$LOG_DIR/dcl_report.json"
+RUN_OUTPUT="$LOG_DIR/dcl_validate.txt"
 
 ################################################################################
 # Functions
@@ -80,6 +84,14 @@ check_prerequisites() {
         exit 1
     fi
     echo -e "${GREEN}✓${NC} CoreBurner binary found"
+
+    # Check the spec exists
+    if [ ! -e "$DCL_SPEC" ]; then
+        echo -e "${RED}✗ DCL spec not found: $DCL_SPEC${NC}"
+        echo "  Set DCL_SPEC to a spec file or a directory of *.dcl files"
+        exit 1
+    fi
+    echo -e "${GREEN}✓${NC} DCL spec: $DCL_SPEC"
     
     # Check if running as root (for MSR/RAPL)
     if [ "$EUID" -eq 0 ]; then
@@ -108,40 +120,39 @@ check_prerequisites() {
     echo ""
 }
 
-run_validation_test() {
-    local TEST_NAME=$1
-    local WORKLOAD_TYPE=$2
-    local EXPECTED_FREQ=$3
-    local LICENSE_LEVEL=$4
-    local LOG_FILE="$LOG_DIR/${WORKLOAD_TYPE}_allcore.csv"
-    
-    echo -e "${BLUE}▶${NC} Testing: $TEST_NAME"
-    echo "  Workload: $WORKLOAD_TYPE"
-    echo "  Expected: ${EXPECTED_FREQ} MHz"
-    echo "  License Level: $LICENSE_LEVEL"
-    echo "  Duration: ${TEST_DURATION}s"
-    echo ""
-    
-    # Run CoreBurner test
-    ./coreburner \
-        --mode multi \
+run_validation() {
+    local EXTRA=()
+    [ -n "$DCL_TOLERANCE" ] && EXTRA+=(--dcl-tolerance "$DCL_TOLERANCE")
+    [ "$EUID" -eq 0 ] && EXTRA+=(--enable-msr-freq --enable-rapl)
+
+    # One run covers every point in the spec; coreburner picks the
+    # license levels, turbo bins and power checks from the file.
+    ../coreburner \
+        --mode dcl-validate \
         --util 100 \
         --duration ${TEST_DURATION}s \
-        --type $WORKLOAD_TYPE \
-        --dcl-${WORKLOAD_TYPE,,}-freq $EXPECTED_FREQ \
-        --dcl-tolerance $DCL_TOLERANCE \
-        --log "$LOG_FILE" 2>&1 | tail -20
-    
+        --dcl-spec "$DCL_SPEC" \
+        --dcl-report "$JSON_REPORT" \
+        --log "$LOG_DIR/dcl_validate.csv" \
+        "${EXTRA[@]}" 2>&1 | tee "$RUN_OUTPUT"
+    DCL_STATUS=${PIPESTATUS[0]}
     echo ""
 }
 
 generate_report() {
     print_section "Generating Validation Report"
-    
+
+    case $DCL_STATUS in
+        0) VERDICT=$(grep -o '"result":"[a-z]*","points"' "$JSON_REPORT" 2>/dev/null | cut -d'"' -f4) ;;
+        4) VERDICT="fail" ;;
+        5) VERDICT="inconclusive (no frequency source: needs cpufreq or --enable-msr-freq)" ;;
+        *) VERDICT="error (exit $DCL_STATUS)" ;;
+    esac
+
     cat << EOF > "$REPORT_FILE"
 ╔═══════════════════════════════════════════════════════════════════╗
 ║                                                                   ║
-║        DCL ALL-CORE TURBO FREQUENCY VALIDATION REPORT            ║
+║               DCL FREQUENCY VALIDATION REPORT                     ║
 ║                                                                   ║
 ╚═══════════════════════════════════════════════════════════════════╝
 
@@ -163,92 +174,26 @@ Max Frequency  : $(cat /sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq 2>/
 Governor       : $(cat /sys/devices/system/cpu/cpu0/cpufreq/scaling_governor 2>/dev/null)
 Kernel Version : $(uname -r)
 
-DCL SPECIFICATIONS (All-Core Turbo)
+DCL SPECIFICATION
 ═══════════════════════════════════════════════════════════════════
 
-License Level 0 (Cdyn0 - SSE) : ${DCL_SSE_ALLCORE} MHz
-License Level 1 (Cdyn1 - AVX) : ${DCL_AVX_ALLCORE} MHz
-License Level 2 (Cdyn2 - AVX2): ${DCL_AVX2_ALLCORE} MHz
+$(grep -E "=== DCL Validation|  Spec   :|  CPUs   :" "$RUN_OUTPUT")
+Test Duration  : ${TEST_DURATION} seconds per point
 
-Tolerance                     : ${DCL_TOLERANCE}%
-Test Duration                 : ${TEST_DURATION} seconds per test
-
-VALIDATION RESULTS
+VALIDATION RESULTS (package scope; per-CPU rows shown only on failure)
 ═══════════════════════════════════════════════════════════════════
 
-EOF
+$(sed -n '/^Check /,/ checks: /p' "$RUN_OUTPUT")
 
-    # Extract results from summary files
-    if [ -f "$LOG_DIR/SSE_allcore.csv.summary.txt" ]; then
-        SSE_FREQ=$(grep "avg_frequency_mhz" "$LOG_DIR/SSE_allcore.csv.summary.txt" | cut -d= -f2)
-        SSE_TEMP=$(grep "avg_temperature" "$LOG_DIR/SSE_allcore.csv.summary.txt" | cut -d= -f2)
-        
-        echo "Test 1: SSE (License Level 0 / Cdyn0)" >> "$REPORT_FILE"
-        echo "───────────────────────────────────────────────────────────────────" >> "$REPORT_FILE"
-        echo "  Workload Type     : SSE (128-bit SIMD)" >> "$REPORT_FILE"
-        echo "  Cdyn Class        : Cdyn0 (Low)" >> "$REPORT_FILE"
-        echo "  Expected Frequency: ${DCL_SSE_ALLCORE} MHz" >> "$REPORT_FILE"
-        echo "  Measured Frequency: ${SSE_FREQ} MHz" >> "$REPORT_FILE"
-        echo "  Avg Temperature   : ${SSE_TEMP}°C" >> "$REPORT_FILE"
-        echo "  Test Duration     : ${TEST_DURATION}s" >> "$REPORT_FILE"
-        echo "" >> "$REPORT_FILE"
-    fi
-    
-    if [ -f "$LOG_DIR/AVX_allcore.csv.summary.txt" ]; then
-        AVX_FREQ=$(grep "avg_frequency_mhz" "$LOG_DIR/AVX_allcore.csv.summary.txt" | cut -d= -f2)
-        AVX_TEMP=$(grep "avg_temperature" "$LOG_DIR/AVX_allcore.csv.summary.txt" | cut -d= -f2)
-        
-        echo "Test 2: AVX (License Level 1 / Cdyn1)" >> "$REPORT_FILE"
-        echo "───────────────────────────────────────────────────────────────────" >> "$REPORT_FILE"
-        echo "  Workload Type     : AVX (256-bit FP SIMD)" >> "$REPORT_FILE"
-        echo "  Cdyn Class        : Cdyn1 (Medium)" >> "$REPORT_FILE"
-        echo "  Expected Frequency: ${DCL_AVX_ALLCORE} MHz" >> "$REPORT_FILE"
-        echo "  Measured Frequency: ${AVX_FREQ} MHz" >> "$REPORT_FILE"
-        echo "  Avg Temperature   : ${AVX_TEMP}°C" >> "$REPORT_FILE"
-        echo "  Test Duration     : ${TEST_DURATION}s" >> "$REPORT_FILE"
-        echo "" >> "$REPORT_FILE"
-    fi
-    
-    if [ -f "$LOG_DIR/AVX2_allcore.csv.summary.txt" ]; then
-        AVX2_FREQ=$(grep "avg_frequency_mhz" "$LOG_DIR/AVX2_allcore.csv.summary.txt" | cut -d= -f2)
-        AVX2_TEMP=$(grep "avg_temperature" "$LOG_DIR/AVX2_allcore.csv.summary.txt" | cut -d= -f2)
-        
-        echo "Test 3: AVX2 (License Level 2 / Cdyn2)" >> "$REPORT_FILE"
-        echo "───────────────────────────────────────────────────────────────────" >> "$REPORT_FILE"
-        echo "  Workload Type     : AVX2 (256-bit FP+INT+FMA)" >> "$REPORT_FILE"
-        echo "  Cdyn Class        : Cdyn2 (High)" >> "$REPORT_FILE"
-        echo "  Expected Frequency: ${DCL_AVX2_ALLCORE} MHz" >> "$REPORT_FILE"
-        echo "  Measured Frequency: ${AVX2_FREQ} MHz" >> "$REPORT_FILE"
-        echo "  Avg Temperature   : ${AVX2_TEMP}°C" >> "$REPORT_FILE"
-        echo "  Test Duration     : ${TEST_DURATION}s" >> "$REPORT_FILE"
-        echo "" >> "$REPORT_FILE"
-    fi
-    
-    cat << EOF >> "$REPORT_FILE"
+Overall        : ${VERDICT}
 
 DETAILED LOGS
 ═══════════════════════════════════════════════════════════════════
 
-CSV Logs:
-  - $LOG_DIR/SSE_allcore.csv
-  - $LOG_DIR/AVX_allcore.csv
-  - $LOG_DIR/AVX2_allcore.csv
-
-Summary Files:
-  - $LOG_DIR/SSE_allcore.csv.summary.txt
-  - $LOG_DIR/AVX_allcore.csv.summary.txt
-  - $LOG_DIR/AVX2_allcore.csv.summary.txt
-
-CONCLUSION
-═══════════════════════════════════════════════════════════════════
-
-Review the validation results above to confirm:
-1. Measured frequencies match DCL specifications within tolerance
-2. All license levels (Cdyn0/1/2) achieve expected all-core turbo
-3. Temperature remains within acceptable limits
-4. No thermal throttling observed
+  - $JSON_REPORT  (every point, per CPU and per package)
+  - $RUN_OUTPUT
 
-If any test shows FAIL status:
+If any check shows FAIL:
 - Check BIOS configuration (AVX offset, turbo settings)
 - Verify thermal solution (cooling, airflow)
 - Confirm power limits (TDP, PL1/PL2)
@@ -287,37 +232,24 @@ main() {
     check_prerequisites
     
     print_section "Starting DCL Validation Tests"
-    echo "This will take approximately $((TEST_DURATION * 3)) seconds..."
+    echo "Each spec point runs for ${TEST_DURATION} seconds..."
     echo ""
-    
-    # Test 1: SSE (Cdyn0 / License Level 0)
-    run_validation_test \
-        "License Level 0 (Cdyn0)" \
-        "SSE" \
-        "$DCL_SSE_ALLCORE" \
-        "0 (Low Power)"
-    
-    # Test 2: AVX (Cdyn1 / License Level 1)
-    run_validation_test \
-        "License Level 1 (Cdyn1)" \
-        "AVX" \
-        "$DCL_AVX_ALLCORE" \
-        "1 (Medium Power)"
-    
-    # Test 3: AVX2 (Cdyn2 / License Level 2)
-    run_validation_test \
-        "License Level 2 (Cdyn2)" \
-        "AVX2" \
-        "$DCL_AVX2_ALLCORE" \
-        "2 (High Power)"
-    
+
+    run_validation
+
     # Generate report
     generate_report
     
     # Display summary
     display_summary
     
-    echo -e "${GREEN}✓ All tests completed successfully${NC}"
+    if [ "$DCL_STATUS" -eq 0 ]; then
+        echo -e "${GREEN}✓ DCL validation passed${NC}"
+    elif [ "$DCL_STATUS" -eq 5 ]; then
+        echo -e "${YELLOW}? DCL validation inconclusive: nothing could be measured${NC}"
+    else
+        echo -e "${RED}✗ DCL validation did not pass (exit $DCL_STATUS)${NC}"
+    fi
     echo ""
     echo "Next steps:"
     echo "  1. Review validation report: cat $REPORT_FILE"
@@ -328,3 +260,4 @@ main() {
 
 # Run main function
 main
+exit $DCL_STATUS
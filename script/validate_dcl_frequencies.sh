@@ -33,9 +33,10 @@ DCL_AVX2_ALLCORE=2500
 # Tolerance (percentage deviation allowed)
 DCL_TOLERANCE=3.0
 
-# Test duration (seconds)
-P0N_DURATION=60
-ALLCORE_DURATION=120
+# Measurement time per point (seconds), after the frequency has settled.
+# All points run in one coreburner process (--dcl-suite) on a warm worker
+# pool, so there is no per-test process start, buffer setup or CSV re-parse.
+POINT_DURATION=20
 
 # ============================================================================
 # SCRIPT CONFIGURATION
@@ -109,28 +110,23 @@ check_prerequisites() {
     echo ""
 }
 
-run_validation_test() {
-    local test_name=$1
-    local mode=$2
-    local util=$3
-    local duration=$4
-    local workload_type=$5
-    local dcl_freq=$6
-    local log_file="${LOG_DIR}/${test_name}.csv"
-    
-    print_test "Running: $test_name"
-    
-    $COREBURNER \
-        --mode "$mode" \
-        --util "$util" \
-        --duration "${duration}s" \
-        --type "$workload_type" \
-        --dcl-${workload_type,,}-freq "$dcl_freq" \
-        --dcl-tolerance "$DCL_TOLERANCE" \
-        --log "$log_file" \
-        2>&1 | tee "${log_file}.output.txt"
-    
-    echo ""
+# Spec for this run: P0n = single active core, all-core = every CPU loaded
+write_spec() {
+    local spec=$1
+    {
+        echo "# coreburner dcl v1 (generated by $(basename "$0"))"
+        echo "sku validate_dcl_frequencies"
+        echo "version ${TIMESTAMP}"
+        echo "cpu $(awk -F': ' '/^vendor_id/{v=$2} /^cpu family/{f=$2} /^model\t/{m=$2} END{print v, f, m}' /proc/cpuinfo) *"
+        echo "tolerance ${DCL_TOLERANCE}"
+        echo "turbo sse    1 ${DCL_SSE_P0N}"
+        echo "turbo avx    1 ${DCL_AVX_P0N}"
+        echo "turbo avx2   1 ${DCL_AVX2_P0N}"
+        [ "$DCL_AVX512_P0N" -gt 0 ] && echo "turbo avx512 1 ${DCL_AVX512_P0N}"
+        echo "p0n sse  ${DCL_SSE_ALLCORE}"
+        echo "p0n avx  ${DCL_AVX_ALLCORE}"
+        echo "p0n avx2 ${DCL_AVX2_ALLCORE}"
+    } > "$spec"
 }
 
 # ============================================================================
@@ -170,75 +166,29 @@ mkdir -p "$LOG_DIR"
 } > "$REPORT_FILE"
 
 # ============================================================================
-# P0n TESTS (Single Core, 100% Utilization)
+# SUITE: all-core per license, then single-core P0n, one process
 # ============================================================================
 
-print_header "Phase 1: P0n Frequency Tests (Single Core)"
-
-run_validation_test \
-    "sse_p0n" \
-    "single" \
-    "100" \
-    "$P0N_DURATION" \
-    "SSE" \
-    "$DCL_SSE_P0N"
-
-run_validation_test \
-    "avx_p0n" \
-    "single" \
-    "100" \
-    "$P0N_DURATION" \
-    "AVX" \
-    "$DCL_AVX_P0N"
-
-run_validation_test \
-    "avx2_p0n" \
-    "single" \
-    "100" \
-    "$P0N_DURATION" \
-    "AVX2" \
-    "$DCL_AVX2_P0N"
-
-# Only test AVX512 if specified
-if [ "$DCL_AVX512_P0N" -gt 0 ]; then
-    run_validation_test \
-        "avx512_p0n" \
-        "single" \
-        "100" \
-        "$P0N_DURATION" \
-        "AVX512" \
-        "$DCL_AVX512_P0N"
-fi
+print_header "Running DCL Suite (all license levels)"
 
-# ============================================================================
-# ALL-CORE TURBO TESTS (Multi Core, 100% Utilization)
-# ============================================================================
+SPEC_FILE="${LOG_DIR}/dcl_spec.dcl"
+JSON_REPORT="${LOG_DIR}/dcl_report.json"
+write_spec "$SPEC_FILE"
 
-print_header "Phase 2: All-Core Turbo Frequency Tests"
-
-run_validation_test \
-    "sse_allcore" \
-    "multi" \
-    "100" \
-    "$ALLCORE_DURATION" \
-    "SSE" \
-    "$DCL_SSE_ALLCORE"
-
-run_validation_test \
-    "avx_allcore" \
-    "multi" \
-    "100" \
-    "$ALLCORE_DURATION" \
-    "AVX" \
-    "$DCL_AVX_ALLCORE"
-
-run_validation_test \
-    "avx2_allcore" \
-    "multi" \
-    "100" \
-    "$ALLCORE_DURATION" \
-    "AVX2" \
-    "$DCL_AVX2_ALLCORE"
+EXTRA=()
+[ "$EUID" -eq 0 ] && EXTRA+=(--enable-msr-freq --enable-rapl)
+
+set +e
+$COREBURNER \
+    --dcl-suite \
+    --dcl-spec "$SPEC_FILE" \
+    --dcl-report "$JSON_REPORT" \
+    --duration "${POINT_DURATION}s" \
+    --log "${LOG_DIR}/dcl_suite.csv" \
+    "${EXTRA[@]}" \
+    2>&1 | tee "${LOG_DIR}/dcl_suite.output.txt"
+SUITE_STATUS=${PIPESTATUS[0]}
+set -e
 
 # ============================================================================
 # RESULTS SUMMARY
@@ -246,41 +196,28 @@ run_validation_test \
 
 print_header "Generating Results Summary"
 
-# Extract validation results from output files
+# One line per point (package scope) from the consolidated JSON report
 {
     echo ""
     echo "========================================="
     echo "TEST RESULTS"
     echo "========================================="
     echo ""
-    
-    for output_file in "${LOG_DIR}"/*.output.txt; do
-        test_name=$(basename "$output_file" .output.txt)
-        
-        if grep -q "Result.*PASS" "$output_file"; then
-            echo "[PASS] $test_name"
-        elif grep -q "Result.*FAIL" "$output_file"; then
-            echo "[FAIL] $test_name"
-        else
-            echo "[????] $test_name (unknown status)"
-        fi
-    done
-    
+
+    grep -o '{"check":"[a-z0-9]*","source":"measured","license":"[a-z0-9]*","active_cores":[0-9]*,"scope":"pkg[0-9]*"[^}]*}' \
+        "$JSON_REPORT" 2>/dev/null |
+    sed -E 's/.*"check":"([a-z0-9]+)".*"license":"([a-z0-9]+)".*"active_cores":([0-9]+).*"scope":"([a-z0-9]+)".*"expected":([0-9.]+).*"measured":([0-9.]+).*"result":"([a-z]+)".*/\7 \1 \2 cores=\3 \4 expected=\5 measured=\6/' |
+    awk '{ printf "[%s] %s_%s %s %s %s %s\n", toupper($1), $3, ($2 == "p0n" ? "allcore" : "p0n"), $4, $5, $6, $7 }'
+
     echo ""
     echo "========================================="
     echo "DETAILED RESULTS"
     echo "========================================="
     echo ""
-    
-    for output_file in "${LOG_DIR}"/*.output.txt; do
-        test_name=$(basename "$output_file" .output.txt)
-        echo "--- $test_name ---"
-        
-        # Extract validation section
-        sed -n '/=== DCL Frequency Validation ===/,/================================/p' "$output_file"
-        echo ""
-    done
-    
+    sed -n '/^Check /,/ checks: /p' "${LOG_DIR}/dcl_suite.output.txt"
+    echo ""
+    echo "Per-CPU rows: $JSON_REPORT"
+
 } >> "$REPORT_FILE"
 
 # Display report
@@ -307,10 +244,10 @@ echo "Detailed logs: $LOG_DIR"
 echo "Full report: $REPORT_FILE"
 echo ""
 
-if [ $FAIL_COUNT -eq 0 ]; then
+if [ $FAIL_COUNT -eq 0 ] && [ $SUITE_STATUS -eq 0 ]; then
     print_pass "All validation tests passed!"
     exit 0
 else
-    print_fail "$FAIL_COUNT test(s) failed"
+    print_fail "$FAIL_COUNT test(s) failed (coreburner exit $SUITE_STATUS)"
     exit 1
 fi